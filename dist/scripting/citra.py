@@ -4,12 +4,16 @@ import enum
 import socket
 
 CURRENT_REQUEST_VERSION = 1
-MAX_REQUEST_DATA_SIZE = 32
-MAX_PACKET_SIZE = 48
+MAX_REQUEST_DATA_SIZE = 1024
+MAX_PACKET_SIZE = 1040
 
 class RequestType(enum.IntEnum):
     ReadMemory = 1,
-    WriteMemory = 2
+    WriteMemory = 2,
+    ReadMemoryBatch = 3,
+    WriteMemoryBatch = 4,
+    WatchMemory = 5,
+    UnwatchMemory = 6
 
 CITRA_PORT = 45987
 
@@ -90,6 +94,82 @@ class Citra:
                 return False
         return True
 
+    def read_memory_batch(self, ranges):
+        """
+        Reads several (address, size) ranges from the same frame. The sizes must add up to at
+        most MAX_REQUEST_DATA_SIZE.
+        >>> c.read_memory_batch([(0x100000, 4), (0x100000, 2)])
+        [b'\\x07\\x00\\x00\\xeb', b'\\x07\\x00']
+        """
+        request_data = b"".join(struct.pack("II", address, size) for address, size in ranges)
+        request, request_id = self._generate_header(RequestType.ReadMemoryBatch, len(request_data))
+        request += request_data
+        self.socket.sendto(request, (self.address, CITRA_PORT))
+
+        raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+        reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.ReadMemoryBatch)
+        if reply_data is None or len(reply_data) != sum(size for _, size in ranges):
+            return None
+
+        result = []
+        for _, size in ranges:
+            result.append(reply_data[:size])
+            reply_data = reply_data[size:]
+        return result
+
+    def write_memory_batch(self, writes):
+        """
+        Writes several (address, contents) pairs at the same frame boundary.
+        >>> c.write_memory_batch([(0x100000, b"\\xff\\xff"), (0x100002, b"\\xff\\xff")])
+        True
+        >>> c.write_memory_batch([(0x100000, b"\\x07\\x00\\x00\\xeb")])
+        True
+        """
+        request_data = b"".join(struct.pack("II", address, len(contents)) + contents
+                                for address, contents in writes)
+        request, request_id = self._generate_header(RequestType.WriteMemoryBatch, len(request_data))
+        request += request_data
+        self.socket.sendto(request, (self.address, CITRA_PORT))
+
+        raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+        return self._read_and_validate_header(raw_reply, request_id, RequestType.WriteMemoryBatch) == b""
+
+    def watch_memory(self, watch_address, watch_size):
+        """
+        Subscribes to a range of memory. Its contents are sent by every frame in which they
+        changed, starting with the next one. Returns the id of the watch.
+        >>> watch_id = c.watch_memory(0x100000, 4)
+        >>> c.wait_watch(watch_id)
+        b'\\x07\\x00\\x00\\xeb'
+        >>> c.unwatch_memory(watch_id)
+        True
+        """
+        request_data = struct.pack("II", watch_address, watch_size)
+        request, request_id = self._generate_header(RequestType.WatchMemory, len(request_data))
+        request += request_data
+        self.socket.sendto(request, (self.address, CITRA_PORT))
+        return request_id
+
+    def wait_watch(self, watch_id):
+        """Blocks until the next notification of the given watch and returns its contents."""
+        while True:
+            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+            reply_data = self._read_and_validate_header(raw_reply, watch_id, RequestType.WatchMemory)
+            if reply_data is not None:
+                return reply_data
+
+    def unwatch_memory(self, watch_id):
+        request_data = struct.pack("I", watch_id)
+        request, request_id = self._generate_header(RequestType.UnwatchMemory, len(request_data))
+        request += request_data
+        self.socket.sendto(request, (self.address, CITRA_PORT))
+
+        # Skip any notification of the watch that was already in flight
+        while True:
+            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+            if self._read_and_validate_header(raw_reply, request_id, RequestType.UnwatchMemory) == b"":
+                return True
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Citra()})
@@ -6,7 +6,10 @@
 
 #include <array>
 #include <cstddef>
-#include <deque>
+#include <span>
+#include <vector>
+#include <boost/serialization/access.hpp>
+#include "common/assert.h"
 #include "common/common_types.h"
 
 namespace AudioCore {
@@ -23,8 +26,64 @@ using StereoFrame16 = std::array<std::array<s16, 2>, samples_per_frame>;
 /// The DSP is quadraphonic internally.
 using QuadFrame32 = std::array<std::array<s32, 4>, samples_per_frame>;
 
-/// A variable length buffer of signed PCM16 stereo samples.
-using StereoBuffer16 = std::deque<std::array<s16, 2>>;
+/**
+ * A variable length buffer of signed PCM16 stereo samples. Decoders write into it and the
+ * interpolators consume from its front. The storage is contiguous and reused between guest
+ * buffers, so a Source only allocates when it sees a buffer longer than any before.
+ */
+class StereoBuffer16 {
+public:
+    using Sample = std::array<s16, 2>;
+
+    /// Number of samples kept in front of the unread ones, for the interpolation history.
+    static constexpr std::size_t history_size = 3;
+
+    /// Discards the contents and returns storage for count new samples.
+    std::span<Sample> Prepare(std::size_t count) {
+        samples.resize(history_size + count);
+        read_position = history_size;
+        return std::span{samples}.subspan(history_size);
+    }
+
+    /// Returns the unread samples preceded by history_size writable history slots.
+    std::span<Sample> WithHistory() {
+        return std::span{samples}.subspan(read_position - history_size);
+    }
+
+    /// Marks the first count unread samples as consumed.
+    void Consume(std::size_t count) {
+        ASSERT(count <= size());
+        read_position += count;
+    }
+
+    void clear() {
+        samples.resize(history_size);
+        read_position = history_size;
+    }
+
+    std::size_t size() const {
+        return samples.size() - read_position;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    const Sample& operator[](std::size_t index) const {
+        return samples[read_position + index];
+    }
+
+private:
+    std::vector<Sample> samples = std::vector<Sample>(history_size);
+    std::size_t read_position = history_size;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& samples;
+        ar& read_position;
+    }
+    friend class boost::serialization::access;
+};
 
 constexpr std::size_t num_dsp_pipe = 8;
 enum class DspPipe {
@@ -8,119 +8,141 @@
 #include <cstring>
 #include "audio_core/audio_types.h"
 #include "audio_core/codec.h"
+#include "common/arch.h"
 #include "common/assert.h"
 #include "common/common_types.h"
 
+#if CITRA_ARCH(x86_64)
+#include <emmintrin.h>
+#endif
+
 namespace AudioCore::Codec {
 
-StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
-                           const std::array<s16, 16>& adpcm_coeff, ADPCMState& state) {
+void DecodeADPCM(const u8* const data, const std::size_t sample_count,
+                 const std::array<s16, 16>& adpcm_coeff, ADPCMState& state,
+                 std::span<std::array<s16, 2>> output) {
     // GC-ADPCM with scale factor and variable coefficients.
     // Frames are 8 bytes long containing 14 samples each.
     // Samples are 4 bits (one nibble) long.
 
     constexpr std::size_t FRAME_LEN = 8;
     constexpr std::size_t SAMPLES_PER_FRAME = 14;
-    static constexpr std::array<int, 16> SIGNED_NIBBLES{
-        0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1,
-    };
 
-    const std::size_t ret_size =
-        sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
-    StereoBuffer16 ret(ret_size);
+    // Samples are decoded in pairs, one per byte, so an odd trailing nibble is decoded too.
+    const std::size_t decoded_size = ADPCMDecodedSize(sample_count);
+    ASSERT(output.size() >= decoded_size);
 
     int yn1 = state.yn1, yn2 = state.yn2;
 
-    const std::size_t NUM_FRAMES =
-        (sample_count + (SAMPLES_PER_FRAME - 1)) / SAMPLES_PER_FRAME; // Round up.
-    for (std::size_t framei = 0; framei < NUM_FRAMES; framei++) {
-        const int frame_header = data[framei * FRAME_LEN];
-        const int scale = 1 << (frame_header & 0xF);
-        const int idx = (frame_header >> 4) & 0x7;
+    for (std::size_t frame_start = 0; frame_start < decoded_size;
+         frame_start += SAMPLES_PER_FRAME) {
+        const u8* const frame = data + frame_start / SAMPLES_PER_FRAME * FRAME_LEN;
+        const int scale = 1 << (frame[0] & 0xF);
+        const int idx = (frame[0] >> 4) & 0x7;
 
         // Coefficients are fixed point with 11 bits fractional part.
         const int coef1 = adpcm_coeff[idx * 2 + 0];
         const int coef2 = adpcm_coeff[idx * 2 + 1];
 
-        // Decodes an audio sample. One nibble produces one sample.
-        const auto decode_sample = [&](const int nibble) -> s16 {
-            const int xn = nibble * scale;
-            // We first transform everything into 11 bit fixed point, perform the second order
-            // digital filter, then transform back.
-            // 0x400 == 0.5 in 11 bit fixed point.
-            // Filter: y[n] = x[n] + 0.5 + c1 * y[n-1] + c2 * y[n-2]
-            int val = ((xn << 11) + 0x400 + coef1 * yn1 + coef2 * yn2) >> 11;
-            // Clamp to output range.
-            val = std::clamp(val, -32768, 32767);
+        // The input terms of the filter do not depend on its output, so they are worked out for
+        // the whole frame first. This leaves only the recursive part in the loop below.
+        // We first transform everything into 11 bit fixed point, perform the second order
+        // digital filter, then transform back.
+        // 0x400 == 0.5 in 11 bit fixed point.
+        const std::size_t count = std::min(SAMPLES_PER_FRAME, decoded_size - frame_start);
+        std::array<int, SAMPLES_PER_FRAME> xn;
+        for (std::size_t i = 0; i < count; i++) {
+            const int nibble = (i % 2 == 0 ? frame[1 + i / 2] >> 4 : frame[1 + i / 2]) & 0xF;
+            // Sign extension of the nibble.
+            xn[i] = (((nibble ^ 8) - 8) * scale << 11) + 0x400;
+        }
+
+        // Filter: y[n] = x[n] + 0.5 + c1 * y[n-1] + c2 * y[n-2]
+        for (std::size_t i = 0; i < count; i++) {
+            // Clamp to output range. std::clamp on integers compiles to conditional moves.
+            const int val = std::clamp((xn[i] + coef1 * yn1 + coef2 * yn2) >> 11, -32768, 32767);
             // Advance output feedback.
             yn2 = yn1;
             yn1 = val;
-            return (s16)val;
-        };
-
-        std::size_t outputi = framei * SAMPLES_PER_FRAME;
-        std::size_t datai = framei * FRAME_LEN + 1;
-        for (std::size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
-            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi].fill(sample1);
-            outputi++;
-
-            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi].fill(sample2);
-            outputi++;
-
-            datai++;
+            output[frame_start + i].fill(static_cast<s16>(val));
         }
     }
 
     state.yn1 = static_cast<s16>(yn1);
     state.yn2 = static_cast<s16>(yn2);
-
-    return ret;
 }
 
-StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
-                          const std::size_t sample_count) {
+void DecodePCM8(const unsigned num_channels, const u8* const data,
+                const std::size_t sample_count, std::span<std::array<s16, 2>> output) {
     ASSERT(num_channels == 1 || num_channels == 2);
+    ASSERT(output.size() >= sample_count);
 
     const auto decode_sample = [](u8 sample) {
         return static_cast<s16>(static_cast<u16>(sample) << 8);
     };
 
-    StereoBuffer16 ret(sample_count);
-
+    std::size_t i = 0;
+#if CITRA_ARCH(x86_64)
+    // Interleaving the bytes with zeroes shifts them into the upper half of each s16.
+    const __m128i zero = _mm_setzero_si128();
+    auto* out = reinterpret_cast<__m128i*>(output.data());
     if (num_channels == 1) {
-        for (std::size_t i = 0; i < sample_count; i++) {
-            ret[i].fill(decode_sample(data[i]));
+        for (; i + 16 <= sample_count; i += 16, out += 4) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            const __m128i lo = _mm_unpacklo_epi8(bytes, bytes);
+            const __m128i hi = _mm_unpackhi_epi8(bytes, bytes);
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi8(zero, lo));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(zero, lo));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi8(zero, hi));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi8(zero, hi));
         }
     } else {
-        for (std::size_t i = 0; i < sample_count; i++) {
-            ret[i][0] = decode_sample(data[i * 2 + 0]);
-            ret[i][1] = decode_sample(data[i * 2 + 1]);
+        for (; i + 8 <= sample_count; i += 8, out += 2) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2));
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi8(zero, bytes));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(zero, bytes));
         }
     }
+#endif
 
-    return ret;
+    if (num_channels == 1) {
+        for (; i < sample_count; i++) {
+            output[i].fill(decode_sample(data[i]));
+        }
+    } else {
+        for (; i < sample_count; i++) {
+            output[i][0] = decode_sample(data[i * 2 + 0]);
+            output[i][1] = decode_sample(data[i * 2 + 1]);
+        }
+    }
 }
 
-StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
-                           const std::size_t sample_count) {
+void DecodePCM16(const unsigned num_channels, const u8* const data,
+                 const std::size_t sample_count, std::span<std::array<s16, 2>> output) {
     ASSERT(num_channels == 1 || num_channels == 2);
+    ASSERT(output.size() >= sample_count);
 
-    StereoBuffer16 ret(sample_count);
+    if (num_channels == 2) {
+        std::memcpy(output.data(), data, sample_count * sizeof(s16) * 2);
+        return;
+    }
 
-    if (num_channels == 1) {
-        for (std::size_t i = 0; i < sample_count; i++) {
-            s16 sample;
-            std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
-            ret[i].fill(sample);
-        }
-    } else {
-        for (std::size_t i = 0; i < sample_count; ++i) {
-            std::memcpy(&ret[i], data + i * sizeof(s16) * 2, 2 * sizeof(s16));
-        }
+    std::size_t i = 0;
+#if CITRA_ARCH(x86_64)
+    // Interleaving the samples with themselves duplicates them into both channels.
+    auto* out = reinterpret_cast<__m128i*>(output.data());
+    for (; i + 8 <= sample_count; i += 8, out += 2) {
+        const __m128i samples =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * sizeof(s16)));
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(samples, samples));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(samples, samples));
     }
+#endif
 
-    return ret;
+    for (; i < sample_count; i++) {
+        s16 sample;
+        std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
+        output[i].fill(sample);
+    }
 }
 } // namespace AudioCore::Codec
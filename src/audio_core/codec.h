@@ -5,6 +5,8 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <span>
 #include "audio_core/audio_types.h"
 #include "common/common_types.h"
 
@@ -18,31 +20,40 @@ struct ADPCMState {
     s16 yn2; ///< y[n-2]
 };
 
+/// Number of samples DecodeADPCM writes: sample_count rounded up to a multiple of two.
+constexpr std::size_t ADPCMDecodedSize(std::size_t sample_count) {
+    return sample_count + sample_count % 2;
+}
+
 /**
  * @param data Pointer to buffer that contains ADPCM data to decode
  * @param sample_count Length of buffer in terms of number of samples
  * @param adpcm_coeff ADPCM coefficients
  * @param state ADPCM state, this is updated with new state
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param output Receives the decoded stereo signed PCM16 data. Must hold at least
+ * ADPCMDecodedSize(sample_count) samples.
  */
-StereoBuffer16 DecodeADPCM(const u8* data, const std::size_t sample_count,
-                           const std::array<s16, 16>& adpcm_coeff, ADPCMState& state);
+void DecodeADPCM(const u8* data, const std::size_t sample_count,
+                 const std::array<s16, 16>& adpcm_coeff, ADPCMState& state,
+                 std::span<std::array<s16, 2>> output);
 
 /**
  * @param num_channels Number of channels
  * @param data Pointer to buffer that contains PCM8 data to decode
  * @param sample_count Length of buffer in terms of number of samples
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param output Receives the decoded stereo signed PCM16 data. Must hold at least sample_count
+ * samples.
  */
-StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
-                          const std::size_t sample_count);
+void DecodePCM8(const unsigned num_channels, const u8* const data,
+                const std::size_t sample_count, std::span<std::array<s16, 2>> output);
 
 /**
  * @param num_channels Number of channels
  * @param data Pointer to buffer that contains PCM16 data to decode
  * @param sample_count Length of buffer in terms of number of samples
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param output Receives the decoded stereo signed PCM16 data. Must hold at least sample_count
+ * samples.
  */
-StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
-                           const std::size_t sample_count);
+void DecodePCM16(const unsigned num_channels, const u8* const data,
+                 const std::size_t sample_count, std::span<std::array<s16, 2>> output);
 } // namespace AudioCore::Codec
@@ -21,6 +21,8 @@
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/perf_counters.h"
+#include "common/thread_pool.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 
@@ -44,6 +46,10 @@ SERIALIZE_IMPL(DspHle)
 // This value has been verified against a rough hardware test with hardware and LLE
 static constexpr u64 audio_frame_ticks = samples_per_frame * 4096 * 2ull; ///< Units: ARM11 cycles
 
+/// Sources ticked by each task of the shared thread pool. An idle source costs next to nothing,
+/// so a task has to cover a few of them to be worth scheduling.
+static constexpr std::size_t sources_per_task = 4;
+
 struct DspHle::Impl final {
 public:
     explicit Impl(DspHle& parent, Memory::MemorySystem& memory, Core::Timing& timing);
@@ -370,10 +376,20 @@ StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
 
     std::array<QuadFrame32, 3> intermediate_mixes = {};
 
-    // Generate intermediate mixes
+    // Sources only touch their own state, configuration and status, so they are ticked in
+    // parallel. Decoding, resampling and filtering all happen here. While waiting, this thread
+    // only runs the ticks themselves, never unrelated pool work such as shader compiles.
+    Common::ThreadPool::Shared().ParallelFor(
+        HLE::num_sources, sources_per_task, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                write.source_statuses.status[i] = sources[i].Tick(
+                    read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+            }
+        });
+
+    // Generate intermediate mixes. Sources are mixed in order, so the output does not depend on
+    // how the ticks were scheduled.
     for (std::size_t i = 0; i < HLE::num_sources; i++) {
-        write.source_statuses.status[i] =
-            sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
         for (std::size_t mix = 0; mix < 3; mix++) {
             sources[i].MixInto(intermediate_mixes[mix], mix);
         }
@@ -396,6 +412,10 @@ StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
 }
 
 bool DspHle::Impl::Tick() {
+    static const Common::Perf::Counter dsp_frames{"DSP frames"};
+    dsp_frames.Add();
+    PERF_TRACE_SCOPE("DSP frame");
+
     StereoFrame16 current_frame = {};
 
     // TODO: Check dsp::DSP semaphore (which indicates emulated application has finished writing to
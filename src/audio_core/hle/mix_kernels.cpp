@@ -0,0 +1,213 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstddef>
+#include "audio_core/hle/mix_kernels.h"
+#include "common/arch.h"
+
+#if CITRA_ARCH(x86_64)
+#include <emmintrin.h>
+#endif
+
+namespace AudioCore::HLE::MixKernels {
+
+static s16 ClampToS16(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
+                                           const std::array<s16, 2>& b) {
+    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
+            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+}
+
+#if CITRA_ARCH(x86_64)
+/// Transposes a 4x4 matrix of s32 held one row per register.
+static void Transpose(__m128i (&rows)[4]) {
+    const __m128i t0 = _mm_unpacklo_epi32(rows[0], rows[1]);
+    const __m128i t1 = _mm_unpacklo_epi32(rows[2], rows[3]);
+    const __m128i t2 = _mm_unpackhi_epi32(rows[0], rows[1]);
+    const __m128i t3 = _mm_unpackhi_epi32(rows[2], rows[3]);
+    rows[0] = _mm_unpacklo_epi64(t0, t1);
+    rows[1] = _mm_unpackhi_epi64(t0, t1);
+    rows[2] = _mm_unpacklo_epi64(t2, t3);
+    rows[3] = _mm_unpackhi_epi64(t2, t3);
+}
+
+/// Loads four quadraphonic samples, one per register.
+static void LoadSamples(const std::array<s32, 4>* samples, __m128i (&rows)[4]) {
+    for (std::size_t i = 0; i < 4; i++) {
+        rows[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+    }
+}
+
+/// Adds four stereo samples to the frame, saturating to the range of s16.
+static void MixInto(std::array<s16, 2>* frame, __m128i samples) {
+    auto* dest = reinterpret_cast<__m128i*>(frame);
+    _mm_storeu_si128(dest, _mm_adds_epi16(_mm_loadu_si128(dest), samples));
+}
+#endif
+
+void StereoToQuad(const StereoFrame16& input, const std::array<float, 4>& gains,
+                  QuadFrame32& dest) {
+#if CITRA_ARCH(x86_64)
+    // Four samples are loaded at a time, and each one is spread to L R L R to scale all four
+    // channels at once.
+    const __m128 scale = _mm_loadu_ps(gains.data());
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        const __m128i stereo16 =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[samplei]));
+        const __m128i stereo32[2] = {
+            _mm_srai_epi32(_mm_unpacklo_epi16(stereo16, stereo16), 16),
+            _mm_srai_epi32(_mm_unpackhi_epi16(stereo16, stereo16), 16),
+        };
+        for (std::size_t half = 0; half < 2; half++) {
+            const __m128i lrlr[2] = {
+                _mm_shuffle_epi32(stereo32[half], _MM_SHUFFLE(1, 0, 1, 0)),
+                _mm_shuffle_epi32(stereo32[half], _MM_SHUFFLE(3, 2, 3, 2)),
+            };
+            for (std::size_t i = 0; i < 2; i++) {
+                const __m128i quad = _mm_cvttps_epi32(_mm_mul_ps(scale, _mm_cvtepi32_ps(lrlr[i])));
+                auto* out = reinterpret_cast<__m128i*>(&dest[samplei + half * 2 + i]);
+                _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), quad));
+            }
+        }
+    }
+#else
+    StereoToQuadScalar(input, gains, dest);
+#endif
+}
+
+void StereoToQuadScalar(const StereoFrame16& input, const std::array<float, 4>& gains,
+                        QuadFrame32& dest) {
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        dest[samplei][0] += static_cast<s32>(gains[0] * input[samplei][0]);
+        dest[samplei][1] += static_cast<s32>(gains[1] * input[samplei][1]);
+        dest[samplei][2] += static_cast<s32>(gains[2] * input[samplei][0]);
+        dest[samplei][3] += static_cast<s32>(gains[3] * input[samplei][1]);
+    }
+}
+
+void DownmixMono(float gain, const QuadFrame32& input, StereoFrame16& dest) {
+#if CITRA_ARCH(x86_64)
+    // Four samples at a time, transposed so that each lane holds one sample. The channels are
+    // summed in the same order as the scalar version so that the result is bit-identical.
+    const __m128 scale = _mm_set1_ps(gain);
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        __m128i channels[4];
+        LoadSamples(&input[samplei], channels);
+        Transpose(channels);
+        __m128 sum = _mm_mul_ps(scale, _mm_cvtepi32_ps(channels[0]));
+        for (std::size_t channel = 1; channel < 4; channel++) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(scale, _mm_cvtepi32_ps(channels[channel])));
+        }
+        const __m128i mono32 = _mm_cvttps_epi32(_mm_mul_ps(sum, _mm_set1_ps(0.5f)));
+        const __m128i mono16 = _mm_packs_epi32(mono32, mono32);
+        MixInto(&dest[samplei], _mm_unpacklo_epi16(mono16, mono16));
+    }
+#else
+    DownmixMonoScalar(gain, input, dest);
+#endif
+}
+
+void DownmixMonoScalar(float gain, const QuadFrame32& input, StereoFrame16& dest) {
+    std::transform(
+        dest.begin(), dest.end(), input.begin(), dest.begin(),
+        [gain](const std::array<s16, 2>& accumulator,
+               const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+            // Downmix to mono
+            s16 mono = ClampToS16(static_cast<s32>(
+                (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+            // Mix into current frame
+            return AddAndClampToS16(accumulator, {mono, mono});
+        });
+}
+
+void DownmixStereo(float gain, const QuadFrame32& input, StereoFrame16& dest) {
+#if CITRA_ARCH(x86_64)
+    // Four samples at a time. Adding the upper half of each scaled sample to its lower half gives
+    // the left and right channels.
+    const __m128 scale = _mm_set1_ps(gain);
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        __m128i quads[4];
+        LoadSamples(&input[samplei], quads);
+        __m128i stereo[2];
+        for (std::size_t pair = 0; pair < 2; pair++) {
+            const __m128 a = _mm_mul_ps(scale, _mm_cvtepi32_ps(quads[pair * 2]));
+            const __m128 b = _mm_mul_ps(scale, _mm_cvtepi32_ps(quads[pair * 2 + 1]));
+            const __m128 sum = _mm_add_ps(_mm_movelh_ps(a, b), _mm_movehl_ps(b, a));
+            stereo[pair] = _mm_cvttps_epi32(sum);
+        }
+        MixInto(&dest[samplei], _mm_packs_epi32(stereo[0], stereo[1]));
+    }
+#else
+    DownmixStereoScalar(gain, input, dest);
+#endif
+}
+
+void DownmixStereoScalar(float gain, const QuadFrame32& input, StereoFrame16& dest) {
+    std::transform(dest.begin(), dest.end(), input.begin(), dest.begin(),
+                   [gain](const std::array<s16, 2>& accumulator,
+                          const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+                       // Downmix to stereo
+                       s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+                       s16 right =
+                           ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+                       // Mix into current frame
+                       return AddAndClampToS16(accumulator, {left, right});
+                   });
+}
+
+void ToChannelMajor(const QuadFrame32& input, IntermediateMixSamples::Samples& output) {
+#if CITRA_ARCH(x86_64)
+    for (std::size_t sample = 0; sample < samples_per_frame; sample += 4) {
+        __m128i channels[4];
+        LoadSamples(&input[sample], channels);
+        Transpose(channels);
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&output.pcm32[channel][sample]),
+                             channels[channel]);
+        }
+    }
+#else
+    ToChannelMajorScalar(input, output);
+#endif
+}
+
+void ToChannelMajorScalar(const QuadFrame32& input, IntermediateMixSamples::Samples& output) {
+    for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            output.pcm32[channel][sample] = input[sample][channel];
+        }
+    }
+}
+
+void FromChannelMajor(const IntermediateMixSamples::Samples& input, QuadFrame32& output) {
+#if CITRA_ARCH(x86_64)
+    for (std::size_t sample = 0; sample < samples_per_frame; sample += 4) {
+        __m128i samples[4];
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            samples[channel] =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input.pcm32[channel][sample]));
+        }
+        Transpose(samples);
+        for (std::size_t i = 0; i < 4; i++) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[sample + i]), samples[i]);
+        }
+    }
+#else
+    FromChannelMajorScalar(input, output);
+#endif
+}
+
+void FromChannelMajorScalar(const IntermediateMixSamples::Samples& input, QuadFrame32& output) {
+    for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            output[sample][channel] = input.pcm32[channel][sample];
+        }
+    }
+}
+
+} // namespace AudioCore::HLE::MixKernels
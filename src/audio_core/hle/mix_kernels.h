@@ -0,0 +1,42 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "audio_core/audio_types.h"
+#include "audio_core/hle/shared_memory.h"
+
+/**
+ * Sample loops of the HLE mixing stages. Each one has a scalar version, which defines the result,
+ * and a version that uses SIMD where the host has it. The two are bit-identical.
+ */
+namespace AudioCore::HLE::MixKernels {
+
+/// Scales the stereo input by gains, spread to the channels as L R L R, and adds it to dest.
+void StereoToQuad(const StereoFrame16& input, const std::array<float, 4>& gains,
+                  QuadFrame32& dest);
+void StereoToQuadScalar(const StereoFrame16& input, const std::array<float, 4>& gains,
+                        QuadFrame32& dest);
+
+/// Downmixes the scaled input to mono and adds it to both channels of dest, saturating.
+void DownmixMono(float gain, const QuadFrame32& input, StereoFrame16& dest);
+void DownmixMonoScalar(float gain, const QuadFrame32& input, StereoFrame16& dest);
+
+/// Downmixes the scaled input to stereo and adds it to dest, saturating.
+void DownmixStereo(float gain, const QuadFrame32& input, StereoFrame16& dest);
+void DownmixStereoScalar(float gain, const QuadFrame32& input, StereoFrame16& dest);
+
+// NOTE: IntermediateMixSamples::Samples::pcm32 annoyingly has its dimensions in reverse order to
+// QuadFrame32.
+
+/// Converts a frame to the channel-major layout of the shared memory.
+void ToChannelMajor(const QuadFrame32& input, IntermediateMixSamples::Samples& output);
+void ToChannelMajorScalar(const QuadFrame32& input, IntermediateMixSamples::Samples& output);
+
+/// Converts a frame from the channel-major layout of the shared memory.
+void FromChannelMajor(const IntermediateMixSamples::Samples& input, QuadFrame32& output);
+void FromChannelMajorScalar(const IntermediateMixSamples::Samples& input, QuadFrame32& output);
+
+} // namespace AudioCore::HLE::MixKernels
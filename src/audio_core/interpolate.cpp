@@ -3,9 +3,15 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <span>
 #include "audio_core/interpolate.h"
+#include "common/arch.h"
 #include "common/assert.h"
 
+#if CITRA_ARCH(x86_64)
+#include <emmintrin.h>
+#endif
+
 namespace AudioCore::AudioInterp {
 
 // Calculations are done in fixed point with 24 fractional bits.
@@ -14,7 +20,9 @@ constexpr u64 scale_factor = 1 << 24;
 constexpr u64 scale_mask = scale_factor - 1;
 
 /// Here we step over the input in steps of rate, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
+/// fn is given the input window starting at x[n-3], the position of the first output within it,
+/// the step size and the outputs to produce. Each output position has one sample before it and
+/// two samples after it available in the window.
 template <typename Function>
 static void StepOverSamples(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
                             std::size_t& outputi, Function fn) {
@@ -23,53 +31,183 @@ static void StepOverSamples(State& state, StereoBuffer16& input, float rate, Ste
     if (input.empty())
         return;
 
-    input.insert(input.begin(), {state.xn2, state.xn1});
+    // The historical samples go into the slots in front of the unread ones, so that the whole
+    // window is one contiguous run of samples.
+    const std::span<std::array<s16, 2>> samples = input.WithHistory();
+    samples[0] = state.xn3;
+    samples[1] = state.xn2;
+    samples[2] = state.xn1;
 
     const u64 step_size = static_cast<u64>(rate * scale_factor);
-    u64 fposition = state.fposition;
-    std::size_t inputi = 0;
+    const u64 fposition = state.fposition;
+
+    // Work out up front how many outputs the input covers, so that fn runs one tight loop.
+    const u64 end = (samples.size() - StereoBuffer16::history_size) * scale_factor;
+    const std::size_t max_steps = output.size() - outputi;
+    std::size_t steps = 0;
+    if (fposition < end) {
+        steps = step_size == 0
+                    ? max_steps
+                    : static_cast<std::size_t>(std::min<u64>(
+                          max_steps, (end - fposition + step_size - 1) / step_size));
+    }
+    fn(std::span<const std::array<s16, 2>>{samples}, fposition, step_size,
+       std::span{output}.subspan(outputi, steps));
+    outputi += steps;
 
-    while (outputi < output.size()) {
-        inputi = static_cast<std::size_t>(fposition / scale_factor);
+    // Keep the samples around the last position if the output filled up, otherwise everything
+    // has been consumed.
+    std::size_t inputi = 0;
+    if (steps < max_steps) {
+        inputi = samples.size() - StereoBuffer16::history_size;
+    } else if (steps > 0) {
+        inputi = static_cast<std::size_t>((fposition + (steps - 1) * step_size) / scale_factor);
+    }
 
-        if (inputi + 2 >= input.size()) {
-            inputi = input.size() - 2;
-            break;
-        }
+    state.xn3 = samples[inputi];
+    state.xn2 = samples[inputi + 1];
+    state.xn1 = samples[inputi + 2];
+    state.fposition = fposition + steps * step_size - inputi * scale_factor;
 
-        u64 fraction = fposition & scale_mask;
-        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+    input.Consume(inputi);
+}
 
+/// Calls fn with the fraction and the two samples around each output position.
+template <typename Function>
+static void ForEachStep(std::span<const std::array<s16, 2>> samples, u64 fposition, u64 step_size,
+                        std::span<std::array<s16, 2>> output, Function fn) {
+    for (auto& sample : output) {
+        const auto inputi = static_cast<std::size_t>(fposition / scale_factor);
+        sample = fn(fposition & scale_mask, samples[inputi + 1], samples[inputi + 2]);
         fposition += step_size;
     }
-
-    state.xn2 = input[inputi];
-    state.xn1 = input[inputi + 1];
-    state.fposition = fposition - inputi * scale_factor;
-
-    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
 }
 
 void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
           std::size_t& outputi) {
-    StepOverSamples(
-        state, input, rate, output, outputi,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+    const auto hold = [](u64 fraction, const auto& x0, const auto& x1) { return x0; };
+    StepOverSamples(state, input, rate, output, outputi,
+                    [&](auto samples, u64 fposition, u64 step_size, auto output) {
+                        ForEachStep(samples, fposition, step_size, output, hold);
+                    });
 }
 
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi) {
     // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
+    const auto interpolate = [](u64 fraction, const auto& x0, const auto& x1) {
+        // This is a saturated subtraction. (Verified by black-box fuzzing.)
+        s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
+        s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
+
+        return std::array<s16, 2>{
+            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
+            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
+        };
+    };
+    StepOverSamples(state, input, rate, output, outputi,
+                    [&](auto samples, u64 fposition, u64 step_size, auto output) {
+                        ForEachStep(samples, fposition, step_size, output, interpolate);
+                    });
+}
+
+namespace {
+constexpr std::size_t num_taps = 4;
+constexpr std::size_t num_phases = 128;
+constexpr u64 phase_shift = 24 - 7;
+static_assert(scale_factor >> phase_shift == num_phases);
+
+/// Filter coefficients are fixed point with 14 fractional bits.
+constexpr int coefficient_bits = 14;
+using FilterBank = std::array<std::array<s16, num_taps>, num_phases>;
+
+/// Samples the kernel at every phase. Each phase is adjusted to sum to one, so that the filter
+/// has unity gain at DC despite the rounding of the coefficients.
+template <typename Kernel>
+constexpr FilterBank MakeFilterBank(Kernel kernel) {
+    FilterBank bank{};
+    for (std::size_t phase = 0; phase < num_phases; phase++) {
+        const double t = static_cast<double>(phase) / num_phases;
+        const std::array<double, num_taps> weights = kernel(t);
+        s32 sum = 0;
+        for (std::size_t tap = 0; tap < num_taps; tap++) {
+            const double scaled = weights[tap] * (1 << coefficient_bits);
+            bank[phase][tap] = static_cast<s16>(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+            sum += bank[phase][tap];
+        }
+        bank[phase][t < 0.5 ? 1 : 2] += static_cast<s16>((1 << coefficient_bits) - sum);
+    }
+    return bank;
+}
+
+/// Catmull-Rom spline, for upsampling.
+constexpr FilterBank catmull_rom_bank = MakeFilterBank([](double t) {
+    const double t2 = t * t;
+    const double t3 = t2 * t;
+    return std::array<double, num_taps>{
+        (-t3 + 2 * t2 - t) / 2,
+        (3 * t3 - 5 * t2 + 2) / 2,
+        (-3 * t3 + 4 * t2 + t) / 2,
+        (t3 - t2) / 2,
+    };
+});
+
+/// Cubic B-spline, for decimation.
+constexpr FilterBank b_spline_bank = MakeFilterBank([](double t) {
+    const double t2 = t * t;
+    const double t3 = t2 * t;
+    return std::array<double, num_taps>{
+        (1 - t) * (1 - t) * (1 - t) / 6,
+        (3 * t3 - 6 * t2 + 4) / 6,
+        (-3 * t3 + 3 * t2 + 3 * t + 1) / 6,
+        t3 / 6,
+    };
+});
+
+/// Applies the filter for one output. The four stereo taps are adjacent in memory, so both
+/// channels are filtered at once with a single multiply-add of eight lanes.
+std::array<s16, 2> Filter(const std::array<s16, num_taps>& phase, const std::array<s16, 2>* x) {
+#if CITRA_ARCH(x86_64)
+    const __m128i coefficients =
+        _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(phase.data())),
+                           _mm_loadl_epi64(reinterpret_cast<const __m128i*>(phase.data())));
+    // Deinterleave L0 R0 L1 R1 L2 R2 L3 R3 into L0 L1 L2 L3 R0 R1 R2 R3.
+    __m128i taps = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x));
+    taps = _mm_shufflelo_epi16(taps, _MM_SHUFFLE(3, 1, 2, 0));
+    taps = _mm_shufflehi_epi16(taps, _MM_SHUFFLE(3, 1, 2, 0));
+    taps = _mm_shuffle_epi32(taps, _MM_SHUFFLE(3, 1, 2, 0));
+    // Sums of pairs of taps, then of both pairs: L L R R.
+    __m128i acc = _mm_madd_epi16(taps, coefficients);
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    acc = _mm_add_epi32(acc, _mm_set1_epi32(1 << (coefficient_bits - 1)));
+    acc = _mm_packs_epi32(_mm_srai_epi32(acc, coefficient_bits), acc);
+    const u32 left_right = static_cast<u32>(_mm_cvtsi128_si32(_mm_shufflelo_epi16(acc, 0b1000)));
+    return {static_cast<s16>(left_right), static_cast<s16>(left_right >> 16)};
+#else
+    std::array<s16, 2> result;
+    for (std::size_t channel = 0; channel < 2; channel++) {
+        s32 acc = 1 << (coefficient_bits - 1);
+        for (std::size_t tap = 0; tap < num_taps; tap++) {
+            acc += phase[tap] * x[tap][channel];
+        }
+        result[channel] = static_cast<s16>(std::clamp(acc >> coefficient_bits, -32768, 32767));
+    }
+    return result;
+#endif
+}
+} // Anonymous namespace
+
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi) {
+    const FilterBank& bank = rate > 1.0f ? b_spline_bank : catmull_rom_bank;
     StepOverSamples(state, input, rate, output, outputi,
-                    [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
-                        // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                        s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
-                        s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
-
-                        return std::array<s16, 2>{
-                            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
-                        };
+                    [&](auto samples, u64 fposition, u64 step_size, auto output) {
+                        for (auto& sample : output) {
+                            const auto inputi = static_cast<std::size_t>(fposition / scale_factor);
+                            const auto& phase = bank[(fposition & scale_mask) >> phase_shift];
+                            sample = Filter(phase, &samples[inputi]);
+                            fposition += step_size;
+                        }
                     });
 }
 
@@ -2,13 +2,19 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <atomic>
-#include <thread>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <utility>
 #include <teakra/teakra.h>
+#include "audio_core/hle/shared_memory.h"
 #include "audio_core/lle/lle.h"
 #include "common/assert.h"
 #include "common/bit_field.h"
+#include "common/polyfill_thread.h"
 #include "common/swap.h"
 #include "common/thread.h"
 #include "core/core.h"
@@ -141,45 +147,145 @@ struct DspLle::Impl final {
     std::atomic<bool> loaded = false;
 
     const bool multithread;
-    std::thread teakra_thread;
-    Common::Barrier teakra_slice_barrier{2};
-    std::atomic<bool> stop_signal = false;
-    std::size_t stop_generation;
+    std::jthread teakra_thread;
+
+    // The DSP thread runs the slices granted by the slice events, and may run up to run_ahead
+    // slices past them while the DSP and the CPU do not interact. Any interaction brings them back
+    // in lockstep, after which the window grows by a slice per slice event.
+    std::mutex slice_mutex;
+    std::condition_variable_any slice_cv;
+    u64 granted_slices = 0;
+    u64 run_slices = 0;
+    u64 run_ahead = 0;
+    bool dsp_waiting = false;
+    bool cpu_waiting = false;
+
+    /// Copy of the watched DSP memory as of the end of the last slice, owned by the DSP thread.
+    std::array<u16, 2> last_frame_counters{};
+    std::array<u8, 16 * 2 * sizeof(PipeStatus)> last_pipe_status{};
 
     static constexpr u32 DspDataOffset = 0x40000;
     static constexpr u32 TeakraSlice = 16384;
+    /// Maximum number of slices the DSP thread may run ahead of the emulation.
+    static constexpr u64 MaxRunAhead = 8;
+    /// Maximum number of slices the emulation may run ahead of the DSP thread.
+    static constexpr u64 MaxRunBehind = 1;
+
+    bool CanRunSlice(u64 margin) const {
+        return run_slices + margin < granted_slices + run_ahead;
+    }
+
+    void TeakraThread(std::stop_token stop_token) {
+        Common::SetCurrentThreadName("DSP");
+        while (!stop_token.stop_requested()) {
+            {
+                std::unique_lock lock{slice_mutex};
+                if (!CanRunSlice(0)) {
+                    // Sleep until half of the window is available to avoid waking up every slice.
+                    dsp_waiting = true;
+                    Common::CondvarWait(slice_cv, lock, stop_token,
+                                        [this] { return CanRunSlice(run_ahead / 2); });
+                    dsp_waiting = false;
+                    if (stop_token.stop_requested()) {
+                        break;
+                    }
+                }
+            }
 
-    void TeakraThread() {
-        while (true) {
             teakra.Run(TeakraSlice);
-            teakra_slice_barrier.Sync();
-            if (stop_signal) {
-                if (stop_generation == teakra_slice_barrier.Generation())
-                    break;
+            const bool interacted = WatchedMemoryChanged();
+
+            std::scoped_lock lock{slice_mutex};
+            run_slices++;
+            if (interacted) {
+                run_ahead = 0;
+            }
+            if (cpu_waiting) {
+                slice_cv.notify_all();
+            }
+        }
+    }
+
+    /// Returns true if the DSP memory shared with the CPU changed since the last call.
+    bool WatchedMemoryChanged() {
+        auto& memory = teakra.GetDspMemory();
+        bool changed = false;
+        for (std::size_t i = 0; i < last_frame_counters.size(); i++) {
+            const u32 offset = (i == 0 ? HLE::region0_offset : HLE::region1_offset) +
+                               offsetof(HLE::SharedMemory, frame_counter);
+            u16 frame_counter;
+            std::memcpy(&frame_counter, &memory[offset], sizeof(u16));
+            changed |= std::exchange(last_frame_counters[i], frame_counter) != frame_counter;
+        }
+        // The pipe base address is only known, and stays the same, once the component is loaded.
+        if (loaded) {
+            const u8* pipe_status = GetDspDataPointer(pipe_base_waddr * 2);
+            if (std::memcmp(last_pipe_status.data(), pipe_status, last_pipe_status.size()) != 0) {
+                std::memcpy(last_pipe_status.data(), pipe_status, last_pipe_status.size());
+                changed = true;
             }
         }
-        stop_signal = false;
+        return changed;
+    }
+
+    void StartTeakraThread() {
+        granted_slices = run_slices = run_ahead = 0;
+        teakra_thread =
+            std::jthread([this](std::stop_token stop_token) { TeakraThread(stop_token); });
     }
 
     void StopTeakraThread() {
         if (teakra_thread.joinable()) {
-            stop_generation = teakra_slice_barrier.Generation() + 1;
-            stop_signal = true;
-            teakra_slice_barrier.Sync();
+            teakra_thread.request_stop();
             teakra_thread.join();
         }
     }
 
-    void RunTeakraSlice() {
+    /// Marks an interaction between the CPU and the DSP, putting them back in lockstep.
+    void NotifyInteraction() {
         if (multithread) {
-            teakra_slice_barrier.Sync();
-        } else {
+            std::scoped_lock lock{slice_mutex};
+            run_ahead = 0;
+        }
+    }
+
+    /// Waits until the DSP thread runs the slice after the current one.
+    void RunTeakraSlice() {
+        if (!multithread) {
             teakra.Run(TeakraSlice);
+            return;
         }
+        // The emulation waits on the DSP, so it is an interaction.
+        std::unique_lock lock{slice_mutex};
+        run_ahead = 0;
+        const u64 target = run_slices + 1;
+        granted_slices = std::max(granted_slices, target);
+        if (dsp_waiting) {
+            slice_cv.notify_all();
+        }
+        WaitForSlices(lock, target);
+    }
+
+    void WaitForSlices(std::unique_lock<std::mutex>& lock, u64 target) {
+        cpu_waiting = true;
+        slice_cv.wait(lock, [this, target] { return run_slices >= target; });
+        cpu_waiting = false;
     }
 
     void TeakraSliceEvent(u64 late) {
-        RunTeakraSlice();
+        if (multithread) {
+            std::unique_lock lock{slice_mutex};
+            granted_slices++;
+            run_ahead = std::min(run_ahead + 1, MaxRunAhead);
+            if (dsp_waiting && CanRunSlice(run_ahead / 2)) {
+                slice_cv.notify_all();
+            }
+            if (granted_slices > run_slices + MaxRunBehind) {
+                WaitForSlices(lock, granted_slices - MaxRunBehind);
+            }
+        } else {
+            teakra.Run(TeakraSlice);
+        }
         u64 next = TeakraSlice * 2; // DSP runs at clock rate half of the CPU rate
         if (next < late)
             next = 0;
@@ -250,6 +356,7 @@ struct DspLle::Impl final {
             need_update = true;
         }
         if (need_update) {
+            NotifyInteraction();
             UpdatePipeStatus(pipe_status);
             while (!teakra.SendDataIsEmpty(2))
                 RunTeakraSlice();
@@ -287,6 +394,7 @@ struct DspLle::Impl final {
             need_update = true;
         }
         if (need_update) {
+            NotifyInteraction();
             UpdatePipeStatus(pipe_status);
             while (!teakra.SendDataIsEmpty(2))
                 RunTeakraSlice();
@@ -329,7 +437,7 @@ struct DspLle::Impl final {
         core_timing.ScheduleEvent(TeakraSlice, teakra_slice_event, 0);
 
         if (multithread) {
-            teakra_thread = std::thread(&Impl::TeakraThread, this);
+            StartTeakraThread();
         }
 
         // Wait for initialization
@@ -377,6 +485,7 @@ struct DspLle::Impl final {
 };
 
 u16 DspLle::RecvData(u32 register_number) {
+    impl->NotifyInteraction();
     while (!impl->teakra.RecvDataIsReady(register_number)) {
         impl->RunTeakraSlice();
     }
@@ -388,6 +497,7 @@ bool DspLle::RecvDataIsReady(u32 register_number) const {
 }
 
 void DspLle::SetSemaphore(u16 semaphore_value) {
+    impl->NotifyInteraction();
     impl->teakra.SetSemaphore(semaphore_value);
 }
 
@@ -413,12 +523,14 @@ void DspLle::SetInterruptHandler(
         if (!impl->loaded) {
             return;
         }
+        impl->NotifyInteraction();
         handler(Service::DSP::InterruptType::Zero, static_cast<DspPipe>(0));
     });
     impl->teakra.SetRecvDataHandler(1, [this, handler]() {
         if (!impl->loaded) {
             return;
         }
+        impl->NotifyInteraction();
         handler(Service::DSP::InterruptType::One, static_cast<DspPipe>(0));
     });
 
@@ -426,6 +538,7 @@ void DspLle::SetInterruptHandler(
         if (!impl->loaded)
             return;
 
+        impl->NotifyInteraction();
         auto& teakra = impl->teakra;
         if (event_from_data) {
             impl->data_signaled = true;
@@ -97,6 +97,10 @@ use_cpu_jit =
 # Range is any positive integer (but we suspect 25 - 400 is a good idea) Default is 100
 cpu_clock_percentage =
 
+# Size of the translation cache of the interpreter, in MiB. It is flushed once full.
+# Range is 1 - 1024. Default is 32
+dyncom_cache_size_mb =
+
 [Renderer]
 # Whether to render using OpenGL or Software
 # 0: Software, 1: OpenGL (default), 2: Vulkan
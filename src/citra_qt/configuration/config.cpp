@@ -457,6 +457,7 @@ void Config::ReadCoreValues() {
 
     if (global) {
         ReadBasicSetting(Settings::values.use_cpu_jit);
+        ReadBasicSetting(Settings::values.dyncom_cache_size_mb);
         ReadBasicSetting(Settings::values.delay_start_for_lle_modules);
     }
 
@@ -995,6 +996,7 @@ void Config::SaveCoreValues() {
 
     if (global) {
         WriteBasicSetting(Settings::values.use_cpu_jit);
+        WriteBasicSetting(Settings::values.dyncom_cache_size_mb);
         WriteBasicSetting(Settings::values.delay_start_for_lle_modules);
     }
 
@@ -0,0 +1,200 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include "citra_trace_replay/trace_player.h"
+#include "common/common_types.h"
+#include "common/logging/backend.h"
+#include "common/perf_counters.h"
+#include "common/scm_rev.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <filename>\n"
+                 "Replays a CiTrace (.ctf) with the software rasterizer and reports timings.\n"
+                 "-l, --loops N       Replay the trace N times (default 1)\n"
+                 "-d, --draw-timings  Report the time taken by every draw\n"
+                 "-s, --hash          Report a hash of the displayed framebuffers of every frame\n"
+                 "-t, --perf-trace F  Record a performance trace to F, viewable with\n"
+                 "                    chrome://tracing or Perfetto\n"
+                 "-q, --quiet         Only report the summary\n"
+                 "-h, --help          Display this help and exit\n"
+                 "-v, --version       Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Citra trace replayer " << Common::g_scm_branch << " " << Common::g_scm_desc
+              << std::endl;
+}
+
+static double ToMilliseconds(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/// Application entry point
+int main(int argc, char** argv) {
+    int option_index = 0;
+    char* endarg;
+
+    u32 loops = 1;
+    bool draw_timings = false;
+    bool hash_framebuffers = false;
+    bool quiet = false;
+    std::string perf_trace;
+
+    static struct option long_options[] = {
+        {"loops", required_argument, 0, 'l'},
+        {"draw-timings", no_argument, 0, 'd'},
+        {"hash", no_argument, 0, 's'},
+        {"perf-trace", required_argument, 0, 't'},
+        {"quiet", no_argument, 0, 'q'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "l:dst:qhv", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 'l':
+                loops = static_cast<u32>(strtoul(optarg, &endarg, 0));
+                break;
+            case 'd':
+                draw_timings = true;
+                break;
+            case 's':
+                hash_framebuffers = true;
+                break;
+            case 't':
+                perf_trace = optarg;
+                break;
+            case 'q':
+                quiet = true;
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            default:
+                PrintHelp(argv[0]);
+                return 1;
+            }
+        } else {
+            break;
+        }
+    }
+
+    if (optind != argc - 1 || loops == 0) {
+        PrintHelp(argv[0]);
+        return 1;
+    }
+    const std::string filename = argv[optind];
+
+    Common::Log::Initialize();
+    Common::Log::SetColorConsoleBackendEnabled(true);
+    Common::Log::Start();
+
+    CiTrace::TracePlayer player{hash_framebuffers};
+    if (!player.Load(filename)) {
+        return 1;
+    }
+
+    Common::Perf::SetThreadName("Replay");
+    if (!perf_trace.empty()) {
+        Common::Perf::StartTrace();
+    }
+
+    std::vector<double> frame_times;
+    std::size_t num_draws = 0;
+    std::chrono::nanoseconds draw_time{};
+
+    for (u32 loop = 0; loop < loops; loop++) {
+        player.Play([&](const CiTrace::TracePlayer::FrameResult& frame) {
+            frame_times.push_back(ToMilliseconds(frame.duration));
+            num_draws += frame.draw_durations.size();
+            for (const auto duration : frame.draw_durations) {
+                draw_time += duration;
+            }
+            if (quiet) {
+                return;
+            }
+
+            std::string line = fmt::format("loop {} frame {}: {:.3f} ms, {} draws", loop,
+                                           frame.index, frame_times.back(),
+                                           frame.draw_durations.size());
+            if (hash_framebuffers) {
+                line += fmt::format(", top {:016X}, bottom {:016X}", frame.framebuffer_hashes[0],
+                                    frame.framebuffer_hashes[1]);
+            }
+            std::cout << line << "\n";
+
+            if (draw_timings) {
+                for (std::size_t i = 0; i < frame.draw_durations.size(); i++) {
+                    std::cout << fmt::format("  draw {}: {:.3f} ms\n", i,
+                                             ToMilliseconds(frame.draw_durations[i]));
+                }
+            }
+        });
+    }
+
+    if (!perf_trace.empty()) {
+        Common::Perf::StopTrace();
+        Common::Perf::ExportChromeTrace(perf_trace);
+    }
+
+    if (frame_times.empty()) {
+        std::cout << "The trace contains no frames" << std::endl;
+        return 0;
+    }
+
+    std::vector<double> sorted_times = frame_times;
+    std::sort(sorted_times.begin(), sorted_times.end());
+    double total_time = 0.0;
+    for (const double time : frame_times) {
+        total_time += time;
+    }
+    const auto percentile = [&](double p) {
+        return sorted_times[static_cast<std::size_t>(p * (sorted_times.size() - 1))];
+    };
+
+    std::cout << fmt::format("{} frames in {:.3f} ms: mean {:.3f} ms, median {:.3f} ms, "
+                             "p99 {:.3f} ms, min {:.3f} ms, max {:.3f} ms\n",
+                             frame_times.size(), total_time, total_time / frame_times.size(),
+                             percentile(0.5), percentile(0.99), sorted_times.front(),
+                             sorted_times.back());
+    if (num_draws > 0) {
+        std::cout << fmt::format("{} draws: mean {:.3f} ms\n", num_draws,
+                                 ToMilliseconds(draw_time) / num_draws);
+    }
+    const auto& cmd_list_stats = player.GetCmdListCacheStats();
+    if (const u64 lookups = cmd_list_stats.hits + cmd_list_stats.misses; lookups > 0) {
+        std::cout << fmt::format("{} command lists: {:.1f}% cache hits, {:.3f} ms decoding\n",
+                                 lookups, 100.0 * cmd_list_stats.hits / lookups,
+                                 ToMilliseconds(cmd_list_stats.parse_time));
+    }
+    for (const auto& counter : Common::Perf::GetCounters()) {
+        if (counter.total > 0) {
+            std::cout << fmt::format("{}: {}, {:.1f} per frame\n", counter.name, counter.total,
+                                     static_cast<double>(counter.total) / frame_times.size());
+        }
+    }
+    std::cout.flush();
+
+    Common::Log::Stop();
+    return 0;
+}
@@ -0,0 +1,266 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/perf_counters.h"
+#include "citra_trace_replay/trace_player.h"
+#include "video_core/pica/regs_lcd.h"
+#include "video_core/renderer_software/sw_rasterizer.h"
+
+namespace CiTrace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Software rasterizer that measures the time taken by every draw.
+class TracePlayer::TimedRasterizer : public SwRenderer::RasterizerSoftware {
+public:
+    using RasterizerSoftware::RasterizerSoftware;
+
+    void DrawTriangles() override {
+        const auto now = Clock::now();
+        draw_durations.push_back(now - last_mark);
+        last_mark = now;
+    }
+
+    /// Starts timing the next draw from now.
+    void Mark() {
+        last_mark = Clock::now();
+    }
+
+    std::vector<std::chrono::nanoseconds> draw_durations;
+
+private:
+    Clock::time_point last_mark;
+};
+
+TracePlayer::TracePlayer(bool hash_framebuffers_)
+    : hash_framebuffers{hash_framebuffers_},
+      rasterizer{std::make_unique<TimedRasterizer>(memory, pica)},
+      blitter{std::make_unique<SwRenderer::SwBlitter>(memory, rasterizer.get())},
+      interrupt_handler{[](Service::GSP::InterruptId) {}} {
+    pica.BindRasterizer(rasterizer.get());
+    pica.SetInterruptHandler(interrupt_handler);
+}
+
+TracePlayer::~TracePlayer() = default;
+
+bool TracePlayer::Load(const std::string& filename) {
+    FileUtil::IOFile file(filename, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Could not open {}", filename);
+        return false;
+    }
+    trace_data.resize(file.GetSize());
+    if (file.ReadBytes(trace_data.data(), trace_data.size()) != trace_data.size()) {
+        LOG_ERROR(HW_GPU, "Could not read {}", filename);
+        return false;
+    }
+
+    if (trace_data.size() < sizeof(CTHeader)) {
+        LOG_ERROR(HW_GPU, "{} is too small to be a CiTrace", filename);
+        return false;
+    }
+    std::memcpy(&header, trace_data.data(), sizeof(header));
+    if (std::memcmp(header.magic, CTHeader::ExpectedMagicWord(), sizeof(header.magic)) != 0 ||
+        header.version != CTHeader::ExpectedVersion() || header.header_size != sizeof(CTHeader)) {
+        LOG_ERROR(HW_GPU, "{} is not a supported CiTrace", filename);
+        return false;
+    }
+
+    const u64 stream_end =
+        header.stream_offset + u64{header.stream_size} * sizeof(CTStreamElement);
+    if (stream_end > trace_data.size()) {
+        LOG_ERROR(HW_GPU, "The command stream of {} is truncated", filename);
+        return false;
+    }
+    return true;
+}
+
+std::span<const u32> TracePlayer::GetArray(u32 offset, u32 size) const {
+    if (offset + u64{size} * sizeof(u32) > trace_data.size()) {
+        LOG_WARNING(HW_GPU, "Ignoring out of bounds initial state at {:#x}", offset);
+        return {};
+    }
+    return {reinterpret_cast<const u32*>(trace_data.data() + offset), size};
+}
+
+void TracePlayer::LoadInitialState() {
+    const auto& initial = header.initial_state_offsets;
+    const auto copy_words = [](std::span<u32> dest, std::span<const u32> src) {
+        std::copy_n(src.begin(), std::min(dest.size(), src.size()), dest.begin());
+    };
+    const auto copy_float24 = [](std::span<Common::Vec4<Pica::f24>> dest,
+                                 std::span<const u32> src) {
+        for (std::size_t i = 0; i < std::min(dest.size() * 4, src.size()); i++) {
+            dest[i / 4][i % 4] = Pica::f24::FromRaw(src[i]);
+        }
+    };
+
+    const auto lcd_registers = GetArray(initial.lcd_registers, initial.lcd_registers_size);
+    for (u32 i = 0; i < std::min<std::size_t>(lcd_registers.size(), Pica::RegsLcd::NumIds());
+         i++) {
+        pica.regs_lcd[i] = lcd_registers[i];
+    }
+    copy_words(pica.regs.reg_array,
+               GetArray(initial.pica_registers, initial.pica_registers_size));
+    copy_float24(pica.input_default_attributes,
+                 GetArray(initial.default_attributes, initial.default_attributes_size));
+
+    copy_words(pica.vs_setup.program_code,
+               GetArray(initial.vs_program_binary, initial.vs_program_binary_size));
+    copy_words(pica.vs_setup.swizzle_data,
+               GetArray(initial.vs_swizzle_data, initial.vs_swizzle_data_size));
+    copy_float24(pica.vs_setup.uniforms.f,
+                 GetArray(initial.vs_float_uniforms, initial.vs_float_uniforms_size));
+    copy_words(pica.gs_setup.program_code,
+               GetArray(initial.gs_program_binary, initial.gs_program_binary_size));
+    copy_words(pica.gs_setup.swizzle_data,
+               GetArray(initial.gs_swizzle_data, initial.gs_swizzle_data_size));
+    copy_float24(pica.gs_setup.uniforms.f,
+                 GetArray(initial.gs_float_uniforms, initial.gs_float_uniforms_size));
+
+    for (auto* setup : {&pica.vs_setup, &pica.gs_setup}) {
+        setup->MarkProgramCodeDirty();
+        setup->MarkSwizzleDataDirty();
+    }
+}
+
+void TracePlayer::LoadMemory(const CTMemoryLoad& memory_load) {
+    if (memory_load.file_offset + u64{memory_load.size} > trace_data.size()) {
+        LOG_WARNING(HW_GPU, "Ignoring out of bounds memory load at {:#x}",
+                    memory_load.file_offset);
+        return;
+    }
+    auto dest = memory.GetPhysicalRef(memory_load.physical_address);
+    if (!dest || dest.GetSize() < memory_load.size) {
+        LOG_WARNING(HW_GPU, "Ignoring memory load to unmapped address {:#010x}",
+                    memory_load.physical_address);
+        return;
+    }
+    std::memcpy(dest.GetPtr(), trace_data.data() + memory_load.file_offset, memory_load.size);
+}
+
+void TracePlayer::WriteRegister(const CTRegisterWrite& register_write) {
+    const u32 address = register_write.physical_address;
+    if (address >= LCD_REGS_PADDR &&
+        address < LCD_REGS_PADDR + Pica::RegsLcd::NumIds() * sizeof(u32)) {
+        pica.regs_lcd[(address - LCD_REGS_PADDR) / sizeof(u32)] = register_write.value;
+    } else if (address >= GPU_REGS_PADDR &&
+               address < GPU_REGS_PADDR + Pica::PicaCore::Regs::NUM_REGS * sizeof(u32)) {
+        WriteGPURegister((address - GPU_REGS_PADDR) / sizeof(u32), register_write.value);
+    } else {
+        LOG_WARNING(HW_GPU, "Ignoring write to unknown register {:#010x}", address);
+    }
+}
+
+void TracePlayer::WriteGPURegister(u32 index, u32 value) {
+    auto& regs = pica.regs;
+    regs.reg_array[index] = value;
+
+    switch (index) {
+    case GPU_REG_INDEX(memory_fill_config[0].trigger):
+    case GPU_REG_INDEX(memory_fill_config[1].trigger): {
+        const u32 unit = index == GPU_REG_INDEX(memory_fill_config[0].trigger) ? 0 : 1;
+        auto& config = regs.memory_fill_config[unit];
+        if (config.trigger) {
+            blitter->MemoryFill(config);
+            blitter->Wait();
+            config.trigger.Assign(0);
+            config.finished.Assign(1);
+        }
+        break;
+    }
+    case GPU_REG_INDEX(display_transfer_config.trigger): {
+        auto& config = regs.display_transfer_config;
+        if (config.trigger) {
+            if (config.is_texture_copy) {
+                blitter->TextureCopy(config);
+            } else {
+                blitter->DisplayTransfer(config);
+                blitter->Wait();
+            }
+            config.trigger.Assign(0);
+        }
+        break;
+    }
+    case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[0]):
+    case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[1]): {
+        const u32 channel =
+            index == GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[0]) ? 0 : 1;
+        const auto& command_buffer = regs.internal.pipeline.command_buffer;
+        rasterizer->Mark();
+        pica.ProcessCmdList(command_buffer.GetPhysicalAddress(channel),
+                            command_buffer.GetSize(channel));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+u64 TracePlayer::HashFramebuffer(u32 screen_id) const {
+    const auto& framebuffer = pica.regs.framebuffer_config[screen_id];
+    const PAddr address =
+        framebuffer.active_fb == 0 ? framebuffer.address_left1 : framebuffer.address_left2;
+    const auto source = memory.GetPhysicalRef(address);
+    const std::size_t size =
+        std::min<std::size_t>(u64{framebuffer.stride} * framebuffer.height, source.GetSize());
+    if (!source || size == 0) {
+        return 0;
+    }
+    return Common::ComputeHash64(source.GetPtr(), size);
+}
+
+void TracePlayer::Play(const std::function<void(const FrameResult&)>& on_frame) {
+    LoadInitialState();
+
+    FrameResult frame{};
+    auto frame_start = Clock::now();
+    const auto finish_frame = [&] {
+        frame.duration = Clock::now() - frame_start;
+        Common::Perf::EndFrame();
+        frame.draw_durations = std::move(rasterizer->draw_durations);
+        rasterizer->draw_durations.clear();
+        if (hash_framebuffers) {
+            frame.framebuffer_hashes = {HashFramebuffer(0), HashFramebuffer(1)};
+        }
+        on_frame(frame);
+
+        frame.index++;
+        frame_start = Clock::now();
+    };
+
+    const u8* stream = trace_data.data() + header.stream_offset;
+    for (u32 i = 0; i < header.stream_size; i++) {
+        CTStreamElement element;
+        std::memcpy(&element, stream + i * sizeof(CTStreamElement), sizeof(element));
+
+        switch (element.type) {
+        case FrameMarker:
+            finish_frame();
+            break;
+        case MemoryLoad:
+            LoadMemory(element.memory_load);
+            break;
+        case RegisterWrite:
+            WriteRegister(element.register_write);
+            break;
+        default:
+            LOG_WARNING(HW_GPU, "Ignoring unknown stream element {:#x}",
+                        static_cast<u32>(element.type));
+            break;
+        }
+    }
+
+    // Report the work after the last frame marker as a frame of its own.
+    if (!rasterizer->draw_durations.empty()) {
+        finish_frame();
+    }
+}
+
+} // namespace CiTrace
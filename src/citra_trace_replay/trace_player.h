@@ -0,0 +1,80 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "core/core.h"
+#include "core/memory.h"
+#include "core/tracer/citrace.h"
+#include "video_core/pica/pica_core.h"
+#include "video_core/renderer_software/sw_blitter.h"
+
+namespace CiTrace {
+
+/**
+ * Replays a CiTrace without a frontend. The recorded memory and register writes are fed to a
+ * PICA core bound to the software rasterizer, and the GPU register triggers (command lists,
+ * memory fills and display transfers) are handled the same way VideoCore::GPU handles them.
+ */
+class TracePlayer {
+public:
+    struct FrameResult {
+        u32 index;
+        std::chrono::nanoseconds duration;
+        /// Time spent from the previous draw (or the start of its command list) to each draw
+        std::vector<std::chrono::nanoseconds> draw_durations;
+        /// Hashes of the displayed top and bottom screen framebuffers, when requested
+        std::array<u64, 2> framebuffer_hashes;
+    };
+
+    explicit TracePlayer(bool hash_framebuffers);
+    ~TracePlayer();
+
+    /**
+     * Loads the trace stored in the given file.
+     * @returns False if the file could not be read or is not a valid CiTrace.
+     */
+    bool Load(const std::string& filename);
+
+    /// Replays the loaded trace from its initial state, calling on_frame after every frame.
+    void Play(const std::function<void(const FrameResult&)>& on_frame);
+
+    /// Returns the counters of the pre-decoded command list cache, accumulated over all replays.
+    [[nodiscard]] const Pica::PicaCore::CmdListCacheStats& GetCmdListCacheStats() const {
+        return pica.GetCmdListCacheStats();
+    }
+
+private:
+    class TimedRasterizer;
+
+    /// Returns the u32 array stored in the trace at the given offset, empty if out of bounds.
+    std::span<const u32> GetArray(u32 offset, u32 size) const;
+
+    void LoadInitialState();
+    void LoadMemory(const CTMemoryLoad& memory_load);
+    void WriteRegister(const CTRegisterWrite& register_write);
+    void WriteGPURegister(u32 index, u32 value);
+    u64 HashFramebuffer(u32 screen_id) const;
+
+    bool hash_framebuffers;
+    std::vector<u8> trace_data;
+    CTHeader header{};
+
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Pica::PicaCore pica{memory, nullptr};
+    std::unique_ptr<TimedRasterizer> rasterizer;
+    std::unique_ptr<SwRenderer::SwBlitter> blitter;
+    Service::GSP::InterruptHandler interrupt_handler;
+};
+
+} // namespace CiTrace
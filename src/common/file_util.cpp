@@ -315,6 +315,27 @@ bool Rename(const std::string& srcFilename, const std::string& destFilename) {
     return false;
 }
 
+bool Replace(const std::string& srcFilename, const std::string& destFilename) {
+    LOG_TRACE(Common_Filesystem, "{} --> {}", srcFilename, destFilename);
+#ifdef _WIN32
+    if (MoveFileExW(Common::UTF8ToUTF16W(srcFilename).c_str(),
+                    Common::UTF8ToUTF16W(destFilename).c_str(),
+                    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        return true;
+#elif ANDROID
+    // The storage access framework cannot rename over an existing document.
+    if (Delete(destFilename) &&
+        AndroidStorage::RenameFile(srcFilename, std::string(GetFilename(destFilename))))
+        return true;
+#else
+    if (rename(srcFilename.c_str(), destFilename.c_str()) == 0)
+        return true;
+#endif
+    LOG_ERROR(Common_Filesystem, "failed {} --> {}: {}", srcFilename, destFilename,
+              GetLastErrorMsg());
+    return false;
+}
+
 bool Copy(const std::string& srcFilename, const std::string& destFilename) {
     LOG_TRACE(Common_Filesystem, "{} --> {}", srcFilename, destFilename);
 #ifdef _WIN32
@@ -428,6 +449,26 @@ u64 GetSize(FILE* f) {
     return size;
 }
 
+u64 GetModificationTime(const std::string& filename) {
+#ifdef ANDROID
+    // Storage access framework paths cannot be stat'd.
+    return 0;
+#else
+    struct stat buf;
+#ifdef _WIN32
+    if (_wstat64(Common::UTF8ToUTF16W(filename).c_str(), &buf) == 0)
+#else
+    if (stat(filename.c_str(), &buf) == 0)
+#endif
+    {
+        return static_cast<u64>(buf.st_mtime);
+    }
+
+    LOG_ERROR(Common_Filesystem, "Stat failed {}: {}", filename, GetLastErrorMsg());
+    return 0;
+#endif
+}
+
 bool CreateEmptyFile(const std::string& filename) {
     LOG_TRACE(Common_Filesystem, "{}", filename);
 
@@ -1152,6 +1193,20 @@ bool IOFile::Flush() {
     return m_good;
 }
 
+bool IOFile::Sync() {
+    if (!Flush())
+        return false;
+
+#ifdef _WIN32
+    if (0 != _commit(_fileno(m_file)))
+#else
+    if (0 != fsync(fileno(m_file)))
+#endif
+        m_good = false;
+
+    return m_good;
+}
+
 std::size_t IOFile::ReadImpl(void* data, std::size_t length, std::size_t data_size) {
     if (!IsOpen()) {
         m_good = false;
@@ -105,6 +105,9 @@ private:
 // Overloaded GetSize, accepts FILE*
 [[nodiscard]] u64 GetSize(FILE* f);
 
+// Returns the last modification time of filename in seconds since the epoch, or 0 if it is unknown
+[[nodiscard]] u64 GetModificationTime(const std::string& filename);
+
 // Returns true if successful, or path already exists.
 bool CreateDir(const std::string& filename);
 
@@ -121,6 +124,11 @@ bool DeleteDir(const std::string& filename);
 // renames file srcFilename to destFilename, returns true on success
 bool Rename(const std::string& srcFilename, const std::string& destFilename);
 
+// Renames file srcFilename to destFilename, replacing destFilename if it exists. The replacement is
+// atomic except on Android, where destFilename is deleted first and a crash can leave only
+// srcFilename. Returns true on success
+bool Replace(const std::string& srcFilename, const std::string& destFilename);
+
 // copies file srcFilename to destFilename, returns true on success
 bool Copy(const std::string& srcFilename, const std::string& destFilename);
 
@@ -369,6 +377,8 @@ public:
     [[nodiscard]] u64 GetSize() const;
     bool Resize(u64 size);
     bool Flush();
+    // Flushes the file and waits until the host has written it to storage
+    bool Sync();
 
     // clear error state
     void Clear() {
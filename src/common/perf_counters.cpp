@@ -0,0 +1,307 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/perf_counters.h"
+
+namespace Common::Perf {
+
+namespace Detail {
+std::array<std::atomic<u64>, MAX_COUNTERS> counter_values{};
+std::atomic<bool> tracing{};
+} // namespace Detail
+
+namespace {
+
+/// Events recorded by a thread past this are dropped, bounding the memory used by long traces.
+constexpr std::size_t MAX_EVENTS_PER_THREAD = 1 << 20;
+
+/// Size of the JSON written to the file at a time when exporting.
+constexpr std::size_t EXPORT_CHUNK_SIZE = 1 << 20;
+
+struct Event {
+    EventId id;
+    u64 begin;
+    u64 end;
+};
+
+/// Events of one thread. Only that thread appends to it, the mutex is contended by exports only.
+struct ThreadTrace {
+    std::mutex mutex;
+    std::string name;
+    u32 tid{};
+    std::vector<Event> events;
+    std::size_t num_dropped{};
+};
+
+/// Value of a counter during a frame, recorded while tracing whenever it changes.
+struct CounterSample {
+    u64 time;
+    CounterId id;
+    u64 value;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::string> counter_names;
+    std::array<u64, MAX_COUNTERS> frame_begin_values{};
+    std::array<u64, MAX_COUNTERS> last_frame_values{};
+    /// Value of the last sample of every counter.
+    std::array<u64, MAX_COUNTERS> sampled_values{};
+    std::vector<std::string> event_names;
+    std::vector<std::shared_ptr<ThreadTrace>> threads;
+    u32 next_tid{1};
+    std::vector<CounterSample> samples;
+    u64 last_frame_end{};
+    EventId frame_event{};
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+std::atomic<std::chrono::steady_clock::rep> trace_start{};
+
+thread_local std::shared_ptr<ThreadTrace> current_thread;
+
+u64 TraceTime() {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    const auto elapsed = std::chrono::steady_clock::duration{now - trace_start.load()};
+    return std::max<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), 1);
+}
+
+ThreadTrace& GetThreadTrace() {
+    if (!current_thread) {
+        auto& registry = GetRegistry();
+        std::scoped_lock lock{registry.mutex};
+        current_thread = std::make_shared<ThreadTrace>();
+        current_thread->tid = registry.next_tid++;
+        registry.threads.push_back(current_thread);
+    }
+    return *current_thread;
+}
+
+void RecordEvent(EventId id, u64 begin, u64 end) {
+    ThreadTrace& thread = GetThreadTrace();
+    std::scoped_lock lock{thread.mutex};
+    if (thread.events.size() >= MAX_EVENTS_PER_THREAD) {
+        thread.num_dropped++;
+        return;
+    }
+    thread.events.push_back({id, begin, end});
+}
+
+u32 FindOrInsert(std::vector<std::string>& names, std::string_view name) {
+    const auto it = std::find(names.begin(), names.end(), name);
+    if (it != names.end()) {
+        return static_cast<u32>(std::distance(names.begin(), it));
+    }
+    names.emplace_back(name);
+    return static_cast<u32>(names.size() - 1);
+}
+
+void AppendEscaped(std::string& out, std::string_view str) {
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<u32>(c));
+        } else {
+            out += c;
+        }
+    }
+}
+
+/// Trace timestamps are in microseconds.
+double ToMicroseconds(u64 nanoseconds) {
+    return static_cast<double>(nanoseconds) / 1000.0;
+}
+
+} // Anonymous namespace
+
+CounterId RegisterCounter(std::string_view name) {
+    auto& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    auto& names = registry.counter_names;
+    const auto it = std::find(names.begin(), names.end(), name);
+    if (it != names.end()) {
+        return static_cast<CounterId>(std::distance(names.begin(), it));
+    }
+    if (names.size() >= MAX_COUNTERS - 1) {
+        LOG_WARNING(Common, "Too many performance counters, {} is counted as Other", name);
+        if (names.size() == MAX_COUNTERS - 1) {
+            names.emplace_back("Other");
+        }
+        return MAX_COUNTERS - 1;
+    }
+    names.emplace_back(name);
+    return static_cast<CounterId>(names.size() - 1);
+}
+
+EventId RegisterEvent(std::string_view name) {
+    auto& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    return FindOrInsert(registry.event_names, name);
+}
+
+std::vector<CounterValue> GetCounters() {
+    auto& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    std::vector<CounterValue> counters;
+    counters.reserve(registry.counter_names.size());
+    for (std::size_t i = 0; i < registry.counter_names.size(); i++) {
+        counters.push_back({registry.counter_names[i], Detail::counter_values[i].load(),
+                            registry.last_frame_values[i]});
+    }
+    return counters;
+}
+
+void EndFrame() {
+    auto& registry = GetRegistry();
+    const bool is_tracing = IsTracing();
+    const u64 now = is_tracing ? TraceTime() : 0;
+
+    u64 frame_begin;
+    EventId frame_event;
+    {
+        std::scoped_lock lock{registry.mutex};
+        for (std::size_t i = 0; i < registry.counter_names.size(); i++) {
+            const u64 value = Detail::counter_values[i].load(std::memory_order_relaxed);
+            const u64 delta = value - registry.frame_begin_values[i];
+            registry.frame_begin_values[i] = value;
+            // Counter events hold their value until the next one, so only changes are recorded.
+            if (is_tracing && delta != registry.sampled_values[i]) {
+                registry.samples.push_back({now, static_cast<CounterId>(i), delta});
+                registry.sampled_values[i] = delta;
+            }
+            registry.last_frame_values[i] = delta;
+        }
+        frame_begin = std::exchange(registry.last_frame_end, now);
+        frame_event = registry.frame_event;
+    }
+    if (is_tracing && frame_begin != 0) {
+        RecordEvent(frame_event, frame_begin, now);
+    }
+}
+
+void SetThreadName(std::string_view name) {
+    ThreadTrace& thread = GetThreadTrace();
+    std::scoped_lock lock{thread.mutex};
+    thread.name = name;
+}
+
+void StartTrace() {
+    auto& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    // Forget the threads that exited, the registry holds the last reference to their traces.
+    std::erase_if(registry.threads, [](const auto& thread) { return thread.use_count() == 1; });
+    for (const auto& thread : registry.threads) {
+        std::scoped_lock thread_lock{thread->mutex};
+        thread->events.clear();
+        thread->num_dropped = 0;
+    }
+    registry.samples.clear();
+    registry.last_frame_end = 0;
+    // Every counter starts with a sample, so the trace shows all of them from its beginning.
+    std::fill(registry.sampled_values.begin(), registry.sampled_values.end(), ~u64{0});
+    registry.frame_event = FindOrInsert(registry.event_names, "Frame");
+    trace_start.store(std::chrono::steady_clock::now().time_since_epoch().count());
+    Detail::tracing.store(true);
+}
+
+void StopTrace() {
+    Detail::tracing.store(false);
+}
+
+bool ExportChromeTrace(const std::string& path) {
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Common, "Failed to open {} to export the trace", path);
+        return false;
+    }
+
+    auto& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    const auto begin_event = [&] {
+        if (!first) {
+            out += ",\n";
+        }
+        first = false;
+    };
+    const auto flush = [&](bool force) {
+        if (force || out.size() >= EXPORT_CHUNK_SIZE) {
+            file.WriteString(out);
+            out.clear();
+        }
+    };
+
+    std::size_t num_dropped = 0;
+    for (const auto& thread : registry.threads) {
+        std::scoped_lock thread_lock{thread->mutex};
+        num_dropped += thread->num_dropped;
+
+        begin_event();
+        out += fmt::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},"
+                           "\"args\":{{\"name\":\"",
+                           thread->tid);
+        AppendEscaped(out, thread->name.empty() ? fmt::format("Thread {}", thread->tid)
+                                                : thread->name);
+        out += "\"}}";
+
+        for (const Event& event : thread->events) {
+            begin_event();
+            out += "{\"name\":\"";
+            AppendEscaped(out, registry.event_names[event.id]);
+            out += fmt::format(
+                "\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", thread->tid,
+                ToMicroseconds(event.begin), ToMicroseconds(event.end - event.begin));
+            flush(false);
+        }
+    }
+
+    for (const CounterSample& sample : registry.samples) {
+        begin_event();
+        out += "{\"name\":\"";
+        AppendEscaped(out, registry.counter_names[sample.id]);
+        out += fmt::format("\",\"ph\":\"C\",\"pid\":1,\"ts\":{:.3f},\"args\":{{\"value\":{}}}}}",
+                           ToMicroseconds(sample.time), sample.value);
+        flush(false);
+    }
+
+    out += "\n]}\n";
+    flush(true);
+
+    if (num_dropped > 0) {
+        LOG_WARNING(Common, "{} trace events were dropped, the trace is incomplete", num_dropped);
+    }
+    if (!file.IsGood()) {
+        LOG_ERROR(Common, "Failed to write the trace to {}", path);
+        return false;
+    }
+    LOG_INFO(Common, "Exported the trace to {}", path);
+    return true;
+}
+
+u64 ScopedEvent::Now() {
+    return TraceTime();
+}
+
+void ScopedEvent::Record(EventId id, u64 begin) {
+    RecordEvent(id, begin, TraceTime());
+}
+
+} // namespace Common::Perf
@@ -0,0 +1,134 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+
+/**
+ * Registry of performance counters and trace events shared by the whole emulator.
+ *
+ * Counters are plain totals that any thread may bump, such as the number of draw calls or of IPC
+ * requests of a service. At the end of every emulated frame their deltas are latched, so they can
+ * be shown per frame. While a trace is recording, scoped events and the per frame counter deltas
+ * are also kept in memory and can be exported to the Chrome trace event format, which can be
+ * opened with chrome://tracing or Perfetto.
+ */
+namespace Common::Perf {
+
+/// Index of a counter in the registry.
+using CounterId = u32;
+
+/// Index of a trace event name in the registry.
+using EventId = u32;
+
+/// Maximum number of distinct counters. Registering more makes them share the last one.
+constexpr std::size_t MAX_COUNTERS = 256;
+
+namespace Detail {
+extern std::array<std::atomic<u64>, MAX_COUNTERS> counter_values;
+extern std::atomic<bool> tracing;
+} // namespace Detail
+
+/// Returns the counter called name, registering it if it does not exist yet. Thread-safe.
+CounterId RegisterCounter(std::string_view name);
+
+/// Returns the trace event called name, registering it if it does not exist yet. Thread-safe.
+EventId RegisterEvent(std::string_view name);
+
+/// Adds amount to a counter. Thread-safe and wait-free.
+inline void Add(CounterId id, u64 amount = 1) {
+    Detail::counter_values[id].fetch_add(amount, std::memory_order_relaxed);
+}
+
+/// Counter registered on construction, usually declared static next to the code it counts.
+class Counter {
+public:
+    explicit Counter(std::string_view name) : id{RegisterCounter(name)} {}
+
+    void Add(u64 amount = 1) const {
+        Perf::Add(id, amount);
+    }
+
+private:
+    CounterId id;
+};
+
+struct CounterValue {
+    std::string name;
+    /// Total since the emulator started.
+    u64 total;
+    /// Amount added during the last complete frame.
+    u64 last_frame;
+};
+
+/// Returns the current value of every registered counter.
+[[nodiscard]] std::vector<CounterValue> GetCounters();
+
+/**
+ * Marks the end of an emulated frame, latching the counter deltas of the frame. While tracing, the
+ * frame is also recorded as an event together with the deltas.
+ */
+void EndFrame();
+
+/// Names the calling thread in the exported traces.
+void SetThreadName(std::string_view name);
+
+/// Returns true if a trace is being recorded.
+[[nodiscard]] inline bool IsTracing() {
+    return Detail::tracing.load(std::memory_order_relaxed);
+}
+
+/// Starts recording a trace, discarding the previously recorded one.
+void StartTrace();
+
+/// Stops recording the trace. What was recorded is kept until the next StartTrace.
+void StopTrace();
+
+/**
+ * Writes the recorded trace to path in the Chrome trace event JSON format.
+ * @returns true on success.
+ */
+bool ExportChromeTrace(const std::string& path);
+
+/// Records the lifetime of the object as a trace event on the calling thread while tracing.
+class ScopedEvent {
+public:
+    explicit ScopedEvent(EventId id_) : id{id_}, begin{IsTracing() ? Now() : 0} {}
+
+    ~ScopedEvent() {
+        if (begin != 0) {
+            Record(id, begin);
+        }
+    }
+
+    ScopedEvent(const ScopedEvent&) = delete;
+    ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+private:
+    /// Nanoseconds since the start of the trace, never 0.
+    static u64 Now();
+    static void Record(EventId id, u64 begin);
+
+    EventId id;
+    u64 begin;
+};
+
+} // namespace Common::Perf
+
+/// Records the rest of the enclosing scope as a trace event called name.
+#define PERF_TRACE_SCOPE(name)                                                                     \
+    static const ::Common::Perf::EventId CONCAT2(perf_event_, __LINE__) =                          \
+        ::Common::Perf::RegisterEvent(name);                                                       \
+    const ::Common::Perf::ScopedEvent CONCAT2(perf_scope_, __LINE__) {                             \
+        CONCAT2(perf_event_, __LINE__)                                                             \
+    }
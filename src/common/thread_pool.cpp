@@ -0,0 +1,151 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <iterator>
+#include <fmt/format.h>
+#include "common/perf_counters.h"
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+namespace {
+/// Pool and worker index of the calling thread, if it is a pool worker.
+thread_local ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_worker = 0;
+} // Anonymous namespace
+
+TaskGroup::~TaskGroup() {
+    Wait();
+}
+
+void TaskGroup::Wait() {
+    ThreadPool* const owner = pool.load(std::memory_order_acquire);
+    while (!IsDone()) {
+        if (owner && owner->TryRunTask(this)) {
+            continue;
+        }
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [this] { return IsDone(); });
+    }
+    // Synchronize with the thread that finished the last task.
+    std::scoped_lock lock{mutex};
+}
+
+ThreadPool::ThreadPool(std::size_t num_threads, std::string_view name_) : name{name_} {
+    num_threads = std::max<std::size_t>(num_threads, 1);
+    workers.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    threads.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; i++) {
+        threads.emplace_back([this, i](std::stop_token stop_token) { WorkerLoop(stop_token, i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    for (auto& thread : threads) {
+        thread.request_stop();
+    }
+    threads.clear();
+    while (TryRunTask(nullptr)) {
+    }
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool{std::max(std::jthread::hardware_concurrency(), 2U) - 1, "Worker"};
+    return pool;
+}
+
+void ThreadPool::Submit(Task&& task, TaskGroup& group, TaskPriority priority,
+                        std::optional<std::size_t> affinity) {
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+    group.pool.store(this, std::memory_order_release);
+
+    std::size_t index;
+    if (affinity) {
+        index = *affinity % workers.size();
+    } else if (current_pool == this) {
+        index = current_worker;
+    } else {
+        index = next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    }
+    {
+        Worker& worker = *workers[index];
+        std::scoped_lock lock{worker.mutex};
+        worker.queues[static_cast<u32>(priority)].push_back({std::move(task), &group});
+    }
+
+    // A worker going to sleep registers itself before checking for queued tasks, so either it sees
+    // this task or it is woken up here.
+    num_queued.fetch_add(1);
+    if (num_sleeping.load() > 0) {
+        std::scoped_lock lock{sleep_mutex};
+        sleep_cv.notify_one();
+    }
+}
+
+void ThreadPool::WorkerLoop(std::stop_token stop_token, std::size_t index) {
+    const std::string thread_name = fmt::format("{}:{}", name, index);
+    SetCurrentThreadName(thread_name.c_str());
+    Perf::SetThreadName(thread_name);
+    current_pool = this;
+    current_worker = index;
+
+    while (!stop_token.stop_requested()) {
+        if (TryRunTask(nullptr)) {
+            continue;
+        }
+        std::unique_lock lock{sleep_mutex};
+        num_sleeping.fetch_add(1);
+        CondvarWait(sleep_cv, lock, stop_token, [this] { return num_queued.load() > 0; });
+        num_sleeping.fetch_sub(1);
+    }
+}
+
+bool ThreadPool::TryRunTask(const TaskGroup* group) {
+    const bool is_worker = current_pool == this;
+    const std::size_t num_workers = workers.size();
+    const std::size_t first = is_worker ? current_worker : 0;
+    const auto matches = [group](const Entry& entry) { return !group || entry.group == group; };
+
+    std::optional<Entry> entry;
+    for (std::size_t priority = 0; priority < num_priorities && !entry; priority++) {
+        for (std::size_t i = 0; i < num_workers && !entry; i++) {
+            Worker& worker = *workers[(first + i) % num_workers];
+            std::scoped_lock lock{worker.mutex};
+            auto& queue = worker.queues[priority];
+            // Own tasks are taken newest first while their data is hot, stolen ones oldest first.
+            if (is_worker && i == 0) {
+                const auto it = std::find_if(queue.rbegin(), queue.rend(), matches);
+                if (it != queue.rend()) {
+                    entry.emplace(std::move(*it));
+                    queue.erase(std::next(it).base());
+                }
+            } else {
+                const auto it = std::find_if(queue.begin(), queue.end(), matches);
+                if (it != queue.end()) {
+                    entry.emplace(std::move(*it));
+                    queue.erase(it);
+                }
+            }
+        }
+    }
+    if (!entry) {
+        return false;
+    }
+    num_queued.fetch_sub(1);
+
+    entry->task();
+    TaskGroup& task_group = *entry->group;
+    std::scoped_lock lock{task_group.mutex};
+    if (task_group.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        task_group.cv.notify_all();
+    }
+    return true;
+}
+
+} // namespace Common
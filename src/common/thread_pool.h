@@ -0,0 +1,162 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/unique_function.h"
+
+namespace Common {
+
+class ThreadPool;
+
+/// Scheduling priority of the tasks of a ThreadPool.
+enum class TaskPriority : u32 {
+    /// Work the emulated frame is waiting for. Always runs before background work.
+    Critical = 0,
+    /// Work nothing waits for right away, such as preloading or dumping.
+    Background = 1,
+};
+
+/**
+ * Tracks the completion of the tasks submitted to a ThreadPool with it. The group must outlive its
+ * tasks, so owners of tasks that reference them wait for their group on destruction.
+ */
+class TaskGroup {
+public:
+    TaskGroup() = default;
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * Blocks until every task of the group has run. Meanwhile the calling thread runs the queued
+     * tasks of this group itself, so waiting never picks up unrelated long tasks and a worker
+     * waiting on its own submissions cannot deadlock.
+     */
+    void Wait();
+
+    /// Returns true if every task of the group has run.
+    [[nodiscard]] bool IsDone() const {
+        return pending.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class ThreadPool;
+
+    /// Finishing a task decrements pending with the mutex held, so that the group is not
+    /// destroyed by a waiter while it is being notified.
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<std::size_t> pending{};
+    std::atomic<ThreadPool*> pool{};
+};
+
+/**
+ * Work-stealing thread pool. Every worker has a deque of tasks per priority; a worker pops its own
+ * tasks from the back and steals from the front of the other deques when it runs out, so tasks
+ * submitted by a worker tend to run on the thread that has their data in cache.
+ */
+class ThreadPool {
+public:
+    using Task = UniqueFunction<void>;
+
+    explicit ThreadPool(std::size_t num_threads, std::string_view name);
+    /// Stops the workers and runs the tasks still queued, so that no group is left pending.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Returns the pool shared by the whole emulator. It has one thread less than the host has
+     * cores, as the threads that wait for its tasks help running them.
+     */
+    static ThreadPool& Shared();
+
+    [[nodiscard]] std::size_t NumThreads() const noexcept {
+        return workers.size();
+    }
+
+    /**
+     * Queues a task. Tasks must not block on other tasks of the pool, except by waiting on their
+     * TaskGroup.
+     * @param group Group tracking the completion of the task.
+     * @param priority Priority of the task.
+     * @param affinity Hint of the worker that should run the task. Tasks given the same hint
+     * land in the same deque, which helps when they touch the same data; idle workers may still
+     * steal them.
+     */
+    void Submit(Task&& task, TaskGroup& group, TaskPriority priority = TaskPriority::Critical,
+                std::optional<std::size_t> affinity = std::nullopt);
+
+    /**
+     * Calls func(begin, end) over chunks of [0, count) in parallel and waits for all of them. The
+     * calling thread processes the first chunk.
+     * @param min_chunk_size Smallest number of iterations worth running as a task of its own.
+     */
+    template <typename Func>
+    void ParallelFor(std::size_t count, std::size_t min_chunk_size, Func&& func,
+                     TaskPriority priority = TaskPriority::Critical) {
+        if (count == 0) {
+            return;
+        }
+        const std::size_t num_chunks = NumThreads() + 1;
+        const std::size_t chunk_size = std::max<std::size_t>(
+            (count + num_chunks - 1) / num_chunks, std::max<std::size_t>(min_chunk_size, 1));
+        TaskGroup group;
+        for (std::size_t begin = chunk_size; begin < count; begin += chunk_size) {
+            const std::size_t end = std::min(begin + chunk_size, count);
+            Submit([&func, begin, end] { func(begin, end); }, group, priority);
+        }
+        func(std::size_t{0}, std::min(chunk_size, count));
+        group.Wait();
+    }
+
+private:
+    friend class TaskGroup;
+
+    struct Entry {
+        Task task;
+        TaskGroup* group;
+    };
+
+    static constexpr std::size_t num_priorities = 2;
+
+    struct Worker {
+        std::mutex mutex;
+        std::array<std::deque<Entry>, num_priorities> queues;
+    };
+
+    void WorkerLoop(std::stop_token stop_token, std::size_t index);
+
+    /// Runs one queued task, of any group if group is null. Returns false if there was none.
+    bool TryRunTask(const TaskGroup* group);
+
+    std::string name;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<std::size_t> next_worker{};
+    std::atomic<std::size_t> num_queued{};
+    std::atomic<std::size_t> num_sleeping{};
+    std::mutex sleep_mutex;
+    std::condition_variable_any sleep_cv;
+    std::vector<std::jthread> threads;
+};
+
+} // namespace Common
@@ -4,204 +4,229 @@
 
 #pragma once
 
-#include <algorithm>
 #include <array>
+#include <bit>
 #include <deque>
+#include <limits>
 #include <boost/serialization/deque.hpp>
 #include <boost/serialization/split_member.hpp>
+#include "common/assert.h"
 #include "common/common_types.h"
 
 namespace Common {
 
+/**
+ * Intrusive links of an element of a ThreadQueueList. The elements (pointed to by T) must expose
+ * one as a public member named queue_node, and can be in at most one list at a time.
+ */
+template <class T>
+struct ThreadQueueListNode {
+    T prev{};
+    T next{};
+    unsigned int priority{};
+    bool linked{};
+};
+
+/**
+ * Multi-level queue of elements ordered by priority, 0 being the highest. Each level is an
+ * intrusive doubly linked list and a bitmap of the non-empty levels is used to find the best one,
+ * so all operations are O(1) and never allocate.
+ */
 template <class T, unsigned int N>
 struct ThreadQueueList {
-    // TODO(yuriks): If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
-
     using Priority = unsigned int;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static constexpr Priority NUM_QUEUES = N;
+    static_assert(NUM_QUEUES <= std::numeric_limits<u64>::digits,
+                  "The level bitmap must fit in a 64-bit integer");
 
-    ThreadQueueList() {
-        first = nullptr;
-    }
+    ThreadQueueList() = default;
 
     // Only for debugging, returns priority level.
     [[nodiscard]] Priority contains(const T& uid) const {
-        for (Priority i = 0; i < NUM_QUEUES; ++i) {
-            const Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
-                return i;
-            }
+        if (uid == nullptr || !uid->queue_node.linked) {
+            return -1;
         }
-
-        return -1;
+        return uid->queue_node.priority;
     }
 
     [[nodiscard]] T get_first() const {
-        const Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
+        if (nonempty_mask == 0) {
+            return T();
         }
-
-        return T();
+        return queues[std::countr_zero(nonempty_mask)].head;
     }
 
     T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+        T first = get_first();
+        if (first != nullptr) {
+            unlink(first);
         }
-
-        return T();
+        return first;
     }
 
     T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+        // Only consider the levels above the given priority.
+        const u64 better_mask =
+            priority < NUM_QUEUES ? nonempty_mask & ((u64{1} << priority) - 1) : nonempty_mask;
+        if (better_mask == 0) {
+            return T();
         }
-
-        return T();
+        T first = queues[std::countr_zero(better_mask)].head;
+        unlink(first);
+        return first;
     }
 
     void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+        DEBUG_ASSERT_MSG(!thread_id->queue_node.linked, "Element is already queued");
+        if (thread_id->queue_node.linked) {
+            unlink(thread_id);
+        }
+        Queue& cur = queues[priority];
+        auto& node = thread_id->queue_node;
+        node.prev = T();
+        node.next = cur.head;
+        node.priority = priority;
+        node.linked = true;
+        if (cur.head != nullptr) {
+            cur.head->queue_node.prev = thread_id;
+        } else {
+            cur.tail = thread_id;
+        }
+        cur.head = thread_id;
+        nonempty_mask |= u64{1} << priority;
     }
 
     void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+        DEBUG_ASSERT_MSG(!thread_id->queue_node.linked, "Element is already queued");
+        if (thread_id->queue_node.linked) {
+            unlink(thread_id);
+        }
+        Queue& cur = queues[priority];
+        auto& node = thread_id->queue_node;
+        node.prev = cur.tail;
+        node.next = T();
+        node.priority = priority;
+        node.linked = true;
+        if (cur.tail != nullptr) {
+            cur.tail->queue_node.next = thread_id;
+        } else {
+            cur.head = thread_id;
+        }
+        cur.tail = thread_id;
+        nonempty_mask |= u64{1} << priority;
     }
 
     void move(const T& thread_id, Priority old_priority, Priority new_priority) {
         remove(old_priority, thread_id);
-        prepare(new_priority);
         push_back(new_priority, thread_id);
     }
 
     void remove(Priority priority, const T& thread_id) {
-        Queue* const cur = &queues[priority];
-        const auto iter = std::remove(cur->data.begin(), cur->data.end(), thread_id);
-        cur->data.erase(iter, cur->data.end());
+        // Removing an element that is not queued is allowed and does nothing.
+        if (!thread_id->queue_node.linked) {
+            return;
+        }
+        DEBUG_ASSERT(thread_id->queue_node.priority == priority);
+        unlink(thread_id);
     }
 
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        Queue& cur = queues[priority];
+        if (cur.head != cur.tail) {
+            T first = cur.head;
+            unlink(first);
+            push_back(priority, first);
         }
     }
 
     void clear() {
-        queues.fill(Queue());
-        first = nullptr;
+        for (Queue& cur : queues) {
+            while (cur.head != nullptr) {
+                unlink(cur.head);
+            }
+        }
     }
 
     [[nodiscard]] bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
+        return (nonempty_mask & (u64{1} << priority)) == 0;
     }
 
-    void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
-    }
+    // Kept for API compatibility, levels no longer need to be linked before use.
+    void prepare(Priority priority) {}
 
 private:
     struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
+        T head{};
+        T tail{};
     };
 
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
-    }
-
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
+    void unlink(const T& thread_id) {
+        auto& node = thread_id->queue_node;
+        Queue& cur = queues[node.priority];
+        if (node.prev != nullptr) {
+            node.prev->queue_node.next = node.next;
+        } else {
+            cur.head = node.next;
         }
-
-        cur->next_nonempty = first;
-        first = cur;
-    }
-
-    // The first queue that's ever been used.
-    Queue* first;
-    // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
-
-    s64 ToIndex(const Queue* q) const {
-        if (q == nullptr) {
-            return -2;
-        } else if (q == UnlinkedTag()) {
-            return -1;
+        if (node.next != nullptr) {
+            node.next->queue_node.prev = node.prev;
         } else {
-            return q - queues.data();
+            cur.tail = node.prev;
+        }
+        if (cur.head == nullptr) {
+            nonempty_mask &= ~(u64{1} << node.priority);
         }
+        node.prev = T();
+        node.next = T();
+        node.linked = false;
     }
 
-    Queue* ToPointer(s64 idx) {
-        if (idx == -1) {
-            return UnlinkedTag();
-        } else if (idx < 0) {
-            return nullptr;
-        } else {
-            return &queues[idx];
+    std::deque<T> level_data(std::size_t priority) const {
+        std::deque<T> data;
+        for (T cur = queues[priority].head; cur != nullptr; cur = cur->queue_node.next) {
+            data.push_back(cur);
         }
+        return data;
     }
 
+    // Bit i is set when the level i is not empty.
+    u64 nonempty_mask{};
+    // The priority level queues of thread ids.
+    std::array<Queue, NUM_QUEUES> queues{};
+
+    // The archive layout predates the intrusive lists: a linked list of the used levels (as
+    // indices, -2 terminating it) followed by the contents of each level. All levels are
+    // written as used, which older readers traverse just the same.
     friend class boost::serialization::access;
     template <class Archive>
     void save(Archive& ar, const unsigned int file_version) const {
-        const s64 idx = ToIndex(first);
-        ar << idx;
+        const s64 first_idx = 0;
+        ar << first_idx;
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
-            const s64 idx1 = ToIndex(queues[i].next_nonempty);
-            ar << idx1;
-            ar << queues[i].data;
+            const s64 next_idx = i + 1 < NUM_QUEUES ? static_cast<s64>(i + 1) : -2;
+            ar << next_idx;
+            const std::deque<T> data = level_data(i);
+            ar << data;
         }
     }
 
     template <class Archive>
     void load(Archive& ar, const unsigned int file_version) {
+        clear();
         s64 idx;
         ar >> idx;
-        first = ToPointer(idx);
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
             ar >> idx;
-            queues[i].next_nonempty = ToPointer(idx);
-            ar >> queues[i].data;
+            std::deque<T> data;
+            ar >> data;
+            for (const T& thread_id : data) {
+                // Older versions could hold the same element more than once.
+                if (!thread_id->queue_node.linked) {
+                    push_back(static_cast<Priority>(i), thread_id);
+                }
+            }
         }
     }
 
@@ -0,0 +1,83 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/perf_counters.h"
+#include "core/arm/dyncom/arm_dyncom_cache.h"
+#include "core/memory.h"
+
+namespace {
+/// Cache of the block being translated on this thread.
+thread_local TranslationCache* active_cache = nullptr;
+} // Anonymous namespace
+
+TranslationCache::TranslationCache(std::size_t capacity_)
+    : capacity{std::max(capacity_, 2 * MAX_BLOCK_SIZE)} {}
+
+TranslationCache::~TranslationCache() = default;
+
+std::size_t TranslationCache::BeginBlock() {
+    if (!buffer) {
+        buffer = std::make_unique<char[]>(capacity);
+    }
+    if (capacity - top < MAX_BLOCK_SIZE) {
+        static const Common::Perf::Counter flushes{"DynCom cache flushes"};
+        flushes.Add();
+        LOG_DEBUG(Core_ARM11, "Translation cache is full, flushing {} blocks", blocks.size());
+        Clear();
+    }
+    active_cache = this;
+
+    const std::size_t offset = top;
+    top += sizeof(BlockHeader);
+    Header(offset) = {};
+    return offset;
+}
+
+void TranslationCache::EndBlock(u32 pc, u32 end_pc, std::size_t offset) {
+    active_cache = nullptr;
+    blocks[pc] = offset;
+
+    const u32 last_page = (std::max(end_pc, pc + 1) - 1) >> Memory::CITRA_PAGE_BITS;
+    for (u32 page = pc >> Memory::CITRA_PAGE_BITS; page <= last_page; page++) {
+        page_blocks[page].push_back(pc);
+    }
+}
+
+void* TranslationCache::Allocate(std::size_t size) {
+    TranslationCache* const cache = active_cache;
+    ASSERT_MSG(cache && cache->top + size <= cache->capacity, "Translation cache is full!");
+    void* const data = cache->buffer.get() + cache->top;
+    cache->top += size;
+    return data;
+}
+
+void TranslationCache::Invalidate(u32 start, std::size_t length) {
+    if (length == 0) {
+        return;
+    }
+    const u32 first_page = start >> Memory::CITRA_PAGE_BITS;
+    const u32 last_page = static_cast<u32>((start + length - 1) >> Memory::CITRA_PAGE_BITS);
+    for (u32 page = first_page; page <= last_page; page++) {
+        const auto it = page_blocks.find(page);
+        if (it == page_blocks.end()) {
+            continue;
+        }
+        for (const u32 pc : it->second) {
+            blocks.erase(pc);
+        }
+        page_blocks.erase(it);
+    }
+    // The invalidated blocks may be the target of links from other blocks.
+    epoch++;
+}
+
+void TranslationCache::Clear() {
+    blocks.clear();
+    page_blocks.clear();
+    top = 0;
+    epoch++;
+}
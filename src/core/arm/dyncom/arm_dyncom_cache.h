@@ -0,0 +1,87 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+/**
+ * Storage of the basic blocks translated by the dyncom interpreter. Blocks are bump allocated in
+ * a buffer of fixed capacity, which is flushed whole when it cannot fit another block. Blocks can
+ * also be invalidated per guest page when the guest modifies its code.
+ *
+ * Every block starts with a header caching the block that followed it last time, so the
+ * interpreter can go from one block to the next without looking it up. These links are only valid
+ * for the epoch they were made in, which changes on every flush or invalidation.
+ */
+class TranslationCache {
+public:
+    struct BlockHeader {
+        u32 next_pc;
+        u32 next_epoch;
+        std::size_t next_offset;
+    };
+
+    /// Upper bound of the size of a block: a page of Thumb instructions, each using at most
+    /// MAX_INSTRUCTION_SIZE bytes.
+    static constexpr std::size_t MAX_INSTRUCTION_SIZE = 128;
+    static constexpr std::size_t MAX_BLOCK_SIZE =
+        sizeof(BlockHeader) + (0x1000 / 2 + 1) * MAX_INSTRUCTION_SIZE;
+
+    explicit TranslationCache(std::size_t capacity);
+    ~TranslationCache();
+
+    /// Returns the offset of the header of the block starting at pc, if it was translated.
+    [[nodiscard]] std::optional<std::size_t> Find(u32 pc) const {
+        const auto it = blocks.find(pc);
+        if (it == blocks.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    /**
+     * Starts translating a block, flushing the cache if it is full. Until EndBlock, the
+     * instructions of the block are allocated with Allocate on the calling thread.
+     * @returns the offset of the header of the new block.
+     */
+    std::size_t BeginBlock();
+
+    /// Registers the block started by BeginBlock as covering the guest code in [pc, end_pc).
+    void EndBlock(u32 pc, u32 end_pc, std::size_t offset);
+
+    /// Allocates size bytes for an instruction of the block being translated on this thread.
+    static void* Allocate(std::size_t size);
+
+    /// Drops the blocks translated from guest code overlapping [start, start + length).
+    void Invalidate(u32 start, std::size_t length);
+
+    /// Drops every block and reclaims the whole buffer.
+    void Clear();
+
+    [[nodiscard]] char* Data() noexcept {
+        return buffer.get();
+    }
+
+    [[nodiscard]] BlockHeader& Header(std::size_t offset) noexcept {
+        return *reinterpret_cast<BlockHeader*>(buffer.get() + offset);
+    }
+
+    [[nodiscard]] u32 Epoch() const noexcept {
+        return epoch;
+    }
+
+private:
+    std::size_t capacity;
+    std::unique_ptr<char[]> buffer;
+    std::size_t top = 0;
+    u32 epoch = 0;
+    std::unordered_map<u32, std::size_t> blocks;
+    /// Start addresses of the blocks translated from every guest page.
+    std::unordered_map<u32, std::vector<u32>> page_blocks;
+};
@@ -9,6 +9,8 @@
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/perf_counters.h"
+#include "core/arm/dyncom/arm_dyncom_cache.h"
 #include "core/arm/dyncom/arm_dyncom_dec.h"
 #include "core/arm/dyncom/arm_dyncom_interpreter.h"
 #include "core/arm/dyncom/arm_dyncom_run.h"
@@ -841,6 +843,8 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
 
 static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
+    static const Common::Perf::Counter cache_misses{"DynCom cache misses"};
+    cache_misses.Add();
 
     // Decode instruction, get index
     // Allocate memory and init InsCream
@@ -848,7 +852,7 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
     // Save start addr of basicblock in CreamCache
     ARM_INST_PTR inst_base = nullptr;
     TransExtData ret = TransExtData::NON_BRANCH;
-    bb_start = trans_cache_buf_top;
+    bb_start = cpu->instruction_cache.BeginBlock();
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
@@ -863,27 +867,29 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
         ret = inst_base->br;
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->instruction_cache.EndBlock(pc_start, phys_addr, bb_start);
 
     return KEEP_GOING;
 }
 
 static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
+    static const Common::Perf::Counter cache_misses{"DynCom cache misses"};
+    cache_misses.Add();
 
     ARM_INST_PTR inst_base = nullptr;
-    bb_start = trans_cache_buf_top;
+    bb_start = cpu->instruction_cache.BeginBlock();
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
 
-    InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
+    const u32 inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
 
     if (inst_base->br == TransExtData::NON_BRANCH) {
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->instruction_cache.EndBlock(pc_start, phys_addr + inst_size, bb_start);
 
     return KEEP_GOING;
 }
@@ -1624,8 +1630,14 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
     unsigned int addr;
     unsigned int num_instrs = 0;
 
+    TranslationCache& cache = cpu->instruction_cache;
+    char* trans_cache_buf = nullptr;
     std::size_t ptr;
 
+    /// Header of the last dispatched block, valid while the cache stays in the same epoch.
+    TranslationCache::BlockHeader* last_block = nullptr;
+    u32 last_block_epoch = 0;
+
     LOAD_NZCVT;
 DISPATCH : {
     if (!cpu->NirqSig) {
@@ -1639,17 +1651,34 @@ DISPATCH : {
     else
         cpu->Reg[15] &= 0xfffffffc;
 
-    // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    // Follow the link of the previous block if it leads to the current PC, otherwise find the
+    // cached instruction cream or translate it...
+    const u32 epoch = cache.Epoch();
+    if (last_block_epoch != epoch) {
+        last_block = nullptr;
+    }
+    std::size_t block;
+    if (last_block && last_block->next_pc == cpu->Reg[15] && last_block->next_epoch == epoch) {
+        block = last_block->next_offset;
     } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+        if (const auto cached = cache.Find(cpu->Reg[15])) {
+            block = *cached;
+        } else if (cpu->NumInstrsToExecute != 1) {
+            if (InterpreterTranslateBlock(cpu, block, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        } else {
+            if (InterpreterTranslateSingle(cpu, block, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        }
+        // Translating may have flushed the cache, including the previous block.
+        if (last_block && cache.Epoch() == epoch) {
+            *last_block = {cpu->Reg[15], epoch, block};
+        }
     }
+    trans_cache_buf = cache.Data();
+    last_block = &cache.Header(block);
+    last_block_epoch = cache.Epoch();
+    ptr = block + sizeof(TranslationCache::BlockHeader);
 
 #ifndef ANDROID
     // Find breakpoint if one exists within the block
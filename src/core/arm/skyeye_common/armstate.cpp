@@ -3,16 +3,21 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include "common/literals.h"
 #include "common/logging/log.h"
+#include "common/settings.h"
 #include "common/swap.h"
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
 #include "core/core.h"
 #include "core/memory.h"
 
+using namespace Common::Literals;
+
 ARMul_State::ARMul_State(Core::System& system_, Memory::MemorySystem& memory_,
                          PrivilegeMode initial_mode)
-    : system{system_}, memory{memory_} {
+    : system{system_}, memory{memory_},
+      instruction_cache{Settings::values.dyncom_cache_size_mb.GetValue() * 1_MiB} {
     Reset();
     ChangePrivilegeMode(initial_mode);
 }
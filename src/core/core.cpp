@@ -335,6 +335,7 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
                   static_cast<u32>(load_result));
     }
 
+    gpu->SetTitleId(title_id);
     cheat_engine.LoadCheatFile(title_id);
     cheat_engine.Connect();
 
@@ -713,6 +714,7 @@ void System::serialize(Archive& ar, const unsigned int file_version) {
         auto n3ds_hw_caps = this->app_loader->LoadNew3dsHwCapabilities();
         [[maybe_unused]] const System::ResultStatus result = Init(
             *m_emu_window, m_secondary_window, *memory_mode.first, *n3ds_hw_caps.first, num_cores);
+        gpu->SetTitleId(title_id);
     }
 
     // Flush on save, don't flush on load
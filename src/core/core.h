@@ -280,6 +280,13 @@ public:
     /// Gets a const reference to the movie recorder
     [[nodiscard]] const Core::Movie& Movie() const;
 
+#ifdef ENABLE_SCRIPTING
+    /// Gets a pointer to the RPC server, if one is running
+    [[nodiscard]] RPC::Server* RPCServer() {
+        return rpc_server.get();
+    }
+#endif
+
     /// Video Dumper interface
 
     void RegisterVideoDumper(std::shared_ptr<VideoDumper::Backend> video_dumper);
@@ -25,11 +25,11 @@ namespace FileSys {
  * A modified version of DiskFile for fixed-size file used by ExtSaveData
  * The file size can't be changed by SetSize or Write.
  */
-class FixSizeDiskFile : public DiskFile {
+class FixSizeDiskFile : public CachedDiskFile {
 public:
-    FixSizeDiskFile(FileUtil::IOFile&& file, const Mode& mode,
+    FixSizeDiskFile(std::shared_ptr<SaveWriteCache::Entry> entry, const Mode& mode,
                     std::unique_ptr<DelayGenerator> delay_generator_)
-        : DiskFile(std::move(file), mode, std::move(delay_generator_)) {
+        : CachedDiskFile(std::move(entry), mode, std::move(delay_generator_)) {
         size = GetSize();
     }
 
@@ -49,7 +49,7 @@ public:
             length = size - offset;
         }
 
-        return DiskFile::Write(offset, length, flush, buffer);
+        return CachedDiskFile::Write(offset, length, flush, buffer);
     }
 
 private:
@@ -122,6 +122,7 @@ public:
         }
 
         const auto full_path = path_parser.BuildHostPath(mount_point);
+        SaveWriteCache::Recover(full_path);
 
         switch (path_parser.GetHostStatus(mount_point)) {
         case PathParser::InvalidMountPoint:
@@ -141,8 +142,8 @@ public:
             break; // Expected 'success' case
         }
 
-        FileUtil::IOFile file(full_path, "r+b");
-        if (!file.IsOpen()) {
+        auto entry = SaveWriteCache::Instance().Open(full_path);
+        if (!entry) {
             LOG_CRITICAL(Service_FS, "(unreachable) Unknown error opening {}", full_path);
             return ResultFileNotFound;
         }
@@ -151,7 +152,7 @@ public:
         rwmode.write_flag.Assign(1);
         rwmode.read_flag.Assign(1);
         auto delay_generator = std::make_unique<ExtSaveDataDelayGenerator>();
-        return std::make_unique<FixSizeDiskFile>(std::move(file), rwmode,
+        return std::make_unique<FixSizeDiskFile>(std::move(entry), rwmode,
                                                  std::move(delay_generator));
     }
 
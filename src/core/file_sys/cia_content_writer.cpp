@@ -0,0 +1,149 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
+#include "common/assert.h"
+#include "common/bounded_threadsafe_queue.h"
+#include "common/logging/log.h"
+#include "common/polyfill_thread.h"
+#include "common/thread.h"
+#include "core/file_sys/cia_content_writer.h"
+
+namespace FileSys {
+
+namespace {
+struct Chunk {
+    /// Index of the content, or std::nullopt to stop the stages.
+    std::optional<std::size_t> index;
+    std::vector<u8> data;
+};
+
+/// Chunks in flight between two stages.
+constexpr std::size_t QueueCapacity = 8;
+using ChunkQueue = Common::SPSCQueue<Chunk, QueueCapacity>;
+} // Anonymous namespace
+
+struct CIAContentWriter::State {
+    // Crypto++ picks the AES-NI or ARMv8 implementation at runtime, and decrypts several CBC
+    // blocks at once when given large buffers.
+    std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> decryptors;
+    std::vector<CryptoPP::SHA256> hashes;
+    std::vector<u64> bytes_written;
+    std::atomic_bool write_failed{};
+
+    ChunkQueue decrypt_queue;
+    ChunkQueue hash_queue;
+    ChunkQueue write_queue;
+    std::jthread decrypt_thread;
+    std::jthread hash_thread;
+    std::jthread write_thread;
+};
+
+CIAContentWriter::CIAContentWriter(std::vector<Content> contents_)
+    : contents{std::move(contents_)}, state{std::make_unique<State>()} {
+    state->decryptors.resize(contents.size());
+    state->hashes.resize(contents.size());
+    state->bytes_written.resize(contents.size());
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        if (const auto& key = contents[i].key) {
+            state->decryptors[i].SetKeyWithIV(key->data(), key->size(), contents[i].iv.data());
+        }
+    }
+
+    state->decrypt_thread = std::jthread{[this] { DecryptStage(); }};
+    state->hash_thread = std::jthread{[this] { HashStage(); }};
+    state->write_thread = std::jthread{[this] { WriteStage(); }};
+}
+
+CIAContentWriter::~CIAContentWriter() {
+    Finish();
+}
+
+void CIAContentWriter::Write(std::size_t index, const u8* data, std::size_t length) {
+    ASSERT(!result && index < contents.size());
+    state->decrypt_queue.EmplaceWait(Chunk{index, std::vector<u8>(data, data + length)});
+}
+
+bool CIAContentWriter::Finish() {
+    if (result) {
+        return *result;
+    }
+
+    state->decrypt_queue.EmplaceWait(Chunk{std::nullopt, {}});
+    state->decrypt_thread.join();
+    state->hash_thread.join();
+    state->write_thread.join();
+
+    bool success = !state->write_failed;
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        contents[i].file.Close();
+
+        // Contents that were not written completely are from an aborted install.
+        if (state->bytes_written[i] != contents[i].size) {
+            continue;
+        }
+        std::array<u8, CryptoPP::SHA256::DIGESTSIZE> hash;
+        state->hashes[i].Final(hash.data());
+        if (hash != contents[i].hash) {
+            LOG_ERROR(Service_AM, "Hash mismatch for content {}", i);
+            success = false;
+        }
+    }
+    result = success;
+    return success;
+}
+
+void CIAContentWriter::DecryptStage() {
+    Common::SetCurrentThreadName("CIADecrypt");
+    while (true) {
+        Chunk chunk = state->decrypt_queue.PopWait();
+        if (chunk.index && contents[*chunk.index].key) {
+            state->decryptors[*chunk.index].ProcessData(chunk.data.data(), chunk.data.data(),
+                                                       chunk.data.size());
+        }
+        const bool is_last = !chunk.index;
+        state->hash_queue.EmplaceWait(std::move(chunk));
+        if (is_last) {
+            return;
+        }
+    }
+}
+
+void CIAContentWriter::HashStage() {
+    Common::SetCurrentThreadName("CIAHash");
+    while (true) {
+        Chunk chunk = state->hash_queue.PopWait();
+        if (chunk.index) {
+            state->hashes[*chunk.index].Update(chunk.data.data(), chunk.data.size());
+        }
+        const bool is_last = !chunk.index;
+        state->write_queue.EmplaceWait(std::move(chunk));
+        if (is_last) {
+            return;
+        }
+    }
+}
+
+void CIAContentWriter::WriteStage() {
+    Common::SetCurrentThreadName("CIAWrite");
+    while (true) {
+        Chunk chunk = state->write_queue.PopWait();
+        if (!chunk.index) {
+            return;
+        }
+        const std::size_t index = *chunk.index;
+        if (contents[index].file.WriteBytes(chunk.data.data(), chunk.data.size()) !=
+            chunk.data.size()) {
+            LOG_ERROR(Service_AM, "Could not write content {}", index);
+            state->write_failed = true;
+        }
+        state->bytes_written[index] += chunk.data.size();
+    }
+}
+
+} // namespace FileSys
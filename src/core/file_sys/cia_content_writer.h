@@ -0,0 +1,60 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+
+namespace FileSys {
+
+/**
+ * Decrypts, verifies and writes out the contents of a CIA being installed. The work is split into
+ * decrypt, hash and write stages, each running on its own thread and connected by bounded queues,
+ * so the stages overlap with each other and with the caller reading the CIA.
+ */
+class CIAContentWriter {
+public:
+    struct Content {
+        FileUtil::IOFile file;
+        u64 size;
+        /// Title key, if the content is encrypted.
+        std::optional<std::array<u8, 16>> key;
+        std::array<u8, 16> iv;
+        /// SHA-256 of the decrypted content, from the TMD.
+        std::array<u8, 0x20> hash;
+    };
+
+    explicit CIAContentWriter(std::vector<Content> contents);
+    ~CIAContentWriter();
+
+    /**
+     * Queues the next length bytes of the content at index. Contents must be written in order,
+     * and blocks must be written whole for encrypted contents. Blocks if the stages are behind.
+     */
+    void Write(std::size_t index, const u8* data, std::size_t length);
+
+    /**
+     * Waits for the queued data to be written and closes the files.
+     * @returns false if a write failed or a fully written content does not match its hash.
+     */
+    bool Finish();
+
+private:
+    void DecryptStage();
+    void HashStage();
+    void WriteStage();
+
+    std::vector<Content> contents;
+    std::optional<bool> result;
+
+    struct State;
+    std::unique_ptr<State> state;
+};
+
+} // namespace FileSys
@@ -12,6 +12,7 @@
 #include "core/file_sys/errors.h"
 
 SERIALIZE_EXPORT_IMPL(FileSys::DiskFile)
+SERIALIZE_EXPORT_IMPL(FileSys::CachedDiskFile)
 SERIALIZE_EXPORT_IMPL(FileSys::DiskDirectory)
 
 namespace FileSys {
@@ -51,6 +52,64 @@ bool DiskFile::Close() const {
     return file->Close();
 }
 
+CachedDiskFile::CachedDiskFile(std::shared_ptr<SaveWriteCache::Entry> entry_, const Mode& mode_,
+                               std::unique_ptr<DelayGenerator> delay_generator_)
+    : entry(std::move(entry_)) {
+    delay_generator = std::move(delay_generator_);
+    mode.hex = mode_.hex;
+}
+
+CachedDiskFile::~CachedDiskFile() {
+    Close();
+}
+
+ResultVal<std::size_t> CachedDiskFile::Read(const u64 offset, const std::size_t length,
+                                            u8* buffer) const {
+    if (!mode.read_flag)
+        return ResultInvalidOpenFlags;
+    if (!entry)
+        return 0ULL;
+
+    return SaveWriteCache::Instance().Read(*entry, offset, length, buffer);
+}
+
+ResultVal<std::size_t> CachedDiskFile::Write(const u64 offset, const std::size_t length,
+                                             const bool flush, const u8* buffer) {
+    if (!mode.write_flag)
+        return ResultInvalidOpenFlags;
+    if (!entry)
+        return 0ULL;
+
+    return SaveWriteCache::Instance().Write(*entry, offset, length, flush, buffer);
+}
+
+u64 CachedDiskFile::GetSize() const {
+    return entry ? SaveWriteCache::Instance().GetSize(*entry) : 0;
+}
+
+bool CachedDiskFile::SetSize(const u64 size) const {
+    if (!entry)
+        return false;
+
+    SaveWriteCache::Instance().SetSize(*entry, size);
+    return true;
+}
+
+bool CachedDiskFile::Close() const {
+    if (!entry)
+        return true;
+
+    const bool committed = SaveWriteCache::Instance().Commit(*entry);
+    entry.reset();
+    return committed;
+}
+
+void CachedDiskFile::Flush() const {
+    if (entry) {
+        SaveWriteCache::Instance().Commit(*entry);
+    }
+}
+
 DiskDirectory::DiskDirectory(const std::string& path) {
     directory.size = FileUtil::ScanDirectoryTree(path, directory);
     directory.isDirectory = true;
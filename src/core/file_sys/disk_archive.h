@@ -16,6 +16,7 @@
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/directory_backend.h"
 #include "core/file_sys/file_backend.h"
+#include "core/file_sys/save_write_cache.h"
 #include "core/hle/result.h"
 
 namespace FileSys {
@@ -56,6 +57,48 @@ private:
     friend class boost::serialization::access;
 };
 
+/**
+ * A file of a host-backed save data archive, read and written through the SaveWriteCache.
+ */
+class CachedDiskFile : public FileBackend {
+public:
+    CachedDiskFile(std::shared_ptr<SaveWriteCache::Entry> entry_, const Mode& mode_,
+                   std::unique_ptr<DelayGenerator> delay_generator_);
+    ~CachedDiskFile() override;
+
+    ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override;
+    ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
+                                 const u8* buffer) override;
+    u64 GetSize() const override;
+    bool SetSize(u64 size) const override;
+    bool Close() const override;
+    void Flush() const override;
+
+protected:
+    Mode mode;
+    mutable std::shared_ptr<SaveWriteCache::Entry> entry;
+
+private:
+    CachedDiskFile() = default;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& boost::serialization::base_object<FileBackend>(*this);
+        ar& mode.hex;
+        std::string path;
+        if (Archive::is_saving::value && entry) {
+            // Savestates refer to the file on the host, which has to be up to date.
+            SaveWriteCache::Instance().Commit(*entry);
+            path = entry->path;
+        }
+        ar& path;
+        if (Archive::is_loading::value) {
+            entry = path.empty() ? nullptr : SaveWriteCache::Instance().Open(path);
+        }
+    }
+    friend class boost::serialization::access;
+};
+
 class DiskDirectory : public DirectoryBackend {
 public:
     explicit DiskDirectory(const std::string& path);
@@ -99,4 +142,5 @@ private:
 } // namespace FileSys
 
 BOOST_CLASS_EXPORT_KEY(FileSys::DiskFile)
+BOOST_CLASS_EXPORT_KEY(FileSys::CachedDiskFile)
 BOOST_CLASS_EXPORT_KEY(FileSys::DiskDirectory)
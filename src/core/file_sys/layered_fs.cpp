@@ -4,11 +4,13 @@
 
 #include <algorithm>
 #include <cstring>
+#include <fmt/format.h>
 #include "common/alignment.h"
 #include "common/archives.h"
 #include "common/assert.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/string_util.h"
 #include "common/swap.h"
 #include "core/file_sys/layered_fs.h"
@@ -20,9 +22,10 @@ namespace FileSys {
 
 struct FileRelocationInfo {
     int type;                      // 0 - none, 1 - replaced / created, 2 - patched, 3 - removed
-    u64 original_offset;           // Type 0. Offset is absolute
+    u64 original_offset;           // Type 0 and 2. Offset is absolute
+    u64 original_size;             // Type 2
     std::string replace_file_path; // Type 1
-    std::vector<u8> patched_file;  // Type 2
+    std::string patch_file_path;   // Type 2
     u64 size;                      // Relocated file size
 };
 struct LayeredFS::File {
@@ -54,6 +57,34 @@ struct FileMetadata {
 };
 static_assert(sizeof(FileMetadata) == 0x20, "Size of FileMetadata is not correct");
 
+constexpr u32 CacheMagic = 0x4353464C; // "LFSC"
+constexpr u32 CacheVersion = 2;
+
+struct CacheHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le key;
+    u64_le metadata_size;
+    u64_le data_size;
+    u64_le num_files;
+};
+
+struct CacheFileEntry {
+    u64_le data_offset;
+    u32_le type;
+    u32_le path_length;
+    u64_le original_offset;
+    u64_le original_size;
+    u64_le size;
+    u32_le relocated_path_length;
+    INSERT_PADDING_WORDS(1);
+    // Followed by the path and the replacement or patch file path
+};
+static_assert(sizeof(CacheFileEntry) == 0x30, "Size of CacheFileEntry is not correct");
+
+// Patched files are kept in memory up to this size.
+constexpr std::size_t MaxPatchedFilesSize = 64 * 1024 * 1024;
+
 LayeredFS::LayeredFS() = default;
 
 LayeredFS::LayeredFS(std::shared_ptr<RomFSReader> romfs_, std::string patch_path_,
@@ -68,26 +99,49 @@ void LayeredFS::Load() {
 
     ASSERT_MSG(header.header_length == sizeof(header), "Header size is incorrect");
 
+    // Read the metadata tables at once rather than entry by entry
+    original_directory_metadata.resize(header.directory_metadata_table.length);
+    romfs->ReadFile(header.directory_metadata_table.offset, original_directory_metadata.size(),
+                    original_directory_metadata.data());
+    original_file_metadata.resize(header.file_metadata_table.length);
+    romfs->ReadFile(header.file_metadata_table.offset, original_file_metadata.size(),
+                    original_file_metadata.data());
+
+    const u64 cache_key = load_relocations ? ComputeCacheKey() : 0;
+    if (load_relocations && LoadCache(cache_key)) {
+        original_directory_metadata = {};
+        original_file_metadata = {};
+        return;
+    }
+
     // TODO: is root always the first directory in table?
     root.parent = &root;
     LoadDirectory(root, 0);
 
+    original_directory_metadata = {};
+    original_file_metadata = {};
+
     if (load_relocations) {
         LoadRelocations();
         LoadExtRelocations();
     }
 
     RebuildMetadata();
+
+    if (load_relocations) {
+        SaveCache(cache_key);
+    }
 }
 
 LayeredFS::~LayeredFS() = default;
 
 u32 LayeredFS::LoadDirectory(Directory& current, u32 offset) {
     DirectoryMetadata metadata;
-    romfs->ReadFile(header.directory_metadata_table.offset + offset, sizeof(metadata),
-                    reinterpret_cast<u8*>(&metadata));
+    ASSERT_MSG(offset + sizeof(metadata) <= original_directory_metadata.size(),
+               "Directory metadata is out of bounds");
+    std::memcpy(&metadata, original_directory_metadata.data() + offset, sizeof(metadata));
 
-    current.name = ReadName(header.directory_metadata_table.offset + offset + sizeof(metadata),
+    current.name = ReadName(original_directory_metadata, offset + sizeof(metadata),
                             metadata.name_length);
     current.path = current.parent->path + current.name + DIR_SEP;
     directory_path_map.emplace(current.path, &current);
@@ -111,12 +165,12 @@ u32 LayeredFS::LoadDirectory(Directory& current, u32 offset) {
 
 u32 LayeredFS::LoadFile(Directory& parent, u32 offset) {
     FileMetadata metadata;
-    romfs->ReadFile(header.file_metadata_table.offset + offset, sizeof(metadata),
-                    reinterpret_cast<u8*>(&metadata));
+    ASSERT_MSG(offset + sizeof(metadata) <= original_file_metadata.size(),
+               "File metadata is out of bounds");
+    std::memcpy(&metadata, original_file_metadata.data() + offset, sizeof(metadata));
 
     auto file = std::make_unique<File>();
-    file->name = ReadName(header.file_metadata_table.offset + offset + sizeof(metadata),
-                          metadata.name_length);
+    file->name = ReadName(original_file_metadata, offset + sizeof(metadata), metadata.name_length);
     file->path = parent.path + file->name;
     file->relocation.original_offset = header.file_data_offset + metadata.file_data_offset;
     file->relocation.size = metadata.file_data_length;
@@ -128,9 +182,10 @@ u32 LayeredFS::LoadFile(Directory& parent, u32 offset) {
     return metadata.next_sibling_offset;
 }
 
-std::string LayeredFS::ReadName(u32 offset, u32 name_length) {
+std::string LayeredFS::ReadName(const std::vector<u8>& table, u32 offset, u32 name_length) {
+    ASSERT_MSG(offset + name_length <= table.size(), "Name is out of bounds");
     std::vector<u16_le> buffer(name_length / sizeof(u16_le));
-    romfs->ReadFile(offset, name_length, reinterpret_cast<u8*>(buffer.data()));
+    std::memcpy(buffer.data(), table.data() + offset, buffer.size() * sizeof(u16_le));
 
     std::u16string name(buffer.size(), 0);
     std::transform(buffer.begin(), buffer.end(), name.begin(), [](u16_le character) {
@@ -230,36 +285,19 @@ void LayeredFS::LoadExtRelocations() {
                 continue;
             }
 
-            FileUtil::IOFile patch_file(entry.physicalName, "rb");
-            if (!patch_file) {
-                LOG_ERROR(Service_FS, "LayeredFS Could not open file {}", entry.physicalName);
-                continue;
-            }
-
-            const auto size = patch_file.GetSize();
-            std::vector<u8> patch(size);
-            if (patch_file.ReadBytes(patch.data(), size) != size) {
-                LOG_ERROR(Service_FS, "LayeredFS Could not read file {}", entry.physicalName);
-                continue;
-            }
-
             auto& file = *file_path_map[file_path];
-            std::vector<u8> buffer(file.relocation.size); // Original size
-            romfs->ReadFile(file.relocation.original_offset, buffer.size(), buffer.data());
+            file.relocation.patch_file_path = entry.physicalName;
+            file.relocation.original_size = file.relocation.size;
 
-            bool ret = false;
-            if (extension == ".ips") {
-                ret = Patch::ApplyIpsPatch(patch, buffer);
-            } else {
-                ret = Patch::ApplyBpsPatch(patch, buffer);
-            }
-
-            if (ret) {
+            // The patch is applied once to know the patched size. The result is kept in the cache
+            // as the file is likely to be read soon.
+            auto buffer = ApplyPatch(file);
+            if (buffer) {
                 LOG_INFO(Service_FS, "LayeredFS patched file {}", file_path);
 
                 file.relocation.type = 2;
-                file.relocation.size = buffer.size();
-                file.relocation.patched_file = std::move(buffer);
+                file.relocation.size = buffer->size();
+                CachePatchedFile(file, std::move(*buffer));
             } else {
                 LOG_ERROR(Service_FS, "LayeredFS failed to patch file {}", file_path);
             }
@@ -269,6 +307,246 @@ void LayeredFS::LoadExtRelocations() {
     }
 }
 
+std::optional<std::vector<u8>> LayeredFS::ApplyPatch(const File& file) {
+    const auto& path = file.relocation.patch_file_path;
+    FileUtil::IOFile patch_file(path, "rb");
+    if (!patch_file) {
+        LOG_ERROR(Service_FS, "LayeredFS Could not open file {}", path);
+        return std::nullopt;
+    }
+
+    const auto size = patch_file.GetSize();
+    std::vector<u8> patch(size);
+    if (patch_file.ReadBytes(patch.data(), size) != size) {
+        LOG_ERROR(Service_FS, "LayeredFS Could not read file {}", path);
+        return std::nullopt;
+    }
+
+    std::vector<u8> buffer(file.relocation.original_size);
+    romfs->ReadFile(file.relocation.original_offset, buffer.size(), buffer.data());
+
+    const bool is_ips = path.size() >= 4 && path.substr(path.size() - 4) == ".ips";
+    const bool ret =
+        is_ips ? Patch::ApplyIpsPatch(patch, buffer) : Patch::ApplyBpsPatch(patch, buffer);
+    if (!ret) {
+        return std::nullopt;
+    }
+    return buffer;
+}
+
+const std::vector<u8>& LayeredFS::GetPatchedFile(File& file) {
+    const auto it = std::find_if(patched_files.begin(), patched_files.end(),
+                                 [&file](const auto& entry) { return entry.first == &file; });
+    if (it != patched_files.end()) {
+        patched_files.splice(patched_files.begin(), patched_files, it);
+        return it->second;
+    }
+
+    auto buffer = ApplyPatch(file);
+    if (!buffer) {
+        LOG_ERROR(Service_FS, "LayeredFS failed to patch file {}", file.path);
+        buffer.emplace();
+    }
+    if (buffer->size() != file.relocation.size) {
+        LOG_ERROR(Service_FS, "LayeredFS patched file {} changed size since it was loaded",
+                  file.path);
+        buffer->resize(file.relocation.size);
+    }
+    return CachePatchedFile(file, std::move(*buffer));
+}
+
+const std::vector<u8>& LayeredFS::CachePatchedFile(File& file, std::vector<u8> data) {
+    patched_files_size += data.size();
+    patched_files.emplace_front(&file, std::move(data));
+    // The file just added is kept even if it is bigger than the limit on its own.
+    while (patched_files_size > MaxPatchedFilesSize && patched_files.size() > 1) {
+        patched_files_size -= patched_files.back().second.size();
+        patched_files.pop_back();
+    }
+    return patched_files.front().second;
+}
+
+static void HashFileContents(const std::string& path, u64& hash) {
+    FileUtil::IOFile file(path, "rb");
+    std::vector<u8> buffer(1024 * 1024);
+    while (file) {
+        const std::size_t read = file.ReadBytes(buffer.data(), buffer.size());
+        if (read == 0) {
+            break;
+        }
+        hash = Common::HashCombine(hash, Common::ComputeHash64(buffer.data(), read));
+    }
+}
+
+static bool IsPatchFile(const std::string& path) {
+    if (path.size() < 4) {
+        return false;
+    }
+    const auto extension = path.substr(path.size() - 4);
+    return extension == ".ips" || extension == ".bps";
+}
+
+static void HashDirectoryTree(const FileUtil::FSTEntry& entry, u64& hash) {
+    for (const auto& child : entry.children) {
+        hash = Common::HashCombine(
+            hash, Common::ComputeHash64(child.physicalName.data(), child.physicalName.size()));
+        hash = Common::HashCombine(hash, child.size);
+        const u64 mtime = FileUtil::GetModificationTime(child.physicalName);
+        if (mtime != 0) {
+            hash = Common::HashCombine(hash, mtime);
+        } else if (!child.isDirectory && IsPatchFile(child.physicalName)) {
+            // Some storage, like the Android SAF, does not report modification times. The cache
+            // only keeps the path and size of replacement files, which are already hashed, but the
+            // size of a patched file depends on the contents of its patch. Patches are small.
+            HashFileContents(child.physicalName, hash);
+        }
+        HashDirectoryTree(child, hash);
+    }
+}
+
+u64 LayeredFS::ComputeCacheKey() const {
+    u64 hash = Common::ComputeHash64(&header, sizeof(header));
+    hash = Common::HashCombine(hash, romfs->GetSize());
+    hash = Common::HashCombine(hash, Common::ComputeHash64(original_directory_metadata.data(),
+                                                           original_directory_metadata.size()));
+    hash = Common::HashCombine(
+        hash, Common::ComputeHash64(original_file_metadata.data(), original_file_metadata.size()));
+    for (std::string path : {patch_path, patch_ext_path}) {
+        if (!path.empty() && (path.back() == '/' || path.back() == '\\')) {
+            // ScanDirectoryTree expects a path without trailing '/'
+            path.pop_back();
+        }
+        hash = Common::HashCombine(hash, Common::ComputeHash64(path.data(), path.size()));
+        if (path.empty() || !FileUtil::Exists(path)) {
+            continue;
+        }
+        FileUtil::FSTEntry tree;
+        FileUtil::ScanDirectoryTree(path, tree, 256);
+        HashDirectoryTree(tree, hash);
+    }
+    return hash;
+}
+
+std::string LayeredFS::GetCachePath() const {
+    return fmt::format("{}layered_fs" DIR_SEP "{:016X}.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir),
+                       Common::ComputeHash64(patch_path.data(), patch_path.size()));
+}
+
+bool LayeredFS::LoadCache(u64 key) {
+    FileUtil::IOFile file(GetCachePath(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    CacheHeader cache_header;
+    if (file.ReadBytes(&cache_header, sizeof(cache_header)) != sizeof(cache_header) ||
+        cache_header.magic != CacheMagic || cache_header.version != CacheVersion ||
+        cache_header.key != key || cache_header.metadata_size > file.GetSize()) {
+        return false;
+    }
+
+    std::vector<u8> cached_metadata(cache_header.metadata_size);
+    if (file.ReadBytes(cached_metadata.data(), cached_metadata.size()) != cached_metadata.size()) {
+        return false;
+    }
+
+    std::vector<std::unique_ptr<File>> files;
+    std::map<u64, File*> offset_map;
+    for (u64 i = 0; i < cache_header.num_files; i++) {
+        CacheFileEntry entry;
+        if (file.ReadBytes(&entry, sizeof(entry)) != sizeof(entry) ||
+            entry.path_length + entry.relocated_path_length > file.GetSize()) {
+            return false;
+        }
+        auto cached_file = std::make_unique<File>();
+        cached_file->path.resize(entry.path_length);
+        std::string relocated_path(entry.relocated_path_length, '\0');
+        if (file.ReadBytes(cached_file->path.data(), entry.path_length) != entry.path_length ||
+            file.ReadBytes(relocated_path.data(), relocated_path.size()) !=
+                relocated_path.size()) {
+            return false;
+        }
+        auto& relocation = cached_file->relocation;
+        relocation.type = static_cast<int>(entry.type);
+        relocation.original_offset = entry.original_offset;
+        relocation.original_size = entry.original_size;
+        relocation.size = entry.size;
+        if (relocation.type == 1) {
+            relocation.replace_file_path = std::move(relocated_path);
+        } else if (relocation.type == 2) {
+            relocation.patch_file_path = std::move(relocated_path);
+        } else if (relocation.type != 0) {
+            return false;
+        }
+        offset_map.emplace(entry.data_offset, cached_file.get());
+        files.emplace_back(std::move(cached_file));
+    }
+
+    metadata = std::move(cached_metadata);
+    current_data_offset = cache_header.data_size;
+    cached_files = std::move(files);
+    data_offset_map = std::move(offset_map);
+    LOG_INFO(Service_FS, "LayeredFS loaded {} files from the cache", cached_files.size());
+    return true;
+}
+
+void LayeredFS::SaveCache(u64 key) const {
+    const auto path = GetCachePath();
+    if (!FileUtil::CreateFullPath(path)) {
+        LOG_WARNING(Service_FS, "LayeredFS could not create the cache directory of {}", path);
+        return;
+    }
+    // The cache is written next to its final path and moved over it once complete, so that an
+    // interrupted write does not leave a truncated cache behind.
+    const auto temp_path = path + ".tmp";
+    FileUtil::IOFile file(temp_path, "wb");
+    if (!file) {
+        LOG_WARNING(Service_FS, "LayeredFS could not open the cache {}", temp_path);
+        return;
+    }
+
+    CacheHeader cache_header{};
+    cache_header.magic = CacheMagic;
+    cache_header.version = CacheVersion;
+    cache_header.key = key;
+    cache_header.metadata_size = metadata.size();
+    cache_header.data_size = current_data_offset;
+    cache_header.num_files = data_offset_map.size();
+    file.WriteObject(cache_header);
+    file.WriteBytes(metadata.data(), metadata.size());
+
+    for (const auto& [data_offset, cached_file] : data_offset_map) {
+        const auto& relocation = cached_file->relocation;
+        const auto& relocated_path = relocation.type == 1   ? relocation.replace_file_path
+                                     : relocation.type == 2 ? relocation.patch_file_path
+                                                            : std::string{};
+        CacheFileEntry entry{};
+        entry.data_offset = data_offset;
+        entry.type = static_cast<u32>(relocation.type);
+        entry.path_length = static_cast<u32>(cached_file->path.size());
+        entry.original_offset = relocation.original_offset;
+        entry.original_size = relocation.original_size;
+        entry.size = relocation.size;
+        entry.relocated_path_length = static_cast<u32>(relocated_path.size());
+        file.WriteObject(entry);
+        file.WriteString(cached_file->path);
+        file.WriteString(relocated_path);
+    }
+
+    if (!file.Flush() || !file.IsGood()) {
+        LOG_WARNING(Service_FS, "LayeredFS could not write the cache {}", path);
+        file.Close();
+        FileUtil::Delete(temp_path);
+        return;
+    }
+    file.Close();
+    if (!FileUtil::Replace(temp_path, path)) {
+        LOG_WARNING(Service_FS, "LayeredFS could not replace the cache {}", path);
+        FileUtil::Delete(temp_path);
+    }
+}
+
 static std::size_t GetNameSize(const std::string& name) {
     std::u16string u16name = Common::UTF8ToUTF16(name);
     return Common::AlignUp(u16name.size() * 2, 4);
@@ -531,8 +809,8 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
                           current->second->path);
             }
         } else if (relocation.type == 2) { // patch
-            std::memcpy(buffer + read_size, relocation.patched_file.data() + relative_offset,
-                        to_read);
+            const auto& patched_file = GetPatchedFile(*current->second);
+            std::memcpy(buffer + read_size, patched_file.data() + relative_offset, to_read);
         } else {
             UNREACHABLE();
         }
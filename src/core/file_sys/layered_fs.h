@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -41,6 +43,11 @@ static_assert(sizeof(RomFSHeader) == 0x28, "Size of RomFSHeader is not correct")
  * patch_ext_path: Path for RomFS extensions. Files present in this path:
  *  - When with an extension of ".stub", remove the corresponding file in the RomFS.
  *  - When with an extension of ".ips" or ".bps", patch the file in the RomFS.
+ *
+ * The rebuilt metadata and the relocations are cached on disk, keyed by the original RomFS header
+ * and metadata tables, and the names, sizes and modification times of the files in both paths.
+ * Where modification times are not available, the contents of the patches are hashed instead.
+ * Patched files are only patched when first read, and kept in a bounded cache.
  */
 class LayeredFS : public RomFSReader {
 public:
@@ -71,7 +78,7 @@ private:
         Directory* parent;
     };
 
-    std::string ReadName(u32 offset, u32 name_length);
+    std::string ReadName(const std::vector<u8>& table, u32 offset, u32 name_length);
 
     // Loads the current directory, then its children.
     // Returns offset of the next sibling directory to load (0xFFFFFFFF if the last directory)
@@ -87,6 +94,25 @@ private:
     // Load patch/remove relocations
     void LoadExtRelocations();
 
+    // Applies the patch of a patched file to the original file.
+    std::optional<std::vector<u8>> ApplyPatch(const File& file);
+
+    // Returns the patched contents of a patched file, patching it if it is not cached.
+    const std::vector<u8>& GetPatchedFile(File& file);
+
+    // Adds the patched contents of a file to the cache, evicting the least recently used ones.
+    const std::vector<u8>& CachePatchedFile(File& file, std::vector<u8> data);
+
+    // Returns a hash of everything the rebuilt metadata and relocations depend on.
+    u64 ComputeCacheKey() const;
+
+    std::string GetCachePath() const;
+
+    // Loads the metadata and relocations from the disk cache. Returns false if it is stale.
+    bool LoadCache(u64 key);
+
+    void SaveCache(u64 key) const;
+
     // Calculate the offset of a single directory add it to the map and list of directories
     void PrepareBuildDirectory(Directory& current);
 
@@ -115,11 +141,20 @@ private:
 
     RomFSHeader header;
     Directory root;
+    std::vector<std::unique_ptr<File>> cached_files; // files loaded from the disk cache
     std::unordered_map<std::string, File*> file_path_map;
     std::unordered_map<std::string, Directory*> directory_path_map;
     std::map<u64, File*> data_offset_map; // assigned data offset -> file
     std::vector<u8> metadata;             // Includes header, hash table and metadata
 
+    // Original metadata tables, only kept while loading
+    std::vector<u8> original_directory_metadata;
+    std::vector<u8> original_file_metadata;
+
+    // Patched file contents, most recently used first
+    std::list<std::pair<File*, std::vector<u8>>> patched_files;
+    std::size_t patched_files_size{};
+
     // Used for rebuilding header
     std::vector<u32_le> directory_hash_table;
     std::vector<u32_le> file_hash_table;
@@ -0,0 +1,292 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/perf_counters.h"
+#include "common/thread.h"
+#include "core/file_sys/save_write_cache.h"
+
+namespace FileSys {
+
+namespace {
+/// Interval at which the background thread looks for files to write back.
+constexpr auto CommitInterval = std::chrono::seconds{1};
+/// Modified files are written back once they were not modified for this long.
+constexpr auto CommitDelay = std::chrono::seconds{2};
+
+const Common::Perf::Counter writes_coalesced{"Save writes coalesced"};
+const Common::Perf::Counter writes_issued{"Save writes issued"};
+
+std::string TempPath(const std::string& path) {
+    return path + ".tmp";
+}
+
+/// Returns true if entry_path is the file at path, or a file under the directory at path.
+bool IsUnderPath(const std::string& entry_path, const std::string& path) {
+    if (path.empty() || !entry_path.starts_with(path)) {
+        return false;
+    }
+    if (entry_path.size() == path.size() || path.back() == '/' || path.back() == '\\') {
+        return true;
+    }
+    const char separator = entry_path[path.size()];
+    return separator == '/' || separator == '\\';
+}
+} // Anonymous namespace
+
+SaveWriteCache& SaveWriteCache::Instance() {
+    static SaveWriteCache cache;
+    return cache;
+}
+
+SaveWriteCache::SaveWriteCache()
+    : commit_thread{[this](std::stop_token stop_token) { CommitThread(stop_token); }} {}
+
+SaveWriteCache::~SaveWriteCache() {
+    commit_thread.request_stop();
+    commit_thread.join();
+    CommitAll();
+}
+
+void SaveWriteCache::Recover(const std::string& path) {
+    // The temporary file is complete once the original is removed, as it is only moved into place
+    // after being written and synced.
+    const std::string temp_path = TempPath(path);
+    if (FileUtil::Exists(path) || !FileUtil::Exists(temp_path)) {
+        return;
+    }
+    LOG_WARNING(Service_FS, "Recovering {} from an interrupted write back", path);
+    if (!FileUtil::Rename(temp_path, path)) {
+        LOG_ERROR(Service_FS, "Could not recover {}", path);
+    }
+}
+
+std::shared_ptr<SaveWriteCache::Entry> SaveWriteCache::Open(const std::string& path) {
+    std::scoped_lock lock{mutex};
+    if (auto entry = entries[path].lock()) {
+        return entry;
+    }
+
+    Recover(path);
+
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Service_FS, "Could not open {}", path);
+        return nullptr;
+    }
+    auto entry = std::make_shared<Entry>();
+    entry->path = path;
+    entry->data.resize(file.GetSize());
+    if (file.ReadBytes(entry->data.data(), entry->data.size()) != entry->data.size()) {
+        LOG_ERROR(Service_FS, "Could not read {}", path);
+        return nullptr;
+    }
+    entries[path] = entry;
+    return entry;
+}
+
+std::size_t SaveWriteCache::Read(Entry& entry, u64 offset, std::size_t length, u8* buffer) {
+    std::scoped_lock lock{mutex};
+    if (offset >= entry.data.size()) {
+        return 0;
+    }
+    length = std::min<std::size_t>(length, entry.data.size() - offset);
+    std::memcpy(buffer, entry.data.data() + offset, length);
+    return length;
+}
+
+std::size_t SaveWriteCache::Write(Entry& entry, u64 offset, std::size_t length, bool flush,
+                                  const u8* buffer) {
+    std::scoped_lock lock{mutex};
+    if (offset + length > entry.data.size()) {
+        entry.data.resize(offset + length);
+    }
+    std::memcpy(entry.data.data() + offset, buffer, length);
+    entry.generation++;
+    entry.modified_time = std::chrono::steady_clock::now();
+    entry.flush_requested |= flush;
+    writes_coalesced.Add();
+    return length;
+}
+
+u64 SaveWriteCache::GetSize(Entry& entry) {
+    std::scoped_lock lock{mutex};
+    return entry.data.size();
+}
+
+void SaveWriteCache::SetSize(Entry& entry, u64 size) {
+    std::scoped_lock lock{mutex};
+    entry.data.resize(size);
+    entry.generation++;
+    entry.modified_time = std::chrono::steady_clock::now();
+    entry.flush_requested = true;
+}
+
+bool SaveWriteCache::Commit(Entry& entry) {
+    // Commits of the same file are serialized, so an older snapshot never replaces a newer one.
+    std::scoped_lock commit_lock{entry.commit_mutex};
+
+    std::vector<u8> data;
+    u64 generation;
+    {
+        std::scoped_lock lock{mutex};
+        if (entry.discarded || entry.generation == entry.committed_generation) {
+            return true;
+        }
+        data = entry.data;
+        generation = entry.generation;
+        entry.flush_requested = false;
+    }
+
+    const std::string temp_path = TempPath(entry.path);
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        if (!file.IsOpen() || file.WriteBytes(data.data(), data.size()) != data.size() ||
+            !file.Sync()) {
+            LOG_ERROR(Service_FS, "Could not write {}", temp_path);
+            file.Close();
+            FileUtil::Delete(temp_path);
+            return false;
+        }
+    }
+    if (!FileUtil::Replace(temp_path, entry.path)) {
+        LOG_ERROR(Service_FS, "Could not replace {}", entry.path);
+        FileUtil::Delete(temp_path);
+        return false;
+    }
+    writes_issued.Add();
+
+    std::scoped_lock lock{mutex};
+    entry.committed_generation = generation;
+    return true;
+}
+
+void SaveWriteCache::CommitAll() {
+    for (const auto& entry : GetEntries()) {
+        Commit(*entry);
+    }
+}
+
+void SaveWriteCache::Discard(const std::string& path) {
+    std::vector<std::shared_ptr<Entry>> discarded_entries;
+    {
+        std::scoped_lock lock{mutex};
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (!IsUnderPath(it->first, path)) {
+                ++it;
+                continue;
+            }
+            if (auto entry = it->second.lock()) {
+                discarded_entries.push_back(std::move(entry));
+            }
+            it = entries.erase(it);
+        }
+    }
+
+    // A write back that already took its snapshot would otherwise recreate the file after the
+    // caller deleted or moved it.
+    for (const auto& entry : discarded_entries) {
+        std::scoped_lock commit_lock{entry->commit_mutex};
+        std::scoped_lock lock{mutex};
+        entry->discarded = true;
+    }
+}
+
+bool SaveWriteCache::Rename(const std::string& src_path, const std::string& dest_path) {
+    std::scoped_lock rename_lock{rename_mutex};
+
+    // Write back the pending modifications, so the host files hold them when they are moved.
+    CommitAll();
+
+    std::vector<std::shared_ptr<Entry>> moved_entries;
+    std::vector<std::shared_ptr<Entry>> replaced_entries;
+    {
+        std::scoped_lock lock{mutex};
+        for (const auto& [entry_path, weak_entry] : entries) {
+            auto entry = weak_entry.lock();
+            if (!entry) {
+                continue;
+            }
+            if (IsUnderPath(entry_path, src_path)) {
+                moved_entries.push_back(std::move(entry));
+            } else if (IsUnderPath(entry_path, dest_path)) {
+                replaced_entries.push_back(std::move(entry));
+            }
+        }
+    }
+
+    // Write backs of the affected files wait for the rename, so that none of them writes to a
+    // path while it is being moved or replaced.
+    std::vector<std::unique_lock<std::mutex>> commit_locks;
+    commit_locks.reserve(moved_entries.size() + replaced_entries.size());
+    for (const auto& entry : moved_entries) {
+        commit_locks.emplace_back(entry->commit_mutex);
+    }
+    for (const auto& entry : replaced_entries) {
+        commit_locks.emplace_back(entry->commit_mutex);
+    }
+
+    if (!FileUtil::Rename(src_path, dest_path)) {
+        return false;
+    }
+
+    std::scoped_lock lock{mutex};
+    for (const auto& entry : replaced_entries) {
+        entry->discarded = true;
+        entries.erase(entry->path);
+    }
+    for (const auto& entry : moved_entries) {
+        entries.erase(entry->path);
+    }
+    for (const auto& entry : moved_entries) {
+        entry->path = dest_path + entry->path.substr(src_path.size());
+        entries[entry->path] = entry;
+    }
+    return true;
+}
+
+std::vector<std::shared_ptr<SaveWriteCache::Entry>> SaveWriteCache::GetEntries() {
+    std::scoped_lock lock{mutex};
+    std::vector<std::shared_ptr<Entry>> open_entries;
+    open_entries.reserve(entries.size());
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (auto entry = it->second.lock()) {
+            open_entries.push_back(std::move(entry));
+            ++it;
+        } else {
+            it = entries.erase(it);
+        }
+    }
+    return open_entries;
+}
+
+void SaveWriteCache::CommitThread(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("SaveWriteCache");
+    const std::stop_callback wake_up{stop_token, [this] { commit_cv.notify_all(); }};
+    while (!stop_token.stop_requested()) {
+        {
+            std::unique_lock lock{mutex};
+            commit_cv.wait_for(lock, CommitInterval,
+                               [&stop_token] { return stop_token.stop_requested(); });
+        }
+        const auto now = std::chrono::steady_clock::now();
+        for (const auto& entry : GetEntries()) {
+            bool should_commit;
+            {
+                std::scoped_lock lock{mutex};
+                const bool is_dirty = entry->generation != entry->committed_generation;
+                should_commit = is_dirty && (entry->flush_requested ||
+                                             now - entry->modified_time >= CommitDelay);
+            }
+            if (should_commit) {
+                Commit(*entry);
+            }
+        }
+    }
+}
+
+} // namespace FileSys
@@ -0,0 +1,105 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+
+namespace FileSys {
+
+/**
+ * Write-back cache of the files of the host-backed save data archives. The contents of every open
+ * file are kept in memory, shared by all of its handles, so guest writes only touch memory. Dirty
+ * files are written back to the host when their last handle is closed, when they are flushed, or
+ * by a background thread a short while after being modified.
+ *
+ * Files are written back atomically: the new contents are written to a temporary file next to the
+ * original, which then replaces it. A crash leaves either the old or the new contents. Where the
+ * host cannot replace a file in one step, a crash can leave only the temporary file, which Recover
+ * then moves into place.
+ */
+class SaveWriteCache {
+public:
+    struct Entry {
+        std::string path;
+        std::vector<u8> data;
+        /// Incremented by every modification, to know if a write back is still up to date.
+        u64 generation{};
+        u64 committed_generation{};
+        std::chrono::steady_clock::time_point modified_time{};
+        /// Set when the guest asked for the write to be flushed. Written back on the next tick.
+        bool flush_requested{};
+        /// Set when the file is deleted or replaced, so its contents are never written back.
+        bool discarded{};
+        /// Held for the whole of a write back.
+        std::mutex commit_mutex;
+    };
+
+    static SaveWriteCache& Instance();
+
+    ~SaveWriteCache();
+
+    /**
+     * Restores the file at path if a write back of it was interrupted after the file was removed
+     * but before its temporary file took its place. Archives call this before looking up a file.
+     */
+    static void Recover(const std::string& path);
+
+    /**
+     * Returns the cache entry of the file at path, loading the file if it is not open yet.
+     * @returns nullptr if the file could not be read.
+     */
+    std::shared_ptr<Entry> Open(const std::string& path);
+
+    std::size_t Read(Entry& entry, u64 offset, std::size_t length, u8* buffer);
+    std::size_t Write(Entry& entry, u64 offset, std::size_t length, bool flush, const u8* buffer);
+    u64 GetSize(Entry& entry);
+    void SetSize(Entry& entry, u64 size);
+
+    /// Writes back the file if it was modified. Returns false on failure.
+    bool Commit(Entry& entry);
+
+    /// Writes back every modified file.
+    void CommitAll();
+
+    /**
+     * Drops the pending modifications of the file at path, or of the files under the directory at
+     * path, as it was deleted. Open handles keep their contents but never write them back.
+     * Waits for the write backs in progress, so the caller can then safely change the host files.
+     */
+    void Discard(const std::string& path);
+
+    /**
+     * Renames the host file or directory at src_path to dest_path. The open files under src_path
+     * move along and keep being written back at their new path, while the open files under
+     * dest_path that the rename replaces are discarded. Nothing changes if the rename fails.
+     * @returns true on success.
+     */
+    bool Rename(const std::string& src_path, const std::string& dest_path);
+
+private:
+    SaveWriteCache();
+
+    void CommitThread(std::stop_token stop_token);
+
+    /// Returns the open entries. Drops the entries whose handles were all closed.
+    std::vector<std::shared_ptr<Entry>> GetEntries();
+
+    std::mutex mutex;
+    /// Serializes renames, which hold the commit mutexes of several entries.
+    std::mutex rename_mutex;
+    std::unordered_map<std::string, std::weak_ptr<Entry>> entries;
+    std::condition_variable commit_cv;
+    std::jthread commit_thread;
+};
+
+} // namespace FileSys
@@ -57,6 +57,7 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
     }
 
     const auto full_path = path_parser.BuildHostPath(mount_point);
+    SaveWriteCache::Recover(full_path);
 
     switch (path_parser.GetHostStatus(mount_point)) {
     case PathParser::InvalidMountPoint:
@@ -83,14 +84,14 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
         break; // Expected 'success' case
     }
 
-    FileUtil::IOFile file(full_path, mode.write_flag ? "r+b" : "rb");
-    if (!file.IsOpen()) {
+    auto entry = SaveWriteCache::Instance().Open(full_path);
+    if (!entry) {
         LOG_CRITICAL(Service_FS, "(unreachable) Unknown error opening {}", full_path);
         return ResultFileNotFound;
     }
 
     std::unique_ptr<DelayGenerator> delay_generator = std::make_unique<SaveDataDelayGenerator>();
-    return std::make_unique<DiskFile>(std::move(file), mode, std::move(delay_generator));
+    return std::make_unique<CachedDiskFile>(std::move(entry), mode, std::move(delay_generator));
 }
 
 Result SaveDataArchive::DeleteFile(const Path& path) const {
@@ -119,6 +120,7 @@ Result SaveDataArchive::DeleteFile(const Path& path) const {
         break; // Expected 'success' case
     }
 
+    SaveWriteCache::Instance().Discard(full_path);
     if (FileUtil::Delete(full_path)) {
         return ResultSuccess;
     }
@@ -146,7 +148,8 @@ Result SaveDataArchive::RenameFile(const Path& src_path, const Path& dest_path)
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
-    if (FileUtil::Rename(src_path_full, dest_path_full)) {
+    // The open files are moved along, so that their later writes land at the new path.
+    if (SaveWriteCache::Instance().Rename(src_path_full, dest_path_full)) {
         return ResultSuccess;
     }
 
@@ -186,6 +189,7 @@ static Result DeleteDirectoryHelper(const Path& path, const std::string& mount_p
         break; // Expected 'success' case
     }
 
+    SaveWriteCache::Instance().Discard(full_path);
     if (deleter(full_path)) {
         return ResultSuccess;
     }
@@ -309,7 +313,8 @@ Result SaveDataArchive::RenameDirectory(const Path& src_path, const Path& dest_p
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
-    if (FileUtil::Rename(src_path_full, dest_path_full)) {
+    // The open files are moved along, so that their later writes land at the new path.
+    if (SaveWriteCache::Instance().Rename(src_path_full, dest_path_full)) {
         return ResultSuccess;
     }
 
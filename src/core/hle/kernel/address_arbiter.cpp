@@ -22,54 +22,66 @@ SERIALIZE_EXPORT_IMPL(Kernel::AddressArbiter::Callback)
 
 namespace Kernel {
 
+void AddressArbiter::IndexLoadedThreads() {
+    for (auto& thread : loaded_waiting_threads) {
+        waiting_threads[thread->wait_address].emplace_back(std::move(thread));
+    }
+    loaded_waiting_threads.clear();
+}
+
 void AddressArbiter::WaitThread(std::shared_ptr<Thread> thread, VAddr wait_address) {
+    IndexLoadedThreads();
     thread->wait_address = wait_address;
     thread->status = ThreadStatus::WaitArb;
-    waiting_threads.emplace_back(std::move(thread));
+    waiting_threads[wait_address].emplace_back(std::move(thread));
 }
 
 u64 AddressArbiter::ResumeAllThreads(VAddr address) {
+    IndexLoadedThreads();
+
     // Determine which threads are waiting on this address, those should be woken up.
-    auto itr = std::stable_partition(waiting_threads.begin(), waiting_threads.end(),
-                                     [address](const auto& thread) {
-                                         ASSERT_MSG(thread->status == ThreadStatus::WaitArb,
-                                                    "Inconsistent AddressArbiter state");
-                                         return thread->wait_address != address;
-                                     });
-
-    // Wake up all the found threads
-    const u64 num_threads = std::distance(itr, waiting_threads.end());
-    std::for_each(itr, waiting_threads.end(), [](auto& thread) { thread->ResumeFromWait(); });
-
-    // Remove the woken up threads from the wait list.
-    waiting_threads.erase(itr, waiting_threads.end());
-    return num_threads;
+    const auto itr = waiting_threads.find(address);
+    if (itr == waiting_threads.end()) {
+        return 0;
+    }
+
+    // Wake up all the found threads and remove them from the wait list.
+    const auto threads = std::move(itr->second);
+    waiting_threads.erase(itr);
+    for (const auto& thread : threads) {
+        ASSERT_MSG(thread->status == ThreadStatus::WaitArb, "Inconsistent AddressArbiter state");
+        thread->ResumeFromWait();
+    }
+    return threads.size();
 }
 
 bool AddressArbiter::ResumeHighestPriorityThread(VAddr address) {
+    IndexLoadedThreads();
+
     // Determine which threads are waiting on this address, those should be considered for wakeup.
-    auto matches_start = std::stable_partition(
-        waiting_threads.begin(), waiting_threads.end(), [address](const auto& thread) {
-            ASSERT_MSG(thread->status == ThreadStatus::WaitArb,
-                       "Inconsistent AddressArbiter state");
-            return thread->wait_address != address;
-        });
+    const auto matches = waiting_threads.find(address);
+    if (matches == waiting_threads.end()) {
+        return false;
+    }
+    auto& threads = matches->second;
 
     // Iterate through threads, find highest priority thread that is waiting to be arbitrated.
     // Note: The real kernel will pick the first thread in the list if more than one have the
     // same highest priority value. Lower priority values mean higher priority.
-    auto itr = std::min_element(matches_start, waiting_threads.end(),
-                                [](const auto& lhs, const auto& rhs) {
-                                    return lhs->current_priority < rhs->current_priority;
-                                });
-
-    if (itr == waiting_threads.end()) {
-        return false;
-    }
+    const auto itr = std::min_element(threads.begin(), threads.end(),
+                                      [](const auto& lhs, const auto& rhs) {
+                                          ASSERT_MSG(lhs->status == ThreadStatus::WaitArb &&
+                                                         rhs->status == ThreadStatus::WaitArb,
+                                                     "Inconsistent AddressArbiter state");
+                                          return lhs->current_priority < rhs->current_priority;
+                                      });
 
     auto thread = *itr;
     thread->ResumeFromWait();
-    waiting_threads.erase(itr);
+    threads.erase(itr);
+    if (threads.empty()) {
+        waiting_threads.erase(matches);
+    }
 
     return true;
 }
@@ -110,9 +122,17 @@ private:
 void AddressArbiter::WakeUp(ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
                             std::shared_ptr<WaitObject> object) {
     ASSERT(reason == ThreadWakeupReason::Timeout);
+    IndexLoadedThreads();
+
     // Remove the newly-awakened thread from the Arbiter's waiting list.
-    waiting_threads.erase(std::remove(waiting_threads.begin(), waiting_threads.end(), thread),
-                          waiting_threads.end());
+    const auto itr = waiting_threads.find(thread->wait_address);
+    if (itr == waiting_threads.end()) {
+        return;
+    }
+    std::erase(itr->second, thread);
+    if (itr->second.empty()) {
+        waiting_threads.erase(itr);
+    }
 };
 
 Result AddressArbiter::ArbitrateAddress(std::shared_ptr<Thread> thread, ArbitrationType type,
@@ -190,13 +210,28 @@ Result AddressArbiter::ArbitrateAddress(std::shared_ptr<Thread> thread, Arbitrat
     return ResultSuccess;
 }
 
+// The waiting threads are stored as a flat list, as they were before being grouped by address.
+template <class Archive>
+void AddressArbiter::save(Archive& ar, const unsigned int) const {
+    ar << boost::serialization::base_object<Object>(*this);
+    ar << name;
+    std::vector<std::shared_ptr<Thread>> threads = loaded_waiting_threads;
+    for (const auto& [address, address_threads] : waiting_threads) {
+        threads.insert(threads.end(), address_threads.begin(), address_threads.end());
+    }
+    ar << threads;
+    ar << timeout_callback;
+    ar << resource_limit;
+}
+
 template <class Archive>
-void AddressArbiter::serialize(Archive& ar, const unsigned int) {
-    ar& boost::serialization::base_object<Object>(*this);
-    ar& name;
-    ar& waiting_threads;
-    ar& timeout_callback;
-    ar& resource_limit;
+void AddressArbiter::load(Archive& ar, const unsigned int) {
+    ar >> boost::serialization::base_object<Object>(*this);
+    ar >> name;
+    waiting_threads.clear();
+    ar >> loaded_waiting_threads;
+    ar >> timeout_callback;
+    ar >> resource_limit;
 }
 SERIALIZE_IMPL(AddressArbiter)
 
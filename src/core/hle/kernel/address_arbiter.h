@@ -5,8 +5,10 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <boost/serialization/export.hpp>
+#include <boost/serialization/split_member.hpp>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/thread.h"
@@ -68,8 +70,16 @@ private:
     /// the resumed thread.
     bool ResumeHighestPriorityThread(VAddr address);
 
-    /// Threads waiting for the address arbiter to be signaled.
-    std::vector<std::shared_ptr<Thread>> waiting_threads;
+    /// Sorts the threads restored from a savestate into waiting_threads.
+    void IndexLoadedThreads();
+
+    /// Threads waiting for the address arbiter to be signaled, by arbitration address, in the
+    /// order they started waiting.
+    std::unordered_map<VAddr, std::vector<std::shared_ptr<Thread>>> waiting_threads;
+
+    /// Waiting threads restored from a savestate. Their wait addresses may not be loaded yet
+    /// when the arbiter is, so they are only sorted into waiting_threads on first use.
+    std::vector<std::shared_ptr<Thread>> loaded_waiting_threads;
 
     std::shared_ptr<Callback> timeout_callback;
 
@@ -78,7 +88,10 @@ private:
 
     friend class boost::serialization::access;
     template <class Archive>
-    void serialize(Archive& ar, const unsigned int);
+    void save(Archive& ar, const unsigned int) const;
+    template <class Archive>
+    void load(Archive& ar, const unsigned int);
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
 };
 
 } // namespace Kernel
@@ -288,6 +288,10 @@ public:
 
     bool can_schedule{true};
     ThreadStatus status;
+
+    /// Links of the thread in the ready queue of its ThreadManager.
+    Common::ThreadQueueListNode<Thread*> queue_node{};
+
     VAddr entry_point;
     VAddr stack_top;
 
@@ -5,8 +5,6 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstring>
-#include <cryptopp/aes.h>
-#include <cryptopp/modes.h>
 #include <fmt/format.h>
 #include "common/alignment.h"
 #include "common/archives.h"
@@ -15,6 +13,7 @@
 #include "common/logging/log.h"
 #include "common/string_util.h"
 #include "core/core.h"
+#include "core/file_sys/cia_content_writer.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/ncch_container.h"
 #include "core/file_sys/title_metadata.h"
@@ -80,14 +79,8 @@ struct TicketInfo {
 
 static_assert(sizeof(TicketInfo) == 0x18, "Ticket info structure size is wrong");
 
-class CIAFile::DecryptionState {
-public:
-    std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
-};
-
 CIAFile::CIAFile(Core::System& system_, Service::FS::MediaType media_type)
-    : system(system_), media_type(media_type),
-      decryption_state(std::make_unique<DecryptionState>()) {}
+    : system(system_), media_type(media_type) {}
 
 CIAFile::~CIAFile() {
     Close();
@@ -156,26 +149,10 @@ Result CIAFile::WriteTitleMetadata() {
     auto content_count = container.GetTitleMetadata().GetContentCount();
     content_written.resize(content_count);
 
-    content_files.clear();
-    for (std::size_t i = 0; i < content_count; i++) {
-        auto path = GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update);
-        auto& file = content_files.emplace_back(path, "wb");
-        if (!file.IsOpen()) {
-            LOG_ERROR(Service_AM, "Could not open output file '{}' for content {}.", path, i);
-            // TODO: Correct error code.
-            return FileSys::ResultFileNotFound;
-        }
-    }
-
-    if (container.GetTitleMetadata().HasEncryptedContent()) {
-        if (auto title_key = container.GetTicket().GetTitleKey()) {
-            decryption_state->content.resize(content_count);
-            for (std::size_t i = 0; i < content_count; ++i) {
-                auto ctr = tmd.GetContentCTRByIndex(i);
-                decryption_state->content[i].SetKeyWithIV(title_key->data(), title_key->size(),
-                                                          ctr.data());
-            }
-        } else {
+    std::optional<std::array<u8, 16>> title_key;
+    if (tmd.HasEncryptedContent()) {
+        title_key = container.GetTicket().GetTitleKey();
+        if (!title_key) {
             LOG_ERROR(Service_AM, "Could not read title key from ticket for encrypted CIA.");
             // TODO: Correct error code.
             return FileSys::ResultFileNotFound;
@@ -185,6 +162,28 @@ Result CIAFile::WriteTitleMetadata() {
                  "Title has no encrypted content, skipping initializing decryption state.");
     }
 
+    std::vector<FileSys::CIAContentWriter::Content> contents;
+    contents.reserve(content_count);
+    for (std::size_t i = 0; i < content_count; i++) {
+        auto path = GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update);
+        FileUtil::IOFile file(path, "wb");
+        if (!file.IsOpen()) {
+            LOG_ERROR(Service_AM, "Could not open output file '{}' for content {}.", path, i);
+            // TODO: Correct error code.
+            return FileSys::ResultFileNotFound;
+        }
+        const bool is_encrypted =
+            (tmd.GetContentTypeByIndex(i) & FileSys::TMDContentTypeFlag::Encrypted) != 0;
+        contents.push_back({
+            .file = std::move(file),
+            .size = container.GetContentSize(static_cast<u16>(i)),
+            .key = is_encrypted ? title_key : std::nullopt,
+            .iv = tmd.GetContentCTRByIndex(i),
+            .hash = tmd.GetContentHashByIndex(i),
+        });
+    }
+    content_writer = std::make_unique<FileSys::CIAContentWriter>(std::move(contents));
+
     install_state = CIAInstallState::TMDLoaded;
 
     return ResultSuccess;
@@ -211,19 +210,8 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
             // Figure out how much of this content ID we have just recieved/can write out
             const u64 available_to_write = std::min(offset_max, range_max) - range_min;
 
-            // Since the incoming TMD has already been written, we can use GetTitleContentPath
-            // to get the content paths to write to.
-            FileSys::TitleMetadata tmd = container.GetTitleMetadata();
-            auto& file = content_files[i];
-
-            std::vector<u8> temp(buffer + (range_min - offset),
-                                 buffer + (range_min - offset) + available_to_write);
-
-            if ((tmd.GetContentTypeByIndex(i) & FileSys::TMDContentTypeFlag::Encrypted) != 0) {
-                decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
-            }
-
-            file.WriteBytes(temp.data(), temp.size());
+            // The content is decrypted, verified and written out by the writer threads.
+            content_writer->Write(i, buffer + (range_min - offset), available_to_write);
 
             // Keep tabs on how much of this content ID has been written so new range_min
             // values can be calculated.
@@ -319,8 +307,11 @@ bool CIAFile::SetSize(u64 size) const {
 }
 
 bool CIAFile::Close() const {
+    // Wait for the queued content data to be written out.
+    const bool content_valid = content_writer && content_writer->Finish();
+
     bool complete =
-        install_state >= CIAInstallState::TMDLoaded &&
+        content_valid && install_state >= CIAInstallState::TMDLoaded &&
         content_written.size() == container.GetTitleMetadata().GetContentCount() &&
         std::all_of(content_written.begin(), content_written.end(),
                     [this, i = 0](auto& bytes_written) mutable {
@@ -331,7 +322,8 @@ bool CIAFile::Close() const {
     if (!complete) {
         LOG_ERROR(Service_AM, "CIAFile closed prematurely, aborting install...");
         FileUtil::DeleteDir(GetTitlePath(media_type, container.GetTitleMetadata().GetTitleID()));
-        return true;
+        // Only report corrupted contents as a failure, an early close is a cancellation.
+        return content_valid || !content_writer;
     }
 
     // Clean up older content data if we installed newer content on top
@@ -445,7 +437,8 @@ InstallStatus InstallCIA(const std::string& path,
             return InstallStatus::ErrorFailedToOpenFile;
         }
 
-        std::array<u8, 0x10000> buffer;
+        // Large reads keep the content writer stages busy with few chunks in flight.
+        std::vector<u8> buffer(0x100000);
         auto file_size = file.GetSize();
         std::size_t total_bytes_read = 0;
         while (total_bytes_read != file_size) {
@@ -463,7 +456,10 @@ InstallStatus InstallCIA(const std::string& path,
             }
             total_bytes_read += bytes_read;
         }
-        installFile.Close();
+        if (!installFile.Close()) {
+            LOG_ERROR(Service_AM, "CIA file {} has corrupted contents, install aborted", path);
+            return InstallStatus::ErrorAborted;
+        }
 
         LOG_INFO(Service_AM, "Installed {} successfully.", path);
 
@@ -25,6 +25,10 @@ namespace Core {
 class System;
 }
 
+namespace FileSys {
+class CIAContentWriter;
+}
+
 namespace FileUtil {
 class IOFile;
 }
@@ -107,11 +111,9 @@ private:
     FileSys::CIAContainer container;
     std::vector<u8> data;
     std::vector<u64> content_written;
-    std::vector<FileUtil::IOFile> content_files;
     Service::FS::MediaType media_type;
 
-    class DecryptionState;
-    std::unique_ptr<DecryptionState> decryption_state;
+    std::unique_ptr<FileSys::CIAContentWriter> content_writer;
 };
 
 // A file handled returned for Tickets to be written into and subsequently installed.
@@ -126,7 +126,10 @@ const std::array<ServiceModuleInfo, 41> service_module_map{
 
 ServiceFrameworkBase::ServiceFrameworkBase(const char* service_name, u32 max_sessions,
                                            InvokerFn* handler_invoker)
-    : service_name(service_name), max_sessions(max_sessions), handler_invoker(handler_invoker) {}
+    : service_name(service_name), max_sessions(max_sessions),
+      ipc_counter(Common::Perf::RegisterCounter(fmt::format("IPC {}", service_name))),
+      ipc_event(Common::Perf::RegisterEvent(fmt::format("IPC {}", service_name))),
+      handler_invoker(handler_invoker) {}
 
 ServiceFrameworkBase::~ServiceFrameworkBase() = default;
 
@@ -183,6 +186,8 @@ void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context)
 
     LOG_TRACE(Service, "{}",
               MakeFunctionString(info->name, GetServiceName(), context.CommandBuffer()));
+    Common::Perf::Add(ipc_counter);
+    const Common::Perf::ScopedEvent event{ipc_event};
     handler_invoker(this, info->handler_callback, context);
 }
 
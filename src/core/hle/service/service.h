@@ -14,6 +14,7 @@
 #include <boost/serialization/shared_ptr.hpp>
 #include "common/common_types.h"
 #include "common/construct.h"
+#include "common/perf_counters.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/service/sm/sm.h"
@@ -99,6 +100,9 @@ private:
     std::string service_name;
     /// Maximum number of concurrent sessions that this service can handle.
     u32 max_sessions;
+    /// Performance counter and trace event of the requests handled by the service.
+    Common::Perf::CounterId ipc_counter;
+    Common::Perf::EventId ipc_event;
 
     /// Function used to safely up-cast pointers to the derived class before invoking a handler.
     InvokerFn* handler_invoker;
@@ -0,0 +1,242 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/hle/service/soc/soc_reactor.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace Service::SOC {
+
+namespace {
+/// Poll timeout used when the wakeup socket could not be created, so new waits are still seen.
+constexpr int FallbackPollTimeoutMs = 100;
+
+int GetLastSocketError() {
+#ifdef _WIN32
+    return WSAGetLastError();
+#else
+    return errno;
+#endif
+}
+
+void CloseSocket(SocketReactor::SocketFd fd) {
+#ifdef _WIN32
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+}
+
+int PollSockets(pollfd* fds, std::size_t count, int timeout_ms) {
+#ifdef _WIN32
+    return WSAPoll(fds, static_cast<ULONG>(count), timeout_ms);
+#else
+    return ::poll(fds, static_cast<nfds_t>(count), timeout_ms);
+#endif
+}
+
+/// Creates a loopback datagram socket connected to itself.
+std::optional<SocketReactor::SocketFd> CreateWakeupSocket() {
+    const auto fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+#ifdef _WIN32
+    if (fd == INVALID_SOCKET) {
+#else
+    if (fd < 0) {
+#endif
+        return std::nullopt;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof(addr);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) != 0 ||
+        ::connect(fd, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0 ||
+        SocketReactor::SetNonBlocking(fd) != 0) {
+        CloseSocket(fd);
+        return std::nullopt;
+    }
+    return fd;
+}
+} // Anonymous namespace
+
+SocketReactor::SocketReactor() : wakeup_socket{CreateWakeupSocket()} {
+    if (!wakeup_socket) {
+        LOG_ERROR(Service_SOC, "Could not create the reactor wakeup socket, error={}",
+                  GetLastSocketError());
+    }
+    reactor_thread = std::jthread{[this](std::stop_token stop_token) {
+        ReactorThread(stop_token);
+    }};
+}
+
+SocketReactor::~SocketReactor() {
+    reactor_thread.request_stop();
+    Notify();
+    reactor_thread.join();
+    if (wakeup_socket) {
+        CloseSocket(*wakeup_socket);
+    }
+}
+
+void SocketReactor::Wait(std::vector<PollEntry> entries, std::chrono::nanoseconds timeout,
+                         Operation operation, std::function<void()> on_complete) {
+    PendingWait wait{
+        .entries = std::move(entries),
+        .deadline = std::nullopt,
+        .operation = std::move(operation),
+        .on_complete = std::move(on_complete),
+    };
+    if (timeout.count() >= 0) {
+        wait.deadline = Clock::now() + timeout;
+    }
+    {
+        std::scoped_lock lock{mutex};
+        waits.emplace(next_wait_id++, std::move(wait));
+    }
+    Notify();
+}
+
+void SocketReactor::Cancel(SocketFd fd) {
+    std::scoped_lock lock{mutex};
+    bool cancelled = false;
+    for (auto it = waits.begin(); it != waits.end();) {
+        PendingWait& wait = it->second;
+        const bool uses_fd = std::any_of(wait.entries.begin(), wait.entries.end(),
+                                         [fd](const PollEntry& entry) { return entry.fd == fd; });
+        if (!uses_fd) {
+            ++it;
+            continue;
+        }
+        wait.operation(wait.entries, WaitResult::Cancelled);
+        wait.on_complete();
+        it = waits.erase(it);
+        cancelled = true;
+    }
+    if (cancelled) {
+        Notify();
+    }
+}
+
+int SocketReactor::SetNonBlocking(SocketFd fd) {
+#ifdef _WIN32
+    unsigned long nonblocking = 1;
+    if (ioctlsocket(fd, FIONBIO, &nonblocking) != 0) {
+        return GetLastSocketError();
+    }
+#else
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        return GetLastSocketError();
+    }
+#endif
+    return 0;
+}
+
+void SocketReactor::Notify() {
+    if (wakeup_socket) {
+        const char byte = 0;
+        ::send(*wakeup_socket, &byte, 1, 0);
+    }
+}
+
+void SocketReactor::ReactorThread(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("SocketReactor");
+
+    std::vector<pollfd> poll_fds;
+    // Id of every polled wait and the index of its first entry in poll_fds.
+    std::vector<std::pair<u64, std::size_t>> polled_waits;
+
+    while (!stop_token.stop_requested()) {
+        int timeout_ms = -1;
+        poll_fds.clear();
+        polled_waits.clear();
+        if (wakeup_socket) {
+            poll_fds.push_back(pollfd{.fd = *wakeup_socket, .events = POLLIN, .revents = 0});
+        } else {
+            timeout_ms = FallbackPollTimeoutMs;
+        }
+        {
+            std::scoped_lock lock{mutex};
+            const auto now = Clock::now();
+            for (const auto& [id, wait] : waits) {
+                polled_waits.emplace_back(id, poll_fds.size());
+                for (const PollEntry& entry : wait.entries) {
+                    poll_fds.push_back(
+                        pollfd{.fd = entry.fd, .events = entry.events, .revents = 0});
+                }
+                if (wait.deadline) {
+                    const auto remaining =
+                        std::chrono::ceil<std::chrono::milliseconds>(*wait.deadline - now);
+                    const int remaining_ms = static_cast<int>(std::clamp<s64>(
+                        remaining.count(), 0, std::numeric_limits<int>::max()));
+                    timeout_ms =
+                        timeout_ms < 0 ? remaining_ms : std::min(timeout_ms, remaining_ms);
+                }
+            }
+        }
+
+        const int ret = PollSockets(poll_fds.data(), poll_fds.size(), timeout_ms);
+        if (ret < 0) {
+            const int error = GetLastSocketError();
+#ifndef _WIN32
+            if (error == EINTR) {
+                continue;
+            }
+#endif
+            LOG_ERROR(Service_SOC, "Reactor poll failed, error={}", error);
+            std::this_thread::sleep_for(std::chrono::milliseconds{FallbackPollTimeoutMs});
+            continue;
+        }
+        if (wakeup_socket && poll_fds[0].revents != 0) {
+            char buffer[64];
+            while (::recv(*wakeup_socket, buffer, sizeof(buffer), 0) > 0) {
+            }
+        }
+
+        std::scoped_lock lock{mutex};
+        const auto now = Clock::now();
+        for (const auto& [id, first_index] : polled_waits) {
+            // The wait may have been cancelled while polling.
+            const auto it = waits.find(id);
+            if (it == waits.end()) {
+                continue;
+            }
+            PendingWait& wait = it->second;
+            bool is_ready = false;
+            for (std::size_t i = 0; i < wait.entries.size(); i++) {
+                wait.entries[i].revents = poll_fds[first_index + i].revents;
+                is_ready |= wait.entries[i].revents != 0;
+            }
+            bool completed = is_ready && wait.operation(wait.entries, WaitResult::Ready);
+            if (!completed && wait.deadline && now >= *wait.deadline) {
+                wait.operation(wait.entries, WaitResult::TimedOut);
+                completed = true;
+            }
+            if (completed) {
+                wait.on_complete();
+                waits.erase(it);
+            }
+        }
+    }
+}
+
+} // namespace Service::SOC
@@ -0,0 +1,93 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "core/hle/service/soc/soc_u.h"
+
+namespace Service::SOC {
+
+/**
+ * Waits for the guest sockets on a single thread. All the host sockets are in non-blocking mode:
+ * operations that would block register a wait, and the reactor thread retries them once their
+ * sockets are ready, instead of occupying a thread per blocked operation.
+ */
+class SocketReactor {
+public:
+    using SocketFd = decltype(SocketHolder::socket_fd);
+
+    /// Layout-independent equivalent of pollfd, with the platform poll event flags.
+    struct PollEntry {
+        SocketFd fd;
+        short events;
+        short revents;
+    };
+
+    enum class WaitResult {
+        Ready,
+        TimedOut,
+        Cancelled,
+    };
+
+    /**
+     * Retries the operation of a wait, called on the reactor thread once any of its sockets is
+     * ready. Returns false if the operation would still block, to keep waiting. Also called once
+     * when the wait times out or is cancelled, in which case the operation must complete.
+     */
+    using Operation = std::function<bool(std::span<const PollEntry> entries, WaitResult result)>;
+
+    SocketReactor();
+    ~SocketReactor();
+
+    /**
+     * Waits for any of the sockets in entries to become ready.
+     * @param timeout Time after which the wait times out, or a negative value to wait forever.
+     * @param on_complete Called on the reactor thread once the operation completed.
+     */
+    void Wait(std::vector<PollEntry> entries, std::chrono::nanoseconds timeout,
+              Operation operation, std::function<void()> on_complete);
+
+    /**
+     * Completes the waits on the socket fd as cancelled. Once this returns, the operations of the
+     * waits no longer use the socket, so it can be closed.
+     */
+    void Cancel(SocketFd fd);
+
+    /// Puts the host socket fd in non-blocking mode. Returns the platform error on failure.
+    static int SetNonBlocking(SocketFd fd);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingWait {
+        std::vector<PollEntry> entries;
+        std::optional<Clock::time_point> deadline;
+        Operation operation;
+        std::function<void()> on_complete;
+    };
+
+    /// Wakes up the reactor thread, so it polls the current set of waits.
+    void Notify();
+
+    void ReactorThread(std::stop_token stop_token);
+
+    std::mutex mutex;
+    std::map<u64, PendingWait> waits;
+    u64 next_wait_id{};
+
+    /// Loopback datagram socket connected to itself, used to wake up the reactor thread.
+    std::optional<SocketFd> wakeup_socket;
+    std::jthread reactor_thread;
+};
+
+} // namespace Service::SOC
@@ -3,7 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <span>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
@@ -18,6 +20,7 @@
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/result.h"
+#include "core/hle/service/soc/soc_reactor.h"
 #include "core/hle/service/soc/soc_u.h"
 
 #ifdef _WIN32
@@ -390,36 +393,9 @@ bool SOC_U::GetSocketBlocking(const SocketHolder& socket_holder) {
     return socket_holder.blocking;
 }
 u32 SOC_U::SetSocketBlocking(SocketHolder& socket_holder, bool blocking) {
-    u32 posix_ret = 0;
-#ifdef _WIN32
-    unsigned long nonblocking = (blocking) ? 0 : 1;
-    int ret = ioctlsocket(socket_holder.socket_fd, FIONBIO, &nonblocking);
-    if (ret == SOCKET_ERROR_VALUE) {
-        posix_ret = TranslateError(GET_ERRNO);
-        return posix_ret;
-    }
-    socket_holder.blocking = blocking;
-#else
-    int flags = ::fcntl(socket_holder.socket_fd, F_GETFL, 0);
-    if (flags == SOCKET_ERROR_VALUE) {
-        posix_ret = TranslateError(GET_ERRNO);
-        return posix_ret;
-    }
-
-    flags &= ~O_NONBLOCK;
-    if (!blocking) { // O_NONBLOCK
-        flags |= O_NONBLOCK;
-    }
-
+    // The host socket is left non-blocking, blocking operations wait on the reactor instead.
     socket_holder.blocking = blocking;
-
-    const int ret = ::fcntl(socket_holder.socket_fd, F_SETFL, flags);
-    if (ret == SOCKET_ERROR_VALUE) {
-        posix_ret = TranslateError(GET_ERRNO);
-        return posix_ret;
-    }
-#endif
-    return posix_ret;
+    return 0;
 }
 
 std::optional<std::reference_wrapper<SocketHolder>> SOC_U::GetSocketHolder(u32 ctr_socket_fd,
@@ -448,10 +424,15 @@ std::optional<std::reference_wrapper<SocketHolder>> SOC_U::GetSocketHolder(u32 c
     return std::ref(fd_info->second);
 }
 
+s32 SOC_U::CloseSocket(const SocketHolder& holder) {
+    reactor->Cancel(holder.socket_fd);
+    return closesocket(holder.socket_fd);
+}
+
 void SOC_U::CloseAndDeleteAllSockets(s32 process_id) {
-    std::erase_if(created_sockets, [process_id](const auto& entry) {
+    std::erase_if(created_sockets, [this, process_id](const auto& entry) {
         if (process_id == -1 || entry.second.ownerProcess == static_cast<u32>(process_id)) {
-            closesocket(entry.second.socket_fd);
+            CloseSocket(entry.second);
             return true;
         }
         return false;
@@ -796,6 +777,141 @@ static u32 NameInfoFlagsToPlatform(u32 flags) {
 
 static_assert(sizeof(CTRAddrInfo) == 0x130, "Size of CTRAddrInfo is not correct");
 
+/// Returns true if the platform error means that the non-blocking operation would have blocked.
+static bool IsWouldBlockError(int error) {
+    return error == ERRNO(EAGAIN) || error == ERRNO(EWOULDBLOCK) || error == ERRNO(EINPROGRESS);
+}
+
+template <typename ResultFunctor>
+class ReactorWakeUpCallback : public Kernel::HLERequestContext::WakeupCallback {
+public:
+    explicit ReactorWakeUpCallback(ResultFunctor functor) : functor(std::move(functor)) {}
+
+    void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                Kernel::ThreadWakeupReason reason) override {
+        functor(ctx);
+    }
+
+private:
+    ResultFunctor functor;
+};
+
+/**
+ * Runs operation, which must not block, and then result_function. If the operation would block
+ * and can_block is set, the client thread is put to sleep and the reactor retries the operation
+ * once any of the sockets in entries is ready, calling result_function once it completes.
+ */
+template <typename ResultFunctor>
+static void RunWhenReady(SocketReactor& reactor, Kernel::HLERequestContext& ctx,
+                         std::vector<SocketReactor::PollEntry> entries,
+                         std::chrono::nanoseconds timeout, bool can_block,
+                         SocketReactor::Operation operation, ResultFunctor result_function) {
+    if (operation(entries, SocketReactor::WaitResult::Ready) || !can_block) {
+        result_function(ctx);
+        return;
+    }
+    ctx.SleepClientThread(
+        "SOC", std::chrono::nanoseconds(-1),
+        std::make_shared<ReactorWakeUpCallback<ResultFunctor>>(std::move(result_function)));
+    reactor.Wait(std::move(entries), timeout, std::move(operation),
+                 [thread = ctx.ClientThread()] { thread->WakeAfterDelay(0, true); });
+}
+
+/// State of a receive, shared between the service thread and the reactor thread.
+struct RecvFromData {
+    // Input
+    SocketReactor::SocketFd socket_fd;
+    u32 socket_handle;
+    u32 len;
+    u32 flags;
+    u32 addr_len;
+
+    // Output
+    s32 ret = SOCKET_ERROR_VALUE;
+    int recv_error{};
+    std::vector<u8> output_buff;
+    std::vector<u8> addr_buff;
+
+    /// Receives from the socket. Returns false if the receive would block.
+    bool Receive() {
+        output_buff.resize(len);
+        if (addr_len > 0) {
+            // Only get src adr if input adr available
+            sockaddr_storage src_addr;
+            socklen_t src_addr_len = sizeof(src_addr);
+            addr_buff.resize(addr_len);
+            ret = static_cast<s32>(::recvfrom(
+                socket_fd, reinterpret_cast<char*>(output_buff.data()), len, flags,
+                reinterpret_cast<sockaddr*>(&src_addr), &src_addr_len));
+            if (ret >= 0 && src_addr_len > 0) {
+                const CTRSockAddr ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
+                std::memcpy(addr_buff.data(), &ctr_src_addr,
+                            std::min<size_t>(addr_len, sizeof(ctr_src_addr)));
+            }
+        } else {
+            ret = static_cast<s32>(::recvfrom(
+                socket_fd, reinterpret_cast<char*>(output_buff.data()), len, flags, NULL, 0));
+            addr_buff.resize(0);
+        }
+        recv_error = (ret == SOCKET_ERROR_VALUE) ? GET_ERRNO : 0;
+        return !IsWouldBlockError(recv_error);
+    }
+};
+
+/// State of a send, shared between the service thread and the reactor thread.
+struct SendToData {
+    // Input
+    SocketReactor::SocketFd socket_fd;
+    u32 socket_handle;
+    u32 len;
+    u32 flags;
+    u32 addr_len;
+    std::vector<u8> input_buff;
+    std::vector<u8> dest_addr_buff;
+    /// Whether the send only completes once all of the data is sent, as for a blocking socket.
+    bool send_all = false;
+
+    // Output
+    s32 ret = SOCKET_ERROR_VALUE;
+    int send_error{};
+    u32 sent = 0;
+
+    /// Sends to dest_addr, or to the connected peer if addr_len is zero. Returns false if the
+    /// send would block, or if send_all is set and part of the data is left to send.
+    bool Send(const u8* dest_addr) {
+        const char* data = reinterpret_cast<const char*>(input_buff.data()) + sent;
+        const u32 remaining = len - sent;
+        s32 result;
+        if (addr_len > 0) {
+            CTRSockAddr ctr_dest_addr;
+            std::memcpy(&ctr_dest_addr, dest_addr,
+                        std::min<size_t>(addr_len, sizeof(ctr_dest_addr)));
+            auto [platform_addr, platform_addr_len] = CTRSockAddr::ToPlatform(ctr_dest_addr);
+            result = static_cast<s32>(::sendto(socket_fd, data, remaining, flags,
+                                               reinterpret_cast<sockaddr*>(&platform_addr),
+                                               platform_addr_len));
+        } else {
+            result = static_cast<s32>(::sendto(socket_fd, data, remaining, flags, nullptr, 0));
+        }
+        send_error = (result == SOCKET_ERROR_VALUE) ? GET_ERRNO : 0;
+        if (!send_all) {
+            ret = result;
+            return !IsWouldBlockError(send_error);
+        }
+
+        // Stream sockets may accept only part of the data, the rest is sent once the socket is
+        // writable again. If a later part fails, the size of what was sent is reported instead.
+        if (result > 0) {
+            sent += static_cast<u32>(result);
+        }
+        ret = sent > 0 ? static_cast<s32>(sent) : result;
+        if (result == SOCKET_ERROR_VALUE) {
+            return !IsWouldBlockError(send_error);
+        }
+        return sent >= len || result == 0;
+    }
+};
+
 void SOC_U::Socket(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx);
     const u32 domain = SocketDomainToPlatform(rp.Pop<u32>()); // Address family
@@ -832,9 +948,12 @@ void SOC_U::Socket(Kernel::HLERequestContext& ctx) {
             .socket_fd = static_cast<decltype(SocketHolder::socket_fd)>(ret),
             .blocking = true,
             .isGlobal = false,
-            .shutdown_rd = false,
             .ownerProcess = pid,
         };
+        const int error = SocketReactor::SetNonBlocking(created_sockets[socketHandle].socket_fd);
+        if (error != 0) {
+            LOG_ERROR(Service_SOC, "Could not make socket non-blocking, error={}", error);
+        }
 #if _WIN32
         // Disable UDP connection reset
         int new_behavior = 0;
@@ -962,7 +1081,7 @@ void SOC_U::Accept(Kernel::HLERequestContext& ctx) {
     struct AsyncData {
         // Input
         u32 max_addr_len{};
-        SocketHolder* fd_info;
+        SocketReactor::SocketFd socket_fd;
         u32 pid;
         u32 socket_handle;
 
@@ -974,18 +1093,20 @@ void SOC_U::Accept(Kernel::HLERequestContext& ctx) {
 
     auto async_data = std::make_shared<AsyncData>();
     async_data->max_addr_len = max_addr_len;
-    async_data->fd_info = &holder;
+    async_data->socket_fd = holder.socket_fd;
     async_data->pid = pid;
     async_data->socket_handle = socket_handle;
 
-    ctx.RunAsync(
-        [async_data](Kernel::HLERequestContext& ctx) {
+    RunWhenReady(
+        *reactor, ctx, {{holder.socket_fd, POLLIN, 0}}, std::chrono::nanoseconds(-1),
+        GetSocketBlocking(holder),
+        [async_data](std::span<const SocketReactor::PollEntry>, SocketReactor::WaitResult) {
             socklen_t addr_len = sizeof(async_data->addr);
             async_data->ret = static_cast<u32>(
-                ::accept(async_data->fd_info->socket_fd,
-                         reinterpret_cast<sockaddr*>(&async_data->addr), &addr_len));
+                ::accept(async_data->socket_fd, reinterpret_cast<sockaddr*>(&async_data->addr),
+                         &addr_len));
             async_data->accept_error = (async_data->ret == SOCKET_ERROR_VALUE) ? GET_ERRNO : 0;
-            return 0;
+            return !IsWouldBlockError(async_data->accept_error);
         },
         [this, async_data](Kernel::HLERequestContext& ctx) {
             if (static_cast<s32>(async_data->ret) != SOCKET_ERROR_VALUE) {
@@ -994,9 +1115,9 @@ void SOC_U::Accept(Kernel::HLERequestContext& ctx) {
                     .socket_fd = static_cast<decltype(SocketHolder::socket_fd)>(async_data->ret),
                     .blocking = true,
                     .isGlobal = false,
-                    .shutdown_rd = false,
                     .ownerProcess = async_data->pid,
                 };
+                SocketReactor::SetNonBlocking(created_sockets[socketID].socket_fd);
                 async_data->ret = socketID;
             }
 
@@ -1091,8 +1212,7 @@ void SOC_U::Close(Kernel::HLERequestContext& ctx) {
     }
     SocketHolder& holder = socket_holder_optional->get();
 
-    s32 ret = 0;
-    ret = closesocket(holder.socket_fd);
+    s32 ret = CloseSocket(holder);
 
     if (ret != 0) {
         ret = TranslateError(GET_ERRNO);
@@ -1112,7 +1232,7 @@ void SOC_U::SendToOther(Kernel::HLERequestContext& ctx) {
     u32 flags = SendRecvFlagsToPlatform(rp.Pop<u32>());
     const u32 addr_len = rp.Pop<u32>();
     const u32 pid = rp.PopPID();
-    const auto dest_addr_buffer = rp.PopStaticBuffer();
+    auto dest_addr_buffer = rp.PopStaticBuffer();
     auto input_mapped_buff = rp.PopMappedBuffer();
 
     auto socket_holder_optional = GetSocketHolder(socket_handle, pid, rp);
@@ -1121,99 +1241,39 @@ void SOC_U::SendToOther(Kernel::HLERequestContext& ctx) {
     }
     SocketHolder& holder = socket_holder_optional->get();
 
-    bool dont_wait = (flags & MSGCUSTOM_HANDLE_DONTWAIT) != 0;
+    const bool dont_wait = (flags & MSGCUSTOM_HANDLE_DONTWAIT) != 0;
     flags &= ~MSGCUSTOM_HANDLE_DONTWAIT;
-#ifdef _WIN32
-    bool was_blocking = GetSocketBlocking(holder);
-    if (dont_wait && was_blocking) {
-        SetSocketBlocking(holder, false);
-    }
-#else
-    if (dont_wait) {
-        flags |= MSG_DONTWAIT;
-    }
-#endif // _WIN32
-    std::vector<u8> input_buff(len);
-    input_mapped_buff.Read(input_buff.data(), 0,
-                           std::min(input_mapped_buff.GetSize(), static_cast<std::size_t>(len)));
 
-    s32 ret = -1;
-    if (addr_len > 0) {
-        CTRSockAddr ctr_dest_addr;
-        std::memcpy(&ctr_dest_addr, dest_addr_buffer.data(),
-                    std::min<size_t>(addr_len, sizeof(ctr_dest_addr)));
-        auto [dest_addr, dest_addr_len] = CTRSockAddr::ToPlatform(ctr_dest_addr);
-        ret = static_cast<s32>(
-            ::sendto(holder.socket_fd, reinterpret_cast<const char*>(input_buff.data()), len, flags,
-                     reinterpret_cast<sockaddr*>(&dest_addr), dest_addr_len));
-    } else {
-        ret = static_cast<s32>(::sendto(holder.socket_fd,
-                                        reinterpret_cast<const char*>(input_buff.data()), len,
-                                        flags, nullptr, 0));
-    }
-
-    const auto send_error = (ret == SOCKET_ERROR_VALUE) ? GET_ERRNO : 0;
-
-#ifdef _WIN32
-    if (dont_wait && was_blocking) {
-        SetSocketBlocking(holder, true);
-    }
-#endif
-
-    if (ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(send_error);
-    }
-
-    LOG_SEND_RECV(Service_SOC, "called, fd={}, ret={}", socket_handle, static_cast<s32>(ret));
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
-    rb.Push(ResultSuccess);
-    rb.Push(ret);
-}
-
-s32 SOC_U::SendToImpl(SocketHolder& holder, u32 len, u32 flags, u32 addr_len,
-                      const std::vector<u8>& input_buff, const u8* dest_addr_buff) {
-
-    bool dont_wait = (flags & MSGCUSTOM_HANDLE_DONTWAIT) != 0;
-    flags &= ~MSGCUSTOM_HANDLE_DONTWAIT;
-#ifdef _WIN32
-    bool was_blocking = GetSocketBlocking(holder);
-    if (dont_wait && was_blocking) {
-        SetSocketBlocking(holder, false);
-    }
-#else
-    if (dont_wait) {
-        flags |= MSG_DONTWAIT;
-    }
-#endif // _WIN32
-
-    s32 ret = -1;
-    if (addr_len > 0) {
-        CTRSockAddr ctr_dest_addr;
-        std::memcpy(&ctr_dest_addr, dest_addr_buff,
-                    std::min<size_t>(addr_len, sizeof(ctr_dest_addr)));
-        auto [dest_addr, dest_addr_len] = CTRSockAddr::ToPlatform(ctr_dest_addr);
-        ret = static_cast<s32>(
-            ::sendto(holder.socket_fd, reinterpret_cast<const char*>(input_buff.data()), len, flags,
-                     reinterpret_cast<sockaddr*>(&dest_addr), dest_addr_len));
-    } else {
-        ret = static_cast<s32>(::sendto(holder.socket_fd,
-                                        reinterpret_cast<const char*>(input_buff.data()), len,
-                                        flags, nullptr, 0));
-    }
-
-    auto send_error = (ret == SOCKET_ERROR_VALUE) ? GET_ERRNO : 0;
-
-#ifdef _WIN32
-    if (dont_wait && was_blocking) {
-        SetSocketBlocking(holder, true);
-    }
-#endif
+    auto async_data = std::make_shared<SendToData>();
+    async_data->socket_fd = holder.socket_fd;
+    async_data->socket_handle = socket_handle;
+    async_data->len = len;
+    async_data->flags = flags;
+    async_data->addr_len = addr_len;
+    async_data->input_buff.resize(len);
+    input_mapped_buff.Read(async_data->input_buff.data(), 0,
+                           std::min(input_mapped_buff.GetSize(), static_cast<std::size_t>(len)));
+    async_data->dest_addr_buff = std::move(dest_addr_buffer);
+    async_data->send_all = GetSocketBlocking(holder) && !dont_wait;
+
+    RunWhenReady(
+        *reactor, ctx, {{holder.socket_fd, POLLOUT, 0}}, std::chrono::nanoseconds(-1),
+        async_data->send_all,
+        [async_data](std::span<const SocketReactor::PollEntry>, SocketReactor::WaitResult) {
+            return async_data->Send(async_data->dest_addr_buff.data());
+        },
+        [async_data](Kernel::HLERequestContext& ctx) {
+            if (async_data->ret == SOCKET_ERROR_VALUE) {
+                async_data->ret = TranslateError(async_data->send_error);
+            }
 
-    if (ret == SOCKET_ERROR_VALUE)
-        ret = TranslateError(send_error);
+            LOG_SEND_RECV(Service_SOC, "called, fd={}, ret={}", async_data->socket_handle,
+                          static_cast<s32>(async_data->ret));
 
-    return ret;
+            IPC::RequestBuilder rb(ctx, 0x09, 2, 0);
+            rb.Push(ResultSuccess);
+            rb.Push(async_data->ret);
+        });
 }
 
 void SOC_U::SendToSingle(Kernel::HLERequestContext& ctx) {
@@ -1232,31 +1292,37 @@ void SOC_U::SendToSingle(Kernel::HLERequestContext& ctx) {
     }
     SocketHolder& holder = socket_holder_optional->get();
 
-    s32 ret = SendToImpl(holder, len, flags, addr_len, input_buff, dest_addr_buff.data());
+    const bool dont_wait = (flags & MSGCUSTOM_HANDLE_DONTWAIT) != 0;
+    flags &= ~MSGCUSTOM_HANDLE_DONTWAIT;
 
-    LOG_SEND_RECV(Service_SOC, "called, fd={}, ret={}", socket_handle, static_cast<s32>(ret));
+    auto async_data = std::make_shared<SendToData>();
+    async_data->socket_fd = holder.socket_fd;
+    async_data->socket_handle = socket_handle;
+    async_data->len = len;
+    async_data->flags = flags;
+    async_data->addr_len = addr_len;
+    async_data->input_buff = std::move(input_buff);
+    async_data->dest_addr_buff = std::move(dest_addr_buff);
+    async_data->send_all = GetSocketBlocking(holder) && !dont_wait;
+
+    RunWhenReady(
+        *reactor, ctx, {{holder.socket_fd, POLLOUT, 0}}, std::chrono::nanoseconds(-1),
+        async_data->send_all,
+        [async_data](std::span<const SocketReactor::PollEntry>, SocketReactor::WaitResult) {
+            return async_data->Send(async_data->dest_addr_buff.data());
+        },
+        [async_data](Kernel::HLERequestContext& ctx) {
+            if (async_data->ret == SOCKET_ERROR_VALUE) {
+                async_data->ret = TranslateError(async_data->send_error);
+            }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
-    rb.Push(ResultSuccess);
-    rb.Push(ret);
-}
+            LOG_SEND_RECV(Service_SOC, "called, fd={}, ret={}", async_data->socket_handle,
+                          static_cast<s32>(async_data->ret));
 
-// A poll busy loop has to be used when recieving from a blocking socket
-// because calling shutdown on a socket that's currently in a blocking
-// recv call does not make it return, which causes some games to hang.
-void SOC_U::RecvBusyWaitForEvent(SocketHolder& holder) {
-    constexpr int timeout_ms = 100;
-
-    while (true) {
-        pollfd poll_fd{};
-        poll_fd.fd = holder.socket_fd;
-        poll_fd.events = POLLIN; // Check for available data.
-        int res = ::poll(&poll_fd, 1, timeout_ms);
-        // Break if there is any event, error or socket RD shutdown.
-        if (res != 0 || holder.shutdown_rd) {
-            break;
-        }
-    }
+            IPC::RequestBuilder rb(ctx, 0x0A, 2, 0);
+            rb.Push(ResultSuccess);
+            rb.Push(async_data->ret);
+        });
 }
 
 void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
@@ -1274,99 +1340,29 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
     }
     SocketHolder& holder = socket_holder_optional->get();
 
-    bool dont_wait = (flags & MSGCUSTOM_HANDLE_DONTWAIT) != 0;
+    const bool dont_wait = (flags & MSGCUSTOM_HANDLE_DONTWAIT) != 0;
     flags &= ~MSGCUSTOM_HANDLE_DONTWAIT;
-#ifdef _WIN32
-    bool was_blocking = GetSocketBlocking(holder);
-    if (dont_wait && was_blocking) {
-        SetSocketBlocking(holder, false);
-    }
-#else
-    if (dont_wait) {
-        flags |= MSG_DONTWAIT;
-    }
-#endif // _WIN32
 
-    bool needs_async = GetSocketBlocking(holder) && !dont_wait;
-    struct AsyncData {
-        // Input
-        u32 len{};
-        u32 flags{};
-        u32 addr_len{};
-        SocketHolder* fd_info;
-        u32 socket_handle;
-#ifdef _WIN32
-        bool dont_wait;
-        bool was_blocking;
-#endif
-        bool is_blocking;
-
-        // Output
-        s32 ret{};
-        int recv_error;
-        Kernel::MappedBuffer* buffer;
-        std::vector<u8> output_buff;
-        std::vector<u8> addr_buff;
-    };
-
-    auto async_data = std::make_shared<AsyncData>();
-    async_data->buffer = &buffer;
-    async_data->ret = -1;
+    auto async_data = std::make_shared<RecvFromData>();
+    async_data->socket_fd = holder.socket_fd;
+    async_data->socket_handle = socket_handle;
     async_data->len = len;
     async_data->flags = flags;
     async_data->addr_len = addr_len;
-    async_data->output_buff.resize(len);
-    async_data->addr_buff.resize(addr_len);
-    async_data->fd_info = &holder;
-    async_data->socket_handle = socket_handle;
-#ifdef _WIN32
-    async_data->dont_wait = dont_wait;
-    async_data->was_blocking = was_blocking;
-#endif
-    async_data->is_blocking = needs_async;
 
-    ctx.RunAsync(
-        [async_data](Kernel::HLERequestContext& ctx) {
-            sockaddr_storage src_addr;
-            socklen_t src_addr_len = sizeof(src_addr);
-            CTRSockAddr ctr_src_addr;
-            // Windows, why do you have to be so special...
-            if (async_data->is_blocking) {
-                RecvBusyWaitForEvent(*async_data->fd_info);
-            }
-            if (async_data->addr_len > 0) {
-                async_data->ret = static_cast<s32>(::recvfrom(
-                    async_data->fd_info->socket_fd,
-                    reinterpret_cast<char*>(async_data->output_buff.data()), async_data->len,
-                    async_data->flags, reinterpret_cast<sockaddr*>(&src_addr), &src_addr_len));
-                if (async_data->ret >= 0 && src_addr_len > 0) {
-                    ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
-                    std::memcpy(async_data->addr_buff.data(), &ctr_src_addr,
-                                std::min<size_t>(async_data->addr_len, sizeof(ctr_src_addr)));
-                }
-            } else {
-                async_data->ret = static_cast<s32>(
-                    ::recvfrom(async_data->fd_info->socket_fd,
-                               reinterpret_cast<char*>(async_data->output_buff.data()),
-                               async_data->len, async_data->flags, NULL, 0));
-                async_data->addr_buff.resize(0);
-            }
-            async_data->recv_error = (async_data->ret == SOCKET_ERROR_VALUE) ? GET_ERRNO : 0;
-            return 0;
+    RunWhenReady(
+        *reactor, ctx, {{holder.socket_fd, POLLIN, 0}}, std::chrono::nanoseconds(-1),
+        GetSocketBlocking(holder) && !dont_wait,
+        [async_data](std::span<const SocketReactor::PollEntry>, SocketReactor::WaitResult) {
+            return async_data->Receive();
         },
-        [this, async_data](Kernel::HLERequestContext& ctx) {
+        [async_data, buffer = &buffer](Kernel::HLERequestContext& ctx) {
             if (async_data->ret == SOCKET_ERROR_VALUE) {
                 async_data->ret = TranslateError(async_data->recv_error);
             } else {
-                async_data->buffer->Write(async_data->output_buff.data(), 0, async_data->ret);
-            }
-#ifdef _WIN32
-            if (async_data->dont_wait && async_data->was_blocking) {
-                SetSocketBlocking(*async_data->fd_info, true);
+                buffer->Write(async_data->output_buff.data(), 0, async_data->ret);
             }
-#else
-            (void)this;
-#endif
+
             LOG_SEND_RECV(Service_SOC, "called, fd={}, ret={}", async_data->socket_handle,
                           static_cast<s32>(async_data->ret));
 
@@ -1374,9 +1370,8 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
             rb.Push(ResultSuccess);
             rb.Push(async_data->ret);
             rb.PushStaticBuffer(std::move(async_data->addr_buff), 0);
-            rb.PushMappedBuffer(*async_data->buffer);
-        },
-        needs_async);
+            rb.PushMappedBuffer(*buffer);
+        });
 }
 
 void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
@@ -1393,93 +1388,23 @@ void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
     }
     SocketHolder& holder = socket_holder_optional->get();
 
-    bool dont_wait = (flags & MSGCUSTOM_HANDLE_DONTWAIT) != 0;
+    const bool dont_wait = (flags & MSGCUSTOM_HANDLE_DONTWAIT) != 0;
     flags &= ~MSGCUSTOM_HANDLE_DONTWAIT;
-#ifdef _WIN32
-    bool was_blocking = GetSocketBlocking(holder);
-    if (dont_wait && was_blocking) {
-        SetSocketBlocking(holder, false);
-    }
-#else
-    if (dont_wait) {
-        flags |= MSG_DONTWAIT;
-    }
-#endif // _WIN32
-
-    bool needs_async = GetSocketBlocking(holder) && !dont_wait;
-    struct AsyncData {
-        // Input
-        u32 len{};
-        u32 flags{};
-        u32 addr_len{};
-        SocketHolder* fd_info;
-        u32 socket_handle;
-#ifdef _WIN32
-        bool dont_wait;
-        bool was_blocking;
-#endif
-        bool is_blocking;
 
-        // Output
-        s32 ret{};
-        int recv_error;
-        std::vector<u8> output_buff;
-        std::vector<u8> addr_buff;
-    };
-
-    auto async_data = std::make_shared<AsyncData>();
-    async_data->ret = -1;
+    auto async_data = std::make_shared<RecvFromData>();
+    async_data->socket_fd = holder.socket_fd;
+    async_data->socket_handle = socket_handle;
     async_data->len = len;
     async_data->flags = flags;
     async_data->addr_len = addr_len;
-    async_data->output_buff.resize(len);
-    async_data->addr_buff.resize(addr_len);
-    async_data->fd_info = &holder;
-    async_data->socket_handle = socket_handle;
-#ifdef _WIN32
-    async_data->dont_wait = dont_wait;
-    async_data->was_blocking = was_blocking;
-#endif
-    async_data->is_blocking = needs_async;
 
-    ctx.RunAsync(
-        [async_data](Kernel::HLERequestContext& ctx) {
-            sockaddr_storage src_addr;
-            socklen_t src_addr_len = sizeof(src_addr);
-            CTRSockAddr ctr_src_addr;
-            if (async_data->is_blocking) {
-                RecvBusyWaitForEvent(*async_data->fd_info);
-            }
-            if (async_data->addr_len > 0) {
-                // Only get src adr if input adr available
-                async_data->ret = static_cast<s32>(::recvfrom(
-                    async_data->fd_info->socket_fd,
-                    reinterpret_cast<char*>(async_data->output_buff.data()), async_data->len,
-                    async_data->flags, reinterpret_cast<sockaddr*>(&src_addr), &src_addr_len));
-                if (async_data->ret >= 0 && src_addr_len > 0) {
-                    ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
-                    std::memcpy(async_data->addr_buff.data(), &ctr_src_addr,
-                                std::min<size_t>(async_data->addr_len, sizeof(ctr_src_addr)));
-                }
-            } else {
-                async_data->ret = static_cast<s32>(
-                    ::recvfrom(async_data->fd_info->socket_fd,
-                               reinterpret_cast<char*>(async_data->output_buff.data()),
-                               async_data->len, async_data->flags, NULL, 0));
-                async_data->addr_buff.resize(0);
-            }
-            async_data->recv_error = (async_data->ret == SOCKET_ERROR_VALUE) ? GET_ERRNO : 0;
-            return 0;
+    RunWhenReady(
+        *reactor, ctx, {{holder.socket_fd, POLLIN, 0}}, std::chrono::nanoseconds(-1),
+        GetSocketBlocking(holder) && !dont_wait,
+        [async_data](std::span<const SocketReactor::PollEntry>, SocketReactor::WaitResult) {
+            return async_data->Receive();
         },
-        [this, async_data](Kernel::HLERequestContext& ctx) {
-
-#ifdef _WIN32
-            if (async_data->dont_wait && async_data->was_blocking) {
-                SetSocketBlocking(*async_data->fd_info, true);
-            }
-#else
-            (void)this;
-#endif
+        [async_data](Kernel::HLERequestContext& ctx) {
             s32 total_received = async_data->ret;
             if (async_data->ret == SOCKET_ERROR_VALUE) {
                 async_data->ret = TranslateError(async_data->recv_error);
@@ -1498,8 +1423,7 @@ void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
             rb.Push(total_received);
             rb.PushStaticBuffer(std::move(async_data->output_buff), 0);
             rb.PushStaticBuffer(std::move(async_data->addr_buff), 1);
-        },
-        needs_async);
+        });
 }
 
 void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
@@ -1511,7 +1435,6 @@ void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
 
     struct AsyncData {
         // Input
-        s32 timeout;
         u32 nfds;
 
         // Input/Output
@@ -1524,7 +1447,6 @@ void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
         int poll_error;
     };
     auto async_data = std::make_shared<AsyncData>();
-    async_data->timeout = timeout;
     async_data->nfds = nfds;
 
     async_data->ctr_fds.resize(nfds);
@@ -1543,14 +1465,19 @@ void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
             CTRPollFD::ToPlatform(*this, async_data->ctr_fds[i], async_data->has_libctru_bug[i]);
     }
 
-    ctx.RunAsync(
-        [async_data](Kernel::HLERequestContext& ctx) {
-            async_data->ret =
-                ::poll(async_data->platform_pollfd.data(), async_data->nfds, async_data->timeout);
-            if (async_data->ret == SOCKET_ERROR_VALUE) {
-                async_data->poll_error = GET_ERRNO;
-            }
-            return 0;
+    std::vector<SocketReactor::PollEntry> entries(nfds);
+    for (u32 i = 0; i < nfds; i++) {
+        entries[i] = {async_data->platform_pollfd[i].fd, async_data->platform_pollfd[i].events, 0};
+    }
+
+    // The reactor only signals that the sockets may be ready, they are polled again without
+    // blocking to get the complete results.
+    RunWhenReady(
+        *reactor, ctx, std::move(entries), std::chrono::milliseconds(timeout), timeout != 0,
+        [async_data](std::span<const SocketReactor::PollEntry>, SocketReactor::WaitResult) {
+            async_data->ret = ::poll(async_data->platform_pollfd.data(), async_data->nfds, 0);
+            async_data->poll_error = (async_data->ret == SOCKET_ERROR_VALUE) ? GET_ERRNO : 0;
+            return async_data->ret != 0;
         },
         [this, async_data](Kernel::HLERequestContext& ctx) {
             // Now update the output 3ds_pollfd structure
@@ -1575,8 +1502,7 @@ void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
 
             LOG_POLL(Service_SOC, "called, fd_count={}, ret={}", async_data->nfds,
                      static_cast<s32>(async_data->ret));
-        },
-        timeout != 0);
+        });
 }
 
 void SOC_U::GetSockName(Kernel::HLERequestContext& ctx) {
@@ -1632,10 +1558,10 @@ void SOC_U::Shutdown(Kernel::HLERequestContext& ctx) {
     s32 ret = ::shutdown(holder.socket_fd, how);
     if (ret != 0) {
         ret = TranslateError(GET_ERRNO);
-    } else {
-        if (how == SHUT_RD || how == SHUT_RDWR) {
-            holder.shutdown_rd = true;
-        }
+    } else if (how == SHUT_RD || how == SHUT_RDWR) {
+        // Not every platform wakes up the operations waiting on a shut down socket, so complete
+        // them explicitly.
+        reactor->Cancel(holder.socket_fd);
     }
 
     LOG_DEBUG(Service_SOC, "called, pid={}, fd={}, ret={}", pid, socket_handle,
@@ -1776,18 +1702,19 @@ void SOC_U::Connect(Kernel::HLERequestContext& ctx) {
 
     struct AsyncData {
         // Input
-        SocketHolder* fd_info;
+        SocketReactor::SocketFd socket_fd;
         std::pair<sockaddr_storage, socklen_t> input_addr;
         u32 socket_handle;
         u32 pid;
 
         // Output
+        bool started{};
         s32 ret{};
         int connect_error;
     };
 
     auto async_data = std::make_shared<AsyncData>();
-    async_data->fd_info = &holder;
+    async_data->socket_fd = holder.socket_fd;
     async_data->pid = pid;
 
     CTRSockAddr ctr_input_addr;
@@ -1797,13 +1724,33 @@ void SOC_U::Connect(Kernel::HLERequestContext& ctx) {
     async_data->input_addr = CTRSockAddr::ToPlatform(ctr_input_addr);
     async_data->socket_handle = socket_handle;
 
-    ctx.RunAsync(
-        [async_data](Kernel::HLERequestContext& ctx) {
-            async_data->ret = ::connect(async_data->fd_info->socket_fd,
-                                        reinterpret_cast<sockaddr*>(&async_data->input_addr.first),
-                                        async_data->input_addr.second);
-            async_data->connect_error = (async_data->ret == SOCKET_ERROR_VALUE) ? GET_ERRNO : 0;
-            return 0;
+    RunWhenReady(
+        *reactor, ctx, {{holder.socket_fd, POLLOUT, 0}}, std::chrono::nanoseconds(-1),
+        GetSocketBlocking(holder),
+        [async_data](std::span<const SocketReactor::PollEntry>, SocketReactor::WaitResult result) {
+            if (!async_data->started) {
+                async_data->started = true;
+                async_data->ret =
+                    ::connect(async_data->socket_fd,
+                              reinterpret_cast<sockaddr*>(&async_data->input_addr.first),
+                              async_data->input_addr.second);
+                async_data->connect_error =
+                    (async_data->ret == SOCKET_ERROR_VALUE) ? GET_ERRNO : 0;
+                return !IsWouldBlockError(async_data->connect_error);
+            }
+            if (result != SocketReactor::WaitResult::Ready) {
+                return false;
+            }
+            // The connection attempt is over once the socket is writable or has an error.
+            int error = 0;
+            socklen_t error_len = sizeof(error);
+            if (::getsockopt(async_data->socket_fd, SOL_SOCKET, SO_ERROR,
+                             reinterpret_cast<char*>(&error), &error_len) != 0) {
+                error = GET_ERRNO;
+            }
+            async_data->ret = (error == 0) ? 0 : SOCKET_ERROR_VALUE;
+            async_data->connect_error = error;
+            return true;
         },
         [async_data](Kernel::HLERequestContext& ctx) {
             if (async_data->ret != 0) {
@@ -2121,14 +2068,28 @@ void SOC_U::SendToMultiple(Kernel::HLERequestContext& ctx) {
     }
     SocketHolder& holder = socket_holder_optional->get();
 
+    SendToData data{
+        .socket_fd = holder.socket_fd,
+        .socket_handle = socket_handle,
+        .len = len,
+        .flags = flags & ~MSGCUSTOM_HANDLE_DONTWAIT,
+        .addr_len = addr_len,
+        .input_buff = std::move(input_buff),
+    };
+
+    // Datagrams are sent without waiting for the socket to be writable, as they do not block in
+    // practice.
     u32 count = total_addr_len / addr_len;
-    s32 ret = 0;
     u32 i = 0;
     do {
-        ret = SendToImpl(holder, len, flags, addr_len, input_buff,
-                         dest_addr_buff.data() + (i * addr_len));
+        data.Send(dest_addr_buff.data() + (i * addr_len));
         i++;
-    } while (i < count && ret >= 0);
+    } while (i < count && data.ret >= 0);
+
+    s32 ret = data.ret;
+    if (ret == SOCKET_ERROR_VALUE) {
+        ret = TranslateError(data.send_error);
+    }
 
     LOG_DEBUG(Service_SOC, "called, pid={}, fd_count={}, ret={}", pid, count,
               static_cast<s32>(ret));
@@ -2225,10 +2186,13 @@ SOC_U::SOC_U() : ServiceFramework("soc:U", 18) {
     WSADATA data;
     WSAStartup(MAKEWORD(2, 2), &data);
 #endif
+
+    reactor = std::make_unique<SocketReactor>();
 }
 
 SOC_U::~SOC_U() {
     CloseAndDeleteAllSockets();
+    reactor.reset();
 #ifdef _WIN32
     WSACleanup();
 #endif
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
 #include <utility>
 #include <boost/serialization/set.hpp>
@@ -21,6 +22,8 @@ class RequestParser;
 
 namespace Service::SOC {
 
+class SocketReactor;
+
 /// Holds information about a particular socket
 struct SocketHolder {
 #ifdef _WIN32
@@ -30,9 +33,9 @@ struct SocketHolder {
     int socket_fd; ///< The socket descriptor
 #endif // _WIN32
 
-    bool blocking = true; ///< Whether the socket is blocking or not.
+    /// Whether the socket is blocking for the guest. The host socket is always non-blocking.
+    bool blocking = true;
     bool isGlobal = false;
-    bool shutdown_rd = false;
 
     u32 ownerProcess = 0;
 
@@ -95,10 +98,8 @@ private:
     // specified process ID.
     void CloseAndDeleteAllSockets(s32 process_id = -1);
 
-    s32 SendToImpl(SocketHolder& holder, u32 len, u32 flags, u32 addr_len,
-                   const std::vector<u8>& input_buff, const u8* dest_addr_buff);
-
-    static void RecvBusyWaitForEvent(SocketHolder& holder);
+    /// Closes the host socket of holder, completing the operations waiting on it.
+    s32 CloseSocket(const SocketHolder& holder);
 
     // From
     // https://github.com/devkitPro/libctru/blob/1de86ea38aec419744149daf692556e187d4678a/libctru/include/3ds/services/soc.h#L15
@@ -167,6 +168,9 @@ private:
     bool interface_info_cached = false;
     InterfaceInfo interface_info;
 
+    /// Completes the operations on blocking sockets once they would no longer block.
+    std::unique_ptr<SocketReactor> reactor;
+
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
         ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
@@ -12,6 +12,7 @@
 #include <fmt/chrono.h>
 #include <fmt/format.h>
 #include "common/file_util.h"
+#include "common/perf_counters.h"
 #include "common/settings.h"
 #include "core/core_timing.h"
 #include "core/perf_stats.h"
@@ -54,6 +55,8 @@ void PerfStats::BeginSystemFrame() {
 }
 
 void PerfStats::EndSystemFrame() {
+    Common::Perf::EndFrame();
+
     std::scoped_lock lock{object_mutex};
 
     auto frame_end = Clock::now();
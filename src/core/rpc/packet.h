@@ -15,6 +15,12 @@ enum class PacketType : u32 {
     Undefined = 0,
     ReadMemory = 1,
     WriteMemory = 2,
+    // The batched and watch requests below are serviced at the next VBlank, on the emulation
+    // thread, so everything they read belongs to the same frame.
+    ReadMemoryBatch = 3,  ///< Gathers (address, size) pairs into one reply
+    WriteMemoryBatch = 4, ///< Scatters (address, size, data) records
+    WatchMemory = 5,      ///< Replies with an (address, size) range every frame it changes
+    UnwatchMemory = 6,    ///< Cancels the watch with the given request id
 };
 
 struct PacketHeader {
@@ -26,7 +32,7 @@ struct PacketHeader {
 
 constexpr u32 CURRENT_VERSION = 1;
 constexpr u32 MIN_PACKET_SIZE = sizeof(PacketHeader);
-constexpr u32 MAX_PACKET_DATA_SIZE = 32;
+constexpr u32 MAX_PACKET_DATA_SIZE = 1024;
 constexpr u32 MAX_PACKET_SIZE = MIN_PACKET_SIZE + MAX_PACKET_DATA_SIZE;
 constexpr u32 MAX_READ_SIZE = MAX_PACKET_DATA_SIZE;
 
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/memory.h"
@@ -10,6 +11,67 @@
 
 namespace Core::RPC {
 
+namespace {
+
+/// Maximum number of batched/watch requests waiting for the next frame, in case it never comes
+constexpr std::size_t MAX_PENDING_FRAME_REQUESTS = 256;
+/// Maximum number of simultaneously active watches
+constexpr std::size_t MAX_WATCHES = 64;
+
+constexpr u32 RANGE_SIZE = sizeof(u32) * 2;
+
+u32 ReadU32(std::span<const u8> data, std::size_t offset) {
+    u32 value;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+/// Only allow writing to certain memory regions
+bool IsWritableAddress(u32 address) {
+    return (address >= Memory::PROCESS_IMAGE_VADDR && address <= Memory::PROCESS_IMAGE_VADDR_END) ||
+           (address >= Memory::HEAP_VADDR && address <= Memory::HEAP_VADDR_END) ||
+           (address >= Memory::N3DS_EXTRA_RAM_VADDR &&
+            address <= Memory::N3DS_EXTRA_RAM_VADDR_END);
+}
+
+/// Checks that the (address, size) pairs of a batched read fit in a single reply
+bool IsValidReadBatch(std::span<const u8> data) {
+    if (data.empty() || data.size() % RANGE_SIZE != 0) {
+        return false;
+    }
+    u32 total_size = 0;
+    for (std::size_t offset = 0; offset < data.size(); offset += RANGE_SIZE) {
+        const u32 size = ReadU32(data, offset + sizeof(u32));
+        if (size > MAX_READ_SIZE - total_size) {
+            return false;
+        }
+        total_size += size;
+    }
+    return true;
+}
+
+/// Checks that the (address, size, data) records of a batched write exactly fill the packet
+bool IsValidWriteBatch(std::span<const u8> data) {
+    if (data.empty()) {
+        return false;
+    }
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+        if (data.size() - offset < RANGE_SIZE) {
+            return false;
+        }
+        const u32 size = ReadU32(data, offset + sizeof(u32));
+        offset += RANGE_SIZE;
+        if (size > data.size() - offset) {
+            return false;
+        }
+        offset += size;
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
 RPCServer::RPCServer(Core::System& system_) : system{system_} {
     LOG_INFO(RPC_Server, "Starting RPC server.");
     request_handler_thread =
@@ -30,10 +92,7 @@ void RPCServer::HandleReadMemory(Packet& packet, u32 address, u32 data_size) {
 }
 
 void RPCServer::HandleWriteMemory(Packet& packet, u32 address, std::span<const u8> data) {
-    // Only allow writing to certain memory regions
-    if ((address >= Memory::PROCESS_IMAGE_VADDR && address <= Memory::PROCESS_IMAGE_VADDR_END) ||
-        (address >= Memory::HEAP_VADDR && address <= Memory::HEAP_VADDR_END) ||
-        (address >= Memory::N3DS_EXTRA_RAM_VADDR && address <= Memory::N3DS_EXTRA_RAM_VADDR_END)) {
+    if (IsWritableAddress(address)) {
         // Note: Memory write occurs asynchronously from the state of the emulator
         system.Memory().WriteBlock(address, data.data(), data.size());
         // If the memory happens to be executable code, make sure the changes become visible
@@ -45,15 +104,113 @@ void RPCServer::HandleWriteMemory(Packet& packet, u32 address, std::span<const u
     packet.SendReply();
 }
 
+void RPCServer::HandleReadMemoryBatch(Packet& packet) {
+    // The reply overwrites the requested ranges, so take a copy of them first
+    std::array<u8, MAX_PACKET_DATA_SIZE> ranges;
+    const u32 ranges_size = packet.GetPacketDataSize();
+    std::memcpy(ranges.data(), packet.GetPacketData().data(), ranges_size);
+
+    u32 total_size = 0;
+    for (u32 offset = 0; offset < ranges_size; offset += RANGE_SIZE) {
+        const u32 address = ReadU32(ranges, offset);
+        const u32 size = ReadU32(ranges, offset + sizeof(u32));
+        system.Memory().ReadBlock(address, packet.GetPacketData().data() + total_size, size);
+        total_size += size;
+    }
+    packet.SetPacketDataSize(total_size);
+    packet.SendReply();
+}
+
+void RPCServer::HandleWriteMemoryBatch(Packet& packet) {
+    const auto data = std::span<const u8>{packet.GetPacketData()}.first(packet.GetPacketDataSize());
+    for (std::size_t offset = 0; offset < data.size();) {
+        const u32 address = ReadU32(data, offset);
+        const u32 size = ReadU32(data, offset + sizeof(u32));
+        offset += RANGE_SIZE;
+        if (size > 0 && IsWritableAddress(address)) {
+            system.Memory().WriteBlock(address, data.data() + offset, size);
+            system.InvalidateCacheRange(address, size);
+        }
+        offset += size;
+    }
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+}
+
+void RPCServer::HandleWatchMemory(std::unique_ptr<Packet> packet) {
+    const u32 id = packet->GetId();
+    if (watches.size() >= MAX_WATCHES || watches.contains(id)) {
+        packet->SetPacketDataSize(0);
+        packet->SendReply();
+        return;
+    }
+    const auto data = packet->GetPacketData();
+    const u32 address = ReadU32(data, 0);
+    const u32 size = ReadU32(data, sizeof(u32));
+    watches.emplace(id, Watch{
+                            .packet = std::move(packet),
+                            .address = address,
+                            .size = size,
+                            .last_data = std::vector<u8>(size),
+                            .notified = false,
+                        });
+}
+
+void RPCServer::HandleUnwatchMemory(Packet& packet) {
+    watches.erase(ReadU32(packet.GetPacketData(), 0));
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+}
+
+void RPCServer::UpdateWatches() {
+    for (auto& [id, watch] : watches) {
+        auto data = watch.packet->GetPacketData().first(watch.size);
+        system.Memory().ReadBlock(watch.address, data.data(), watch.size);
+        if (watch.notified && std::memcmp(data.data(), watch.last_data.data(), watch.size) == 0) {
+            continue;
+        }
+        std::memcpy(watch.last_data.data(), data.data(), watch.size);
+        watch.notified = true;
+        watch.packet->SetPacketDataSize(watch.size);
+        watch.packet->SendReply();
+    }
+}
+
+void RPCServer::OnVBlank() {
+    {
+        std::scoped_lock lock{frame_requests_mutex};
+        if (frame_requests.empty() && watches.empty()) {
+            return;
+        }
+        // Keep both vectors around so that servicing a frame does not allocate
+        frame_requests_swap.swap(frame_requests);
+    }
+
+    for (auto& request : frame_requests_swap) {
+        HandleFrameRequest(std::move(request));
+    }
+    frame_requests_swap.clear();
+
+    UpdateWatches();
+}
+
 bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
     if (packet_header.version <= CURRENT_VERSION) {
         switch (packet_header.packet_type) {
         case PacketType::ReadMemory:
         case PacketType::WriteMemory:
+        case PacketType::ReadMemoryBatch:
+        case PacketType::WriteMemoryBatch:
+        case PacketType::WatchMemory:
             if (packet_header.packet_size >= (sizeof(u32) * 2)) {
                 return true;
             }
             break;
+        case PacketType::UnwatchMemory:
+            if (packet_header.packet_size >= sizeof(u32)) {
+                return true;
+            }
+            break;
         default:
             break;
         }
@@ -63,34 +220,61 @@ bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
 
 void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     bool success = false;
+    bool deferred = false;
     const auto packet_data = request_packet->GetPacketData();
 
     if (ValidatePacket(request_packet->GetHeader())) {
-        // Currently, all request types use the address/data_size wire format
-        u32 address = 0;
-        u32 data_size = 0;
-        std::memcpy(&address, packet_data.data(), sizeof(address));
-        std::memcpy(&data_size, packet_data.data() + sizeof(address), sizeof(data_size));
+        const auto request_data = std::span<const u8>{packet_data}.first(
+            request_packet->GetPacketDataSize());
 
         switch (request_packet->GetPacketType()) {
         case PacketType::ReadMemory:
-            if (data_size > 0 && data_size <= MAX_READ_SIZE) {
-                HandleReadMemory(*request_packet, address, data_size);
-                success = true;
-            }
-            break;
-        case PacketType::WriteMemory:
-            if (data_size > 0 && data_size <= MAX_PACKET_DATA_SIZE - (sizeof(u32) * 2)) {
+        case PacketType::WriteMemory: {
+            // These request types use the address/data_size wire format
+            const u32 address = ReadU32(packet_data, 0);
+            const u32 data_size = ReadU32(packet_data, sizeof(u32));
+
+            if (request_packet->GetPacketType() == PacketType::ReadMemory) {
+                if (data_size > 0 && data_size <= MAX_READ_SIZE) {
+                    HandleReadMemory(*request_packet, address, data_size);
+                    success = true;
+                }
+            } else if (data_size > 0 && data_size <= MAX_PACKET_DATA_SIZE - (sizeof(u32) * 2)) {
                 const auto data = packet_data.subspan(sizeof(u32) * 2, data_size);
                 HandleWriteMemory(*request_packet, address, data);
                 success = true;
             }
             break;
+        }
+        case PacketType::ReadMemoryBatch:
+            deferred = IsValidReadBatch(request_data);
+            break;
+        case PacketType::WriteMemoryBatch:
+            deferred = IsValidWriteBatch(request_data);
+            break;
+        case PacketType::WatchMemory: {
+            const u32 data_size = ReadU32(packet_data, sizeof(u32));
+            deferred = data_size > 0 && data_size <= MAX_READ_SIZE;
+            break;
+        }
+        case PacketType::UnwatchMemory:
+            deferred = true;
+            break;
         default:
             break;
         }
     }
 
+    if (deferred) {
+        // Replied to by OnVBlank, on the emulation thread
+        std::scoped_lock lock{frame_requests_mutex};
+        if (frame_requests.size() < MAX_PENDING_FRAME_REQUESTS) {
+            frame_requests.push_back(std::move(request_packet));
+            return;
+        }
+        LOG_WARNING(RPC_Server, "Too many requests are waiting for the next frame");
+    }
+
     if (!success) {
         // Send an empty reply, so as not to hang the client
         request_packet->SetPacketDataSize(0);
@@ -98,6 +282,27 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     }
 }
 
+void RPCServer::HandleFrameRequest(std::unique_ptr<Packet> request_packet) {
+    switch (request_packet->GetPacketType()) {
+    case PacketType::ReadMemoryBatch:
+        HandleReadMemoryBatch(*request_packet);
+        break;
+    case PacketType::WriteMemoryBatch:
+        HandleWriteMemoryBatch(*request_packet);
+        break;
+    case PacketType::WatchMemory:
+        HandleWatchMemory(std::move(request_packet));
+        break;
+    case PacketType::UnwatchMemory:
+        HandleUnwatchMemory(*request_packet);
+        break;
+    default:
+        UNREACHABLE_MSG("Unexpected frame request type {}",
+                        static_cast<u32>(request_packet->GetPacketType()));
+        break;
+    }
+}
+
 void RPCServer::HandleRequestsLoop(std::stop_token stop_token) {
     std::unique_ptr<RPC::Packet> request_packet;
 
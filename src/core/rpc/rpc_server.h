@@ -6,7 +6,11 @@
 
 #include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <span>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
 #include "common/polyfill_thread.h"
 #include "common/threadsafe_queue.h"
 
@@ -26,17 +30,44 @@ public:
 
     void QueueRequest(std::unique_ptr<RPC::Packet> request);
 
+    /**
+     * Services the batched and watch requests received since the previous frame. Called from
+     * the emulation thread on VBlank, so all the memory read here is a consistent snapshot.
+     */
+    void OnVBlank();
+
 private:
+    struct Watch {
+        std::unique_ptr<Packet> packet; ///< The watch request, reused for every notification
+        u32 address;
+        u32 size;
+        std::vector<u8> last_data;
+        bool notified;
+    };
+
     void HandleReadMemory(Packet& packet, u32 address, u32 data_size);
     void HandleWriteMemory(Packet& packet, u32 address, std::span<const u8> data);
+    void HandleReadMemoryBatch(Packet& packet);
+    void HandleWriteMemoryBatch(Packet& packet);
+    void HandleWatchMemory(std::unique_ptr<Packet> packet);
+    void HandleUnwatchMemory(Packet& packet);
+    void UpdateWatches();
     bool ValidatePacket(const PacketHeader& packet_header);
     void HandleSingleRequest(std::unique_ptr<Packet> request);
+    void HandleFrameRequest(std::unique_ptr<Packet> request);
     void HandleRequestsLoop(std::stop_token stop_token);
 
 private:
     Core::System& system;
     Common::SPSCQueue<std::unique_ptr<Packet>, true> request_queue;
     std::jthread request_handler_thread;
+
+    std::mutex frame_requests_mutex;
+    std::vector<std::unique_ptr<Packet>> frame_requests;
+    std::vector<std::unique_ptr<Packet>> frame_requests_swap;
+
+    /// Active watches, keyed by the id of their request. Only touched on the emulation thread.
+    std::unordered_map<u32, Watch> watches;
 };
 
 } // namespace Core::RPC
@@ -23,6 +23,9 @@ public:
 
     void NewRequestCallback(std::unique_ptr<Packet> new_request);
 
+    /// Called by the GPU on VBlank to service the requests that need a frame boundary
+    void OnVBlank();
+
 private:
     RPCServer rpc_server;
     std::unique_ptr<UDPServer> udp_server;
@@ -66,16 +66,22 @@ private:
         std::memcpy(reply_buffer.data() + (4 * sizeof(u32)), reply_packet.GetPacketData().data(),
                     reply_packet.GetPacketDataSize());
 
-        boost::system::error_code error;
-        socket.send_to(boost::asio::buffer(reply_buffer), endpoint, 0, error);
-
-        if (error) {
-            LOG_WARNING(RPC_Server, "Failed to send reply: {}", error.message());
-        } else {
-            LOG_INFO(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
-                     reply_packet.GetVersion(), reply_packet.GetId(), reply_packet.GetPacketType(),
-                     reply_packet.GetPacketDataSize());
-        }
+        // The socket is only used from the worker thread, while replies may come from the
+        // emulation thread, so the send is handed over to it.
+        boost::asio::post(io_context, [this, endpoint, reply_buffer = std::move(reply_buffer),
+                                       version = reply_packet.GetVersion(),
+                                       id = reply_packet.GetId(),
+                                       type = reply_packet.GetPacketType()] {
+            boost::system::error_code error;
+            socket.send_to(boost::asio::buffer(reply_buffer), endpoint, 0, error);
+
+            if (error) {
+                LOG_WARNING(RPC_Server, "Failed to send reply: {}", error.message());
+            } else {
+                LOG_TRACE(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
+                          version, id, type, reply_buffer.size() - MIN_PACKET_SIZE);
+            }
+        });
     }
 
     std::thread worker_thread;
@@ -10,6 +10,11 @@ namespace CiTrace {
 
 // NOTE: Things are stored in little-endian
 
+/// Physical base addresses of the register blocks whose writes are stored in RegisterWrite
+/// elements. GPU registers include the internal PICA registers, from offset 0x1000.
+constexpr u32 LCD_REGS_PADDR = 0x10202000;
+constexpr u32 GPU_REGS_PADDR = 0x10400000;
+
 #pragma pack(1)
 
 struct CTHeader {
@@ -4,11 +4,13 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <mutex>
 #include <random>
 #include <regex>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
 #include "common/logging/log.h"
 #include "enet/enet.h"
 #include "network/packet.h"
@@ -47,6 +49,17 @@ public:
     mutable std::mutex member_mutex; ///< Mutex for locking the members list
     /// This should be a std::shared_mutex as soon as C++17 is supported
 
+    struct MacAddressHash {
+        std::size_t operator()(const MacAddress& address) const noexcept {
+            u64 value = 0;
+            std::memcpy(&value, address.data(), address.size());
+            return std::hash<u64>{}(value);
+        }
+    };
+    /// Maps the MAC address of each member to its peer, used to route unicast wifi frames.
+    /// Guarded by member_mutex and kept in sync with members.
+    std::unordered_map<MacAddress, ENetPeer*, MacAddressHash> peer_by_mac;
+
     UsernameBanList username_ban_list; ///< List of banned usernames
     IPBanList ip_ban_list;             ///< List of banned IP addresses
     mutable std::mutex ban_list_mutex; ///< Mutex for the ban lists
@@ -222,7 +235,8 @@ public:
     MacAddress GenerateMacAddress();
 
     /**
-     * Broadcasts this packet to all members except the sender.
+     * Relays a wifi frame to its destination member, or to all members except the sender for
+     * broadcast frames. The received ENet packet is forwarded as-is and ownership of it is taken.
      * @param event The ENet event containing the data
      */
     void HandleWifiPacket(const ENetEvent* event);
@@ -261,7 +275,10 @@ void Room::RoomImpl::ServerLoop() {
                     HandleGameNamePacket(&event);
                     break;
                 case IdWifiPacket:
+                    // Wifi frames are relayed without a copy, HandleWifiPacket takes ownership of
+                    // the received packet.
                     HandleWifiPacket(&event);
+                    event.packet = nullptr;
                     break;
                 case IdChatMessage:
                     HandleChatPacket(&event);
@@ -402,6 +419,7 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
 
     {
         std::lock_guard lock(member_mutex);
+        peer_by_mac.emplace(member.mac_address, member.peer);
         members.push_back(std::move(member));
     }
 
@@ -448,6 +466,7 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
+        peer_by_mac.erase(target_member->mac_address);
         members.erase(target_member);
     }
 
@@ -491,6 +510,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
+        peer_by_mac.erase(target_member->mac_address);
         members.erase(target_member);
     }
 
@@ -578,8 +598,7 @@ bool Room::RoomImpl::IsValidNickname(const std::string& nickname) const {
 bool Room::RoomImpl::IsValidMacAddress(const MacAddress& address) const {
     // A MAC address is valid if it is not already taken by anybody else in the room.
     std::lock_guard lock(member_mutex);
-    return std::all_of(members.begin(), members.end(),
-                       [&address](const auto& member) { return member.mac_address != address; });
+    return !peer_by_mac.contains(address);
 }
 
 bool Room::RoomImpl::IsValidConsoleId(const std::string& console_id_hash) const {
@@ -846,50 +865,48 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
 }
 
 void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
+    // The header of the frame is read in place:
+    // <u8> message type, <u8> WifiPacket type, <u8> channel, <MacAddress> transmitter address,
+    // <MacAddress> destination address
+    constexpr std::size_t DestinationOffset = 3 * sizeof(u8) + sizeof(MacAddress);
+    ENetPacket* enet_packet = event->packet;
+    if (enet_packet->dataLength < DestinationOffset + sizeof(MacAddress)) {
+        LOG_ERROR(Network, "Received truncated wifi packet of {} bytes", enet_packet->dataLength);
+        enet_packet_destroy(enet_packet);
+        return;
+    }
     MacAddress destination_address;
-    in_packet >> destination_address;
+    std::memcpy(destination_address.data(), enet_packet->data + DestinationOffset,
+                destination_address.size());
 
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    // Forward the received packet itself, ENet keeps it alive until every peer has sent it.
+    enet_packet->flags = ENET_PACKET_FLAG_RELIABLE;
 
     if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
         std::lock_guard lock(member_mutex);
-        bool sent_packet = false;
         for (const auto& member : members) {
             if (member.peer != event->peer) {
-                sent_packet = true;
                 enet_peer_send(member.peer, 0, enet_packet);
             }
         }
-
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
     } else { // Send the data only to the destination client
         std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member) -> bool {
-                                       return member.mac_address == destination_address;
-                                   });
-        if (member != members.end()) {
-            enet_peer_send(member->peer, 0, enet_packet);
+        const auto it = peer_by_mac.find(destination_address);
+        if (it != peer_by_mac.end()) {
+            enet_peer_send(it->second, 0, enet_packet);
         } else {
             LOG_ERROR(Network,
                       "Attempting to send to unknown MAC address: "
                       "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
                       destination_address[0], destination_address[1], destination_address[2],
                       destination_address[3], destination_address[4], destination_address[5]);
-            enet_packet_destroy(enet_packet);
         }
     }
+
+    // Nobody holds a reference if the frame could not be queued for any peer.
+    if (enet_packet->referenceCount == 0) {
+        enet_packet_destroy(enet_packet);
+    }
     enet_host_flush(server);
 }
 
@@ -992,6 +1009,7 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
             enet_address_get_host_ip(&member->peer->address, ip_raw, sizeof(ip_raw) - 1);
             ip = ip_raw;
 
+            peer_by_mac.erase(member->mac_address);
             members.erase(member);
         }
     }
@@ -1032,7 +1050,8 @@ bool Room::Create(const std::string& name, const std::string& description,
     room_impl->room_information.name = name;
     room_impl->room_information.description = description;
     room_impl->room_information.member_slots = max_connections;
-    room_impl->room_information.port = server_port;
+    // The host reads back the bound address, which gives the actual port if server_port is 0
+    room_impl->room_information.port = room_impl->server->address.port;
     room_impl->room_information.preferred_game = preferred_game;
     room_impl->room_information.preferred_game_id = preferred_game_id;
     room_impl->room_information.host_username = host_username;
@@ -1102,6 +1121,7 @@ void Room::Destroy() {
     {
         std::lock_guard lock(room_impl->member_mutex);
         room_impl->members.clear();
+        room_impl->peer_by_mac.clear();
     }
     room_impl->room_information.member_slots = 0;
     room_impl->room_information.name.clear();
@@ -0,0 +1,103 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/codec.h"
+
+namespace AudioCore::Codec {
+
+namespace {
+using Samples = std::vector<std::array<s16, 2>>;
+
+// Straightforward decoders the optimized ones are checked against.
+
+Samples ReferenceADPCM(const u8* data, std::size_t sample_count,
+                       const std::array<s16, 16>& adpcm_coeff, ADPCMState& state) {
+    Samples ret(sample_count % 2 == 0 ? sample_count : sample_count + 1);
+    int yn1 = state.yn1, yn2 = state.yn2;
+    for (std::size_t framei = 0; framei < (sample_count + 13) / 14; framei++) {
+        const int frame_header = data[framei * 8];
+        const int scale = 1 << (frame_header & 0xF);
+        const int idx = (frame_header >> 4) & 0x7;
+        const int coef1 = adpcm_coeff[idx * 2 + 0];
+        const int coef2 = adpcm_coeff[idx * 2 + 1];
+        const auto decode_sample = [&](int nibble) {
+            const int xn = (nibble >= 8 ? nibble - 16 : nibble) * scale;
+            const int val =
+                std::clamp(((xn << 11) + 0x400 + coef1 * yn1 + coef2 * yn2) >> 11, -32768, 32767);
+            yn2 = yn1;
+            yn1 = val;
+            return static_cast<s16>(val);
+        };
+        std::size_t outputi = framei * 14;
+        std::size_t datai = framei * 8 + 1;
+        for (std::size_t i = 0; i < 14 && outputi < sample_count; i += 2, datai++) {
+            ret[outputi++].fill(decode_sample(data[datai] >> 4));
+            ret[outputi++].fill(decode_sample(data[datai] & 0xF));
+        }
+    }
+    state.yn1 = static_cast<s16>(yn1);
+    state.yn2 = static_cast<s16>(yn2);
+    return ret;
+}
+
+Samples ReferencePCM8(unsigned num_channels, const u8* data, std::size_t sample_count) {
+    Samples ret(sample_count);
+    for (std::size_t i = 0; i < sample_count; i++) {
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            const u8 sample = data[num_channels == 1 ? i : i * 2 + channel];
+            ret[i][channel] = static_cast<s16>(static_cast<u16>(sample) << 8);
+        }
+    }
+    return ret;
+}
+
+Samples ReferencePCM16(unsigned num_channels, const u8* data, std::size_t sample_count) {
+    Samples ret(sample_count);
+    for (std::size_t i = 0; i < sample_count; i++) {
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            const std::size_t offset = num_channels == 1 ? i : i * 2 + channel;
+            std::memcpy(&ret[i][channel], data + offset * sizeof(s16), sizeof(s16));
+        }
+    }
+    return ret;
+}
+} // Anonymous namespace
+
+TEST_CASE("Codec - Decoders match the reference implementation", "[audio_core]") {
+    std::mt19937 rng{0};
+    std::vector<u8> data(0x2000);
+
+    for (int iteration = 0; iteration < 500; iteration++) {
+        std::generate(data.begin(), data.end(), [&] { return static_cast<u8>(rng()); });
+        const std::size_t sample_count = rng() % 1000;
+        std::array<s16, 16> coeffs;
+        std::generate(coeffs.begin(), coeffs.end(), [&] { return static_cast<s16>(rng()); });
+
+        ADPCMState reference_state{static_cast<s16>(rng()), static_cast<s16>(rng())};
+        ADPCMState state = reference_state;
+        const Samples expected_adpcm =
+            ReferenceADPCM(data.data(), sample_count, coeffs, reference_state);
+        Samples output(ADPCMDecodedSize(sample_count));
+        DecodeADPCM(data.data(), sample_count, coeffs, state, output);
+        REQUIRE(output == expected_adpcm);
+        REQUIRE(state.yn1 == reference_state.yn1);
+        REQUIRE(state.yn2 == reference_state.yn2);
+
+        for (const unsigned num_channels : {1, 2}) {
+            output.resize(sample_count);
+            DecodePCM8(num_channels, data.data(), sample_count, output);
+            REQUIRE(output == ReferencePCM8(num_channels, data.data(), sample_count));
+            DecodePCM16(num_channels, data.data(), sample_count, output);
+            REQUIRE(output == ReferencePCM16(num_channels, data.data(), sample_count));
+        }
+    }
+}
+
+} // namespace AudioCore::Codec
@@ -0,0 +1,78 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/hle/mix_kernels.h"
+
+namespace AudioCore::HLE::MixKernels {
+
+namespace {
+template <typename Frame, typename Generator>
+Frame RandomFrame(Generator&& generate) {
+    Frame frame;
+    for (auto& sample : frame) {
+        for (auto& channel : sample) {
+            channel = generate();
+        }
+    }
+    return frame;
+}
+} // Anonymous namespace
+
+TEST_CASE("MixKernels - Match the scalar implementation", "[audio_core][hle]") {
+    std::mt19937 rng{0};
+    // Gains and samples are bounded so that the scaled sums fit in an s32, but still go past the
+    // range of s16 to exercise the saturation.
+    std::uniform_real_distribution<float> gain_dist{-4.0f, 4.0f};
+    std::uniform_int_distribution<s32> quad_dist{-(1 << 24), 1 << 24};
+    const auto random_s16 = [&] { return static_cast<s16>(rng()); };
+    const auto random_s32 = [&] { return static_cast<s32>(rng()); };
+    const auto random_quad = [&] { return quad_dist(rng); };
+
+    for (int iteration = 0; iteration < 200; iteration++) {
+        const float gain = gain_dist(rng);
+        const std::array<float, 4> gains{gain_dist(rng), gain_dist(rng), gain_dist(rng),
+                                         gain_dist(rng)};
+        const auto stereo = RandomFrame<StereoFrame16>(random_s16);
+        const auto quad = RandomFrame<QuadFrame32>(random_quad);
+
+        auto quad_dest = RandomFrame<QuadFrame32>(random_quad);
+        auto quad_expected = quad_dest;
+        StereoToQuad(stereo, gains, quad_dest);
+        StereoToQuadScalar(stereo, gains, quad_expected);
+        REQUIRE(quad_dest == quad_expected);
+
+        auto stereo_dest = RandomFrame<StereoFrame16>(random_s16);
+        auto stereo_expected = stereo_dest;
+        DownmixMono(gain, quad, stereo_dest);
+        DownmixMonoScalar(gain, quad, stereo_expected);
+        REQUIRE(stereo_dest == stereo_expected);
+
+        DownmixStereo(gain, quad, stereo_dest);
+        DownmixStereoScalar(gain, quad, stereo_expected);
+        REQUIRE(stereo_dest == stereo_expected);
+
+        const auto full_range = RandomFrame<QuadFrame32>(random_s32);
+        IntermediateMixSamples::Samples channel_major;
+        IntermediateMixSamples::Samples channel_major_expected;
+        ToChannelMajor(full_range, channel_major);
+        ToChannelMajorScalar(full_range, channel_major_expected);
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
+                REQUIRE(channel_major.pcm32[channel][sample] ==
+                        channel_major_expected.pcm32[channel][sample]);
+            }
+        }
+
+        QuadFrame32 round_trip;
+        QuadFrame32 round_trip_expected;
+        FromChannelMajor(channel_major, round_trip);
+        FromChannelMajorScalar(channel_major, round_trip_expected);
+        REQUIRE(round_trip == round_trip_expected);
+        REQUIRE(round_trip == full_range);
+    }
+}
+
+} // namespace AudioCore::HLE::MixKernels
@@ -0,0 +1,114 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/interpolate.h"
+
+namespace AudioCore::AudioInterp {
+
+namespace {
+void Fill(StereoBuffer16& buffer, std::size_t count, s16 first) {
+    auto samples = buffer.Prepare(count);
+    for (std::size_t i = 0; i < count; i++) {
+        samples[i].fill(static_cast<s16>(first + i));
+    }
+}
+} // Anonymous namespace
+
+TEST_CASE("StereoBuffer16 - Reuses storage between buffers", "[audio_core]") {
+    StereoBuffer16 buffer;
+    REQUIRE(buffer.empty());
+
+    Fill(buffer, 8, 100);
+    buffer.Consume(3);
+    REQUIRE(buffer.size() == 5);
+    REQUIRE(buffer[0][0] == 103);
+
+    Fill(buffer, 4, 200);
+    REQUIRE(buffer.size() == 4);
+    REQUIRE(buffer[3][1] == 203);
+    REQUIRE(buffer.WithHistory().size() == 4 + StereoBuffer16::history_size);
+}
+
+TEST_CASE("AudioInterp - Carries history across buffers", "[audio_core]") {
+    State state{};
+    StereoBuffer16 buffer;
+    StereoFrame16 frame{};
+    std::size_t frame_position = 0;
+
+    // Feed 100 samples in buffers of 30, 30 and 40 samples.
+    s16 next = 1;
+    for (const std::size_t length : {30, 30, 40}) {
+        Fill(buffer, length, next);
+        next += static_cast<s16>(length);
+        Linear(state, buffer, 1.0f, frame, frame_position);
+        REQUIRE(buffer.empty());
+    }
+
+    // At a rate of 1, the output is the input delayed by two samples.
+    REQUIRE(frame_position == 100);
+    REQUIRE(frame[0][0] == 0);
+    REQUIRE(frame[1][0] == 0);
+    for (std::size_t i = 2; i < frame_position; i++) {
+        REQUIRE(frame[i][0] == static_cast<s16>(i - 1));
+        REQUIRE(frame[i][1] == static_cast<s16>(i - 1));
+    }
+}
+
+TEST_CASE("AudioInterp - Interpolates between samples", "[audio_core]") {
+    State state{};
+    StereoBuffer16 buffer;
+    StereoFrame16 frame{};
+    std::size_t frame_position = 0;
+
+    auto samples = buffer.Prepare(2);
+    samples[0] = {-1001, 1001};
+    samples[1] = {1000, -1000};
+    Linear(state, buffer, 0.5f, frame, frame_position);
+
+    // After the historical samples comes the halfway point between the last of them and the first
+    // input sample, rounded towards negative infinity.
+    REQUIRE(frame_position == 4);
+    REQUIRE(frame[2] == std::array<s16, 2>{0, 0});
+    REQUIRE(frame[3] == std::array<s16, 2>{-501, 500});
+    REQUIRE(buffer.empty());
+}
+
+TEST_CASE("AudioInterp - Polyphase passes through samples at a rate of one", "[audio_core]") {
+    State state{};
+    StereoBuffer16 buffer;
+    StereoFrame16 frame{};
+    std::size_t frame_position = 0;
+
+    Fill(buffer, 50, -20);
+    Polyphase(state, buffer, 1.0f, frame, frame_position);
+
+    REQUIRE(frame_position == 50);
+    for (std::size_t i = 2; i < frame_position; i++) {
+        REQUIRE(frame[i][0] == static_cast<s16>(i - 22));
+    }
+}
+
+TEST_CASE("AudioInterp - Polyphase keeps a constant signal constant", "[audio_core]") {
+    for (const float rate : {0.3f, 0.77f, 1.5f, 2.9f}) {
+        State state{};
+        StereoBuffer16 buffer;
+        StereoFrame16 frame{};
+        std::size_t frame_position = 0;
+
+        while (frame_position < frame.size()) {
+            auto samples = buffer.Prepare(37);
+            std::fill(samples.begin(), samples.end(), std::array<s16, 2>{-32768, 32767});
+            Polyphase(state, buffer, rate, frame, frame_position);
+        }
+
+        // Skip the outputs that still depend on the three zeroed historical samples.
+        for (std::size_t i = static_cast<std::size_t>(3 / rate) + 1; i < frame.size(); i++) {
+            REQUIRE(frame[i] == std::array<s16, 2>{-32768, 32767});
+        }
+    }
+}
+
+} // namespace AudioCore::AudioInterp
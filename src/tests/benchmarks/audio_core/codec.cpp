@@ -0,0 +1,56 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/codec.h"
+
+static constexpr std::size_t SAMPLE_COUNT = 16 * 1024;
+
+TEST_CASE("Codec", "[benchmark][audio_core]") {
+    std::vector<u8> data(SAMPLE_COUNT * 2 * sizeof(s16));
+    std::mt19937 rng{0};
+    for (auto& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+    // ADPCM frames are 8 bytes, a header (coefficient index and scale) followed by 14 nibbles.
+    for (std::size_t frame = 0; frame < data.size(); frame += 8) {
+        data[frame] = (data[frame] & 0x70) | 0x4;
+    }
+
+    const std::array<s16, 16> coeffs{0x0800, 0x0000, 0x1000, -0x0800, 0x0E00, -0x0600,
+                                     0x0C00, -0x0400, 0x0A00, -0x0200, 0x0400, 0x0200,
+                                     0x0600, 0x0000, 0x0200, 0x0400};
+
+    std::vector<std::array<s16, 2>> output(SAMPLE_COUNT);
+
+    BENCHMARK("DecodeADPCM 16384 samples") {
+        AudioCore::Codec::ADPCMState state{};
+        AudioCore::Codec::DecodeADPCM(data.data(), SAMPLE_COUNT, coeffs, state, output);
+        return output[0];
+    };
+
+    BENCHMARK("DecodePCM8 mono 16384 samples") {
+        AudioCore::Codec::DecodePCM8(1, data.data(), SAMPLE_COUNT, output);
+        return output[0];
+    };
+
+    BENCHMARK("DecodePCM8 stereo 16384 samples") {
+        AudioCore::Codec::DecodePCM8(2, data.data(), SAMPLE_COUNT, output);
+        return output[0];
+    };
+
+    BENCHMARK("DecodePCM16 mono 16384 samples") {
+        AudioCore::Codec::DecodePCM16(1, data.data(), SAMPLE_COUNT, output);
+        return output[0];
+    };
+
+    BENCHMARK("DecodePCM16 stereo 16384 samples") {
+        AudioCore::Codec::DecodePCM16(2, data.data(), SAMPLE_COUNT, output);
+        return output[0];
+    };
+}
@@ -0,0 +1,43 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/hle/hle.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/memory.h"
+
+TEST_CASE("DspHle", "[benchmark][audio_core][hle]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Core::Timing timing(1, 100);
+    AudioCore::DspHle hle(system, memory, timing);
+
+    u64 frames = 0;
+    hle.SetInterruptHandler([&frames](Service::DSP::InterruptType, AudioCore::DspPipe pipe) {
+        if (pipe == AudioCore::DspPipe::Audio) {
+            frames++;
+        }
+    });
+
+    // Initialise the audio pipe, which turns the DSP on.
+    const std::vector<u8> buffer(4, 0);
+    hle.PipeWrite(AudioCore::DspPipe::Audio, buffer);
+
+    auto* timer = timing.GetTimer(0).get();
+    timer->Advance();
+    timer->SetNextSlice();
+
+    BENCHMARK("Generate one audio frame") {
+        const u64 target = frames + 1;
+        while (frames < target) {
+            timer->AddTicks(timer->GetDowncount());
+            timer->Advance();
+            timer->SetNextSlice();
+        }
+        return frames;
+    };
+}
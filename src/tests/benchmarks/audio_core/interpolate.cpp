@@ -0,0 +1,59 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/interpolate.h"
+
+static constexpr std::size_t FRAME_COUNT = 64;
+
+TEST_CASE("AudioInterp", "[benchmark][audio_core]") {
+    using namespace AudioCore;
+
+    std::vector<std::array<s16, 2>> input(FRAME_COUNT * samples_per_frame * 2);
+    std::mt19937 rng{0};
+    for (auto& sample : input) {
+        sample = {static_cast<s16>(rng()), static_cast<s16>(rng())};
+    }
+
+    // Resamples FRAME_COUNT frames of output, decoding a guest buffer whenever one runs out.
+    const auto resample = [&](auto interpolate, float rate) {
+        AudioInterp::State state{};
+        StereoBuffer16 buffer;
+        StereoFrame16 frame{};
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < FRAME_COUNT; i++) {
+            std::size_t frame_position = 0;
+            while (frame_position < frame.size()) {
+                if (buffer.empty()) {
+                    const std::size_t length = std::min<std::size_t>(512, input.size() - offset);
+                    const auto samples = buffer.Prepare(length);
+                    std::copy_n(input.begin() + offset, length, samples.begin());
+                    offset = (offset + length) % input.size();
+                }
+                interpolate(state, buffer, rate, frame, frame_position);
+            }
+        }
+        return frame[0];
+    };
+
+    BENCHMARK("Linear upsampling") {
+        return resample(AudioInterp::Linear, 0.75f);
+    };
+
+    BENCHMARK("Polyphase upsampling") {
+        return resample(AudioInterp::Polyphase, 0.75f);
+    };
+
+    BENCHMARK("Linear decimation") {
+        return resample(AudioInterp::Linear, 1.5f);
+    };
+
+    BENCHMARK("Polyphase decimation") {
+        return resample(AudioInterp::Polyphase, 1.5f);
+    };
+}
@@ -0,0 +1,34 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "common/zstd_compression.h"
+
+TEST_CASE("ZSTD savestate compression", "[benchmark][common]") {
+    // Savestates are dominated by the emulated RAM, which is mostly zeroes with islands of
+    // code and data. Approximate that with 16 MiB holding a random 1/8th.
+    std::vector<u8> state(16 * 1024 * 1024);
+    std::mt19937 rng{0};
+    for (std::size_t block = 0; block < state.size(); block += 0x1000) {
+        if (rng() % 8 == 0) {
+            for (std::size_t i = block; i < block + 0x1000; i++) {
+                state[i] = static_cast<u8>(rng());
+            }
+        }
+    }
+
+    const std::vector<u8> compressed = Common::Compression::CompressDataZSTDDefault(state);
+    REQUIRE(Common::Compression::DecompressDataZSTD(compressed) == state);
+
+    BENCHMARK("CompressDataZSTDDefault 16 MiB") {
+        return Common::Compression::CompressDataZSTDDefault(state);
+    };
+
+    BENCHMARK("DecompressDataZSTD 16 MiB") {
+        return Common::Compression::DecompressDataZSTD(compressed);
+    };
+}
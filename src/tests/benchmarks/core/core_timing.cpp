@@ -0,0 +1,57 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core_timing.h"
+
+static constexpr std::size_t NUM_EVENT_TYPES = 32;
+
+static void AdvanceSlice(Core::Timing& timing) {
+    auto* timer = timing.GetTimer(0).get();
+    timer->AddTicks(timer->GetDowncount());
+    timer->Advance();
+    timer->SetNextSlice();
+}
+
+TEST_CASE("CoreTiming", "[benchmark][core]") {
+    Core::Timing timing(1, 100);
+
+    u64 callbacks_ran = 0;
+    std::array<Core::TimingEventType*, NUM_EVENT_TYPES> event_types{};
+    for (std::size_t i = 0; i < event_types.size(); i++) {
+        event_types[i] = timing.RegisterEvent("benchmark_event_" + std::to_string(i),
+                                              [&callbacks_ran](std::uintptr_t, int) { callbacks_ran++; });
+    }
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    BENCHMARK("ScheduleEvent + UnscheduleEvent x32") {
+        for (std::size_t i = 0; i < event_types.size(); i++) {
+            timing.ScheduleEvent(1000 + i * 100, event_types[i], i, 0);
+        }
+        for (std::size_t i = 0; i < event_types.size(); i++) {
+            timing.UnscheduleEvent(event_types[i], i);
+        }
+    };
+
+    BENCHMARK("ScheduleEvent + Advance x32") {
+        // Spread the events over a few slices so Advance pops them in order from the queue.
+        for (std::size_t i = 0; i < event_types.size(); i++) {
+            timing.ScheduleEvent(static_cast<s64>(i) * 50000, event_types[i], i, 0);
+        }
+        for (std::size_t i = 0; i < 4; i++) {
+            AdvanceSlice(timing);
+        }
+        return callbacks_ran;
+    };
+
+    BENCHMARK("Advance empty slice") {
+        AdvanceSlice(timing);
+    };
+}
@@ -0,0 +1,66 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
+#include "common/file_util.h"
+#include "core/file_sys/cia_content_writer.h"
+
+static constexpr std::size_t CONTENT_SIZE = 64 * 1024 * 1024;
+static constexpr std::size_t CHUNK_SIZE = 1024 * 1024;
+
+TEST_CASE("CIAContentWriter", "[benchmark][core][file_sys]") {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "citra_benchmarks_content.app").string();
+
+    // Synthetic encrypted content, as found after the TMD of a CIA.
+    std::vector<u8> content(CONTENT_SIZE);
+    std::mt19937 rng{0};
+    for (auto& byte : content) {
+        byte = static_cast<u8>(rng());
+    }
+    const std::array<u8, 16> key{0x01, 0x23, 0x45, 0x67};
+    const std::array<u8, 16> iv{};
+    std::array<u8, 0x20> hash;
+    CryptoPP::SHA256 sha;
+    sha.Update(content.data(), content.size());
+    sha.Final(hash.data());
+    std::vector<u8> encrypted(CONTENT_SIZE);
+    CryptoPP::CBC_Mode<CryptoPP::AES>::Encryption aes;
+    aes.SetKeyWithIV(key.data(), key.size(), iv.data());
+    aes.ProcessData(encrypted.data(), content.data(), content.size());
+
+    const auto install = [&](bool is_encrypted) {
+        std::vector<FileSys::CIAContentWriter::Content> contents;
+        contents.push_back({
+            .file = FileUtil::IOFile(path, "wb"),
+            .size = CONTENT_SIZE,
+            .key = is_encrypted ? std::optional{key} : std::nullopt,
+            .iv = iv,
+            .hash = hash,
+        });
+        const auto& data = is_encrypted ? encrypted : content;
+        FileSys::CIAContentWriter writer(std::move(contents));
+        for (std::size_t offset = 0; offset < CONTENT_SIZE; offset += CHUNK_SIZE) {
+            writer.Write(0, data.data() + offset, CHUNK_SIZE);
+        }
+        return writer.Finish();
+    };
+
+    BENCHMARK("Install 64 MiB encrypted content") {
+        return install(true);
+    };
+
+    BENCHMARK("Install 64 MiB decrypted content") {
+        return install(false);
+    };
+
+    FileUtil::Delete(path);
+}
@@ -0,0 +1,52 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/romfs_reader.h"
+
+static constexpr std::size_t ROMFS_SIZE = 16 * 1024 * 1024;
+
+TEST_CASE("DirectRomFSReader", "[benchmark][core][file_sys]") {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "citra_benchmarks_romfs.bin").string();
+    {
+        std::vector<u8> data(ROMFS_SIZE);
+        std::mt19937 rng{0};
+        for (auto& byte : data) {
+            byte = static_cast<u8>(rng());
+        }
+        FileUtil::IOFile file(path, "wb");
+        REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+    }
+
+    FileSys::DirectRomFSReader reader(FileUtil::IOFile(path, "rb"), 0, ROMFS_SIZE);
+    std::vector<u8> buffer(1024 * 1024);
+
+    BENCHMARK("ReadFile sequential 4 KiB x256") {
+        for (std::size_t i = 0; i < 256; i++) {
+            reader.ReadFile(i * 0x1000, 0x1000, buffer.data());
+        }
+        return buffer[0];
+    };
+
+    BENCHMARK("ReadFile random 512 B x256") {
+        std::mt19937 rng{0};
+        for (std::size_t i = 0; i < 256; i++) {
+            reader.ReadFile(rng() % (ROMFS_SIZE - 0x200), 0x200, buffer.data());
+        }
+        return buffer[0];
+    };
+
+    BENCHMARK("ReadFile 1 MiB") {
+        reader.ReadFile(0, buffer.size(), buffer.data());
+        return buffer[0];
+    };
+
+    FileUtil::Delete(path);
+}
@@ -0,0 +1,62 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/memory.h"
+
+static constexpr VAddr BENCHMARK_VADDR = Memory::HEAP_VADDR;
+static constexpr u32 BENCHMARK_REGION_SIZE = 0x100000;
+
+TEST_CASE("MemorySystem", "[benchmark][core][memory]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+
+    auto page_table = std::make_shared<Memory::PageTable>();
+    page_table->Clear();
+    memory.MapMemoryRegion(*page_table, BENCHMARK_VADDR, BENCHMARK_REGION_SIZE,
+                           memory.GetFCRAMRef(0));
+    memory.SetCurrentPageTable(page_table);
+
+    BENCHMARK("Read8 x4096") {
+        u32 sum = 0;
+        for (u32 offset = 0; offset < 4096; offset++) {
+            sum += memory.Read8(BENCHMARK_VADDR + offset);
+        }
+        return sum;
+    };
+
+    BENCHMARK("Read32 x4096") {
+        u32 sum = 0;
+        for (u32 offset = 0; offset < 4096 * sizeof(u32); offset += sizeof(u32)) {
+            sum += memory.Read32(BENCHMARK_VADDR + offset);
+        }
+        return sum;
+    };
+
+    BENCHMARK("Write32 x4096") {
+        for (u32 offset = 0; offset < 4096 * sizeof(u32); offset += sizeof(u32)) {
+            memory.Write32(BENCHMARK_VADDR + offset, offset);
+        }
+    };
+
+    std::vector<u8> buffer(BENCHMARK_REGION_SIZE);
+
+    BENCHMARK("ReadBlock 4 KiB") {
+        memory.ReadBlock(BENCHMARK_VADDR, buffer.data(), 0x1000);
+        return buffer[0];
+    };
+
+    BENCHMARK("ReadBlock 1 MiB") {
+        memory.ReadBlock(BENCHMARK_VADDR, buffer.data(), buffer.size());
+        return buffer[0];
+    };
+
+    BENCHMARK("WriteBlock 1 MiB") {
+        memory.WriteBlock(BENCHMARK_VADDR, buffer.data(), buffer.size());
+    };
+}
@@ -0,0 +1,180 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <boost/icl/interval_map.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+#include "video_core/rasterizer_cache/region_tracker.h"
+
+using VideoCore::SurfaceId;
+using VideoCore::SurfaceInterval;
+
+namespace {
+
+constexpr PAddr VRAM_BASE = 0x18000000;
+constexpr u32 NUM_RENDER_TARGETS = 192;
+constexpr u32 RENDER_TARGET_SIZE = 64 * 64 * 4;
+constexpr u32 NUM_FRAMES = 8;
+
+/// Operation of the rasterizer cache on its dirty regions.
+struct Operation {
+    enum class Type {
+        Draw,     ///< A surface was rendered to
+        Flush,    ///< The CPU or a display transfer read guest memory back
+        Validate, ///< A texture checked whether its memory was written by the GPU
+        Clear,    ///< The CPU wrote to guest memory
+    };
+    Type type;
+    SurfaceInterval interval;
+    SurfaceId owner;
+};
+
+/**
+ * Builds the operations of a few frames of a game rendering to many small render targets in VRAM,
+ * which are then sampled as textures and partially read back by the CPU.
+ */
+std::vector<Operation> RecordOperations() {
+    std::mt19937 rng{0};
+    std::vector<Operation> operations;
+    const auto target_interval = [](u32 index) {
+        const PAddr addr = VRAM_BASE + index * RENDER_TARGET_SIZE;
+        return SurfaceInterval{addr, addr + RENDER_TARGET_SIZE};
+    };
+    for (u32 frame = 0; frame < NUM_FRAMES; frame++) {
+        for (u32 i = 0; i < NUM_RENDER_TARGETS; i++) {
+            operations.push_back({Operation::Type::Draw, target_interval(i), SurfaceId{i + 1}});
+            const u32 texture = rng() % NUM_RENDER_TARGETS;
+            operations.push_back({Operation::Type::Validate, target_interval(texture), {}});
+            if (rng() % 4 == 0) {
+                const PAddr addr = target_interval(rng() % NUM_RENDER_TARGETS).lower() +
+                                   (rng() % RENDER_TARGET_SIZE & ~3U);
+                operations.push_back({Operation::Type::Flush, SurfaceInterval{addr, addr + 4}, {}});
+            }
+        }
+        // Display transfer of the frame out of a group of render targets, then CPU writes.
+        operations.push_back(
+            {Operation::Type::Flush, SurfaceInterval{VRAM_BASE, VRAM_BASE + 0x46000}, {}});
+        for (u32 i = 0; i < 16; i++) {
+            operations.push_back(
+                {Operation::Type::Clear, target_interval(rng() % NUM_RENDER_TARGETS), {}});
+        }
+    }
+    return operations;
+}
+
+using ReferenceMap = boost::icl::interval_map<PAddr, SurfaceId, boost::icl::partial_absorber,
+                                              std::less, boost::icl::inplace_plus,
+                                              boost::icl::inter_section, SurfaceInterval>;
+
+} // Anonymous namespace
+
+TEST_CASE("RasterizerCache dirty regions", "[benchmark][video_core]") {
+    const std::vector<Operation> operations = RecordOperations();
+
+    BENCHMARK(fmt::format("DirtyRegions replay {} operations", operations.size())) {
+        VideoCore::DirtyRegions regions;
+        std::size_t result = 0;
+        for (const Operation& op : operations) {
+            switch (op.type) {
+            case Operation::Type::Draw:
+                regions.Set(op.interval, op.owner);
+                break;
+            case Operation::Type::Flush: {
+                std::vector<SurfaceInterval> flushed;
+                for (const auto& [region, owner] : regions.Overlapping(op.interval)) {
+                    flushed.push_back(op.interval.upper() - op.interval.lower() <= 8
+                                          ? region
+                                          : region & op.interval);
+                }
+                for (const SurfaceInterval& interval : flushed) {
+                    regions.Erase(interval);
+                }
+                result += flushed.size();
+                break;
+            }
+            case Operation::Type::Validate:
+                result += regions.Contains(op.interval);
+                break;
+            case Operation::Type::Clear:
+                regions.Erase(op.interval);
+                break;
+            }
+        }
+        return result;
+    };
+
+    BENCHMARK(fmt::format("boost::icl::interval_map replay {} operations", operations.size())) {
+        ReferenceMap regions;
+        std::size_t result = 0;
+        for (const Operation& op : operations) {
+            switch (op.type) {
+            case Operation::Type::Draw:
+                regions.set({op.interval, op.owner});
+                break;
+            case Operation::Type::Flush: {
+                boost::icl::interval_set<PAddr, std::less, SurfaceInterval> flushed;
+                for (const auto& [region, owner] :
+                     boost::make_iterator_range(regions.equal_range(op.interval))) {
+                    flushed += op.interval.upper() - op.interval.lower() <= 8
+                                   ? region
+                                   : region & op.interval;
+                    result++;
+                }
+                regions -= flushed;
+                break;
+            }
+            case Operation::Type::Validate:
+                result += boost::icl::contains(regions, op.interval);
+                break;
+            case Operation::Type::Clear:
+                regions.erase(op.interval);
+                break;
+            }
+        }
+        return result;
+    };
+}
+
+TEST_CASE("RasterizerCache cached pages", "[benchmark][video_core]") {
+    // Registers and unregisters every render target, as recreating the cache does.
+    constexpr u32 PAGE_BITS = 12;
+    const auto page_range = [](u32 index) {
+        const PAddr addr = VRAM_BASE + index * RENDER_TARGET_SIZE;
+        return std::make_pair(addr >> PAGE_BITS, (addr + RENDER_TARGET_SIZE - 1 >> PAGE_BITS) + 1);
+    };
+
+    BENCHMARK(fmt::format("CachedPages {} surfaces", NUM_RENDER_TARGETS)) {
+        VideoCore::CachedPages pages;
+        u32 num_runs = 0;
+        const auto count_run = [&](u32, u32) { num_runs++; };
+        for (s32 delta : {1, -1}) {
+            for (u32 i = 0; i < NUM_RENDER_TARGETS; i++) {
+                const auto [page_start, page_end] = page_range(i);
+                pages.Update(page_start, page_end, delta, count_run);
+            }
+        }
+        return num_runs;
+    };
+
+    BENCHMARK(fmt::format("boost::icl::interval_map {} surfaces", NUM_RENDER_TARGETS)) {
+        boost::icl::interval_map<u32, int> pages;
+        u32 num_runs = 0;
+        for (s32 delta : {1, -1}) {
+            for (u32 i = 0; i < NUM_RENDER_TARGETS; i++) {
+                const auto [page_start, page_end] = page_range(i);
+                const auto interval =
+                    boost::icl::interval_map<u32, int>::interval_type::right_open(page_start,
+                                                                                  page_end);
+                pages.add({interval, delta});
+                for (const auto& pair : boost::make_iterator_range(pages.equal_range(interval))) {
+                    num_runs += pair.second == delta;
+                }
+            }
+        }
+        return num_runs;
+    };
+}
@@ -0,0 +1,95 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nihstro/inline_assembly.h>
+#include "common/arch.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/pica/shader_unit.h"
+#include "video_core/shader/shader_interpreter.h"
+#if CITRA_ARCH(x86_64)
+#include "video_core/shader/shader_jit_x64_compiler.h"
+#elif CITRA_ARCH(arm64)
+#include "video_core/shader/shader_jit_a64_compiler.h"
+#endif
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+static constexpr u32 NUM_VERTICES = 1024;
+
+/// Builds a vertex shader shaped like a typical one: a matrix transform plus attribute passthrough.
+static std::unique_ptr<Pica::ShaderSetup> CompileVertexShader() {
+    const auto v0 = SourceRegister::MakeInput(0);
+    const auto v1 = SourceRegister::MakeInput(1);
+    const auto v2 = SourceRegister::MakeInput(2);
+    const auto r0 = SourceRegister::MakeTemporary(0);
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary({
+        // clang-format off
+        {OpCode::Id::DP4, DestRegister::MakeTemporary(0), v0, SourceRegister::MakeFloat(0)},
+        {OpCode::Id::DP4, DestRegister::MakeTemporary(1), v0, SourceRegister::MakeFloat(1)},
+        {OpCode::Id::DP4, DestRegister::MakeTemporary(2), v0, SourceRegister::MakeFloat(2)},
+        {OpCode::Id::DP4, DestRegister::MakeTemporary(3), v0, SourceRegister::MakeFloat(3)},
+        {OpCode::Id::MUL, DestRegister::MakeOutput(0), r0, SourceRegister::MakeFloat(4)},
+        {OpCode::Id::MUL, DestRegister::MakeTemporary(4), v1, SourceRegister::MakeFloat(5)},
+        {OpCode::Id::ADD, DestRegister::MakeOutput(1), SourceRegister::MakeTemporary(4),
+                          SourceRegister::MakeFloat(6)},
+        {OpCode::Id::MOV, DestRegister::MakeOutput(2), v2},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    auto shader = std::make_unique<Pica::ShaderSetup>();
+    std::transform(shbin.program.begin(), shbin.program.end(), shader->program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   shader->swizzle_data.begin(), [](const auto& x) { return x.hex; });
+    for (u32 i = 0; i < 7; i++) {
+        shader->uniforms.f[i] = Common::Vec4<Pica::f24>::AssignToAll(Pica::f24::FromFloat32(0.5f));
+    }
+    return shader;
+}
+
+static void SetInputs(Pica::ShaderUnit& shader_unit, u32 vertex) {
+    const auto value = Pica::f24::FromFloat32(static_cast<float>(vertex));
+    for (u32 i = 0; i < 3; i++) {
+        shader_unit.input[i] = Common::Vec4<Pica::f24>::AssignToAll(value);
+    }
+}
+
+TEST_CASE("Vertex shader", "[benchmark][video_core][shader]") {
+    const auto shader_setup = CompileVertexShader();
+    Pica::ShaderUnit shader_unit;
+
+    Pica::Shader::InterpreterEngine interpreter;
+    BENCHMARK("InterpreterEngine 1024 vertices") {
+        for (u32 vertex = 0; vertex < NUM_VERTICES; vertex++) {
+            SetInputs(shader_unit, vertex);
+            interpreter.Run(*shader_setup, shader_unit);
+        }
+        return shader_unit.output[0].x.ToFloat32();
+    };
+
+#if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
+    BENCHMARK("JitShader compile") {
+        auto jit = std::make_unique<Pica::Shader::JitShader>();
+        jit->Compile(&shader_setup->program_code, &shader_setup->swizzle_data);
+        return jit;
+    };
+
+    Pica::Shader::JitShader jit;
+    jit.Compile(&shader_setup->program_code, &shader_setup->swizzle_data);
+    BENCHMARK("JitShader 1024 vertices") {
+        for (u32 vertex = 0; vertex < NUM_VERTICES; vertex++) {
+            SetInputs(shader_unit, vertex);
+            jit.Run(*shader_setup, shader_unit, 0);
+        }
+        return shader_unit.output[0].x.ToFloat32();
+    };
+#endif
+}
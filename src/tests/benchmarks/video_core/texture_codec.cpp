@@ -0,0 +1,62 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+#include "video_core/rasterizer_cache/pixel_format.h"
+#include "video_core/rasterizer_cache/surface_params.h"
+#include "video_core/rasterizer_cache/utils.h"
+
+using VideoCore::PixelFormat;
+
+static constexpr u32 TEXTURE_SIZE = 256;
+
+static VideoCore::SurfaceParams MakeSurface(PixelFormat format) {
+    VideoCore::SurfaceParams params;
+    params.addr = 0;
+    params.width = TEXTURE_SIZE;
+    params.height = TEXTURE_SIZE;
+    params.stride = TEXTURE_SIZE;
+    params.is_tiled = true;
+    params.pixel_format = format;
+    params.UpdateParams();
+    return params;
+}
+
+TEST_CASE("Texture codec", "[benchmark][video_core]") {
+    // Large enough for any format, decoded textures are at most RGBA8.
+    std::vector<u8> tiled(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+    std::vector<u8> linear(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+    std::mt19937 rng{0};
+    for (auto& byte : tiled) {
+        byte = static_cast<u8>(rng());
+    }
+
+    for (u32 i = 0; i < VideoCore::PIXEL_FORMAT_COUNT; i++) {
+        const auto format = static_cast<PixelFormat>(i);
+        if (VideoCore::GetFormatType(format) == VideoCore::SurfaceType::Invalid) {
+            continue;
+        }
+        const auto params = MakeSurface(format);
+        const auto name = VideoCore::PixelFormatAsString(format);
+
+        BENCHMARK(fmt::format("DecodeTexture {} {}x{} tiled", name, TEXTURE_SIZE, TEXTURE_SIZE)) {
+            VideoCore::DecodeTexture(params, params.addr, params.end, tiled, linear);
+            return linear[0];
+        };
+
+        // There are no encoders for the compressed formats, they are only ever sampled.
+        if (format == PixelFormat::ETC1 || format == PixelFormat::ETC1A4) {
+            continue;
+        }
+
+        BENCHMARK(fmt::format("EncodeTexture {} {}x{} tiled", name, TEXTURE_SIZE, TEXTURE_SIZE)) {
+            VideoCore::EncodeTexture(params, params.addr, params.end, linear, tiled);
+            return tiled[0];
+        };
+    }
+}
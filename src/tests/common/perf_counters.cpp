@@ -0,0 +1,42 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include "common/perf_counters.h"
+
+namespace Common::Perf {
+
+static CounterValue FindCounter(std::string_view name) {
+    const auto counters = GetCounters();
+    const auto it = std::find_if(counters.begin(), counters.end(), [name](const auto& counter) {
+        return counter.name == name;
+    });
+    REQUIRE(it != counters.end());
+    return *it;
+}
+
+TEST_CASE("PerfCounters: Registering a name twice returns the same counter", "[common]") {
+    const CounterId id = RegisterCounter("Test registration");
+    REQUIRE(RegisterCounter("Test registration") == id);
+    REQUIRE(RegisterCounter("Test registration 2") != id);
+}
+
+TEST_CASE("PerfCounters: Frame deltas", "[common]") {
+    const Counter counter{"Test frame deltas"};
+    EndFrame();
+
+    counter.Add(3);
+    REQUIRE(FindCounter("Test frame deltas").last_frame == 0);
+    EndFrame();
+    REQUIRE(FindCounter("Test frame deltas").last_frame == 3);
+
+    counter.Add();
+    EndFrame();
+    const CounterValue value = FindCounter("Test frame deltas");
+    REQUIRE(value.total == 4);
+    REQUIRE(value.last_frame == 1);
+}
+
+} // namespace Common::Perf
@@ -0,0 +1,75 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include "common/thread_pool.h"
+
+namespace Common {
+
+TEST_CASE("ThreadPool: A single worker waiting on its own tasks does not deadlock", "[common]") {
+    std::atomic<int> inner_runs{};
+    ThreadPool pool{1, "Test"};
+    TaskGroup outer;
+
+    pool.Submit(
+        [&] {
+            // The inner tasks land behind this one in the only deque of the pool.
+            TaskGroup inner;
+            for (int i = 0; i < 4; i++) {
+                pool.Submit([&] { inner_runs++; }, inner);
+            }
+            inner.Wait();
+        },
+        outer);
+    outer.Wait();
+
+    REQUIRE(inner_runs == 4);
+}
+
+TEST_CASE("ThreadPool: Waiting only runs tasks of the waited group", "[common]") {
+    std::atomic<bool> started{};
+    std::atomic<bool> release{};
+    std::atomic<bool> other_ran{};
+    ThreadPool pool{1, "Test"};
+    TaskGroup blocker_group;
+    TaskGroup other_group;
+    TaskGroup group;
+
+    // Keep the worker busy so that every other task stays queued.
+    pool.Submit(
+        [&] {
+            started = true;
+            while (!release) {
+            }
+        },
+        blocker_group);
+    while (!started) {
+    }
+    pool.Submit([&] { other_ran = true; }, other_group);
+    int runs = 0;
+    pool.Submit([&] { runs++; }, group);
+    group.Wait();
+    const bool ran_other_group = other_ran;
+    release = true;
+
+    REQUIRE(runs == 1);
+    REQUIRE(!ran_other_group);
+}
+
+TEST_CASE("ThreadPool: Destruction completes the queued tasks", "[common]") {
+    std::atomic<int> runs{};
+    TaskGroup group;
+    {
+        ThreadPool pool{1, "Test"};
+        for (int i = 0; i < 64; i++) {
+            pool.Submit([&] { runs++; }, group);
+        }
+    }
+
+    REQUIRE(group.IsDone());
+    REQUIRE(runs == 64);
+}
+
+} // namespace Common
@@ -0,0 +1,94 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
+#include "common/file_util.h"
+#include "core/file_sys/cia_content_writer.h"
+
+namespace FileSys {
+
+namespace {
+constexpr std::array<u8, 16> TestKey{0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+                                     0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10};
+constexpr std::array<u8, 16> TestIV{0x00, 0x01};
+
+std::vector<u8> MakeContent(std::size_t size) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; i++) {
+        data[i] = static_cast<u8>(i * 7);
+    }
+    return data;
+}
+
+std::array<u8, 0x20> Hash(const std::vector<u8>& data) {
+    std::array<u8, 0x20> hash;
+    CryptoPP::SHA256 sha;
+    sha.Update(data.data(), data.size());
+    sha.Final(hash.data());
+    return hash;
+}
+
+std::vector<u8> Encrypt(const std::vector<u8>& data) {
+    std::vector<u8> encrypted(data.size());
+    CryptoPP::CBC_Mode<CryptoPP::AES>::Encryption aes;
+    aes.SetKeyWithIV(TestKey.data(), TestKey.size(), TestIV.data());
+    aes.ProcessData(encrypted.data(), data.data(), data.size());
+    return encrypted;
+}
+
+std::string ReadHostFile(const std::string& path) {
+    std::string contents;
+    FileUtil::ReadFileToString(true, path, contents);
+    return contents;
+}
+} // Anonymous namespace
+
+TEST_CASE("CIAContentWriter - Decrypts and verifies contents", "[core][file_sys]") {
+    const std::string path = "./cia_content_writer_test.app";
+    const auto content = MakeContent(0x3000);
+    const auto encrypted = Encrypt(content);
+
+    std::vector<CIAContentWriter::Content> contents;
+    contents.push_back({
+        .file = FileUtil::IOFile(path, "wb"),
+        .size = content.size(),
+        .key = TestKey,
+        .iv = TestIV,
+        .hash = Hash(content),
+    });
+    CIAContentWriter writer(std::move(contents));
+    writer.Write(0, encrypted.data(), 0x1000);
+    writer.Write(0, encrypted.data() + 0x1000, 0x2000);
+    REQUIRE(writer.Finish());
+    REQUIRE(ReadHostFile(path) == std::string(content.begin(), content.end()));
+
+    FileUtil::Delete(path);
+}
+
+TEST_CASE("CIAContentWriter - Rejects contents not matching the TMD", "[core][file_sys]") {
+    const std::string path = "./cia_content_writer_test.app";
+    const auto content = MakeContent(0x1000);
+
+    std::vector<CIAContentWriter::Content> contents;
+    contents.push_back({
+        .file = FileUtil::IOFile(path, "wb"),
+        .size = content.size(),
+        .key = std::nullopt,
+        .iv = {},
+        .hash = {},
+    });
+    CIAContentWriter writer(std::move(contents));
+    writer.Write(0, content.data(), content.size());
+    REQUIRE(!writer.Finish());
+
+    FileUtil::Delete(path);
+}
+
+} // namespace FileSys
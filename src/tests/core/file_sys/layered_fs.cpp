@@ -0,0 +1,157 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/layered_fs.h"
+
+namespace FileSys {
+
+namespace {
+using FileEntry = std::pair<std::string, std::string>;
+
+class MemoryRomFSReader : public RomFSReader {
+public:
+    explicit MemoryRomFSReader(std::vector<u8> data_) : data(std::move(data_)) {}
+
+    std::size_t GetSize() const override {
+        return data.size();
+    }
+
+    std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) override {
+        if (offset >= data.size()) {
+            return 0;
+        }
+        length = std::min(length, data.size() - offset);
+        std::memcpy(buffer, data.data() + offset, length);
+        return length;
+    }
+
+    bool AllowsCachedReads() const override {
+        return false;
+    }
+
+    bool CacheReady(std::size_t file_offset, std::size_t length) override {
+        return false;
+    }
+
+private:
+    std::vector<u8> data;
+};
+
+template <typename T>
+void Write(std::vector<u8>& image, std::size_t offset, T value) {
+    std::memcpy(image.data() + offset, &value, sizeof(value));
+}
+
+template <typename T>
+T Read(RomFSReader& romfs, std::size_t offset) {
+    T value{};
+    romfs.ReadFile(offset, sizeof(value), reinterpret_cast<u8*>(&value));
+    return value;
+}
+
+/// Builds a RomFS with a root directory that holds a single file, with a 5 character name.
+std::vector<u8> BuildRomFS(const std::string& file_name, const std::string& contents) {
+    constexpr u32 directory_metadata_offset = 0x2C;
+    constexpr u32 file_metadata_offset = 0x48;
+    constexpr u32 file_data_offset = 0x80;
+
+    std::vector<u8> image(file_data_offset + contents.size(), 0xFF);
+    RomFSHeader header{};
+    header.header_length = sizeof(RomFSHeader);
+    header.directory_hash_table = {0x28, 4};
+    header.directory_metadata_table = {directory_metadata_offset, 0x18};
+    header.file_hash_table = {0x44, 4};
+    header.file_metadata_table = {file_metadata_offset, 0x2C};
+    header.file_data_offset = file_data_offset;
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    // Root directory
+    Write<u32_le>(image, directory_metadata_offset + 0x00, 0);          // parent
+    Write<u32_le>(image, directory_metadata_offset + 0x0C, 0);          // first file
+    Write<u32_le>(image, directory_metadata_offset + 0x14, 0);          // name length
+    Write<u32_le>(image, file_metadata_offset + 0x00, 0);               // parent
+    Write<u64_le>(image, file_metadata_offset + 0x08, 0);               // data offset
+    Write<u64_le>(image, file_metadata_offset + 0x10, contents.size()); // data length
+    Write<u32_le>(image, file_metadata_offset + 0x1C, 10);              // name length
+    for (std::size_t i = 0; i < 5; i++) {
+        Write<u16_le>(image, file_metadata_offset + 0x20 + i * 2, file_name[i]);
+    }
+    std::memcpy(image.data() + file_data_offset, contents.data(), contents.size());
+    return image;
+}
+
+/// Reads the name and the contents of the first file of the rebuilt RomFS.
+FileEntry ReadFirstFile(RomFSReader& romfs) {
+    const auto header = Read<RomFSHeader>(romfs, 0);
+    const u32 metadata = header.file_metadata_table.offset;
+    const auto data_offset = Read<u64_le>(romfs, metadata + 0x08);
+    const auto data_length = Read<u64_le>(romfs, metadata + 0x10);
+    const auto name_length = Read<u32_le>(romfs, metadata + 0x1C);
+
+    std::string name;
+    for (u32 i = 0; i < name_length; i += 2) {
+        name += static_cast<char>(Read<u16_le>(romfs, metadata + 0x20 + i));
+    }
+    std::string contents(data_length, '\0');
+    romfs.ReadFile(header.file_data_offset + data_offset, contents.size(),
+                   reinterpret_cast<u8*>(contents.data()));
+    return {name, contents};
+}
+} // Anonymous namespace
+
+TEST_CASE("LayeredFS - The cache is reused until the RomFS layout changes", "[core][file_sys]") {
+    const std::string test_dir = "./layered_fs_test";
+    const std::string cache_dir = test_dir + "/cache";
+    const std::string patch_dir = test_dir + "/romfs/";
+    FileUtil::CreateFullPath(cache_dir + "/");
+    FileUtil::CreateFullPath(patch_dir);
+    FileUtil::WriteStringToFile(false, patch_dir + "a.bin", "replaced");
+    const std::string old_cache_dir = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir);
+    FileUtil::UpdateUserPath(FileUtil::UserPath::CacheDir, cache_dir);
+
+    const auto original = BuildRomFS("a.bin", "original");
+    {
+        LayeredFS layered_fs(std::make_shared<MemoryRomFSReader>(original), patch_dir, "");
+        REQUIRE(ReadFirstFile(layered_fs) == FileEntry{"a.bin", "replaced"});
+    }
+
+    std::vector<std::filesystem::path> cache_files;
+    for (const auto& entry : std::filesystem::directory_iterator(cache_dir + "/layered_fs")) {
+        cache_files.push_back(entry.path());
+    }
+    REQUIRE(cache_files.size() == 1);
+    const auto& cache_file = cache_files.front();
+    const auto stale_time = std::filesystem::file_time_type{} + std::chrono::hours{24};
+
+    // The same RomFS and patches are loaded from the cache, which is left as is.
+    std::filesystem::last_write_time(cache_file, stale_time);
+    {
+        LayeredFS layered_fs(std::make_shared<MemoryRomFSReader>(original), patch_dir, "");
+        REQUIRE(ReadFirstFile(layered_fs) == FileEntry{"a.bin", "replaced"});
+    }
+    REQUIRE(std::filesystem::last_write_time(cache_file) == stale_time);
+
+    // A RomFS with the same header and size, but another file name, is rebuilt.
+    {
+        LayeredFS layered_fs(
+            std::make_shared<MemoryRomFSReader>(BuildRomFS("b.bin", "original")), patch_dir, "");
+        REQUIRE(ReadFirstFile(layered_fs) == FileEntry{"b.bin", "original"});
+    }
+    REQUIRE(std::filesystem::last_write_time(cache_file) != stale_time);
+
+    FileUtil::UpdateUserPath(FileUtil::UserPath::CacheDir, old_cache_dir);
+    FileUtil::DeleteDirRecursively(test_dir);
+}
+
+} // namespace FileSys
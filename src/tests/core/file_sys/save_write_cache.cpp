@@ -0,0 +1,126 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/save_write_cache.h"
+
+namespace FileSys {
+
+static std::string ReadHostFile(const std::string& path) {
+    std::string contents;
+    FileUtil::ReadFileToString(false, path, contents);
+    return contents;
+}
+
+TEST_CASE("SaveWriteCache - Writes are written back on commit", "[core][file_sys]") {
+    const std::string test_dir = "./save_write_cache_test";
+    const std::string path = test_dir + "/file";
+    FileUtil::CreateDir(test_dir);
+    FileUtil::WriteStringToFile(false, path, "0123456789");
+
+    auto& cache = SaveWriteCache::Instance();
+    auto entry = cache.Open(path);
+    REQUIRE(entry != nullptr);
+    REQUIRE(cache.GetSize(*entry) == 10);
+
+    const std::array<u8, 2> data{'a', 'b'};
+    cache.Write(*entry, 2, data.size(), false, data.data());
+    cache.Write(*entry, 10, data.size(), false, data.data());
+
+    // Handles of the same file share the pending modifications.
+    auto other_entry = cache.Open(path);
+    REQUIRE(other_entry == entry);
+    std::array<u8, 4> read{};
+    REQUIRE(cache.Read(*other_entry, 1, read.size(), read.data()) == read.size());
+    REQUIRE(read == std::array<u8, 4>{'1', 'a', 'b', '4'});
+    REQUIRE(ReadHostFile(path) == "0123456789");
+
+    REQUIRE(cache.Commit(*entry));
+    REQUIRE(ReadHostFile(path) == "01ab456789ab");
+    REQUIRE(!FileUtil::Exists(path + ".tmp"));
+
+    FileUtil::DeleteDirRecursively(test_dir);
+}
+
+TEST_CASE("SaveWriteCache - Discarded files are not written back", "[core][file_sys]") {
+    const std::string test_dir = "./save_write_cache_test";
+    const std::string path = test_dir + "/file";
+    FileUtil::CreateDir(test_dir);
+    FileUtil::WriteStringToFile(false, path, "0123");
+
+    auto& cache = SaveWriteCache::Instance();
+    auto entry = cache.Open(path);
+    REQUIRE(entry != nullptr);
+    const std::array<u8, 1> data{'x'};
+    cache.Write(*entry, 0, data.size(), true, data.data());
+
+    cache.Discard(test_dir);
+    FileUtil::Delete(path);
+    REQUIRE(cache.Commit(*entry));
+    REQUIRE(!FileUtil::Exists(path));
+
+    FileUtil::DeleteDirRecursively(test_dir);
+}
+
+TEST_CASE("SaveWriteCache - Renamed files keep being written back", "[core][file_sys]") {
+    const std::string test_dir = "./save_write_cache_test";
+    const std::string src_path = test_dir + "/src";
+    const std::string dest_path = test_dir + "/dest";
+    FileUtil::CreateDir(test_dir);
+    FileUtil::WriteStringToFile(false, src_path, "src");
+    FileUtil::WriteStringToFile(false, dest_path, "dest");
+
+    auto& cache = SaveWriteCache::Instance();
+    auto src_entry = cache.Open(src_path);
+    auto dest_entry = cache.Open(dest_path);
+    REQUIRE(src_entry != nullptr);
+    REQUIRE(dest_entry != nullptr);
+    const std::array<u8, 1> data{'x'};
+
+    // A failed rename leaves the open files as they were.
+    REQUIRE(!cache.Rename(test_dir + "/missing", test_dir + "/other"));
+    cache.Write(*src_entry, 0, data.size(), false, data.data());
+    REQUIRE(cache.Commit(*src_entry));
+    REQUIRE(ReadHostFile(src_path) == "xrc");
+
+    REQUIRE(cache.Rename(src_path, dest_path));
+    REQUIRE(!FileUtil::Exists(src_path));
+    REQUIRE(ReadHostFile(dest_path) == "xrc");
+
+    // The replaced file is not written back over the renamed one.
+    cache.Write(*dest_entry, 0, data.size(), true, data.data());
+    REQUIRE(cache.Commit(*dest_entry));
+    REQUIRE(ReadHostFile(dest_path) == "xrc");
+
+    // The renamed file is written back at its new path, and shared by new handles.
+    cache.Write(*src_entry, 1, data.size(), false, data.data());
+    REQUIRE(cache.Commit(*src_entry));
+    REQUIRE(ReadHostFile(dest_path) == "xxc");
+    REQUIRE(!FileUtil::Exists(src_path));
+    REQUIRE(cache.Open(dest_path) == src_entry);
+
+    FileUtil::DeleteDirRecursively(test_dir);
+}
+
+TEST_CASE("SaveWriteCache - Interrupted write backs are recovered", "[core][file_sys]") {
+    const std::string test_dir = "./save_write_cache_test";
+    const std::string path = test_dir + "/file";
+    FileUtil::CreateDir(test_dir);
+    // The original was removed, but its replacement was not moved into place yet.
+    FileUtil::WriteStringToFile(false, path + ".tmp", "new");
+
+    auto& cache = SaveWriteCache::Instance();
+    auto entry = cache.Open(path);
+    REQUIRE(entry != nullptr);
+    REQUIRE(cache.GetSize(*entry) == 3);
+    REQUIRE(ReadHostFile(path) == "new");
+    REQUIRE(!FileUtil::Exists(path + ".tmp"));
+
+    FileUtil::DeleteDirRecursively(test_dir);
+}
+
+} // namespace FileSys
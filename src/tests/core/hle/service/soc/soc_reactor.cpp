@@ -0,0 +1,127 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <future>
+#include <catch2/catch_test_macros.hpp>
+#include "core/hle/service/soc/soc_reactor.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace Service::SOC {
+
+namespace {
+using namespace std::chrono_literals;
+
+/// Loopback datagram socket bound to an ephemeral port.
+struct LoopbackSocket {
+    LoopbackSocket() {
+#ifdef _WIN32
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+        fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t addr_len = sizeof(addr);
+        REQUIRE(::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+        REQUIRE(::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0);
+        REQUIRE(SocketReactor::SetNonBlocking(fd) == 0);
+    }
+
+    ~LoopbackSocket() {
+#ifdef _WIN32
+        closesocket(fd);
+        WSACleanup();
+#else
+        close(fd);
+#endif
+    }
+
+    void SendTo(const LoopbackSocket& other) const {
+        const char byte = 'x';
+        ::sendto(fd, &byte, 1, 0, reinterpret_cast<const sockaddr*>(&other.addr),
+                 sizeof(other.addr));
+    }
+
+    bool Receive() const {
+        char byte;
+        return ::recv(fd, &byte, 1, 0) == 1;
+    }
+
+    SocketReactor::SocketFd fd;
+    sockaddr_in addr{};
+};
+} // Anonymous namespace
+
+TEST_CASE("SocketReactor - Completes waits once the socket is ready", "[core][soc]") {
+    LoopbackSocket server;
+    LoopbackSocket client;
+    SocketReactor reactor;
+
+    std::promise<SocketReactor::WaitResult> completed;
+    SocketReactor::WaitResult last_result{};
+    REQUIRE(!server.Receive());
+    reactor.Wait(
+        {{server.fd, POLLIN, 0}}, std::chrono::nanoseconds(-1),
+        [&](std::span<const SocketReactor::PollEntry> entries, SocketReactor::WaitResult result) {
+            last_result = result;
+            return server.Receive();
+        },
+        [&] { completed.set_value(last_result); });
+
+    client.SendTo(server);
+    auto future = completed.get_future();
+    REQUIRE(future.wait_for(5s) == std::future_status::ready);
+    REQUIRE(future.get() == SocketReactor::WaitResult::Ready);
+}
+
+TEST_CASE("SocketReactor - Times out waits", "[core][soc]") {
+    LoopbackSocket server;
+    SocketReactor reactor;
+
+    std::promise<SocketReactor::WaitResult> completed;
+    SocketReactor::WaitResult last_result{};
+    reactor.Wait(
+        {{server.fd, POLLIN, 0}}, 10ms,
+        [&](std::span<const SocketReactor::PollEntry> entries, SocketReactor::WaitResult result) {
+            last_result = result;
+            return server.Receive();
+        },
+        [&] { completed.set_value(last_result); });
+
+    auto future = completed.get_future();
+    REQUIRE(future.wait_for(5s) == std::future_status::ready);
+    REQUIRE(future.get() == SocketReactor::WaitResult::TimedOut);
+}
+
+TEST_CASE("SocketReactor - Cancels the waits of a socket", "[core][soc]") {
+    LoopbackSocket server;
+    SocketReactor reactor;
+
+    bool completed = false;
+    SocketReactor::WaitResult last_result{};
+    reactor.Wait(
+        {{server.fd, POLLIN, 0}}, std::chrono::nanoseconds(-1),
+        [&](std::span<const SocketReactor::PollEntry> entries, SocketReactor::WaitResult result) {
+            last_result = result;
+            return server.Receive();
+        },
+        [&] { completed = true; });
+
+    reactor.Cancel(server.fd);
+    REQUIRE(completed);
+    REQUIRE(last_result == SocketReactor::WaitResult::Cancelled);
+}
+
+} // namespace Service::SOC
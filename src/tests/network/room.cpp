@@ -0,0 +1,210 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include "enet/enet.h"
+#include "network/packet.h"
+#include "network/room.h"
+#include "network/room_member.h"
+#include "network/verify_user.h"
+
+namespace {
+
+/// A bare ENet client that joins a room the same way RoomMember does and exchanges wifi frames.
+class SimulatedMember {
+public:
+    SimulatedMember(u16 port, const std::string& nickname) {
+        host = enet_host_create(nullptr, 1, Network::NumChannels, 0, 0);
+        REQUIRE(host != nullptr);
+
+        ENetAddress address{};
+        enet_address_set_host(&address, "127.0.0.1");
+        address.port = port;
+        peer = enet_host_connect(host, &address, Network::NumChannels, 0);
+        REQUIRE(peer != nullptr);
+
+        ENetEvent event;
+        REQUIRE(enet_host_service(host, &event, 5000) > 0);
+        REQUIRE(event.type == ENET_EVENT_TYPE_CONNECT);
+
+        Network::Packet packet;
+        packet << static_cast<u8>(Network::IdJoinRequest);
+        packet << nickname;
+        packet << "console-" + nickname;
+        packet << Network::NoPreferredMac;
+        packet << Network::network_version;
+        packet << std::string{}; // Password
+        packet << std::string{}; // Token
+        Send(packet);
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (enet_host_service(host, &event, 10) <= 0 || event.type != ENET_EVENT_TYPE_RECEIVE) {
+                continue;
+            }
+            const u8 type = event.packet->data[0];
+            if (type == Network::IdJoinSuccess || type == Network::IdJoinSuccessAsMod) {
+                Network::Packet response;
+                response.Append(event.packet->data, event.packet->dataLength);
+                response.IgnoreBytes(sizeof(u8));
+                response >> mac_address;
+                joined = true;
+            }
+            enet_packet_destroy(event.packet);
+            if (joined) {
+                break;
+            }
+        }
+        REQUIRE(joined);
+    }
+
+    ~SimulatedMember() {
+        enet_peer_disconnect_now(peer, 0);
+        enet_host_destroy(host);
+    }
+
+    void SendWifiFrame(const Network::MacAddress& destination, std::size_t payload_size) {
+        Network::Packet packet;
+        packet << static_cast<u8>(Network::IdWifiPacket);
+        packet << static_cast<u8>(Network::WifiPacket::PacketType::Data);
+        packet << static_cast<u8>(1); // Channel
+        packet << mac_address;
+        packet << destination;
+        packet << std::vector<u8>(payload_size, 0xA5);
+        Send(packet);
+    }
+
+    /// Services the connection for at most timeout_ms and returns the wifi frames received.
+    std::size_t ReceiveWifiFrames(u32 timeout_ms) {
+        std::size_t received = 0;
+        ENetEvent event;
+        if (enet_host_service(host, &event, timeout_ms) <= 0) {
+            return received;
+        }
+        do {
+            if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+                if (event.packet->data[0] == Network::IdWifiPacket) {
+                    ++received;
+                }
+                enet_packet_destroy(event.packet);
+            }
+        } while (enet_host_check_events(host, &event) > 0);
+        return received;
+    }
+
+    Network::MacAddress mac_address{};
+
+private:
+    void Send(const Network::Packet& packet) {
+        ENetPacket* enet_packet =
+            enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+        enet_peer_send(peer, 0, enet_packet);
+        enet_host_flush(host);
+    }
+
+    ENetHost* host = nullptr;
+    ENetPeer* peer = nullptr;
+    bool joined = false;
+};
+
+/// Creates a room on loopback together with num_members joined members.
+struct RoomFixture {
+    explicit RoomFixture(std::size_t num_members) {
+        REQUIRE(enet_initialize() == 0);
+        // Port 0 lets the system pick a free port, so that concurrent test runs do not conflict.
+        REQUIRE(room.Create("test", "", "127.0.0.1", 0, "", static_cast<u32>(num_members), "", "",
+                            0, std::make_unique<Network::VerifyUser::NullBackend>()));
+        const u16 port = room.GetRoomInformation().port;
+        REQUIRE(port != 0);
+        for (std::size_t i = 0; i < num_members; ++i) {
+            members.push_back(std::make_unique<SimulatedMember>(port, fmt::format("member{}", i)));
+        }
+    }
+
+    ~RoomFixture() {
+        members.clear();
+        room.Destroy();
+        enet_deinitialize();
+    }
+
+    /// Services all members until total frames were received or the timeout expired.
+    std::vector<std::size_t> ReceiveAll(std::size_t total, std::chrono::milliseconds timeout) {
+        std::vector<std::size_t> received(members.size());
+        std::size_t received_total = 0;
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (received_total < total && std::chrono::steady_clock::now() < deadline) {
+            for (std::size_t i = 0; i < members.size(); ++i) {
+                const std::size_t count = members[i]->ReceiveWifiFrames(1);
+                received[i] += count;
+                received_total += count;
+            }
+        }
+        return received;
+    }
+
+    Network::Room room;
+    std::vector<std::unique_ptr<SimulatedMember>> members;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("Room relays unicast wifi frames to the destination only", "[network][room]") {
+    RoomFixture fixture(3);
+    auto& members = fixture.members;
+
+    members[0]->SendWifiFrame(members[1]->mac_address, 64);
+
+    // Wait long enough for a misrouted frame to show up as well.
+    const auto received = fixture.ReceiveAll(2, std::chrono::milliseconds(500));
+    REQUIRE(received[0] == 0);
+    REQUIRE(received[1] == 1);
+    REQUIRE(received[2] == 0);
+}
+
+TEST_CASE("Room relays broadcast wifi frames to everyone but the sender", "[network][room]") {
+    RoomFixture fixture(3);
+    auto& members = fixture.members;
+
+    members[0]->SendWifiFrame(Network::BroadcastMac, 64);
+
+    // Wait long enough for a frame echoed back to the sender to show up as well.
+    const auto received = fixture.ReceiveAll(3, std::chrono::milliseconds(500));
+    REQUIRE(received[0] == 0);
+    REQUIRE(received[1] == 1);
+    REQUIRE(received[2] == 1);
+}
+
+TEST_CASE("Room wifi relay load test", "[.][network][room][load]") {
+    constexpr std::size_t NumMembers = 16;
+    constexpr std::size_t FramesPerMember = 500;
+    constexpr std::size_t PayloadSize = 512;
+
+    RoomFixture fixture(NumMembers);
+    auto& members = fixture.members;
+
+    // Every member streams unicast frames to its neighbour, like a local wireless session.
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t frame = 0; frame < FramesPerMember; ++frame) {
+        for (std::size_t i = 0; i < NumMembers; ++i) {
+            members[i]->SendWifiFrame(members[(i + 1) % NumMembers]->mac_address, PayloadSize);
+        }
+    }
+    const auto received =
+        fixture.ReceiveAll(NumMembers * FramesPerMember, std::chrono::seconds(60));
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    std::size_t total = 0;
+    for (const std::size_t count : received) {
+        total += count;
+    }
+    fmt::print("Relayed {} frames between {} members in {:.3f} s ({:.0f} frames/s)\n", total,
+               NumMembers, elapsed.count(), total / elapsed.count());
+    REQUIRE(total == NumMembers * FramesPerMember);
+}
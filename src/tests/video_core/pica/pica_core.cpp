@@ -0,0 +1,88 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/memory.h"
+#include "video_core/pica/pica_core.h"
+#include "video_core/renderer_software/sw_rasterizer.h"
+
+namespace {
+
+constexpr PAddr CMD_LIST_ADDR = Memory::FCRAM_PADDR;
+
+/// Encodes a command writing the given values, starting at register id.
+void AddCommand(std::vector<u32>& list, u32 id, u32 mask, std::vector<u32> values,
+                bool group = false) {
+    const u32 extra = static_cast<u32>(values.size() - 1);
+    list.push_back(values[0]);
+    list.push_back(id | (mask << 16) | (extra << 20) | (u32{group} << 31));
+    list.insert(list.end(), values.begin() + 1, values.end());
+    if (list.size() % 2 != 0) {
+        list.push_back(0);
+    }
+}
+
+struct PicaFixture {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Pica::PicaCore pica{memory, nullptr};
+    SwRenderer::RasterizerSoftware rasterizer{memory, pica};
+
+    PicaFixture() {
+        pica.BindRasterizer(&rasterizer);
+    }
+
+    void Run(const std::vector<u32>& list) {
+        std::memcpy(memory.GetFCRAMPointer(0), list.data(), list.size() * sizeof(u32));
+        pica.ProcessCmdList(CMD_LIST_ADDR, static_cast<u32>(list.size() * sizeof(u32)));
+    }
+};
+
+} // Anonymous namespace
+
+TEST_CASE("PicaCore command list decoding", "[video_core][pica]") {
+    PicaFixture fixture;
+    auto& pica = fixture.pica;
+    const u32 viewport_x = PICA_REG_INDEX(rasterizer.viewport_size_x);
+    const u32 program_offset = PICA_REG_INDEX(vs.program.offset);
+    const u32 program_word = PICA_REG_INDEX(vs.program.set_word[0]);
+
+    std::vector<u32> list;
+    // Consecutive masked writes to a register are combined byte by byte.
+    AddCommand(list, viewport_x, 0xF, {0x11223344});
+    AddCommand(list, viewport_x, 0x3, {0xAABBCCDD, 0x00005566});
+    // Writes without a mask leave the register alone.
+    AddCommand(list, viewport_x, 0x0, {0xFFFFFFFF});
+    // Repeated writes to an upload register are all kept.
+    AddCommand(list, program_offset, 0xF, {0});
+    AddCommand(list, program_word, 0xF, {1, 2, 3});
+
+    fixture.Run(list);
+    CHECK(pica.regs.internal.reg_array[viewport_x] == 0x11225566);
+    CHECK(pica.vs_setup.program_code[0] == 1);
+    CHECK(pica.vs_setup.program_code[1] == 2);
+    CHECK(pica.vs_setup.program_code[2] == 3);
+    CHECK(pica.regs.internal.vs.program.offset == 3);
+    CHECK(pica.GetCmdListCacheStats().misses == 1);
+
+    SECTION("an unchanged list is replayed from the cache") {
+        pica.regs.internal.reg_array[viewport_x] = 0;
+        fixture.Run(list);
+        CHECK(pica.regs.internal.reg_array[viewport_x] == 0x11225566);
+        CHECK(pica.regs.internal.vs.program.offset == 3);
+        CHECK(pica.GetCmdListCacheStats().hits == 1);
+        CHECK(pica.GetCmdListCacheStats().misses == 1);
+    }
+
+    SECTION("a modified list is decoded again") {
+        list[0] = 0x01020304;
+        fixture.Run(list);
+        CHECK(pica.regs.internal.reg_array[viewport_x] == 0x01025566);
+        CHECK(pica.GetCmdListCacheStats().hits == 0);
+        CHECK(pica.GetCmdListCacheStats().misses == 2);
+    }
+}
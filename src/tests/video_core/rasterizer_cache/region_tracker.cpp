@@ -0,0 +1,103 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <boost/icl/interval_map.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/rasterizer_cache/region_tracker.h"
+
+namespace VideoCore {
+
+using ReferenceMap = boost::icl::interval_map<PAddr, SurfaceId, boost::icl::partial_absorber,
+                                              std::less, boost::icl::inplace_plus,
+                                              boost::icl::inter_section, SurfaceInterval>;
+
+static void RequireSameRegions(const DirtyRegions& regions, const ReferenceMap& reference) {
+    const auto all = regions.Overlapping(SurfaceInterval{0, 0xFFFFFFFF});
+    REQUIRE(all.size() == reference.iterative_size());
+    auto it = reference.begin();
+    for (const auto& [interval, owner] : all) {
+        REQUIRE(interval == it->first);
+        REQUIRE(owner == it->second);
+        ++it;
+    }
+}
+
+TEST_CASE("DirtyRegions: Set merges and splits regions", "[video_core][rasterizer_cache]") {
+    DirtyRegions regions;
+    const SurfaceId a{1};
+    const SurfaceId b{2};
+
+    regions.Set(SurfaceInterval{0x100, 0x200}, a);
+    regions.Set(SurfaceInterval{0x200, 0x300}, a);
+    REQUIRE(regions.Overlapping(SurfaceInterval{0, 0x1000}).size() == 1);
+
+    regions.Set(SurfaceInterval{0x180, 0x280}, b);
+    const auto split = regions.Overlapping(SurfaceInterval{0, 0x1000});
+    REQUIRE(split.size() == 3);
+    REQUIRE(split[0].interval == SurfaceInterval{0x100, 0x180});
+    REQUIRE(split[1].owner == b);
+    REQUIRE(split[2].interval == SurfaceInterval{0x280, 0x300});
+
+    REQUIRE(regions.Contains(SurfaceInterval{0x100, 0x300}));
+    regions.Erase(SurfaceInterval{0x1F0, 0x210});
+    REQUIRE(!regions.Contains(SurfaceInterval{0x100, 0x300}));
+    REQUIRE(regions.Contains(SurfaceInterval{0x100, 0x1F0}));
+    REQUIRE(regions.Overlapping(SurfaceInterval{0x1F0, 0x210}).empty());
+}
+
+TEST_CASE("DirtyRegions: Matches boost::icl::interval_map", "[video_core][rasterizer_cache]") {
+    DirtyRegions regions;
+    ReferenceMap reference;
+    std::mt19937 rng{0};
+    std::uniform_int_distribution<u32> addr_dist{0, 0x4000};
+    std::uniform_int_distribution<u32> size_dist{1, 0x800};
+    std::uniform_int_distribution<u32> owner_dist{1, 4};
+
+    for (u32 i = 0; i < 2000; i++) {
+        const PAddr addr = addr_dist(rng);
+        const SurfaceInterval interval{addr, addr + size_dist(rng)};
+        switch (rng() % 3) {
+        case 0:
+        case 1: {
+            const SurfaceId owner{owner_dist(rng)};
+            regions.Set(interval, owner);
+            reference.set({interval, owner});
+            break;
+        }
+        case 2:
+            regions.Erase(interval);
+            reference.erase(interval);
+            break;
+        }
+        REQUIRE(regions.Contains(interval) == boost::icl::contains(reference, interval));
+        RequireSameRegions(regions, reference);
+    }
+}
+
+TEST_CASE("CachedPages: Reports pages becoming cached and uncached",
+          "[video_core][rasterizer_cache]") {
+    CachedPages pages;
+    std::vector<std::pair<u32, u32>> runs;
+    const auto record = [&](u32 page, u32 num_pages) { runs.emplace_back(page, num_pages); };
+
+    pages.Update(10, 20, 1, record);
+    REQUIRE(runs == std::vector<std::pair<u32, u32>>{{10, 10}});
+
+    // Only the pages that were not cached yet change state.
+    runs.clear();
+    pages.Update(5, 25, 1, record);
+    REQUIRE(runs == std::vector<std::pair<u32, u32>>{{5, 5}, {20, 5}});
+
+    runs.clear();
+    pages.Update(10, 20, -1, record);
+    REQUIRE(runs.empty());
+
+    runs.clear();
+    pages.Clear(record);
+    REQUIRE(runs == std::vector<std::pair<u32, u32>>{{5, 20}});
+}
+
+} // namespace VideoCore
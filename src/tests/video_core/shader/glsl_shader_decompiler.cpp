@@ -0,0 +1,178 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <catch2/catch_test_macros.hpp>
+#include <nihstro/inline_assembly.h>
+#include "video_core/pica/regs_internal.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/shader/generator/glsl_shader_decompiler.h"
+#include "video_core/shader/generator/glsl_shader_gen.h"
+#include "video_core/shader/generator/shader_gen.h"
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+namespace Pica::Shader::Generator::GLSL {
+
+namespace {
+const auto sh_input = SourceRegister::MakeInput(0);
+const auto sh_c0 = SourceRegister::MakeFloat(0);
+const auto sh_temp = SourceRegister::MakeTemporary(0);
+const auto sh_temp_dest = DestRegister::MakeTemporary(0);
+const auto sh_output = DestRegister::MakeOutput(0);
+
+std::unique_ptr<ShaderSetup> CompileShaderSetup(std::initializer_list<nihstro::InlineAsm> code) {
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
+
+    auto shader = std::make_unique<ShaderSetup>();
+
+    std::transform(shbin.program.begin(), shbin.program.end(), shader->program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   shader->swizzle_data.begin(), [](const auto& x) { return x.hex; });
+
+    return shader;
+}
+
+// nihstro does not support the geometry shader and most flow control instructions, so they are
+// encoded by hand and written over NOP placeholders.
+
+u32 Encode(OpCode::Id opcode) {
+    nihstro::Instruction instr = {};
+    instr.opcode = nihstro::OpCode(opcode);
+    return instr.hex;
+}
+
+u32 Nop() {
+    return Encode(OpCode::Id::NOP);
+}
+
+u32 Emit() {
+    return Encode(OpCode::Id::EMIT);
+}
+
+u32 SetEmit(u32 vertex_id, bool prim_emit) {
+    nihstro::Instruction instr = {Encode(OpCode::Id::SETEMIT)};
+    instr.setemit.vertex_id = vertex_id;
+    instr.setemit.prim_emit = prim_emit;
+    return instr.hex;
+}
+
+u32 FlowControl(OpCode::Id opcode, u32 dest_offset, u32 num_instructions) {
+    nihstro::Instruction instr = {Encode(opcode)};
+    instr.flow_control.dest_offset = dest_offset;
+    instr.flow_control.num_instructions = num_instructions;
+    return instr.hex;
+}
+
+/// Emits a triangle from three vertices, each of them offset from the input point.
+std::unique_ptr<ShaderSetup> MakeTriangleShader() {
+    auto setup = CompileShaderSetup({
+        {OpCode::Id::MOV, sh_output, sh_input},
+        {OpCode::Id::NOP}, // setemit 0
+        {OpCode::Id::NOP}, // emit
+        {OpCode::Id::ADD, sh_output, sh_input, sh_c0},
+        {OpCode::Id::NOP}, // setemit 1
+        {OpCode::Id::NOP}, // emit
+        {OpCode::Id::ADD, sh_output, sh_c0, sh_input},
+        {OpCode::Id::NOP}, // setemit 2, prim
+        {OpCode::Id::NOP}, // emit
+        {OpCode::Id::END},
+    });
+    setup->program_code[1] = SetEmit(0, false);
+    setup->program_code[2] = Emit();
+    setup->program_code[4] = SetEmit(1, false);
+    setup->program_code[5] = Emit();
+    setup->program_code[7] = SetEmit(2, true);
+    setup->program_code[8] = Emit();
+    return setup;
+}
+
+bool IsStateless(const ShaderSetup& setup) {
+    return IsStatelessGeometryShader(setup.program_code, setup.swizzle_data, 0, 0x1,
+                                     MAX_GEOMETRY_SHADER_VERTICES);
+}
+} // Anonymous namespace
+
+TEST_CASE("Geometry shader - Stateless program is translated", "[video_core][shader]") {
+    auto setup = MakeTriangleShader();
+    REQUIRE(IsStateless(*setup));
+
+    RegsInternal regs{};
+    regs.gs.output_mask.Assign(0x1);
+    const PicaGSConfig config{regs, *setup, false};
+    const std::string source = GenerateGeometryShader(*setup, config, false);
+    REQUIRE(source.find("layout(points) in;") != std::string::npos);
+    REQUIRE(source.find("setemit(2u, true, false);") != std::string::npos);
+    REQUIRE(source.find("emit();") != std::string::npos);
+}
+
+TEST_CASE("Geometry shader - Registers written on every path", "[video_core][shader]") {
+    auto setup = CompileShaderSetup({
+        {OpCode::Id::NOP}, // ifu b0
+        {OpCode::Id::MOV, sh_temp_dest, sh_input},
+        {OpCode::Id::MOV, sh_temp_dest, sh_c0}, // else
+        {OpCode::Id::MOV, sh_output, sh_temp},
+        {OpCode::Id::END},
+    });
+    setup->program_code[0] = FlowControl(OpCode::Id::IFU, 2, 1);
+    REQUIRE(IsStateless(*setup));
+
+    // Without the else branch, the temporary keeps the value of a previous invocation.
+    setup->program_code[2] = Nop();
+    REQUIRE(!IsStateless(*setup));
+}
+
+TEST_CASE("Geometry shader - Programs that carry state fall back", "[video_core][shader]") {
+    SECTION("Temporary read before it is written") {
+        auto setup = MakeTriangleShader();
+        setup->program_code[3] =
+            CompileShaderSetup({{OpCode::Id::ADD, sh_output, sh_temp, sh_input}})->program_code[0];
+        REQUIRE(!IsStateless(*setup));
+    }
+
+    SECTION("Emitter state of a previous invocation") {
+        auto setup = MakeTriangleShader();
+        setup->program_code[1] = Nop();
+        REQUIRE(!IsStateless(*setup));
+    }
+
+    SECTION("Vertex buffered by a previous invocation") {
+        auto setup = MakeTriangleShader();
+        setup->program_code[5] = Nop();
+        REQUIRE(!IsStateless(*setup));
+    }
+
+    SECTION("Output register of a previous invocation") {
+        auto setup = MakeTriangleShader();
+        REQUIRE(!IsStatelessGeometryShader(setup->program_code, setup->swizzle_data, 0, 0x3,
+                                           MAX_GEOMETRY_SHADER_VERTICES));
+    }
+}
+
+TEST_CASE("Geometry shader - Emit count is bounded", "[video_core][shader]") {
+    auto setup = MakeTriangleShader();
+    REQUIRE(!IsStatelessGeometryShader(setup->program_code, setup->swizzle_data, 0, 0x1, 2));
+
+    // The number of loop iterations comes from a uniform.
+    setup = CompileShaderSetup({
+        {OpCode::Id::MOV, sh_output, sh_input},
+        {OpCode::Id::NOP}, // loop i0
+        {OpCode::Id::NOP}, // setemit 0
+        {OpCode::Id::NOP}, // emit
+        {OpCode::Id::END},
+    });
+    setup->program_code[1] = FlowControl(OpCode::Id::LOOP, 3, 0);
+    setup->program_code[2] = SetEmit(0, false);
+    setup->program_code[3] = Emit();
+    REQUIRE(!IsStateless(*setup));
+
+    setup->program_code[3] = Nop();
+    REQUIRE(IsStateless(*setup));
+}
+
+} // namespace Pica::Shader::Generator::GLSL
@@ -58,7 +58,10 @@ CustomTexManager::CustomTexManager(Core::System& system_)
     : system{system_}, image_interface{*system.GetImageInterface()},
       async_custom_loading{Settings::values.async_custom_loading.GetValue()} {}
 
-CustomTexManager::~CustomTexManager() = default;
+CustomTexManager::~CustomTexManager() {
+    // The decoding and dumping tasks use the materials and the dumped texture set.
+    tasks.Wait();
+}
 
 void CustomTexManager::TickFrame() {
     MICROPROFILE_SCOPE(CustomTexManager_TickFrame);
@@ -89,9 +92,6 @@ void CustomTexManager::FindCustomTextures() {
     if (textures_loaded) {
         return;
     }
-    if (!workers) {
-        CreateWorkers();
-    }
 
     const u64 title_id = system.Kernel().GetCurrentProcess()->codeset->program_id;
     const auto textures = GetTextures(title_id);
@@ -206,8 +206,10 @@ void CustomTexManager::PrepareDumping(u64 title_id) {
 
 void CustomTexManager::PreloadTextures(const std::atomic_bool& stop_run,
                                        const VideoCore::DiskResourceLoadCallback& callback) {
-    u64 size_sum = 0;
+    std::atomic<u64> size_sum = 0;
+    std::atomic<bool> aborted = false;
     std::size_t preloaded = 0;
+    std::mutex callback_mutex;
     const u64 sys_mem = Common::GetMemInfo().total_physical_memory;
     const u64 recommended_min_mem = 2_GiB;
 
@@ -216,24 +218,35 @@ void CustomTexManager::PreloadTextures(const std::atomic_bool& stop_run,
     const u64 max_mem =
         (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
 
-    workers->QueueWork([&]() {
-        for (auto& [hash, material] : material_map) {
-            if (size_sum > max_mem) {
-                LOG_WARNING(Render, "Aborting texture preload due to insufficient memory");
-                return;
-            }
-            if (stop_run) {
-                return;
-            }
-            material->LoadFromDisk(flip_png_files);
-            size_sum += material->size;
-            if (callback) {
-                callback(VideoCore::LoadCallbackStage::Preload, preloaded, custom_textures.size());
+    std::vector<Material*> materials;
+    materials.reserve(material_map.size());
+    for (const auto& [hash, material] : material_map) {
+        materials.push_back(material.get());
+    }
+
+    Common::ThreadPool::Shared().ParallelFor(
+        materials.size(), 1,
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                if (stop_run || aborted) {
+                    return;
+                }
+                if (size_sum > max_mem) {
+                    if (!aborted.exchange(true)) {
+                        LOG_WARNING(Render, "Aborting texture preload due to insufficient memory");
+                    }
+                    return;
+                }
+                materials[i]->LoadFromDisk(flip_png_files);
+                size_sum += materials[i]->size;
+                if (callback) {
+                    std::scoped_lock lock{callback_mutex};
+                    callback(VideoCore::LoadCallbackStage::Preload, preloaded++,
+                             custom_textures.size());
+                }
             }
-            preloaded++;
-        }
-    });
-    workers->WaitForRequests();
+        },
+        Common::TaskPriority::Background);
     async_custom_loading = false;
 }
 
@@ -279,10 +292,7 @@ void CustomTexManager::DumpTexture(const SurfaceParams& params, u32 level, std::
         Common::FlipRGBA8Texture(decoded, width, height);
         image_interface.EncodePNG(dump_path, width, height, decoded);
     };
-    if (!workers) {
-        CreateWorkers();
-    }
-    workers->QueueWork(std::move(dump));
+    Common::ThreadPool::Shared().Submit(std::move(dump), tasks, Common::TaskPriority::Background);
     dumped_textures.insert(data_hash);
 }
 
@@ -302,7 +312,9 @@ bool CustomTexManager::Decode(Material* material, std::function<bool()>&& upload
     }
     if (material->IsUnloaded()) {
         material->state = DecodeState::Pending;
-        workers->QueueWork([material, this] { material->LoadFromDisk(flip_png_files); });
+        Common::ThreadPool::Shared().Submit(
+            [material, this] { material->LoadFromDisk(flip_png_files); }, tasks,
+            Common::TaskPriority::Background);
     }
     async_uploads.push_back({
         .material = material,
@@ -384,9 +396,4 @@ std::vector<FileUtil::FSTEntry> CustomTexManager::GetTextures(u64 title_id) {
     return textures;
 }
 
-void CustomTexManager::CreateWorkers() {
-    const std::size_t num_workers = std::max(std::thread::hardware_concurrency(), 2U) - 1;
-    workers = std::make_unique<Common::ThreadWorker>(num_workers, "Custom textures");
-}
-
 } // namespace VideoCore
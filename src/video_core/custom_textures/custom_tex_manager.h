@@ -8,7 +8,7 @@
 #include <span>
 #include <unordered_map>
 #include <unordered_set>
-#include "common/thread_worker.h"
+#include "common/thread_pool.h"
 #include "video_core/custom_textures/material.h"
 #include "video_core/rasterizer_interface.h"
 
@@ -76,9 +76,6 @@ private:
     /// Returns a vector of all custom texture files.
     std::vector<FileUtil::FSTEntry> GetTextures(u64 title_id);
 
-    /// Creates the thread workers.
-    void CreateWorkers();
-
 private:
     Core::System& system;
     Frontend::ImageInterface& image_interface;
@@ -87,12 +84,12 @@ private:
     std::unordered_map<std::string, std::vector<u64>> path_to_hash_map;
     std::vector<std::unique_ptr<CustomTexture>> custom_textures;
     std::list<AsyncUpload> async_uploads;
-    std::unique_ptr<Common::ThreadWorker> workers;
     bool textures_loaded{false};
     bool async_custom_loading{true};
     bool skip_mipmap{false};
     bool flip_png_files{true};
     bool use_new_hash{true};
+    Common::TaskGroup tasks;
 };
 
 } // namespace VideoCore
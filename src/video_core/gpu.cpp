@@ -2,15 +2,23 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <mutex>
+#include <vector>
 #include "common/archives.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/gsp/gsp_gpu.h"
 #include "core/hle/service/plgldr/plgldr.h"
+#include "core/tracer/recorder.h"
+#ifdef ENABLE_SCRIPTING
+#include "core/rpc/server.h"
+#endif
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/gpu.h"
 #include "video_core/gpu_debugger.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica/pica_core.h"
 #include "video_core/pica/regs_lcd.h"
 #include "video_core/renderer_base.h"
@@ -22,6 +30,21 @@ namespace VideoCore {
 constexpr VAddr VADDR_LCD = 0x1ED02000;
 constexpr VAddr VADDR_GPU = 0x1EF00000;
 
+/// Number of GPU registers configuring a display transfer, the last one being its trigger.
+constexpr u32 NUM_DISPLAY_TRANSFER_REGS =
+    GPU_REG_INDEX(display_transfer_config.trigger) - GPU_REG_INDEX(display_transfer_config) + 1;
+
+/// Rough throughput of the PICA transfer engine and fill units, in ARM11 cycles per 16 bytes
+/// written. Used to schedule the completion interrupt of transfers done in software, so that
+/// emulation keeps running while the blitter workers process them.
+constexpr u64 TRANSFER_CYCLES_PER_16_BYTES = 1;
+
+/// Lower bound for the latency of a software transfer, in ARM11 cycles.
+constexpr u64 MIN_TRANSFER_CYCLES = 1024;
+
+/// How often the interrupts raised by the GPU thread are delivered to the guest, in ARM11 cycles.
+constexpr u64 INTERRUPT_POLL_CYCLES = 16384;
+
 MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
 MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
 
@@ -36,7 +59,12 @@ struct GPU::Impl {
     RasterizerInterface* rasterizer;
     std::unique_ptr<SwRenderer::SwBlitter> sw_blitter;
     Core::TimingEventType* vblank_event;
+    Core::TimingEventType* transfer_event;
+    Core::TimingEventType* interrupt_event;
     Service::GSP::InterruptHandler signal_interrupt;
+    std::mutex interrupt_mutex;
+    std::vector<Service::GSP::InterruptId> pending_interrupts;
+    std::unique_ptr<GPUThread> gpu_thread;
 
     explicit Impl(Core::System& system, Frontend::EmuWindow& emu_window,
                   Frontend::EmuWindow* secondary_window)
@@ -45,7 +73,10 @@ struct GPU::Impl {
           renderer{VideoCore::CreateRenderer(emu_window, secondary_window, pica, system)},
           rasterizer{renderer->Rasterizer()}, sw_blitter{std::make_unique<SwRenderer::SwBlitter>(
                                                   memory, rasterizer)} {}
-    ~Impl() = default;
+    ~Impl() {
+        // The GPU thread runs work on the renderer and the blitter, finish it before they go.
+        gpu_thread.reset();
+    }
 };
 
 GPU::GPU(Core::System& system, Frontend::EmuWindow& emu_window,
@@ -55,9 +86,27 @@ GPU::GPU(Core::System& system, Frontend::EmuWindow& emu_window,
         "GPU::VBlankCallback",
         [this](uintptr_t user_data, s64 cycles_late) { VBlankCallback(user_data, cycles_late); });
     impl->timing.ScheduleEvent(FRAME_TICKS, impl->vblank_event);
+    impl->transfer_event = impl->timing.RegisterEvent(
+        "GPU::TransferDoneCallback", [this](uintptr_t user_data, s64 cycles_late) {
+            TransferDoneCallback(user_data, cycles_late);
+        });
+    impl->interrupt_event = impl->timing.RegisterEvent(
+        "GPU::InterruptPollCallback", [this](uintptr_t user_data, s64 cycles_late) {
+            InterruptPollCallback(user_data, cycles_late);
+        });
 
     // Bind the rasterizer to the PICA GPU
     impl->pica.BindRasterizer(impl->rasterizer);
+
+    if (Settings::values.async_gpu_emulation.GetValue()) {
+        if (impl->renderer->SupportsAsyncGpu()) {
+            impl->gpu_thread = std::make_unique<GPUThread>();
+            impl->timing.ScheduleEvent(INTERRUPT_POLL_CYCLES, impl->interrupt_event);
+        } else {
+            LOG_WARNING(HW_GPU, "The selected renderer does not support asynchronous GPU "
+                                "emulation, it will run on the emulation thread");
+        }
+    }
 }
 
 GPU::~GPU() = default;
@@ -88,28 +137,57 @@ PAddr GPU::VirtualToPhysicalAddress(VAddr addr) {
 }
 
 void GPU::SetInterruptHandler(Service::GSP::InterruptHandler handler) {
+    WaitIdle();
     impl->signal_interrupt = handler;
-    impl->pica.SetInterruptHandler(handler);
+    Service::GSP::InterruptHandler pica_handler = [this](Service::GSP::InterruptId id) {
+        SignalInterrupt(id);
+    };
+    impl->pica.SetInterruptHandler(pica_handler);
 }
 
 void GPU::FlushRegion(PAddr addr, u32 size) {
+    WaitIdle();
+    impl->sw_blitter->WaitForRegion(addr, size);
     impl->rasterizer->FlushRegion(addr, size);
 }
 
 void GPU::InvalidateRegion(PAddr addr, u32 size) {
+    WaitIdle();
+    impl->sw_blitter->WaitForRegion(addr, size);
     impl->rasterizer->InvalidateRegion(addr, size);
 }
 
+void GPU::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    WaitIdle();
+    impl->sw_blitter->WaitForRegion(addr, size);
+    impl->rasterizer->FlushAndInvalidateRegion(addr, size);
+}
+
 void GPU::ClearAll(bool flush) {
+    WaitIdle();
+    impl->sw_blitter->Wait();
     impl->rasterizer->ClearAll(flush);
 }
 
 void GPU::Execute(const Service::GSP::Command& command) {
+    // DMA requests copy guest memory on behalf of the CPU, so they run on the emulation thread
+    // once the GPU is done with the memory.
+    if (command.id == Service::GSP::CommandId::RequestDma) {
+        WaitIdle();
+        ExecuteCommand(command);
+        return;
+    }
+    // The command is copied, the guest may reuse its slot in the command queue right away.
+    RunOnGPUThread([this, command] { ExecuteCommand(command); });
+}
+
+void GPU::ExecuteCommand(const Service::GSP::Command& command) {
     using Service::GSP::CommandId;
     auto& regs = impl->pica.regs;
 
     switch (command.id) {
     case CommandId::RequestDma: {
+        impl->sw_blitter->Wait();
         impl->system.Memory().RasterizerFlushVirtualRegion(
             command.dma_request.source_address, command.dma_request.size, Memory::FlushMode::Flush);
         impl->system.Memory().RasterizerFlushVirtualRegion(command.dma_request.dest_address,
@@ -121,17 +199,24 @@ void GPU::Execute(const Service::GSP::Command& command) {
         const auto process = impl->system.Kernel().GetCurrentProcess();
         impl->memory.CopyBlock(*process, command.dma_request.dest_address,
                                command.dma_request.source_address, command.dma_request.size);
-        impl->signal_interrupt(Service::GSP::InterruptId::DMA);
+        SignalInterrupt(Service::GSP::InterruptId::DMA);
         break;
     }
     case CommandId::SubmitCmdList: {
         auto& params = command.submit_gpu_cmdlist;
         auto& cmdbuffer = regs.internal.pipeline.command_buffer;
 
+        // Rendering may sample the output of pending software transfers.
+        impl->sw_blitter->Wait();
+
         // Write to the command buffer GPU registers
         cmdbuffer.addr[0].Assign(VirtualToPhysicalAddress(params.address) >> 3);
         cmdbuffer.size[0].Assign(params.size >> 3);
         cmdbuffer.trigger[0] = 1;
+        RecordMemory(cmdbuffer.GetPhysicalAddress(0), cmdbuffer.GetSize(0));
+        RecordRegisters(GPU_REG_INDEX(internal.pipeline.command_buffer.size[0]), 1);
+        RecordRegisters(GPU_REG_INDEX(internal.pipeline.command_buffer.addr[0]), 1);
+        RecordRegisters(GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[0]), 1);
 
         // Trigger processing of the command list
         SubmitCmdList(0);
@@ -143,17 +228,21 @@ void GPU::Execute(const Service::GSP::Command& command) {
 
         // Write to the memory fill GPU registers.
         if (params.start1 != 0) {
+            CompletePendingMemoryFill(0);
             memfill[0].address_start = VirtualToPhysicalAddress(params.start1) >> 3;
             memfill[0].address_end = VirtualToPhysicalAddress(params.end1) >> 3;
             memfill[0].value_32bit = params.value1;
             memfill[0].control = params.control1;
+            RecordRegisters(GPU_REG_INDEX(memory_fill_config[0]), 4);
             MemoryFill(0);
         }
         if (params.start2 != 0) {
+            CompletePendingMemoryFill(1);
             memfill[1].address_start = VirtualToPhysicalAddress(params.start2) >> 3;
             memfill[1].address_end = VirtualToPhysicalAddress(params.end2) >> 3;
             memfill[1].value_32bit = params.value2;
             memfill[1].control = params.control2;
+            RecordRegisters(GPU_REG_INDEX(memory_fill_config[1]), 4);
             MemoryFill(1);
         }
         break;
@@ -161,6 +250,7 @@ void GPU::Execute(const Service::GSP::Command& command) {
     case CommandId::DisplayTransfer: {
         auto& params = command.display_transfer;
         auto& display_transfer = regs.display_transfer_config;
+        CompletePendingMemoryTransfer();
 
         // Write to the transfer engine GPU registers.
         display_transfer.input_address = VirtualToPhysicalAddress(params.in_buffer_address) >> 3;
@@ -169,6 +259,7 @@ void GPU::Execute(const Service::GSP::Command& command) {
         display_transfer.output_size = params.out_buffer_size;
         display_transfer.flags = params.flags;
         display_transfer.trigger.Assign(1);
+        RecordRegisters(GPU_REG_INDEX(display_transfer_config), NUM_DISPLAY_TRANSFER_REGS);
 
         // Trigger the display transfer.
         MemoryTransfer();
@@ -177,6 +268,7 @@ void GPU::Execute(const Service::GSP::Command& command) {
     case CommandId::TextureCopy: {
         auto& params = command.texture_copy;
         auto& texture_copy = regs.display_transfer_config;
+        CompletePendingMemoryTransfer();
 
         // Write to the transfer engine GPU registers.
         texture_copy.input_address = VirtualToPhysicalAddress(params.in_buffer_address) >> 3;
@@ -186,6 +278,8 @@ void GPU::Execute(const Service::GSP::Command& command) {
         texture_copy.texture_copy.output_size = params.out_width_gap;
         texture_copy.flags = params.flags;
         texture_copy.trigger.Assign(1);
+        RecordMemory(texture_copy.GetPhysicalInputAddress(), texture_copy.texture_copy.size);
+        RecordRegisters(GPU_REG_INDEX(display_transfer_config), NUM_DISPLAY_TRANSFER_REGS);
 
         // Trigger the texture copy.
         MemoryTransfer();
@@ -210,24 +304,27 @@ void GPU::SetBufferSwap(u32 screen_id, const Service::GSP::FrameBufferInfo& info
     const PAddr phys_address_left = VirtualToPhysicalAddress(info.address_left);
     const PAddr phys_address_right = VirtualToPhysicalAddress(info.address_right);
 
-    // Update framebuffer properties.
-    auto& framebuffer = impl->pica.regs.framebuffer_config[screen_id];
-    if (info.active_fb == 0) {
-        framebuffer.address_left1 = phys_address_left;
-        framebuffer.address_right1 = phys_address_right;
-    } else {
-        framebuffer.address_left2 = phys_address_left;
-        framebuffer.address_right2 = phys_address_right;
-    }
+    // The registers are updated in order with the rendering of the frame being swapped in.
+    RunOnGPUThread([this, screen_id, info, phys_address_left, phys_address_right] {
+        // Update framebuffer properties.
+        auto& framebuffer = impl->pica.regs.framebuffer_config[screen_id];
+        if (info.active_fb == 0) {
+            framebuffer.address_left1 = phys_address_left;
+            framebuffer.address_right1 = phys_address_right;
+        } else {
+            framebuffer.address_left2 = phys_address_left;
+            framebuffer.address_right2 = phys_address_right;
+        }
 
-    framebuffer.stride = info.stride;
-    framebuffer.format = info.format;
-    framebuffer.active_fb = info.shown_fb;
+        framebuffer.stride = info.stride;
+        framebuffer.format = info.format;
+        framebuffer.active_fb = info.shown_fb;
 
-    // Notify debugger about the buffer swap.
-    if (impl->debug_context) {
-        impl->debug_context->OnEvent(Pica::DebugContext::Event::BufferSwapped, nullptr);
-    }
+        // Notify debugger about the buffer swap.
+        if (impl->debug_context) {
+            impl->debug_context->OnEvent(Pica::DebugContext::Event::BufferSwapped, nullptr);
+        }
+    });
 
     if (screen_id == 0) {
         MicroProfileFlip();
@@ -236,11 +333,14 @@ void GPU::SetBufferSwap(u32 screen_id, const Service::GSP::FrameBufferInfo& info
 }
 
 void GPU::SetColorFill(const Pica::ColorFill& fill) {
-    impl->pica.regs_lcd.color_fill_top = fill;
-    impl->pica.regs_lcd.color_fill_bottom = fill;
+    RunOnGPUThread([this, fill] {
+        impl->pica.regs_lcd.color_fill_top = fill;
+        impl->pica.regs_lcd.color_fill_bottom = fill;
+    });
 }
 
 u32 GPU::ReadReg(VAddr addr) {
+    WaitIdle();
     switch (addr & 0xFFFFF000) {
     case VADDR_LCD: {
         const u32 offset = addr - VADDR_LCD;
@@ -263,6 +363,10 @@ u32 GPU::ReadReg(VAddr addr) {
 }
 
 void GPU::WriteReg(VAddr addr, u32 data) {
+    RunOnGPUThread([this, addr, data] { ProcessRegWrite(addr, data); });
+}
+
+void GPU::ProcessRegWrite(VAddr addr, u32 data) {
     switch (addr & 0xFFFFF000) {
     case VADDR_LCD: {
         const u32 offset = addr - VADDR_LCD;
@@ -270,6 +374,10 @@ void GPU::WriteReg(VAddr addr, u32 data) {
         ASSERT(addr % sizeof(u32) == 0);
         ASSERT(index < Pica::RegsLcd::NumIds());
         impl->pica.regs_lcd[index] = data;
+        if (impl->debug_context && impl->debug_context->recorder) {
+            impl->debug_context->recorder->RegisterWritten(
+                CiTrace::LCD_REGS_PADDR + index * sizeof(u32), data);
+        }
         break;
     }
     case VADDR_GPU:
@@ -279,7 +387,25 @@ void GPU::WriteReg(VAddr addr, u32 data) {
 
         ASSERT(addr % sizeof(u32) == 0);
         ASSERT(index < Pica::PicaCore::Regs::NUM_REGS);
+
+        // Pending software transfers are tracked through their trigger bits, so they have to
+        // complete before the registers that describe them can be reprogrammed.
+        const auto& regs = impl->pica.regs;
+        const auto writes_config = [index](u32 first_index, std::size_t size) {
+            return index >= first_index && index < first_index + size / sizeof(u32);
+        };
+        if (writes_config(GPU_REG_INDEX(memory_fill_config[0]),
+                          sizeof(regs.memory_fill_config[0]))) {
+            CompletePendingMemoryFill(0);
+        } else if (writes_config(GPU_REG_INDEX(memory_fill_config[1]),
+                                 sizeof(regs.memory_fill_config[1]))) {
+            CompletePendingMemoryFill(1);
+        } else if (writes_config(GPU_REG_INDEX(display_transfer_config),
+                                 sizeof(regs.display_transfer_config))) {
+            CompletePendingMemoryTransfer();
+        }
         impl->pica.regs.reg_array[index] = data;
+        RecordRegisters(index, 1);
 
         // Handle registers that trigger GPU actions
         switch (index) {
@@ -309,9 +435,16 @@ void GPU::WriteReg(VAddr addr, u32 data) {
 }
 
 void GPU::Sync() {
+    WaitIdle();
     impl->renderer->Sync();
 }
 
+void GPU::SetTitleId(u64 title_id) {
+    WaitIdle();
+    impl->pica.SetTitleId(title_id);
+    impl->rasterizer->SetTitleId(title_id);
+}
+
 VideoCore::RendererBase& GPU::Renderer() {
     return *impl->renderer;
 }
@@ -332,6 +465,52 @@ GraphicsDebugger& GPU::Debugger() {
     return impl->gpu_debugger;
 }
 
+void GPU::RunOnGPUThread(Common::UniqueFunction<void>&& work) {
+    if (impl->gpu_thread) {
+        impl->gpu_thread->Push(std::move(work));
+    } else {
+        work();
+    }
+}
+
+void GPU::WaitIdle() {
+    if (!impl->gpu_thread || impl->gpu_thread->IsGPUThread()) {
+        return;
+    }
+    impl->gpu_thread->WaitIdle();
+    DeliverInterrupts();
+}
+
+void GPU::SignalInterrupt(Service::GSP::InterruptId id) {
+    if (!impl->gpu_thread || !impl->gpu_thread->IsGPUThread()) {
+        impl->signal_interrupt(id);
+        return;
+    }
+    // The GSP service is not thread safe, leave it to the emulation thread.
+    std::scoped_lock lock{impl->interrupt_mutex};
+    impl->pending_interrupts.push_back(id);
+}
+
+void GPU::DeliverInterrupts() {
+    std::vector<Service::GSP::InterruptId> interrupts;
+    {
+        std::scoped_lock lock{impl->interrupt_mutex};
+        interrupts.swap(impl->pending_interrupts);
+    }
+    for (const auto id : interrupts) {
+        impl->signal_interrupt(id);
+    }
+}
+
+void GPU::InterruptPollCallback(std::uintptr_t user_data, s64 cycles_late) {
+    // Scheduled in asynchronous mode only, but a save state may carry it over to synchronous mode.
+    if (!impl->gpu_thread) {
+        return;
+    }
+    DeliverInterrupts();
+    impl->timing.ScheduleEvent(INTERRUPT_POLL_CYCLES - cycles_late, impl->interrupt_event);
+}
+
 void GPU::SubmitCmdList(u32 index) {
     // Check if a command list was triggered.
     auto& config = impl->pica.regs.internal.pipeline.command_buffer;
@@ -355,18 +534,36 @@ void GPU::MemoryFill(u32 index) {
         return;
     }
 
-    // Perform memory fill.
+    // Both paths access guest memory that earlier software transfers may still be writing.
+    impl->sw_blitter->Wait();
+
+    // Perform memory fill. The software fill runs on the blitter workers and completes
+    // through the transfer event.
     if (!impl->rasterizer->AccelerateFill(config)) {
-        impl->sw_blitter->MemoryFill(config);
+        const u32 size = impl->sw_blitter->MemoryFill(config);
+        if (size != 0 && !impl->gpu_thread) {
+            ScheduleTransferDone(index == 0 ? Service::GSP::InterruptId::PSC0
+                                            : Service::GSP::InterruptId::PSC1,
+                                 size);
+            return;
+        }
+        // The GPU thread cannot schedule events, it finishes the fill itself.
+        impl->sw_blitter->Wait();
     }
 
+    FinishMemoryFill(index);
+}
+
+void GPU::FinishMemoryFill(u32 index) {
+    auto& config = impl->pica.regs.memory_fill_config[index];
+
     // It seems that it won't signal interrupt if "address_start" is zero.
     // TODO: hwtest this
     if (config.GetStartAddress() != 0) {
         if (!index) {
-            impl->signal_interrupt(Service::GSP::InterruptId::PSC0);
+            SignalInterrupt(Service::GSP::InterruptId::PSC0);
         } else {
-            impl->signal_interrupt(Service::GSP::InterruptId::PSC1);
+            SignalInterrupt(Service::GSP::InterruptId::PSC1);
         }
     }
 
@@ -376,6 +573,18 @@ void GPU::MemoryFill(u32 index) {
     config.finished.Assign(1);
 }
 
+void GPU::CompletePendingMemoryFill(u32 index) {
+    // A fill that is still triggered at this point is being processed by the blitter workers.
+    if (!impl->pica.regs.memory_fill_config[index].trigger) {
+        return;
+    }
+    const auto id =
+        index == 0 ? Service::GSP::InterruptId::PSC0 : Service::GSP::InterruptId::PSC1;
+    impl->timing.UnscheduleEvent(impl->transfer_event, static_cast<uintptr_t>(id));
+    impl->sw_blitter->Wait();
+    FinishMemoryFill(index);
+}
+
 void GPU::MemoryTransfer() {
     // Check if a transfer was triggered.
     auto& config = impl->pica.regs.display_transfer_config;
@@ -390,26 +599,87 @@ void GPU::MemoryTransfer() {
         impl->debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer, nullptr);
     }
 
-    // Perform memory transfer
+    // Both paths access guest memory that earlier software transfers may still be writing.
+    impl->sw_blitter->Wait();
+
+    // Perform memory transfer. Software display transfers run on the blitter workers and
+    // complete through the transfer event.
     if (config.is_texture_copy) {
         if (!impl->rasterizer->AccelerateTextureCopy(config)) {
             impl->sw_blitter->TextureCopy(config);
         }
     } else {
         if (!impl->rasterizer->AccelerateDisplayTransfer(config)) {
-            impl->sw_blitter->DisplayTransfer(config);
+            const u32 size = impl->sw_blitter->DisplayTransfer(config);
+            if (size != 0 && !impl->gpu_thread) {
+                ScheduleTransferDone(Service::GSP::InterruptId::PPF, size);
+                return;
+            }
+            impl->sw_blitter->Wait();
         }
     }
 
+    FinishMemoryTransfer();
+}
+
+void GPU::FinishMemoryTransfer() {
     // Complete transfer.
-    config.trigger.Assign(0);
-    impl->signal_interrupt(Service::GSP::InterruptId::PPF);
+    impl->pica.regs.display_transfer_config.trigger.Assign(0);
+    SignalInterrupt(Service::GSP::InterruptId::PPF);
+}
+
+void GPU::CompletePendingMemoryTransfer() {
+    // A transfer that is still triggered at this point is being processed by the blitter workers.
+    if (!impl->pica.regs.display_transfer_config.trigger) {
+        return;
+    }
+    impl->timing.UnscheduleEvent(impl->transfer_event,
+                                 static_cast<uintptr_t>(Service::GSP::InterruptId::PPF));
+    impl->sw_blitter->Wait();
+    FinishMemoryTransfer();
+}
+
+void GPU::ScheduleTransferDone(Service::GSP::InterruptId id, u32 size) {
+    const u64 cycles = std::max(size / 16 * TRANSFER_CYCLES_PER_16_BYTES, MIN_TRANSFER_CYCLES);
+    impl->timing.ScheduleEvent(cycles, impl->transfer_event, static_cast<uintptr_t>(id));
+}
+
+void GPU::TransferDoneCallback(std::uintptr_t user_data, s64 cycles_late) {
+    // Make sure the software blitter has written its results before the guest is notified.
+    impl->sw_blitter->Wait();
+
+    switch (static_cast<Service::GSP::InterruptId>(user_data)) {
+    case Service::GSP::InterruptId::PSC0:
+        FinishMemoryFill(0);
+        break;
+    case Service::GSP::InterruptId::PSC1:
+        FinishMemoryFill(1);
+        break;
+    case Service::GSP::InterruptId::PPF:
+        FinishMemoryTransfer();
+        break;
+    default:
+        UNREACHABLE_MSG("Unexpected transfer interrupt {}", user_data);
+    }
 }
 
 void GPU::VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
     // Present renderered frame.
+    WaitIdle();
+    impl->sw_blitter->Wait();
     impl->renderer->SwapBuffers();
 
+#ifdef ENABLE_SCRIPTING
+    // Scripting clients see the memory of the frame that was just presented
+    if (auto* rpc_server = impl->system.RPCServer()) {
+        rpc_server->OnVBlank();
+    }
+#endif
+
+    if (impl->debug_context && impl->debug_context->recorder) {
+        impl->debug_context->recorder->FrameFinished();
+    }
+
     // Signal to GSP that GPU interrupt has occurred
     impl->signal_interrupt(Service::GSP::InterruptId::PDC0);
     impl->signal_interrupt(Service::GSP::InterruptId::PDC1);
@@ -418,8 +688,28 @@ void GPU::VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
     impl->timing.ScheduleEvent(FRAME_TICKS - cycles_late, impl->vblank_event);
 }
 
+void GPU::RecordRegisters(u32 index, u32 count) {
+    if (!impl->debug_context || !impl->debug_context->recorder) {
+        return;
+    }
+    for (u32 i = index; i < index + count; i++) {
+        impl->debug_context->recorder->RegisterWritten(CiTrace::GPU_REGS_PADDR + i * sizeof(u32),
+                                                       impl->pica.regs.reg_array[i]);
+    }
+}
+
+void GPU::RecordMemory(PAddr address, u32 size) {
+    if (!impl->debug_context || !impl->debug_context->recorder) {
+        return;
+    }
+    if (const u8* data = impl->memory.GetPhysicalPointer(address); data && size > 0) {
+        impl->debug_context->recorder->MemoryAccessed(data, size, address);
+    }
+}
+
 template <class Archive>
 void GPU::serialize(Archive& ar, const u32 file_version) {
+    WaitIdle();
     ar & impl->pica;
 }
 
@@ -8,6 +8,7 @@
 #include <memory>
 #include <boost/serialization/access.hpp>
 
+#include "common/unique_function.h"
 #include "core/hle/service/gsp/gsp_interrupt.h"
 
 namespace Service::GSP {
@@ -56,6 +57,9 @@ public:
     /// Notify rasterizer that any caches of the specified region should be invalidated
     void InvalidateRegion(PAddr addr, u32 size);
 
+    /// Notify rasterizer that any caches of the specified region should be flushed and invalidated
+    void FlushAndInvalidateRegion(PAddr addr, u32 size);
+
     /// Flushes and invalidates all memory in the rasterizer cache and removes any leftover state.
     void ClearAll(bool flush);
 
@@ -77,6 +81,9 @@ public:
     /// Synchronizes fixed function renderer state with PICA registers.
     void Sync();
 
+    /// Sets the title id of the running application, used to key per-title data.
+    void SetTitleId(u64 title_id);
+
     /// Returns a mutable reference to the renderer.
     [[nodiscard]] VideoCore::RendererBase& Renderer();
 
@@ -93,14 +100,56 @@ public:
     [[nodiscard]] GraphicsDebugger& Debugger();
 
 private:
+    void ExecuteCommand(const Service::GSP::Command& command);
+
+    void ProcessRegWrite(VAddr addr, u32 data);
+
+    /// Runs work on the GPU thread when asynchronous GPU emulation is enabled, immediately
+    /// otherwise.
+    void RunOnGPUThread(Common::UniqueFunction<void>&& work);
+
+    /// Waits for the GPU thread to finish its work and delivers the interrupts it raised.
+    void WaitIdle();
+
+    /// Signals an interrupt to the guest. Interrupts raised on the GPU thread are delivered by the
+    /// emulation thread later on.
+    void SignalInterrupt(Service::GSP::InterruptId id);
+
+    /// Delivers the interrupts raised on the GPU thread, called on the emulation thread.
+    void DeliverInterrupts();
+
+    void InterruptPollCallback(uintptr_t user_data, s64 cycles_late);
+
     void SubmitCmdList(u32 index);
 
     void MemoryFill(u32 index);
 
+    void FinishMemoryFill(u32 index);
+
+    /// Finishes a software memory fill still in flight, ahead of its scheduled interrupt.
+    void CompletePendingMemoryFill(u32 index);
+
     void MemoryTransfer();
 
+    void FinishMemoryTransfer();
+
+    /// Finishes a software display transfer still in flight, ahead of its scheduled interrupt.
+    void CompletePendingMemoryTransfer();
+
+    /// Schedules the completion of a software transfer that writes size bytes.
+    void ScheduleTransferDone(Service::GSP::InterruptId id, u32 size);
+
+    void TransferDoneCallback(uintptr_t user_data, s64 cycles_late);
+
     void VBlankCallback(uintptr_t user_data, s64 cycles_late);
 
+    /// Stores the current value of count GPU registers, starting at index, in the CiTrace being
+    /// recorded.
+    void RecordRegisters(u32 index, u32 count);
+
+    /// Stores a copy of the physical memory range in the CiTrace being recorded.
+    void RecordMemory(PAddr address, u32 size);
+
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const u32 file_version);
@@ -0,0 +1,58 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/microprofile.h"
+#include "common/perf_counters.h"
+#include "common/thread.h"
+#include "video_core/gpu_thread.h"
+
+namespace VideoCore {
+
+MICROPROFILE_DEFINE(GPU_WaitIdle, "GPU", "Wait for GPU thread", MP_RGB(255, 100, 100));
+
+GPUThread::GPUThread() : thread{[this](std::stop_token stop_token) { ThreadLoop(stop_token); }} {}
+
+GPUThread::~GPUThread() {
+    // Finish the queued work, it may still reference state owned by the caller.
+    WaitIdle();
+}
+
+void GPUThread::Push(Work&& work) {
+    submitted++;
+    queue.Push(std::move(work));
+}
+
+void GPUThread::WaitIdle() {
+    if (IsGPUThread()) {
+        return;
+    }
+    MICROPROFILE_SCOPE(GPU_WaitIdle);
+    const u64 target = submitted;
+    u64 current = completed.load(std::memory_order_acquire);
+    while (current < target) {
+        completed.wait(current, std::memory_order_acquire);
+        current = completed.load(std::memory_order_acquire);
+    }
+}
+
+bool GPUThread::IsGPUThread() const {
+    return std::this_thread::get_id() == thread.get_id();
+}
+
+void GPUThread::ThreadLoop(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("GPU");
+    Common::Perf::SetThreadName("GPU");
+    Common::SetCurrentThreadPriority(Common::ThreadPriority::High);
+    while (!stop_token.stop_requested()) {
+        Work work = queue.PopWait(stop_token);
+        if (!work) {
+            continue;
+        }
+        work();
+        completed.fetch_add(1, std::memory_order_release);
+        completed.notify_all();
+    }
+}
+
+} // namespace VideoCore
@@ -0,0 +1,51 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/threadsafe_queue.h"
+#include "common/unique_function.h"
+
+namespace VideoCore {
+
+/**
+ * Runs GPU work submitted by the emulation thread on a thread of its own. Work is executed in
+ * submission order, and the emulation thread waits for it with WaitIdle before it observes any
+ * state the work may modify.
+ */
+class GPUThread {
+public:
+    using Work = Common::UniqueFunction<void>;
+
+    GPUThread();
+    ~GPUThread();
+
+    GPUThread(const GPUThread&) = delete;
+    GPUThread& operator=(const GPUThread&) = delete;
+
+    /// Queues work to run on the GPU thread. Must only be called from the emulation thread.
+    void Push(Work&& work);
+
+    /// Blocks until all the work queued so far has run. Does nothing on the GPU thread itself.
+    void WaitIdle();
+
+    /// Returns true if the calling thread is the GPU thread.
+    [[nodiscard]] bool IsGPUThread() const;
+
+private:
+    void ThreadLoop(std::stop_token stop_token);
+
+    Common::SPSCQueue<Work, true> queue;
+    /// Number of work items pushed by the emulation thread.
+    u64 submitted{};
+    /// Number of work items the GPU thread finished, waited on by WaitIdle.
+    std::atomic<u64> completed{};
+    std::jthread thread;
+};
+
+} // namespace VideoCore
@@ -35,6 +35,9 @@ public:
     /// Reconfigures the pipeline according to current register settings
     void Reconfigure();
 
+    /// Checks if there is no vertex waiting for a geometry shader invocation
+    bool IsEmpty() const;
+
     /// Checks if the pipeline needs a direct input from index buffer
     bool NeedIndexInput() const;
 
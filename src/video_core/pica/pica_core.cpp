@@ -2,13 +2,17 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <bitset>
 #include "common/arch.h"
 #include "common/archives.h"
+#include "common/hash.h"
 #include "common/microprofile.h"
+#include "common/perf_counters.h"
 #include "common/scope_exit.h"
 #include "common/settings.h"
 #include "core/core.h"
 #include "core/memory.h"
+#include "core/tracer/recorder.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/pica/pica_core.h"
 #include "video_core/pica/vertex_loader.h"
@@ -18,6 +22,7 @@
 namespace Pica {
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
+MICROPROFILE_DEFINE(GPU_CmdlistDecoding, "GPU", "Cmdlist Decoding", MP_RGB(100, 200, 100));
 
 using namespace DebugUtils;
 
@@ -30,6 +35,61 @@ union CommandHeader {
 };
 static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect size!");
 
+// Expand a 4-bit mask to 4-byte mask, e.g. 0b0101 -> 0x00FF00FF
+constexpr std::array<u32, 16> ExpandBitsToBytes = {
+    0x00000000, 0x000000ff, 0x0000ff00, 0x0000ffff, 0x00ff0000, 0x00ff00ff,
+    0x00ffff00, 0x00ffffff, 0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ffff,
+    0xffff0000, 0xffff00ff, 0xffffff00, 0xffffffff,
+};
+
+/// Decoded command lists are dropped all at once when there are more than this many of them.
+constexpr std::size_t MAX_DECODED_CMD_LISTS = 256;
+
+/// Returns true for the registers that make the command list continue in another one.
+static bool IsCmdBufferTrigger(u32 id) {
+    return id == PICA_REG_INDEX(pipeline.command_buffer.trigger[0]) ||
+           id == PICA_REG_INDEX(pipeline.command_buffer.trigger[1]);
+}
+
+/**
+ * Returns the internal registers whose writes do more than update their value (the ones handled
+ * by PicaCore::WriteInternalReg), so they are never folded or dropped from a decoded command list.
+ */
+static const std::bitset<RegsInternal::NUM_REGS>& RegsWithSideEffects() {
+    static const auto regs = [] {
+        std::bitset<RegsInternal::NUM_REGS> result;
+        const auto set = [&result](u32 first, u32 count = 1) {
+            for (u32 id = first; id < first + count; id++) {
+                result.set(id);
+            }
+        };
+        set(PICA_REG_INDEX(trigger_irq));
+        set(PICA_REG_INDEX(pipeline.triangle_topology));
+        set(PICA_REG_INDEX(pipeline.restart_primitive));
+        set(PICA_REG_INDEX(pipeline.vs_default_attributes_setup.index));
+        set(PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value[0]), 3);
+        set(PICA_REG_INDEX(pipeline.command_buffer.trigger[0]), 2);
+        set(PICA_REG_INDEX(pipeline.trigger_draw));
+        set(PICA_REG_INDEX(pipeline.trigger_draw_indexed));
+        set(PICA_REG_INDEX(gs.bool_uniforms));
+        set(PICA_REG_INDEX(gs.int_uniforms[0]), 4);
+        set(PICA_REG_INDEX(gs.uniform_setup.set_value[0]), 8);
+        set(PICA_REG_INDEX(gs.program.set_word[0]), 8);
+        set(PICA_REG_INDEX(gs.swizzle_patterns.set_word[0]), 8);
+        set(PICA_REG_INDEX(vs.output_mask));
+        set(PICA_REG_INDEX(vs.bool_uniforms));
+        set(PICA_REG_INDEX(vs.int_uniforms[0]), 4);
+        set(PICA_REG_INDEX(vs.uniform_setup.set_value[0]), 8);
+        set(PICA_REG_INDEX(vs.program.set_word[0]), 8);
+        set(PICA_REG_INDEX(vs.swizzle_patterns.set_word[0]), 8);
+        set(PICA_REG_INDEX(lighting.lut_data[0]), 8);
+        set(PICA_REG_INDEX(texturing.fog_lut_data[0]), 8);
+        set(PICA_REG_INDEX(texturing.proctex_lut_data[0]), 8);
+        return result;
+    }();
+    return regs;
+}
+
 PicaCore::PicaCore(Memory::MemorySystem& memory_, std::shared_ptr<DebugContext> debug_context_)
     : memory{memory_}, debug_context{std::move(debug_context_)}, geometry_pipeline{regs.internal,
                                                                                    gs_unit,
@@ -92,11 +152,118 @@ void PicaCore::SetInterruptHandler(Service::GSP::InterruptHandler& signal_interr
     this->signal_interrupt = signal_interrupt;
 }
 
+void PicaCore::SetTitleId(u64 title_id) {
+    shader_engine->SetTitleId(title_id);
+}
+
 void PicaCore::ProcessCmdList(PAddr list, u32 size) {
     // Initialize command list tracking.
     const u8* head = memory.GetPhysicalPointer(list);
     cmd_list.Reset(list, head, size);
 
+    // Register tracing and command breakpoints need to see every write of the list.
+    const bool debugging =
+        IsPicaTracing() ||
+        (debug_context &&
+         (debug_context->breakpoints[static_cast<int>(DebugContext::Event::PicaCommandLoaded)]
+              .enabled ||
+          debug_context->breakpoints[static_cast<int>(DebugContext::Event::PicaCommandProcessed)]
+              .enabled));
+    if (debugging) {
+        ParseCmdList();
+        return;
+    }
+
+    // Writing a command buffer trigger resets cmd_list to the list it points to, the rest of the
+    // current list is not processed.
+    bool jumped;
+    do {
+        jumped = false;
+        for (const DecodedWrite& write : GetDecodedCmdList().writes) {
+            WriteInternalReg(write.id, write.value, write.mask);
+            if (IsCmdBufferTrigger(write.id)) {
+                jumped = true;
+                break;
+            }
+        }
+    } while (jumped);
+}
+
+const PicaCore::DecodedCmdList& PicaCore::GetDecodedCmdList() {
+    const std::size_t size_bytes = cmd_list.length * sizeof(u32);
+    const u64 hash = cmd_list.head ? Common::ComputeHash64(cmd_list.head, size_bytes) : 0;
+    const u64 key = (static_cast<u64>(cmd_list.addr) << 32) | cmd_list.length;
+    if (const auto it = cmd_list_cache.find(key); it != cmd_list_cache.end() &&
+                                                  it->second.hash == hash) {
+        cmd_list_cache_stats.hits++;
+        return it->second;
+    }
+
+    MICROPROFILE_SCOPE(GPU_CmdlistDecoding);
+    const auto start = std::chrono::steady_clock::now();
+    cmd_list_cache_stats.misses++;
+    if (cmd_list_cache.size() >= MAX_DECODED_CMD_LISTS) {
+        cmd_list_cache.clear();
+    }
+
+    DecodedCmdList& decoded = cmd_list_cache[key];
+    decoded.hash = hash;
+    decoded.writes.clear();
+    const auto& side_effects = RegsWithSideEffects();
+    const auto add_write = [&](u32 id, u32 value, u32 mask) {
+        const bool has_side_effects = id >= RegsInternal::NUM_REGS || side_effects[id];
+        if (has_side_effects) {
+            decoded.writes.push_back({static_cast<u16>(id), static_cast<u16>(mask), value});
+            return;
+        }
+        if (mask == 0) {
+            return;
+        }
+        if (!decoded.writes.empty() && decoded.writes.back().id == id) {
+            // Combine with the previous write, the bytes written by this one take precedence.
+            DecodedWrite& previous = decoded.writes.back();
+            const u32 previous_mask = ExpandBitsToBytes[previous.mask];
+            const u32 write_mask = ExpandBitsToBytes[mask];
+            previous.value = (previous.value & previous_mask & ~write_mask) | (value & write_mask);
+            previous.mask |= static_cast<u16>(mask);
+            return;
+        }
+        decoded.writes.push_back({static_cast<u16>(id), static_cast<u16>(mask), value});
+    };
+
+    u32 index = 0;
+    while (cmd_list.head && index < cmd_list.length) {
+        // Align read pointer to 8 bytes
+        if (index % 2 != 0) {
+            index++;
+        }
+
+        const u32 value = cmd_list.head[index++];
+        const CommandHeader header{cmd_list.head[index++]};
+        add_write(header.cmd_id, value, header.parameter_mask);
+        if (IsCmdBufferTrigger(header.cmd_id)) {
+            break;
+        }
+
+        bool jumped = false;
+        for (u32 i = 0; i < header.extra_data_length; ++i) {
+            const u32 cmd = header.cmd_id + (header.group_commands ? i + 1 : 0);
+            add_write(cmd, cmd_list.head[index++], header.parameter_mask);
+            if (IsCmdBufferTrigger(cmd)) {
+                jumped = true;
+                break;
+            }
+        }
+        if (jumped) {
+            break;
+        }
+    }
+
+    cmd_list_cache_stats.parse_time += std::chrono::steady_clock::now() - start;
+    return decoded;
+}
+
+void PicaCore::ParseCmdList() {
     while (cmd_list.current_index < cmd_list.length) {
         // Align read pointer to 8 bytes
         if (cmd_list.current_index % 2 != 0) {
@@ -128,13 +295,6 @@ void PicaCore::WriteInternalReg(u32 id, u32 value, u32 mask) {
         return;
     }
 
-    // Expand a 4-bit mask to 4-byte mask, e.g. 0b0101 -> 0x00FF00FF
-    constexpr std::array<u32, 16> ExpandBitsToBytes = {
-        0x00000000, 0x000000ff, 0x0000ff00, 0x0000ffff, 0x00ff0000, 0x00ff00ff,
-        0x00ffff00, 0x00ffffff, 0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ffff,
-        0xffff0000, 0xffff00ff, 0xffffff00, 0xffffffff,
-    };
-
     // TODO: Figure out how register masking acts on e.g. vs.uniform_setup.set_value
     const u32 old_value = regs.internal.reg_array[id];
     const u32 write_mask = ExpandBitsToBytes[mask];
@@ -234,7 +394,7 @@ void PicaCore::WriteInternalReg(u32 id, u32 value, u32 mask) {
             LOG_ERROR(HW_GPU, "Invalid GS program offset {}", offset);
         } else {
             gs_setup.program_code[offset] = value;
-            gs_setup.MarkProgramCodeDirty();
+            gs_setup.MarkProgramCodeDirty(offset);
             offset++;
         }
         break;
@@ -253,7 +413,7 @@ void PicaCore::WriteInternalReg(u32 id, u32 value, u32 mask) {
             LOG_ERROR(HW_GPU, "Invalid GS swizzle pattern offset {}", offset);
         } else {
             gs_setup.swizzle_data[offset] = value;
-            gs_setup.MarkSwizzleDataDirty();
+            gs_setup.MarkSwizzleDataDirty(offset);
             offset++;
         }
         break;
@@ -316,10 +476,10 @@ void PicaCore::WriteInternalReg(u32 id, u32 value, u32 mask) {
             LOG_ERROR(HW_GPU, "Invalid VS program offset {}", offset);
         } else {
             vs_setup.program_code[offset] = value;
-            vs_setup.MarkProgramCodeDirty();
+            vs_setup.MarkProgramCodeDirty(offset);
             if (!regs.internal.pipeline.gs_unit_exclusive_configuration) {
                 gs_setup.program_code[offset] = value;
-                gs_setup.MarkProgramCodeDirty();
+                gs_setup.MarkProgramCodeDirty(offset);
             }
             offset++;
         }
@@ -339,10 +499,10 @@ void PicaCore::WriteInternalReg(u32 id, u32 value, u32 mask) {
             LOG_ERROR(HW_GPU, "Invalid VS swizzle pattern offset {}", offset);
         } else {
             vs_setup.swizzle_data[offset] = value;
-            vs_setup.MarkSwizzleDataDirty();
+            vs_setup.MarkSwizzleDataDirty(offset);
             if (!regs.internal.pipeline.gs_unit_exclusive_configuration) {
                 gs_setup.swizzle_data[offset] = value;
-                gs_setup.MarkSwizzleDataDirty();
+                gs_setup.MarkSwizzleDataDirty(offset);
             }
             offset++;
         }
@@ -487,18 +647,29 @@ void PicaCore::DrawImmediate() {
 
 void PicaCore::DrawArrays(bool is_indexed) {
     MICROPROFILE_SCOPE(GPU_Drawing);
+    static const Common::Perf::Counter draw_calls{"Draw calls"};
+    draw_calls.Add();
+    PERF_TRACE_SCOPE("Draw");
 
     // Track vertex in the debug recorder.
     if (debug_context) {
         debug_context->OnEvent(DebugContext::Event::IncomingPrimitiveBatch, nullptr);
         SCOPE_EXIT(
             { debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr); });
+        if (debug_context->recorder) {
+            RecordDrawMemory(is_indexed);
+        }
     }
 
-    const bool accelerate_draw = [this] {
-        // Geometry shaders cannot be accelerated due to register preservation.
-        if (regs.internal.pipeline.use_gs == PipelineRegs::UseGS::Yes) {
-            return false;
+    const bool use_gs = regs.internal.pipeline.use_gs == PipelineRegs::UseGS::Yes;
+    const bool accelerate_draw = [this, use_gs] {
+        // The host geometry shader invocations run in parallel, so they all start from the
+        // registers the geometry shader unit has before the draw instead of preserving them
+        // from one invocation to the next. The rasterizer only accepts programs that do not
+        // depend on the registers of a previous invocation.
+        if (use_gs) {
+            return Settings::values.use_hw_shader && geometry_pipeline.IsEmpty() &&
+                   primitive_assembler.IsEmpty();
         }
 
         // TODO (wwylele): for Strip/Fan topology, if the primitive assember is not restarted
@@ -519,6 +690,9 @@ void PicaCore::DrawArrays(bool is_indexed) {
 
     // Attempt to use hardware vertex shaders if possible.
     if (accelerate_draw && rasterizer->AccelerateDrawBatch(is_indexed)) {
+        if (use_gs && regs.internal.pipeline.num_vertices > 0) {
+            gs_setup.uniforms.b[15] = true;
+        }
         return;
     }
 
@@ -529,6 +703,62 @@ void PicaCore::DrawArrays(bool is_indexed) {
     rasterizer->DrawTriangles();
 }
 
+void PicaCore::RecordDrawMemory(bool is_indexed) {
+    auto& recorder = *debug_context->recorder;
+    const auto record = [&](PAddr address, u32 size) {
+        const u8* data = memory.GetPhysicalPointer(address);
+        if (data && size > 0) {
+            recorder.MemoryAccessed(data, size, address);
+        }
+    };
+
+    const auto& pipeline = regs.internal.pipeline;
+    const PAddr base_address = pipeline.vertex_attributes.GetPhysicalBaseAddress();
+    if (pipeline.num_vertices == 0) {
+        return;
+    }
+
+    // Find the highest vertex read, so that the vertex arrays are only stored up to it.
+    u32 vertex_max = 0;
+    if (is_indexed) {
+        const PAddr index_address = base_address + pipeline.index_array.offset;
+        const u8* index_address_8 = memory.GetPhysicalPointer(index_address);
+        if (!index_address_8) {
+            return;
+        }
+        const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
+        const bool index_u16 = pipeline.index_array.format != 0;
+        for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+            const u32 vertex = index_u16 ? index_address_16[index] : index_address_8[index];
+            vertex_max = std::max(vertex_max, vertex);
+        }
+        record(index_address, pipeline.num_vertices * (index_u16 ? 2 : 1));
+    } else {
+        vertex_max = pipeline.vertex_offset + pipeline.num_vertices - 1;
+    }
+
+    for (const auto& loader : pipeline.vertex_attributes.attribute_loaders) {
+        if (loader.component_count != 0) {
+            record(base_address + loader.data_offset, (vertex_max + 1) * loader.byte_count);
+        }
+    }
+
+    // Cube map faces other than the first one are not stored.
+    for (const auto& texture : regs.internal.texturing.GetTextures()) {
+        if (!texture.enabled) {
+            continue;
+        }
+        const u32 bits_per_pixel = TexturingRegs::NibblesPerPixel(texture.format) * 4;
+        u32 size = 0;
+        for (u32 level = 0; level <= texture.config.lod.max_level; ++level) {
+            const u32 width = texture.config.width >> level;
+            const u32 height = texture.config.height >> level;
+            size += width * height * bits_per_pixel / 8;
+        }
+        record(texture.config.GetPhysicalAddress(), size);
+    }
+}
+
 void PicaCore::LoadVertices(bool is_indexed) {
     // Read and validate vertex information from the loaders
     const auto& pipeline = regs.internal.pipeline;
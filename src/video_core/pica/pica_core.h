@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <chrono>
+#include <unordered_map>
+#include <vector>
 #include "core/hle/service/gsp/gsp_interrupt.h"
 #include "video_core/pica/geometry_pipeline.h"
 #include "video_core/pica/packed_attribute.h"
@@ -36,11 +39,46 @@ public:
 
     void SetInterruptHandler(Service::GSP::InterruptHandler& signal_interrupt);
 
+    /// Sets the title id of the running application, used to key per-title data.
+    void SetTitleId(u64 title_id);
+
     void ProcessCmdList(PAddr list, u32 size);
 
+    /// Counters of the cache of pre-decoded command lists.
+    struct CmdListCacheStats {
+        u64 hits{};
+        u64 misses{};
+        /// Time spent decoding the command lists that missed the cache.
+        std::chrono::nanoseconds parse_time{};
+    };
+
+    [[nodiscard]] const CmdListCacheStats& GetCmdListCacheStats() const {
+        return cmd_list_cache_stats;
+    }
+
 private:
+    /// A register write of a pre-decoded command list.
+    struct DecodedWrite {
+        u16 id;
+        u16 mask;
+        u32 value;
+    };
+
+    /// The register writes of a command list, with its no-op writes removed and the consecutive
+    /// writes to a register folded together.
+    struct DecodedCmdList {
+        u64 hash;
+        std::vector<DecodedWrite> writes;
+    };
+
     void InitializeRegs();
 
+    /// Writes the registers of cmd_list word by word, following the jumps to other lists.
+    void ParseCmdList();
+
+    /// Returns the pre-decoded writes of cmd_list, decoding it if its contents are not cached.
+    const DecodedCmdList& GetDecodedCmdList();
+
     void WriteInternalReg(u32 id, u32 value, u32 mask);
 
     void SubmitImmediate(u32 data);
@@ -51,6 +89,9 @@ private:
 
     void LoadVertices(bool is_indexed);
 
+    /// Stores the vertex, index and texture data read by a draw in the CiTrace being recorded.
+    void RecordDrawMemory(bool is_indexed);
+
 public:
     union Regs {
         static constexpr std::size_t NUM_REGS = 0x732;
@@ -279,6 +320,9 @@ private:
     GeometryPipeline geometry_pipeline;
     PrimitiveAssembler primitive_assembler;
     CommandList cmd_list;
+    /// Pre-decoded command lists, keyed by their address and size.
+    std::unordered_map<u64, DecodedCmdList> cmd_list_cache;
+    CmdListCacheStats cmd_list_cache_stats;
     std::unique_ptr<ShaderEngine> shader_engine;
 };
 
@@ -4,7 +4,6 @@
 
 #include "common/assert.h"
 #include "common/bit_set.h"
-#include "common/hash.h"
 #include "common/logging/log.h"
 #include "video_core/pica/regs_shader.h"
 #include "video_core/pica/shader_setup.h"
@@ -47,19 +46,11 @@ std::optional<u32> ShaderSetup::WriteUniformFloatReg(ShaderRegs& config, u32 val
 }
 
 u64 ShaderSetup::GetProgramCodeHash() {
-    if (program_code_hash_dirty) {
-        program_code_hash = Common::ComputeHash64(&program_code, sizeof(program_code));
-        program_code_hash_dirty = false;
-    }
-    return program_code_hash;
+    return program_code_hash.Get(program_code);
 }
 
 u64 ShaderSetup::GetSwizzleDataHash() {
-    if (swizzle_data_hash_dirty) {
-        swizzle_data_hash = Common::ComputeHash64(&swizzle_data, sizeof(swizzle_data));
-        swizzle_data_hash_dirty = false;
-    }
-    return swizzle_data_hash;
+    return swizzle_data_hash.Get(swizzle_data);
 }
 
 } // namespace Pica
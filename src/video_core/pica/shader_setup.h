@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <bit>
 #include <optional>
+#include "common/hash.h"
 #include "common/vector_math.h"
 #include "video_core/pica/packed_attribute.h"
 #include "video_core/pica_types.h"
@@ -17,6 +19,52 @@ constexpr u32 MAX_SWIZZLE_DATA_LENGTH = 4096;
 using ProgramCode = std::array<u32, MAX_PROGRAM_CODE_LENGTH>;
 using SwizzleData = std::array<u32, MAX_SWIZZLE_DATA_LENGTH>;
 
+/**
+ * Hash of a shader memory that is kept up to date incrementally. The memory is split in blocks
+ * with a hash each, and only the blocks written to since the last query are hashed again.
+ */
+template <std::size_t N>
+class IncrementalHash {
+public:
+    static constexpr std::size_t BLOCK_LENGTH = 64;
+    static constexpr std::size_t NUM_BLOCKS = N / BLOCK_LENGTH;
+    static_assert(N % BLOCK_LENGTH == 0 && NUM_BLOCKS <= 64);
+
+    /// Returns the hash the given memory would have, without any cached state.
+    static u64 Compute(const std::array<u32, N>& data) {
+        return IncrementalHash{}.Get(data);
+    }
+
+    void MarkDirty(u32 offset) {
+        dirty_mask |= u64{1} << (offset / BLOCK_LENGTH);
+    }
+
+    void MarkAllDirty() {
+        dirty_mask = ALL_BLOCKS;
+    }
+
+    u64 Get(const std::array<u32, N>& data) {
+        if (dirty_mask == 0) {
+            return hash;
+        }
+        for (u64 mask = dirty_mask; mask != 0; mask &= mask - 1) {
+            const std::size_t block = std::countr_zero(mask);
+            block_hashes[block] = Common::ComputeHash64(data.data() + block * BLOCK_LENGTH,
+                                                        BLOCK_LENGTH * sizeof(u32));
+        }
+        hash = Common::ComputeHash64(block_hashes.data(), sizeof(block_hashes));
+        dirty_mask = 0;
+        return hash;
+    }
+
+private:
+    static constexpr u64 ALL_BLOCKS = ~u64{0} >> (64 - NUM_BLOCKS);
+
+    std::array<u64, NUM_BLOCKS> block_hashes{};
+    u64 dirty_mask{ALL_BLOCKS};
+    u64 hash{};
+};
+
 struct Uniforms {
     alignas(16) std::array<Common::Vec4<f24>, 96> f;
     std::array<bool, 16> b;
@@ -65,12 +113,22 @@ public:
 
     u64 GetSwizzleDataHash();
 
+    /// Marks the word of the program code at offset as written.
+    void MarkProgramCodeDirty(u32 offset) {
+        program_code_hash.MarkDirty(offset);
+    }
+
     void MarkProgramCodeDirty() {
-        program_code_hash_dirty = true;
+        program_code_hash.MarkAllDirty();
+    }
+
+    /// Marks the word of the swizzle data at offset as written.
+    void MarkSwizzleDataDirty(u32 offset) {
+        swizzle_data_hash.MarkDirty(offset);
     }
 
     void MarkSwizzleDataDirty() {
-        swizzle_data_hash_dirty = true;
+        swizzle_data_hash.MarkAllDirty();
     }
 
 public:
@@ -82,10 +140,8 @@ public:
     const void* cached_shader{};
 
 private:
-    bool program_code_hash_dirty{true};
-    bool swizzle_data_hash_dirty{true};
-    u64 program_code_hash{0xDEADC0DE};
-    u64 swizzle_data_hash{0xDEADC0DE};
+    IncrementalHash<MAX_PROGRAM_CODE_LENGTH> program_code_hash;
+    IncrementalHash<MAX_SWIZZLE_DATA_LENGTH> swizzle_data_hash;
 
     friend class boost::serialization::access;
     template <class Archive>
@@ -94,10 +150,17 @@ private:
         ar& uniform_queue;
         ar& program_code;
         ar& swizzle_data;
-        ar& program_code_hash_dirty;
-        ar& swizzle_data_hash_dirty;
-        ar& program_code_hash;
-        ar& swizzle_data_hash;
+        // The hashes are recomputed after loading, these used to hold the cached ones.
+        bool hash_dirty = true;
+        u64 hash = 0;
+        ar& hash_dirty;
+        ar& hash_dirty;
+        ar& hash;
+        ar& hash;
+        if (Archive::is_loading::value) {
+            MarkProgramCodeDirty();
+            MarkSwizzleDataDirty();
+        }
     }
 };
 
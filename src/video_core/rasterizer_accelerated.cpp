@@ -2,14 +2,19 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <fmt/format.h>
 #include "common/alignment.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
 #include "common/settings.h"
 #include "core/memory.h"
 #include "video_core/pica/pica_core.h"
 #include "video_core/rasterizer_accelerated.h"
 
-#include <set>
-
 namespace VideoCore {
 
 using Pica::f24;
@@ -897,6 +902,277 @@ static void MatrixMultiply(float m[16], const float a[16], const float b[16]) {
     }
 }
 
+namespace {
+
+// Draws ignored before the auto-detection starts, a lot of these are just things like intro
+// videos etc.
+constexpr u32 VR_HEURISTIC_START = 5000;
+// Draws after which the auto-detection stops, as we should have a good hit by then and we don't
+// want to waste precious CPU
+constexpr u32 VR_HEURISTIC_STOP = 250000;
+// Only one in this many draws is scored, consecutive draws mostly see the same uniforms anyway
+constexpr u32 VR_HEURISTIC_SAMPLE_RATE = 8;
+
+/// Returns the bit of the distinct value bitmap that a value (rounded to 4dp) maps to
+u64 ValueSketchBit(float value) {
+    const u32 rounded = static_cast<u32>(std::floor(value * 10000.f));
+    return u64{1} << ((rounded * 0x9E3779B1U) >> 26);
+}
+
+/// Estimates the number of distinct values inserted in a bitmap using linear counting
+float EstimateDistinctValues(u64 values) {
+    constexpr float BITS = 64.f;
+    const int set_bits = std::popcount(values);
+    if (set_bits == 64) {
+        return BITS * std::log(BITS);
+    }
+    return -BITS * std::log((BITS - set_bits) / BITS);
+}
+
+std::string GetVRHeuristicPath(u64 title_id) {
+    return fmt::format("{}vr_heuristic" DIR_SEP "{:016X}.txt",
+                       FileUtil::GetUserPath(FileUtil::UserPath::ConfigDir), title_id);
+}
+
+} // Anonymous namespace
+
+void RasterizerAccelerated::LoadVRHeuristic() {
+    auto& state = vr_heuristic_state;
+    state.initialized = true;
+    if (state.title_id == 0) {
+        // Without a title id there is nowhere to store the result, just detect it every boot
+        return;
+    }
+
+    std::string data;
+    if (FileUtil::ReadFileToString(true, GetVRHeuristicPath(state.title_id), data) == 0) {
+        return;
+    }
+    HeuristicResult result;
+    if (std::sscanf(data.c_str(), "%d %d %d", &result.view_matrixregister,
+                    &result.eye_indicator_register, &result.eye_indicator_reg_index) != 3 ||
+        result.view_matrixregister < 0 || result.view_matrixregister > 91 ||
+        result.eye_indicator_register < -1 || result.eye_indicator_register >= 96 ||
+        result.eye_indicator_reg_index < -1 || result.eye_indicator_reg_index > 3 ||
+        (result.eye_indicator_register == -1) != (result.eye_indicator_reg_index == -1)) {
+        LOG_WARNING(Render, "Ignoring invalid VR auto-detection result for title {:016X}",
+                    state.title_id);
+        return;
+    }
+
+    LOG_INFO(Render, "Using stored VR auto-detection result for title {:016X}", state.title_id);
+    vr_heuristic = result;
+    state.done = true;
+}
+
+void RasterizerAccelerated::SetTitleId(u64 title_id) {
+    vr_heuristic_state.title_id = title_id;
+}
+
+void RasterizerAccelerated::SaveVRHeuristic() const {
+    const auto& state = vr_heuristic_state;
+    if (state.title_id == 0 || vr_heuristic.view_matrixregister == -1) {
+        return;
+    }
+
+    const std::string path = GetVRHeuristicPath(state.title_id);
+    if (!FileUtil::CreateFullPath(path)) {
+        LOG_ERROR(Render, "Failed to create the directory of {}", path);
+        return;
+    }
+    const std::string data =
+        fmt::format("{} {} {}\n", vr_heuristic.view_matrixregister,
+                    vr_heuristic.eye_indicator_register, vr_heuristic.eye_indicator_reg_index);
+    if (FileUtil::WriteStringToFile(true, path, data) != data.size()) {
+        LOG_ERROR(Render, "Failed to write the VR auto-detection result to {}", path);
+    }
+}
+
+/*
+ * The following is a "heuristic" algorithm that guesses (pretty well actually!) both the number of the
+ * register for the view transformation matrix and also the left/right eye indicator register based on a bunch of
+ * characteristics I gathered by looking at the register values for a few games. If it gets it wrong, then it is
+ * still possible to supply your own values using the config options, but the default now should be using this
+ * "auto-detect" routine.
+ */
+void RasterizerAccelerated::UpdateVRHeuristic(const Pica::Shader::Generator::VSPicaUniformData& vs_uniforms)
+{
+    auto& state = vr_heuristic_state;
+    if (!state.initialized) {
+        LoadVRHeuristic();
+    }
+    if (state.done) {
+        return;
+    }
+
+    // use a counter to ignore the first number of times through here, and then only score
+    // every few draws
+    const u32 draw = ++state.draws;
+    if (draw >= VR_HEURISTIC_STOP) {
+        state.done = true;
+        SaveVRHeuristic();
+        return;
+    }
+    if (draw <= VR_HEURISTIC_START || (draw - VR_HEURISTIC_START) % VR_HEURISTIC_SAMPLE_RATE != 0) {
+        return;
+    }
+    const u32 samples = ++state.samples;
+
+    const auto& f = vs_uniforms.uniforms.f;
+    constexpr float EPSILON = 0.00001f;
+    auto between = [=](float l, float v, float r) { return v <= r && v >= l; };
+    static constexpr int identityMatrix[16] = {
+            1, 0, 0, 0,
+            0, 1, 0, 0,
+            0, 0, 1, 0,
+            0, 0, 0, 1
+    };
+
+    for (int r = 0; r < 96; ++r)
+    {
+        /*
+         * This block does the scoring for the possible view matrix register
+         */
+        if (r <= 91)
+        {
+            float& score = state.view_matrix_scores[r];
+
+            //Check that all the values are between -1 and 1
+            //don't include values that might be positional and values in the final 4x4 row
+            bool valid = true;
+            for (int i = 0; i < 3 && valid; ++i) {
+                for (int j = 0; j < 3 && valid; ++j) {
+                    valid = between(-1.f, f[r + i][j], 1.f);
+                }
+            }
+
+            //only proceed to score if register could legitimately be a view matrix
+            if (valid) {
+                score += 1;
+
+                //bonus point if register appear to be an identity matrix
+                bool isIdentity = true;
+                for (int i = 0; i < 3 && isIdentity; ++i) {
+                    for (int j = 0; j < 3 && isIdentity; ++j) {
+                        isIdentity = (int)std::roundf(f[r + i][j]) == identityMatrix[i * 4 + j];
+                    }
+                }
+                if (isIdentity) {
+                    score += 1;
+                }
+
+                //another bonus point if the absolute position values in the matrix are bigger than 1
+                if (fabsf(f[r].w) > 1.f && fabsf(f[r+1].w) > 1.f && fabsf(f[r+2].w) > 1.f) {
+                    score += 1;
+                }
+
+                //another bonus point if the last position contains 0, 1, 2, 3 or 0, 0, 0, 1
+                if ((f[r + 3].x == 0.f && f[r + 3].y == 0.f && f[r + 3].z == 0.f &&
+                     f[r + 3].w == 1.f) ||
+                    (f[r + 3].x == 0.f && f[r + 3].y == 1.f && f[r + 3].z == 2.f &&
+                     f[r + 3].w == 3.f))
+                {
+                    score += 1;
+                }
+
+                //Certain values in the register should never be exactly 0
+                if (f[r].x == 0.f || f[r + 1].y == 0.f || f[r + 2].z == 0.f) {
+                    score -= 2;
+                }
+
+                // final bonus point if register is a commonly occuring one
+                if (r == 90 || r == 4 || r == 8) {
+                    score += 1;
+                }
+            } else {
+                //Not possibly a view matrix, subtract a point as punishment, but don't go below 0
+                if (score > 0)
+                    score -= 1;
+            }
+        }
+
+        /*
+         * This block does the scoring for the possible left/right eye indicator register, typical characteristics
+         * of that register are:
+         *   * Its value has a more or less equal number of negative and positive values over time
+         *   * It is a small number greater than almost 0 and less than 0.1
+         *   * It only has a small amount of variance in its values (rounded to 4dp)
+         *   * Frequently selected registers get a small bonus, as they then become more likely to be the correct ones
+         */
+        for (int i = 0; i <= 3; ++i)
+        {
+            float value = fabsf(f[r][i]);
+
+            auto &regscore = state.eye_indicator_scores[r * 4 + i];
+
+            if (value < 0.1f && value > EPSILON)
+            {
+                if (f[r][i] < 0.f)
+                {
+                    regscore.neg++;
+                }
+                else
+                {
+                    regscore.pos++;
+                }
+
+                //Remember the value rounded, we are looking for the register with the least variance
+                regscore.values |= ValueSketchBit(value);
+            }
+
+            // recalc score
+            if (regscore.neg > 0 && regscore.pos > 0)
+            {
+                const u32 max = std::max(regscore.neg, regscore.pos);
+                const u32 min = std::min(regscore.neg, regscore.pos);
+                const float distinct = std::max(EstimateDistinctValues(regscore.values), 1.f);
+                regscore.score = ((min * 1000.0f) / (max * distinct)) *
+                                 (static_cast<float>(min + max) / samples);
+
+                //If this register has only seen 1 or two legit values, then punish it
+                if (std::popcount(regscore.values) < 2)
+                {
+                    regscore.score /= 10.0f;
+                }
+
+                //Add on any bonuses this register has received
+                regscore.score += regscore.bonus;
+            }
+        }
+    }
+
+    //Now find the highest scoring registers/index
+    float topscore = 0.f;
+    float mat_topscore = 0.f;
+    for (int r = 0; r < 96; ++r)
+    {
+        if (state.view_matrix_scores[r] > mat_topscore) {
+            vr_heuristic.view_matrixregister = r;
+            mat_topscore = state.view_matrix_scores[r];
+        }
+
+        for (int i = 0; i <= 3; ++i)
+        {
+            if (state.eye_indicator_scores[r * 4 + i].score > topscore)
+            {
+                vr_heuristic.eye_indicator_register = r;
+                vr_heuristic.eye_indicator_reg_index = i;
+                topscore = state.eye_indicator_scores[r * 4 + i].score;
+            }
+        }
+    }
+
+    if (mat_topscore != 0.f) {
+        state.view_matrix_scores[vr_heuristic.view_matrixregister] += 0.05f; // small perk for being selected
+    }
+
+    if (topscore != 0.0f)
+    {
+        state.eye_indicator_scores[vr_heuristic.eye_indicator_register * 4 +
+                                   vr_heuristic.eye_indicator_reg_index].bonus += 0.001f; // small perk for being selected
+    }
+}
+
 void RasterizerAccelerated::ApplyVRDataToPicaVSUniforms(Pica::Shader::Generator::VSPicaUniformData &vs_uniforms)
 {
     if (vr_immersive_mode)
@@ -934,205 +1210,10 @@ void RasterizerAccelerated::ApplyVRDataToPicaVSUniforms(Pica::Shader::Generator:
 
         const bool findLeftRightEyeIndicator = Settings::values.vr_immersive_eye_indicator.GetValue().empty();
 
-        /*
-         * The following section is a "heuristic" algorithm that guesses (pretty well actually!) both the number of the
-         * register for the view transformation matrix and also the left/right eye indicator register based on a bunch of
-         * characteristics I gathered by looking at the register values for a few games. If it gets it wrong, then it is
-         * still possible to supply your own values using the config options, but the default now should be using this
-         * "auto-detect" routine.
-         */
         if (viewMatrixIndex == -1 && mode >= 3)
         {
-            struct regscore
-            {
-                regscore() {
-                    neg = pos = 0;
-                    score = bonus = 0.f;
-                }
-                int neg;
-                int pos;
-                std::set<float> values;
-                float score;
-                float bonus;
-            };
-
-            //static array to keep track of the way the data changes in each register location
-            static regscore regscores[96 * 4];
-            static regscore regscores2[96];
-
-            // use a counter to ignore the first number of
-            // times through here, as a lot of these will
-            // just be things like intro videos etc
-            static int counter = 0;
-            constexpr int start = 5000;
-            constexpr int stop = 250000;
-            constexpr float EPSILON = 0.00001f;
-            auto between = [=](float l, float v, float r) { return v <= r && v >= l; };
-            static int identityMatrix[16] = {
-                    1, 0, 0, 0,
-                    0, 1, 0, 0,
-                    0, 0, 1, 0,
-                    0, 0, 0, 1
-            };
-
-            if (++counter > start)
-            {
-                //Stop collecting after a period of time as we should have a good hit by now
-                //we don't want to waste precious CPU
-                if (counter < stop)
-                {
-                    for (int r = 0; r < 96; ++r)
-                    {
-                        /*
-                         * This block does the scoring for the possible view matrix register
-                         */
-                        if (r <= 91)
-                        {
-                            //Check that all the values are between -1 and 1
-                            //don't include values that might be positional and values in the final 4x4 row
-                            bool valid = true;
-                            for (int i = 0; i < 3 && valid; ++i) {
-                                for (int j = 0; j < 3 && valid; ++j) {
-                                    valid = between(-1.f, f[r + i][j], 1.f);
-                                }
-                            }
-
-                            //only proceed to score if register could legitimately be a view matrix
-                            if (valid) {
-                                regscores2[r].score += 1;
-
-                                //bonus point if register appear to be an identity matrix
-                                bool isIdentity = true;
-                                for (int i = 0; i < 3 && isIdentity; ++i) {
-                                    for (int j = 0; j < 3 && isIdentity; ++j) {
-                                        isIdentity = (int)std::roundf(f[r + i][j]) == identityMatrix[i * 4 + j];
-                                    }
-                                }
-                                if (isIdentity) {
-                                    regscores2[r].score += 1;
-                                }
-
-                                //another bonus point if the absolute position values in the matrix are bigger than 1
-                                if (fabsf(f[r].w) > 1.f && fabsf(f[r+1].w) > 1.f && fabsf(f[r+2].w) > 1.f) {
-                                    regscores2[r].score += 1;
-                                }
-
-                                //another bonus point if the last position contains 0, 1, 2, 3 or 0, 0, 0, 1
-                                if ((f[r + 3].x == 0.f && f[r + 3].y == 0.f && f[r + 3].z == 0.f &&
-                                     f[r + 3].w == 1.f) ||
-                                    (f[r + 3].x == 0.f && f[r + 3].y == 1.f && f[r + 3].z == 2.f &&
-                                     f[r + 3].w == 3.f))
-                                {
-                                    regscores2[r].score += 1;
-                                }
-
-                                //Certain values in the register should never be exactly 0
-                                if (f[r].x == 0.f || f[r + 1].y == 0.f || f[r + 2].z == 0.f) {
-                                    regscores2[r].score -= 2;
-                                }
-
-                                // final bonus point if register is a commonly occuring one
-                                if (r == 90 || r == 4 || r == 8) {
-                                    regscores2[r].score += 1;
-                                }
-                            } else {
-                                //Not possibly a view matrix, subtract a point as punishment, but don't go below 0
-                                if (regscores2[r].score > 0)
-                                    regscores2[r].score -= 1;
-                            }
-                        }
-
-                        /*
-                         * This block does the scoring for the possible left/right eye indicator register, typical characteristics
-                         * of that register are:
-                         *   * Its value has a more or less equal number of negative and positive values over time
-                         *   * It is a small number greater than almost 0 and less than 0.1
-                         *   * It only has a small amount of variance in its values (rounded to 5dp)
-                         *   * Frequently selected registers get a small bonus, as they then become more likely to be the correct ones
-                         */
-                        for (int i = 0; i <= 3; ++i)
-                        {
-                            float value = fabsf(f[r][i]);
-
-                            auto &regscore = regscores[r * 4 + i];
-
-                            if (value < 0.1f && value > EPSILON)
-                            {
-                                if (f[r][i] < 0.f)
-                                {
-                                    regscore.neg++;
-                                }
-                                else
-                                {
-                                    regscore.pos++;
-                                }
-
-                                //Store the value rounded, we are looking for the register with the least variance
-                                regscore.values.insert(
-                                        floorf(value * 10000) / 10000);
-                            }
-
-                            // recalc score
-                            if (regscore.neg > 0 &&
-                                    regscore.pos > 0 &&
-                                    regscore.values.size() > 0)
-                            {
-                                int max = std::max<int>(regscore.neg,
-                                                        regscore.pos);
-                                int min = std::min<int>(regscore.neg,
-                                                        regscore.pos);
-                                regscore.score =
-                                        ((min * 1000.0f) /
-                                         (float) (max *
-                                                 regscore.values.size())) *
-                                        ((float) (min + max) / (counter - start));
-
-                                //If this register has only seen 1 or two legit values, then punish it
-                                if (regscore.values.size() < 2)
-                                {
-                                    regscore.score /= 10.0f;
-                                }
-
-                                //Add on any bonuses this register has received
-                                regscore.score += regscore.bonus;
-                            }
-                        }
-                    }
-
-                    //Now find the highest scoring registers/index
-                    float topscore = 0.f;
-                    float mat_topscore = 0.f;
-                    for (int r = 0; r < 96; ++r)
-                    {
-                        if (regscores2[r].score > mat_topscore) {
-                            vr_heuristic.view_matrixregister = r;
-                            mat_topscore = regscores2[r].score;
-                        }
-
-                        for (int i = 0; i <= 3; ++i)
-                        {
-                            if (regscores[r * 4 + i].score > topscore)
-                            {
-                                vr_heuristic.eye_indicator_register = r;
-                                vr_heuristic.eye_indicator_reg_index = i;
-                                topscore = regscores[r * 4 + i].score;
-                            }
-                        }
-                    }
-
-                    if (mat_topscore != 0.f) {
-                        regscores2[vr_heuristic.view_matrixregister].score += 0.05f; // small perk for being selected
-                    }
-
-                    if (topscore != 0.0f)
-                    {
-                        regscores[vr_heuristic.eye_indicator_register * 4 +
-                                  vr_heuristic.eye_indicator_reg_index].bonus += 0.001f; // small perk for being selected
-                    }
-                }
-
-                viewMatrixIndex = vr_heuristic.view_matrixregister;
-            }
+            UpdateVRHeuristic(vs_uniforms);
+            viewMatrixIndex = vr_heuristic.view_matrixregister;
         }
 
         if (viewMatrixIndex != -1 && vs_uniforms.uniforms.f.size() > viewMatrixIndex)
@@ -1167,8 +1248,8 @@ void RasterizerAccelerated::ApplyVRDataToPicaVSUniforms(Pica::Shader::Generator:
                 //
                 // The pair of values (e.g "87,2") represents the offset of the Vec4f in the vs pica uniforms and the
                 // index into that Vec4 of the value that is check for: -ve for left eye and +ve for right eye
-                float eye_indicator_register = vr_heuristic.eye_indicator_register;
-                float eye_indicator_reg_index = vr_heuristic.eye_indicator_reg_index;
+                int eye_indicator_register = vr_heuristic.eye_indicator_register;
+                int eye_indicator_reg_index = vr_heuristic.eye_indicator_reg_index;
                 //If the user _has_ defined this (unlikely!) then use the config setting
                 if (!findLeftRightEyeIndicator)
                 {
@@ -1182,9 +1263,10 @@ void RasterizerAccelerated::ApplyVRDataToPicaVSUniforms(Pica::Shader::Generator:
                 }
 
                 //If we found/know a viable register/index, then use it for left/right eye logic
-                if (eye_indicator_register != -1 &&
-                        eye_indicator_reg_index != -1 &&
-                        eye_indicator_register < vs_uniforms.uniforms.f.size() &&
+                // Negative values, -1 included, mean that there is no indicator
+                if (eye_indicator_register >= 0 &&
+                        eye_indicator_reg_index >= 0 && eye_indicator_reg_index <= 3 &&
+                        eye_indicator_register < static_cast<int>(vs_uniforms.uniforms.f.size()) &&
                         (eye_indicator_register < viewMatrixIndex ||
                             eye_indicator_register > viewMatrixIndex + 3) &&
                         f[eye_indicator_register][eye_indicator_reg_index] != 0.0f)
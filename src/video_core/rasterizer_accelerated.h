@@ -184,8 +184,39 @@ protected:
         int32_t eye_indicator_reg_index = -1;
     } vr_heuristic;
 
+    /// Statistics gathered by the view matrix and eye indicator auto-detection. The distinct
+    /// values seen by each eye indicator candidate are kept in a small hashed bitmap, so scoring
+    /// a draw never allocates.
+    struct HeuristicState {
+        struct EyeIndicatorScore {
+            u32 neg = 0;
+            u32 pos = 0;
+            u64 values = 0;
+            float score = 0.f;
+            float bonus = 0.f;
+        };
+        std::array<EyeIndicatorScore, 96 * 4> eye_indicator_scores{};
+        std::array<float, 96> view_matrix_scores{};
+        u32 draws = 0;
+        u32 samples = 0;
+        u64 title_id = 0;
+        bool initialized = false;
+        bool done = false;
+    } vr_heuristic_state;
+
+    /// Scores the uniforms of a sampled draw and updates vr_heuristic with the best candidates
+    void UpdateVRHeuristic(const Pica::Shader::Generator::VSPicaUniformData& vs_uniforms);
+
+    /// Loads the result of a previous auto-detection of the running title, if there is one
+    void LoadVRHeuristic();
+
+    /// Stores the auto-detection result so that later boots of the title can skip it
+    void SaveVRHeuristic() const;
+
 public:
     void ApplyVRDataToPicaVSUniforms(Pica::Shader::Generator::VSPicaUniformData &vs_uniforms);
+
+    void SetTitleId(u64 title_id) override;
 };
 
 } // namespace VideoCore
@@ -6,10 +6,10 @@
 
 #include <type_traits>
 #include <boost/container/small_vector.hpp>
-#include <boost/range/iterator_range.hpp>
 #include "common/alignment.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/perf_counters.h"
 #include "common/scope_exit.h"
 #include "common/settings.h"
 #include "core/memory.h"
@@ -28,10 +28,6 @@ MICROPROFILE_DECLARE(RasterizerCache_UploadSurface);
 MICROPROFILE_DECLARE(RasterizerCache_DownloadSurface);
 MICROPROFILE_DECLARE(RasterizerCache_Invalidation);
 
-constexpr auto RangeFromInterval(const auto& map, const auto& interval) {
-    return boost::make_iterator_range(map.equal_range(interval));
-}
-
 template <class T>
 RasterizerCache<T>::RasterizerCache(Memory::MemorySystem& memory_,
                                     CustomTexManager& custom_tex_manager_, Runtime& runtime_,
@@ -790,8 +786,9 @@ template <typename Func>
 void RasterizerCache<T>::ForEachSurfaceInRegion(PAddr addr, std::size_t size, Func&& func) {
     using FuncReturn = typename std::invoke_result<Func, SurfaceId, Surface&>::type;
     static constexpr bool BOOL_BREAK = std::is_same_v<FuncReturn, bool>;
-    boost::container::small_vector<SurfaceId, 8> surfaces;
-    ForEachPage(addr, size, [this, &surfaces, addr, size, func](u64 page) {
+    const u64 region_end = u64{addr} + size;
+    const u64 first_page = addr >> CITRA_PAGEBITS;
+    ForEachPage(addr, size, [this, addr, region_end, first_page, &func](u64 page) {
         const auto it = page_table.find(page);
         if (it == page_table.end()) {
             if constexpr (BOOL_BREAK) {
@@ -800,32 +797,32 @@ void RasterizerCache<T>::ForEachSurfaceInRegion(PAddr addr, std::size_t size, Fu
                 return;
             }
         }
-        for (const SurfaceId surface_id : it->second) {
-            Surface& surface = slot_surfaces[surface_id];
-            if (True(surface.flags & SurfaceFlagBits::Picked)) {
+        // The entries are sorted by address, so the first one past the region ends the search.
+        for (const PageEntry& entry : it->second) {
+            if (entry.addr >= region_end) {
+                break;
+            }
+            if (entry.end <= addr) {
                 continue;
             }
-            if (!surface.Overlaps(addr, size)) {
+            // Surfaces spanning several pages are only visited on the first page they share with
+            // the region.
+            if (std::max<u64>(entry.addr >> CITRA_PAGEBITS, first_page) != page) {
                 continue;
             }
-
-            surface.flags |= SurfaceFlagBits::Picked;
-            surfaces.push_back(surface_id);
+            const SurfaceId surface_id = entry.surface_id;
             if constexpr (BOOL_BREAK) {
-                if (func(surface_id, surface)) {
+                if (func(surface_id, slot_surfaces[surface_id])) {
                     return true;
                 }
             } else {
-                func(surface_id, surface);
+                func(surface_id, slot_surfaces[surface_id]);
             }
         }
         if constexpr (BOOL_BREAK) {
             return false;
         }
     });
-    for (const SurfaceId surface_id : surfaces) {
-        slot_surfaces[surface_id].flags &= ~SurfaceFlagBits::Picked;
-    }
 }
 
 template <class T>
@@ -837,7 +834,7 @@ SurfaceId RasterizerCache<T>::FindMatch(const SurfaceParams& params, ScaleMatch
     u32 match_scale = 0;
     SurfaceInterval match_interval{};
 
-    ForEachSurfaceInRegion(params.addr, params.size, [&](SurfaceId surface_id, Surface& surface) {
+    const auto check_surface = [&](SurfaceId surface_id, Surface& surface) {
         const bool res_scale_matched = match_scale_type == ScaleMatch::Exact
                                            ? (params.res_scale == surface.res_scale)
                                            : (params.res_scale <= surface.res_scale);
@@ -911,7 +908,18 @@ SurfaceId RasterizerCache<T>::FindMatch(const SurfaceParams& params, ScaleMatch
         IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::TexCopy>{}, [&] {
             return std::make_pair(surface.CanTexCopy(params), surface.GetInterval());
         });
-    });
+    };
+
+    if constexpr (find_flags == MatchFlags::Exact) {
+        const auto it = exact_surfaces.find(MakeExactKey(params));
+        if (it != exact_surfaces.end()) {
+            for (const SurfaceId surface_id : it->second) {
+                check_surface(surface_id, slot_surfaces[surface_id]);
+            }
+        }
+    } else {
+        ForEachSurfaceInRegion(params.addr, params.size, check_surface);
+    }
     return match_id;
 }
 
@@ -993,6 +1001,9 @@ void RasterizerCache<T>::ValidateSurface(SurfaceId surface_id, PAddr addr, u32 s
 template <class T>
 void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interval) {
     MICROPROFILE_SCOPE(RasterizerCache_UploadSurface);
+    static const Common::Perf::Counter surface_uploads{"Surface uploads"};
+    surface_uploads.Add();
+    PERF_TRACE_SCOPE("Upload surface");
 
     const SurfaceParams load_info = surface.FromInterval(interval);
     ASSERT(load_info.addr >= surface.addr && load_info.end <= surface.end);
@@ -1091,6 +1102,9 @@ bool RasterizerCache<T>::UploadCustomSurface(SurfaceId surface_id, SurfaceInterv
 template <class T>
 void RasterizerCache<T>::DownloadSurface(Surface& surface, SurfaceInterval interval) {
     MICROPROFILE_SCOPE(RasterizerCache_DownloadSurface);
+    static const Common::Perf::Counter surface_downloads{"Surface downloads"};
+    surface_downloads.Add();
+    PERF_TRACE_SCOPE("Download surface");
 
     const SurfaceParams flush_info = surface.FromInterval(interval);
     const u32 flush_start = boost::icl::first(interval);
@@ -1183,7 +1197,7 @@ bool RasterizerCache<T>::ValidateByReinterpretation(Surface& surface, SurfacePar
     // If there's a surface with invalid format it means the region was cleared
     // so we don't want to skip validation in that case.
     const bool has_invalid = IntervalHasInvalidPixelFormat(params, interval);
-    const bool is_gpu_modified = boost::icl::contains(dirty_regions, interval);
+    const bool is_gpu_modified = dirty_regions.Contains(interval);
     return !has_invalid && is_gpu_modified;
 }
 
@@ -1205,26 +1219,20 @@ bool RasterizerCache<T>::IntervalHasInvalidPixelFormat(const SurfaceParams& para
 
 template <class T>
 void RasterizerCache<T>::ClearAll(bool flush) {
-    const auto flush_interval = PageMap::interval_type::right_open(0x0, 0xFFFFFFFF);
     // Force flush all surfaces from the cache
     if (flush) {
         FlushRegion(0x0, 0xFFFFFFFF);
     }
     // Unmark all of the marked pages
-    for (auto& pair : RangeFromInterval(cached_pages, flush_interval)) {
-        const auto interval = pair.first & flush_interval;
-
-        const PAddr interval_start_addr = boost::icl::first(interval) << Memory::CITRA_PAGE_BITS;
-        const PAddr interval_end_addr = boost::icl::last_next(interval) << Memory::CITRA_PAGE_BITS;
-        const u32 interval_size = interval_end_addr - interval_start_addr;
-
-        memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
-    }
+    cached_pages.Clear([this](u32 page, u32 num_pages) {
+        memory.RasterizerMarkRegionCached(page << Memory::CITRA_PAGE_BITS,
+                                          num_pages << Memory::CITRA_PAGE_BITS, false);
+    });
 
     // Remove the whole cache without really looking at it.
-    cached_pages -= flush_interval;
-    dirty_regions.clear();
+    dirty_regions.Clear();
     page_table.clear();
+    exact_surfaces.clear();
 }
 
 template <class T>
@@ -1234,9 +1242,9 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, SurfaceId flush_surfa
     }
 
     const SurfaceInterval flush_interval(addr, addr + size);
-    SurfaceRegions flushed_intervals;
+    boost::container::small_vector<SurfaceInterval, 4> flushed_intervals;
 
-    for (const auto& [region, surface_id] : RangeFromInterval(dirty_regions, flush_interval)) {
+    for (const auto& [region, surface_id] : dirty_regions.Overlapping(flush_interval)) {
         if (flush_surface_id && surface_id != flush_surface_id) {
             continue;
         }
@@ -1252,7 +1260,7 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, SurfaceId flush_surfa
                                "RasterizerCache::FlushRegion (from {:#x} to {:#x})",
                                interval.lower(), interval.upper()};
 
-        SCOPE_EXIT({ flushed_intervals += interval; });
+        SCOPE_EXIT({ flushed_intervals.push_back(interval); });
         if (surface.type == SurfaceType::Fill) {
             DownloadFillSurface(surface, interval);
             continue;
@@ -1271,7 +1279,9 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, SurfaceId flush_surfa
     }
 
     // Reset dirty regions
-    dirty_regions -= flushed_intervals;
+    for (const SurfaceInterval& interval : flushed_intervals) {
+        dirty_regions.Erase(interval);
+    }
 }
 
 template <class T>
@@ -1316,9 +1326,9 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, SurfaceId region
     });
 
     if (region_owner_id) {
-        dirty_regions.set({invalid_interval, region_owner_id});
+        dirty_regions.Set(invalid_interval, region_owner_id);
     } else {
-        dirty_regions.erase(invalid_interval);
+        dirty_regions.Erase(invalid_interval);
     }
 
     for (const SurfaceId surface_id : remove_surfaces) {
@@ -1355,8 +1365,15 @@ void RasterizerCache<T>::RegisterSurface(SurfaceId surface_id) {
 
     surface.flags |= SurfaceFlagBits::Registered;
     UpdatePagesCachedCount(surface.addr, surface.size, 1);
-    ForEachPage(surface.addr, surface.size,
-                [this, surface_id](u64 page) { page_table[page].push_back(surface_id); });
+    const PageEntry entry{surface.addr, surface.end, surface_id};
+    ForEachPage(surface.addr, surface.size, [this, &entry](u64 page) {
+        std::vector<PageEntry>& entries = page_table[page];
+        const auto it = std::upper_bound(
+            entries.begin(), entries.end(), entry.addr,
+            [](PAddr addr, const PageEntry& other) { return addr < other.addr; });
+        entries.insert(it, entry);
+    });
+    exact_surfaces[MakeExactKey(surface)].push_back(surface_id);
 }
 
 template <class T>
@@ -1373,15 +1390,25 @@ void RasterizerCache<T>::UnregisterSurface(SurfaceId surface_id) {
             ASSERT_MSG(false, "Unregistering unregistered page=0x{:x}", page << CITRA_PAGEBITS);
             return;
         }
-        std::vector<SurfaceId>& surfaces = page_it.value();
-        const auto vector_it = std::find(surfaces.begin(), surfaces.end(), surface_id);
-        if (vector_it == surfaces.end()) {
+        std::vector<PageEntry>& entries = page_it.value();
+        const auto vector_it = std::find_if(entries.begin(), entries.end(), [&](const auto& entry) {
+            return entry.surface_id == surface_id;
+        });
+        if (vector_it == entries.end()) {
             ASSERT_MSG(false, "Unregistering unregistered surface in page=0x{:x}",
                        page << CITRA_PAGEBITS);
             return;
         }
-        surfaces.erase(vector_it);
+        entries.erase(vector_it);
     });
+    const auto exact_it = exact_surfaces.find(MakeExactKey(surface));
+    if (exact_it != exact_surfaces.end()) {
+        auto& surfaces = exact_it->second;
+        surfaces.erase(std::find(surfaces.begin(), surfaces.end(), surface_id));
+        if (surfaces.empty()) {
+            exact_surfaces.erase(exact_it);
+        }
+    }
 
     if (surface.type != SurfaceType::Fill) {
         RemoveTextureCubeFace(surface_id);
@@ -1395,9 +1422,9 @@ void RasterizerCache<T>::UnregisterSurface(SurfaceId surface_id) {
 template <class T>
 void RasterizerCache<T>::UnregisterAll() {
     FlushAll();
-    for (auto& [page, surfaces] : page_table) {
-        while (!surfaces.empty()) {
-            UnregisterSurface(surfaces.back());
+    for (auto& [page, entries] : page_table) {
+        while (!entries.empty()) {
+            UnregisterSurface(entries.back().surface_id);
         }
     }
     runtime.Finish();
@@ -1407,38 +1434,12 @@ void RasterizerCache<T>::UnregisterAll() {
 
 template <class T>
 void RasterizerCache<T>::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
-    const u32 num_pages =
-        ((addr + size - 1) >> Memory::CITRA_PAGE_BITS) - (addr >> Memory::CITRA_PAGE_BITS) + 1;
     const u32 page_start = addr >> Memory::CITRA_PAGE_BITS;
-    const u32 page_end = page_start + num_pages;
-
-    // Interval maps will erase segments if count reaches 0, so if delta is negative we have to
-    // subtract after iterating
-    const auto pages_interval = PageMap::interval_type::right_open(page_start, page_end);
-    if (delta > 0) {
-        cached_pages.add({pages_interval, delta});
-    }
-
-    for (const auto& pair : RangeFromInterval(cached_pages, pages_interval)) {
-        const auto interval = pair.first & pages_interval;
-        const int count = pair.second;
-
-        const PAddr interval_start_addr = boost::icl::first(interval) << Memory::CITRA_PAGE_BITS;
-        const PAddr interval_end_addr = boost::icl::last_next(interval) << Memory::CITRA_PAGE_BITS;
-        const u32 interval_size = interval_end_addr - interval_start_addr;
-
-        if (delta > 0 && count == delta) {
-            memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, true);
-        } else if (delta < 0 && count == -delta) {
-            memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
-        } else {
-            ASSERT(count >= 0);
-        }
-    }
-
-    if (delta < 0) {
-        cached_pages.add({pages_interval, delta});
-    }
+    const u32 page_end = ((addr + size - 1) >> Memory::CITRA_PAGE_BITS) + 1;
+    cached_pages.Update(page_start, page_end, delta, [this, delta](u32 page, u32 num_pages) {
+        memory.RasterizerMarkRegionCached(page << Memory::CITRA_PAGE_BITS,
+                                          num_pages << Memory::CITRA_PAGE_BITS, delta > 0);
+    });
 }
 
 } // namespace VideoCore
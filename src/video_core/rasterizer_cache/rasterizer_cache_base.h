@@ -10,10 +10,12 @@
 #include <span>
 #include <unordered_map>
 #include <vector>
-#include <boost/icl/interval_map.hpp>
+#include <boost/container/small_vector.hpp>
 #include <tsl/robin_map.h>
 
+#include "common/hash.h"
 #include "video_core/rasterizer_cache/framebuffer_base.h"
+#include "video_core/rasterizer_cache/region_tracker.h"
 #include "video_core/rasterizer_cache/sampler_params.h"
 #include "video_core/rasterizer_cache/surface_params.h"
 #include "video_core/rasterizer_cache/texture_cube.h"
@@ -68,12 +70,41 @@ class RasterizerCache {
     using Framebuffer = typename T::Framebuffer;
     using DebugScope = typename T::DebugScope;
 
-    using SurfaceMap = boost::icl::interval_map<PAddr, SurfaceId, boost::icl::partial_absorber,
-                                                std::less, boost::icl::inplace_plus,
-                                                boost::icl::inter_section, SurfaceInterval>;
-
     using SurfaceRect_Tuple = std::pair<SurfaceId, Common::Rectangle<u32>>;
-    using PageMap = boost::icl::interval_map<u32, int>;
+
+    /// Surface registered in a page of the page table.
+    struct PageEntry {
+        PAddr addr;
+        PAddr end;
+        SurfaceId surface_id;
+    };
+
+    /// Fields compared by SurfaceParams::ExactMatch, used to look up exact matches directly.
+    struct ExactKey {
+        PAddr addr;
+        u32 width;
+        u32 height;
+        u32 stride;
+        PixelFormat pixel_format;
+        bool is_tiled;
+
+        bool operator==(const ExactKey&) const = default;
+    };
+
+    struct ExactKeyHash {
+        std::size_t operator()(const ExactKey& key) const noexcept {
+            u64 hash = Common::HashCombine(key.addr, u64{key.width} << 32 | key.height);
+            hash = Common::HashCombine(hash, u64{key.stride} << 32 |
+                                                 static_cast<u32>(key.pixel_format) << 1 |
+                                                 key.is_tiled);
+            return static_cast<std::size_t>(hash);
+        }
+    };
+
+    static ExactKey MakeExactKey(const SurfaceParams& params) {
+        return {params.addr,   params.width,        params.height,
+                params.stride, params.pixel_format, params.is_tiled};
+    }
 
 public:
     explicit RasterizerCache(Memory::MemorySystem& memory, CustomTexManager& custom_tex_manager,
@@ -140,7 +171,7 @@ private:
     /// Iterate over all page indices in a range
     template <typename Func>
     void ForEachPage(PAddr addr, std::size_t size, Func&& func) {
-        static constexpr bool RETURNS_BOOL = std::is_same_v<std::invoke_result<Func, u64>, bool>;
+        static constexpr bool RETURNS_BOOL = std::is_same_v<std::invoke_result_t<Func, u64>, bool>;
         const u64 page_end = (addr + size - 1) >> CITRA_PAGEBITS;
         for (u64 page = addr >> CITRA_PAGEBITS; page <= page_end; ++page) {
             if constexpr (RETURNS_BOOL) {
@@ -218,15 +249,19 @@ private:
     Pica::RegsInternal& regs;
     RendererBase& renderer;
     std::unordered_map<TextureCubeConfig, TextureCube> texture_cube_cache;
-    tsl::robin_pg_map<u64, std::vector<SurfaceId>, Common::IdentityHash<u64>> page_table;
+    /// Surfaces overlapping every page, sorted by address.
+    tsl::robin_pg_map<u64, std::vector<PageEntry>, Common::IdentityHash<u64>> page_table;
+    /// Registered surfaces by the fields that have to match for an exact match.
+    std::unordered_map<ExactKey, boost::container::small_vector<SurfaceId, 1>, ExactKeyHash>
+        exact_surfaces;
     std::unordered_map<FramebufferParams, FramebufferId> framebuffers;
     std::unordered_map<SamplerParams, SamplerId> samplers;
     std::list<std::pair<SurfaceId, u64>> sentenced;
     Common::SlotVector<Surface> slot_surfaces;
     Common::SlotVector<Sampler> slot_samplers;
     Common::SlotVector<Framebuffer> slot_framebuffers;
-    SurfaceMap dirty_regions;
-    PageMap cached_pages;
+    DirtyRegions dirty_regions;
+    CachedPages cached_pages;
     u32 resolution_scale_factor;
     u64 frame_tick{};
     FramebufferParams fb_params;
@@ -0,0 +1,101 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include "video_core/rasterizer_cache/region_tracker.h"
+
+namespace VideoCore {
+
+void DirtyRegions::Set(SurfaceInterval interval, SurfaceId owner) {
+    if (boost::icl::is_empty(interval)) {
+        return;
+    }
+    Erase(interval);
+
+    const PAddr start = interval.lower();
+    const PAddr end = interval.upper();
+    // Adjacent regions of the same owner are merged, since small CPU flushes write back whole
+    // regions.
+    const auto pos = regions.begin() + FirstEndingAfter(start);
+    const auto prev = pos != regions.begin() ? std::prev(pos) : regions.end();
+    const bool merge_prev =
+        prev != regions.end() && prev->interval.upper() == start && prev->owner == owner;
+    const bool merge_next =
+        pos != regions.end() && pos->interval.lower() == end && pos->owner == owner;
+
+    if (merge_prev && merge_next) {
+        prev->interval = SurfaceInterval{prev->interval.lower(), pos->interval.upper()};
+        regions.erase(pos);
+    } else if (merge_prev) {
+        prev->interval = SurfaceInterval{prev->interval.lower(), end};
+    } else if (merge_next) {
+        pos->interval = SurfaceInterval{start, pos->interval.upper()};
+    } else {
+        regions.insert(pos, Region{interval, owner});
+    }
+}
+
+void DirtyRegions::Erase(SurfaceInterval interval) {
+    if (boost::icl::is_empty(interval)) {
+        return;
+    }
+    const PAddr start = interval.lower();
+    const PAddr end = interval.upper();
+    const auto first = regions.begin() + FirstEndingAfter(start);
+    auto last = first;
+    while (last != regions.end() && last->interval.lower() < end) {
+        ++last;
+    }
+    if (first == last) {
+        return;
+    }
+
+    // Keep the parts of the straddling regions that lie outside of the interval.
+    std::optional<Region> head;
+    std::optional<Region> tail;
+    if (first->interval.lower() < start) {
+        head = Region{SurfaceInterval{first->interval.lower(), start}, first->owner};
+    }
+    if (const Region& back = *std::prev(last); back.interval.upper() > end) {
+        tail = Region{SurfaceInterval{end, back.interval.upper()}, back.owner};
+    }
+    auto it = regions.erase(first, last);
+    if (tail) {
+        it = regions.insert(it, *tail);
+    }
+    if (head) {
+        regions.insert(it, *head);
+    }
+}
+
+bool DirtyRegions::Contains(SurfaceInterval interval) const {
+    PAddr cursor = interval.lower();
+    for (auto it = regions.begin() + FirstEndingAfter(cursor); cursor < interval.upper(); ++it) {
+        if (it == regions.end() || it->interval.lower() > cursor) {
+            return false;
+        }
+        cursor = it->interval.upper();
+    }
+    return true;
+}
+
+std::span<const DirtyRegions::Region> DirtyRegions::Overlapping(SurfaceInterval interval) const {
+    const std::size_t first = FirstEndingAfter(interval.lower());
+    std::size_t last = first;
+    while (last < regions.size() && regions[last].interval.lower() < interval.upper()) {
+        last++;
+    }
+    return std::span{regions}.subspan(first, last - first);
+}
+
+std::size_t DirtyRegions::FirstEndingAfter(PAddr addr) const {
+    const auto it = std::upper_bound(
+        regions.begin(), regions.end(), addr,
+        [](PAddr value, const Region& region) { return value < region.interval.upper(); });
+    return static_cast<std::size_t>(std::distance(regions.begin(), it));
+}
+
+} // namespace VideoCore
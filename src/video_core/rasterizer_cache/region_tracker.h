@@ -0,0 +1,136 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+#include "common/assert.h"
+#include "common/common_types.h"
+#include "video_core/rasterizer_cache/slot_id.h"
+#include "video_core/rasterizer_cache/surface_params.h"
+
+namespace VideoCore {
+
+/**
+ * Tracks which surface owns the most recent data of every region of guest memory. The regions are
+ * kept in a flat vector sorted by address, with adjacent regions of the same owner merged, so
+ * lookups are binary searches and updates only move a few elements.
+ */
+class DirtyRegions {
+public:
+    struct Region {
+        SurfaceInterval interval;
+        SurfaceId owner;
+    };
+
+    /// Makes owner the owner of interval, replacing the previous owners.
+    void Set(SurfaceInterval interval, SurfaceId owner);
+
+    /// Removes interval from the tracked regions, splitting the regions that straddle it.
+    void Erase(SurfaceInterval interval);
+
+    /// Returns true if all of interval is owned by surfaces.
+    [[nodiscard]] bool Contains(SurfaceInterval interval) const;
+
+    /// Returns the regions overlapping interval, unclipped. Invalidated by any modification.
+    [[nodiscard]] std::span<const Region> Overlapping(SurfaceInterval interval) const;
+
+    void Clear() {
+        regions.clear();
+    }
+
+private:
+    /// Returns the index of the first region ending after addr.
+    std::size_t FirstEndingAfter(PAddr addr) const;
+
+    std::vector<Region> regions;
+};
+
+/**
+ * Counts the registered surfaces overlapping every guest page, to know which pages have to be
+ * marked as cached in the memory system. The counts are stored in flat arrays allocated on first
+ * use for every 4 MiB of the physical address space.
+ */
+class CachedPages {
+    static constexpr u32 CHUNK_BITS = 10;
+    static constexpr u32 PAGES_PER_CHUNK = 1U << CHUNK_BITS;
+    static constexpr u32 NUM_CHUNKS = (1U << 20) >> CHUNK_BITS;
+
+    using Chunk = std::array<u16, PAGES_PER_CHUNK>;
+
+public:
+    /**
+     * Adds delta to the count of every page in [page_start, page_end).
+     * @param func Called as func(page, num_pages) for every run of pages whose count became zero
+     * or stopped being zero.
+     */
+    template <typename Func>
+    void Update(u32 page_start, u32 page_end, s32 delta, Func&& func) {
+        u32 run_start = page_start;
+        u32 run_length = 0;
+        for (u32 page = page_start; page < page_end; page++) {
+            u16& count = GetCount(page);
+            const s32 new_count = count + delta;
+            ASSERT(new_count >= 0 && new_count <= std::numeric_limits<u16>::max());
+            const bool changed = (count == 0) != (new_count == 0);
+            count = static_cast<u16>(new_count);
+            if (!changed) {
+                continue;
+            }
+            if (run_length != 0 && run_start + run_length != page) {
+                func(run_start, run_length);
+                run_length = 0;
+            }
+            if (run_length == 0) {
+                run_start = page;
+            }
+            run_length++;
+        }
+        if (run_length != 0) {
+            func(run_start, run_length);
+        }
+    }
+
+    /// Resets every count, calling func(page, num_pages) for every run of pages that was cached.
+    template <typename Func>
+    void Clear(Func&& func) {
+        for (u32 chunk_index = 0; chunk_index < NUM_CHUNKS; chunk_index++) {
+            auto& chunk = chunks[chunk_index];
+            if (!chunk) {
+                continue;
+            }
+            const u32 base = chunk_index << CHUNK_BITS;
+            u32 page = 0;
+            while (page < PAGES_PER_CHUNK) {
+                if ((*chunk)[page] == 0) {
+                    page++;
+                    continue;
+                }
+                const u32 run_start = page;
+                while (page < PAGES_PER_CHUNK && (*chunk)[page] != 0) {
+                    page++;
+                }
+                func(base + run_start, page - run_start);
+            }
+            chunk.reset();
+        }
+    }
+
+private:
+    u16& GetCount(u32 page) {
+        auto& chunk = chunks[page >> CHUNK_BITS];
+        if (!chunk) {
+            chunk = std::make_unique<Chunk>();
+        }
+        return (*chunk)[page & (PAGES_PER_CHUNK - 1)];
+    }
+
+    std::array<std::unique_ptr<Chunk>, NUM_CHUNKS> chunks;
+};
+
+} // namespace VideoCore
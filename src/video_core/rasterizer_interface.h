@@ -83,6 +83,9 @@ public:
 
     virtual void SyncEntireState() {}
 
+    /// Sets the title id of the running application, used to key per-title data
+    virtual void SetTitleId([[maybe_unused]] u64 title_id) {}
+
     /// Set VR position data on the rasterizer
     virtual void SetVRData(const int32_t &vrImmersiveMode, const float& immersiveModeFactor, int uoffset, const float& gamePosScaler, const float inv_view[16]) {}
 };
@@ -66,6 +66,11 @@ public:
     /// This is called to notify the rendering backend of a surface change
     virtual void NotifySurfaceChanged() {}
 
+    /// Returns true if the rasterizer can run on a thread other than the emulation thread
+    virtual bool SupportsAsyncGpu() const {
+        return false;
+    }
+
     /// Returns the resolution scale factor relative to the native 3DS screen resolution
     u32 GetResolutionScaleFactor();
 
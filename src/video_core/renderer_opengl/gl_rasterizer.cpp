@@ -49,6 +49,24 @@ GLenum MakePrimitiveMode(Pica::PipelineRegs::TriangleTopology topology) {
     return GL_TRIANGLES;
 }
 
+GLenum MakeGeometryShaderInputMode(u32 vertices_per_invocation) {
+    switch (vertices_per_invocation) {
+    case 1:
+        return GL_POINTS;
+    case 2:
+        return GL_LINES;
+    case 3:
+        return GL_TRIANGLES;
+    case 4:
+        return GL_LINES_ADJACENCY;
+    case 6:
+        return GL_TRIANGLES_ADJACENCY;
+    default:
+        UNREACHABLE();
+    }
+    return GL_POINTS;
+}
+
 GLenum MakeAttributeType(Pica::PipelineRegs::VertexAttributeFormat format) {
     switch (format) {
     case Pica::PipelineRegs::VertexAttributeFormat::BYTE:
@@ -97,6 +115,8 @@ RasterizerOpenGL::RasterizerOpenGL(Memory::MemorySystem& memory, Pica::PicaCore&
     glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_buffer_alignment);
     uniform_size_aligned_vs_pica =
         Common::AlignUp<std::size_t>(sizeof(VSPicaUniformData), uniform_buffer_alignment);
+    uniform_size_aligned_gs_pica =
+        Common::AlignUp<std::size_t>(sizeof(GSPicaUniformData), uniform_buffer_alignment);
     uniform_size_aligned_vs =
         Common::AlignUp<std::size_t>(sizeof(VSUniformData), uniform_buffer_alignment);
     uniform_size_aligned_fs =
@@ -273,8 +293,7 @@ bool RasterizerOpenGL::SetupGeometryShader() {
     MICROPROFILE_SCOPE(OpenGL_GS);
 
     if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
-        LOG_ERROR(Render_OpenGL, "Accelerate draw doesn't support geometry shader");
-        return false;
+        return shader_manager.UseProgrammableGeometryShader(regs, pica.gs_setup);
     }
 
     // Enable the quaternion fix-up geometry-shader only if we are actually doing per-fragment
@@ -297,6 +316,12 @@ bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
         if (regs.pipeline.triangle_topology != Pica::PipelineRegs::TriangleTopology::Shader) {
             return false;
         }
+        // Vertices left over from an incomplete invocation would be carried to the next draw.
+        const u32 vertices_per_invocation = GetGSVerticesPerInvocation(regs);
+        if (vertices_per_invocation == 0 ||
+            regs.pipeline.num_vertices % vertices_per_invocation != 0) {
+            return false;
+        }
     }
 
     if (!SetupVertexShader()) {
@@ -311,7 +336,10 @@ bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
 }
 
 bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
-    const GLenum primitive_mode = MakePrimitiveMode(regs.pipeline.triangle_topology);
+    const GLenum primitive_mode =
+        regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No
+            ? MakeGeometryShaderInputMode(GetGSVerticesPerInvocation(regs))
+            : MakePrimitiveMode(regs.pipeline.triangle_topology);
     auto [vs_input_index_min, vs_input_index_max, vs_input_size] = AnalyzeVertexArray(is_indexed);
 
     if (vs_input_size > VERTEX_BUFFER_SIZE) {
@@ -1095,14 +1123,16 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
     state.Apply();
 
     const bool sync_vs_pica = accelerate_draw;
+    const bool sync_gs_pica =
+        accelerate_draw && regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No;
     const bool sync_vs = vs_uniform_block_data.dirty;
     const bool sync_fs = fs_uniform_block_data.dirty;
     if (!sync_vs_pica && !sync_vs && !sync_fs) {
         return;
     }
 
-    std::size_t uniform_size =
-        uniform_size_aligned_vs_pica + uniform_size_aligned_vs + uniform_size_aligned_fs;
+    std::size_t uniform_size = uniform_size_aligned_vs_pica + uniform_size_aligned_gs_pica +
+                               uniform_size_aligned_vs + uniform_size_aligned_fs;
     std::size_t used_bytes = 0;
 
     const auto [uniforms, offset, invalidate] =
@@ -1138,6 +1168,16 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
         used_bytes += uniform_size_aligned_vs_pica;
     }
 
+    if (sync_gs_pica) {
+        GSPicaUniformData gs_uniforms;
+        gs_uniforms.uniforms.SetFromRegs(regs.gs, pica.gs_setup);
+
+        std::memcpy(uniforms + used_bytes, &gs_uniforms, sizeof(gs_uniforms));
+        glBindBufferRange(GL_UNIFORM_BUFFER, UniformBindings::GSPicaData,
+                          uniform_buffer.GetHandle(), offset + used_bytes, sizeof(gs_uniforms));
+        used_bytes += uniform_size_aligned_gs_pica;
+    }
+
     uniform_buffer.Unmap(used_bytes);
 }
 
@@ -94,7 +94,9 @@ static std::tuple<PicaVSConfig, Pica::ShaderSetup> BuildVSConfigFromRaw(
 
     // Enable the geometry-shader only if we are actually doing per-fragment lighting
     // and care about proper quaternions. Otherwise just use standard vertex+fragment shaders
-    const bool use_geometry_shader = !raw.GetRawShaderConfig().lighting.disable;
+    const auto& regs = raw.GetRawShaderConfig();
+    const bool use_geometry_shader =
+        regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No || !regs.lighting.disable;
     return {PicaVSConfig{raw.GetRawShaderConfig(), setup, driver.HasClipCullDistance(),
                          use_geometry_shader},
             setup};
@@ -252,6 +254,9 @@ private:
 using ProgrammableVertexShaders =
     ShaderDoubleCache<PicaVSConfig, &GLSL::GenerateVertexShader, GL_VERTEX_SHADER>;
 
+using ProgrammableGeometryShaders =
+    ShaderDoubleCache<PicaGSConfig, &GLSL::GenerateGeometryShader, GL_GEOMETRY_SHADER>;
+
 using FixedGeometryShaders =
     ShaderCache<PicaFixedGSConfig, &GLSL::GenerateFixedGeometryShader, GL_GEOMETRY_SHADER>;
 
@@ -261,7 +266,8 @@ class ShaderProgramManager::Impl {
 public:
     explicit Impl(const Driver& driver, bool separable)
         : separable(separable), programmable_vertex_shaders(separable),
-          trivial_vertex_shader(driver, separable), fixed_geometry_shaders(separable),
+          trivial_vertex_shader(driver, separable), programmable_geometry_shaders(separable),
+          fixed_geometry_shaders(separable),
           fragment_shaders(separable), disk_cache(separable) {
         if (separable) {
             pipeline.Create();
@@ -320,6 +326,7 @@ public:
     ProgrammableVertexShaders programmable_vertex_shaders;
     TrivialVertexShader trivial_vertex_shader;
 
+    ProgrammableGeometryShaders programmable_geometry_shaders;
     FixedGeometryShaders fixed_geometry_shaders;
 
     FragmentShaders fragment_shaders;
@@ -339,8 +346,10 @@ ShaderProgramManager::~ShaderProgramManager() = default;
 bool ShaderProgramManager::UseProgrammableVertexShader(const Pica::RegsInternal& regs,
                                                        Pica::ShaderSetup& setup) {
     // Enable the geometry-shader only if we are actually doing per-fragment lighting
-    // and care about proper quaternions. Otherwise just use standard vertex+fragment shaders
-    const bool use_geometry_shader = !regs.lighting.disable;
+    // and care about proper quaternions, or if the PICA geometry shader is in use. Otherwise just
+    // use standard vertex+fragment shaders
+    const bool use_geometry_shader =
+        regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No || !regs.lighting.disable;
 
     PicaVSConfig config{regs, setup, driver.HasClipCullDistance(), use_geometry_shader};
     auto [handle, result] = impl->programmable_vertex_shaders.Get(config, setup);
@@ -370,6 +379,18 @@ void ShaderProgramManager::UseTrivialVertexShader() {
     impl->current.vs_hash = 0;
 }
 
+bool ShaderProgramManager::UseProgrammableGeometryShader(const Pica::RegsInternal& regs,
+                                                         Pica::ShaderSetup& setup) {
+    PicaGSConfig gs_config{regs, setup, driver.HasClipCullDistance()};
+    auto [handle, _] = impl->programmable_geometry_shaders.Get(gs_config, setup);
+    if (handle == 0) {
+        return false;
+    }
+    impl->current.gs = handle;
+    impl->current.gs_hash = gs_config.Hash();
+    return true;
+}
+
 void ShaderProgramManager::UseFixedGeometryShader(const Pica::RegsInternal& regs) {
     PicaFixedGSConfig gs_config(regs, driver.HasClipCullDistance());
     auto [handle, _] = impl->fixed_geometry_shaders.Get(gs_config, impl->separable);
@@ -29,6 +29,7 @@ enum UniformBindings {
     VSPicaData = 0,
     VSData = 1,
     FSData = 2,
+    GSPicaData = 3,
 };
 
 /// A class that manage different shader stages and configures them with given config data.
@@ -44,6 +45,8 @@ public:
 
     void UseTrivialVertexShader();
 
+    bool UseProgrammableGeometryShader(const Pica::RegsInternal& regs, Pica::ShaderSetup& setup);
+
     void UseFixedGeometryShader(const Pica::RegsInternal& regs);
 
     void UseTrivialGeometryShader();
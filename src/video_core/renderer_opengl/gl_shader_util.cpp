@@ -8,12 +8,17 @@
 #include <glad/glad.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/perf_counters.h"
 #include "video_core/renderer_opengl/gl_shader_util.h"
 #include "video_core/renderer_opengl/gl_vars.h"
 
 namespace OpenGL {
 
 GLuint LoadShader(std::string_view source, GLenum type) {
+    static const Common::Perf::Counter shader_compiles{"Shader compiles"};
+    shader_compiles.Add();
+    PERF_TRACE_SCOPE("Compile shader");
+
     std::string preamble;
     if (GLES) {
         preamble = R"(#version 320 es
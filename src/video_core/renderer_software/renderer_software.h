@@ -36,6 +36,9 @@ public:
     void SwapBuffers() override;
     void TryPresent(int timeout_ms, bool is_secondary) override {}
     void Sync() override {}
+    bool SupportsAsyncGpu() const override {
+        return true;
+    }
 
 private:
     void PrepareRenderTarget();
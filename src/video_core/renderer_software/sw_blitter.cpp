@@ -2,6 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+
 #include "common/alignment.h"
 #include "common/color.h"
 #include "common/vector_math.h"
@@ -13,28 +17,264 @@
 
 namespace SwRenderer {
 
-static Common::Vec4<u8> DecodePixel(Pica::PixelFormat input_format, const u8* src_pixel) {
+namespace {
+
+using ScalingMode = Pica::DisplayTransferConfig::ScalingMode;
+
+/// Transfers with fewer output pixels than this are processed on the calling thread.
+constexpr u32 MIN_PARALLEL_TRANSFER_PIXELS = 64 * 64;
+
+/// Fills smaller than this (in bytes) are processed on the calling thread.
+constexpr u32 MIN_PARALLEL_FILL_SIZE = 64 * 1024;
+
+/// Transfers are bound by memory bandwidth, splitting them further does not help.
+constexpr u32 MAX_TASKS_PER_TRANSFER = 4;
+
+/// Fill patterns are expanded to 12 bytes, which holds a whole number of 16, 24 and 32-bit values.
+constexpr u32 FILL_PATTERN_SIZE = 12;
+
+struct TransferParams {
+    const u8* src;
+    u8* dst;
+    u32 input_width;
+    u32 output_width;
+    u32 output_height;
+    bool flip_vertically;
+    bool input_linear;
+    bool dont_swizzle;
+};
+
+using TransferRowsFunc = void (*)(const TransferParams&, u32, u32);
+
+template <Pica::PixelFormat format>
+Common::Vec4<u8> DecodePixel(const u8* src_pixel) {
+    if constexpr (format == Pica::PixelFormat::RGBA8) {
+        return Common::Color::DecodeRGBA8(src_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB8) {
+        return Common::Color::DecodeRGB8(src_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB565) {
+        return Common::Color::DecodeRGB565(src_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB5A1) {
+        return Common::Color::DecodeRGB5A1(src_pixel);
+    } else {
+        return Common::Color::DecodeRGBA4(src_pixel);
+    }
+}
+
+template <Pica::PixelFormat format>
+void EncodePixel(const Common::Vec4<u8>& color, u8* dst_pixel) {
+    if constexpr (format == Pica::PixelFormat::RGBA8) {
+        Common::Color::EncodeRGBA8(color, dst_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB8) {
+        Common::Color::EncodeRGB8(color, dst_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB565) {
+        Common::Color::EncodeRGB565(color, dst_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB5A1) {
+        Common::Color::EncodeRGB5A1(color, dst_pixel);
+    } else {
+        Common::Color::EncodeRGBA4(color, dst_pixel);
+    }
+}
+
+template <Pica::PixelFormat input_format, Pica::PixelFormat output_format, ScalingMode scaling>
+void ConvertPixel(const u8* src_pixel, u8* dst_pixel) {
+    constexpr u32 src_bytes_per_pixel = Pica::BytesPerPixel(input_format);
+
+    // The box filters read the neighbouring pixels in Morton order, which for tiled input are
+    // the pixel to the right (ScaleX) and the remaining pixels of the 2x2 subtile (ScaleXY).
+    auto src_color = DecodePixel<input_format>(src_pixel);
+    if constexpr (scaling == ScalingMode::ScaleX) {
+        const auto pixel = DecodePixel<input_format>(src_pixel + src_bytes_per_pixel);
+        src_color = ((src_color + pixel) / 2).template Cast<u8>();
+    } else if constexpr (scaling == ScalingMode::ScaleXY) {
+        const auto pixel1 = DecodePixel<input_format>(src_pixel + 1 * src_bytes_per_pixel);
+        const auto pixel2 = DecodePixel<input_format>(src_pixel + 2 * src_bytes_per_pixel);
+        const auto pixel3 = DecodePixel<input_format>(src_pixel + 3 * src_bytes_per_pixel);
+        src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).template Cast<u8>();
+    }
+    EncodePixel<output_format>(src_color, dst_pixel);
+}
+
+/**
+ * Converts output rows [y_begin, y_end) of a display transfer. The pixel formats and the
+ * scaling mode are template parameters so that the inner loops are free of per-pixel
+ * dispatch and can be vectorized by the compiler.
+ */
+template <Pica::PixelFormat input_format, Pica::PixelFormat output_format, ScalingMode scaling>
+void TransferRows(const TransferParams& params, u32 y_begin, u32 y_end) {
+    constexpr u32 src_bytes_per_pixel = Pica::BytesPerPixel(input_format);
+    constexpr u32 dst_bytes_per_pixel = Pica::BytesPerPixel(output_format);
+    constexpr u32 horizontal_scale = scaling != ScalingMode::NoScale ? 1 : 0;
+    constexpr u32 vertical_scale = scaling == ScalingMode::ScaleXY ? 1 : 0;
+    constexpr bool is_plain_copy =
+        input_format == output_format && scaling == ScalingMode::NoScale;
+
+    const u32 src_stride = params.input_width * src_bytes_per_pixel;
+    const u32 dst_stride = params.output_width * dst_bytes_per_pixel;
+
+    for (u32 y = y_begin; y < y_end; ++y) {
+        // Calculate the y position of the input image based on the current output position
+        // and the scale.
+        const u32 input_y = y << vertical_scale;
+
+        // Flip the y value of the output data, we do this after calculating the position
+        // of the input image to account for the scaling options.
+        const u32 output_y = params.flip_vertically ? params.output_height - y - 1 : y;
+
+        if (params.input_linear) {
+            const u8* src_row = params.src + input_y * src_stride;
+            if (!params.dont_swizzle) {
+                // Interpret the input as linear and the output as tiled
+                u8* dst_tile_row = params.dst + (output_y & ~7) * dst_stride;
+                for (u32 x = 0; x < params.output_width; ++x) {
+                    const u32 input_x = x << horizontal_scale;
+                    ConvertPixel<input_format, output_format, scaling>(
+                        src_row + input_x * src_bytes_per_pixel,
+                        dst_tile_row +
+                            VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel));
+                }
+            } else {
+                // Both input and output are linear
+                u8* dst_row = params.dst + output_y * dst_stride;
+                if constexpr (is_plain_copy) {
+                    std::memcpy(dst_row, src_row, dst_stride);
+                    continue;
+                }
+                for (u32 x = 0; x < params.output_width; ++x) {
+                    const u32 input_x = x << horizontal_scale;
+                    ConvertPixel<input_format, output_format, scaling>(
+                        src_row + input_x * src_bytes_per_pixel, dst_row + x * dst_bytes_per_pixel);
+                }
+            }
+        } else {
+            const u8* src_tile_row = params.src + (input_y & ~7) * src_stride;
+            if (!params.dont_swizzle) {
+                // Interpret the input as tiled and the output as linear
+                u8* dst_row = params.dst + output_y * dst_stride;
+                for (u32 x = 0; x < params.output_width; ++x) {
+                    const u32 input_x = x << horizontal_scale;
+                    ConvertPixel<input_format, output_format, scaling>(
+                        src_tile_row +
+                            VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel),
+                        dst_row + x * dst_bytes_per_pixel);
+                }
+            } else {
+                // Both input and output are tiled
+                u8* dst_tile_row = params.dst + (output_y & ~7) * dst_stride;
+                for (u32 x = 0; x < params.output_width; ++x) {
+                    const u32 input_x = x << horizontal_scale;
+                    ConvertPixel<input_format, output_format, scaling>(
+                        src_tile_row +
+                            VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel),
+                        dst_tile_row +
+                            VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel));
+                }
+            }
+        }
+    }
+}
+
+template <Pica::PixelFormat input_format, Pica::PixelFormat output_format>
+TransferRowsFunc GetTransferRowsFunc(ScalingMode scaling) {
+    switch (scaling) {
+    case ScalingMode::NoScale:
+        return &TransferRows<input_format, output_format, ScalingMode::NoScale>;
+    case ScalingMode::ScaleX:
+        return &TransferRows<input_format, output_format, ScalingMode::ScaleX>;
+    case ScalingMode::ScaleXY:
+        return &TransferRows<input_format, output_format, ScalingMode::ScaleXY>;
+    default:
+        return nullptr;
+    }
+}
+
+template <Pica::PixelFormat input_format>
+TransferRowsFunc GetTransferRowsFunc(Pica::PixelFormat output_format, ScalingMode scaling) {
+    switch (output_format) {
+    case Pica::PixelFormat::RGBA8:
+        return GetTransferRowsFunc<input_format, Pica::PixelFormat::RGBA8>(scaling);
+    case Pica::PixelFormat::RGB8:
+        return GetTransferRowsFunc<input_format, Pica::PixelFormat::RGB8>(scaling);
+    case Pica::PixelFormat::RGB565:
+        return GetTransferRowsFunc<input_format, Pica::PixelFormat::RGB565>(scaling);
+    case Pica::PixelFormat::RGB5A1:
+        return GetTransferRowsFunc<input_format, Pica::PixelFormat::RGB5A1>(scaling);
+    case Pica::PixelFormat::RGBA4:
+        return GetTransferRowsFunc<input_format, Pica::PixelFormat::RGBA4>(scaling);
+    default:
+        LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
+                  static_cast<u32>(output_format));
+        return nullptr;
+    }
+}
+
+TransferRowsFunc GetTransferRowsFunc(Pica::PixelFormat input_format,
+                                     Pica::PixelFormat output_format, ScalingMode scaling) {
     switch (input_format) {
     case Pica::PixelFormat::RGBA8:
-        return Common::Color::DecodeRGBA8(src_pixel);
+        return GetTransferRowsFunc<Pica::PixelFormat::RGBA8>(output_format, scaling);
     case Pica::PixelFormat::RGB8:
-        return Common::Color::DecodeRGB8(src_pixel);
+        return GetTransferRowsFunc<Pica::PixelFormat::RGB8>(output_format, scaling);
     case Pica::PixelFormat::RGB565:
-        return Common::Color::DecodeRGB565(src_pixel);
+        return GetTransferRowsFunc<Pica::PixelFormat::RGB565>(output_format, scaling);
     case Pica::PixelFormat::RGB5A1:
-        return Common::Color::DecodeRGB5A1(src_pixel);
+        return GetTransferRowsFunc<Pica::PixelFormat::RGB5A1>(output_format, scaling);
     case Pica::PixelFormat::RGBA4:
-        return Common::Color::DecodeRGBA4(src_pixel);
+        return GetTransferRowsFunc<Pica::PixelFormat::RGBA4>(output_format, scaling);
     default:
-        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", input_format);
-        return {0, 0, 0, 0};
+        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}",
+                  static_cast<u32>(input_format));
+        return nullptr;
+    }
+}
+
+/// Fills size bytes at dst with the repeating pattern, by doubling the already written prefix.
+void FillPattern(u8* dst, std::size_t size, const std::array<u8, FILL_PATTERN_SIZE>& pattern) {
+    std::size_t filled = std::min<std::size_t>(size, pattern.size());
+    std::memcpy(dst, pattern.data(), filled);
+    while (filled < size) {
+        const std::size_t copy_size = std::min(filled, size - filled);
+        std::memcpy(dst + filled, dst, copy_size);
+        filled += copy_size;
     }
 }
 
+/// Returns the number of tasks a parallel transfer or fill is split in.
+u32 NumTasks(const Common::ThreadPool& thread_pool) {
+    return static_cast<u32>(
+        std::clamp<std::size_t>(thread_pool.NumThreads(), 1, MAX_TASKS_PER_TRANSFER));
+}
+
+} // Anonymous namespace
+
 SwBlitter::SwBlitter(Memory::MemorySystem& memory_, VideoCore::RasterizerInterface* rasterizer_)
-    : memory{memory_}, rasterizer{rasterizer_} {}
+    : memory{memory_}, rasterizer{rasterizer_}, thread_pool{Common::ThreadPool::Shared()} {}
+
+SwBlitter::~SwBlitter() {
+    Wait();
+}
+
+void SwBlitter::Wait() {
+    if (pending_ranges.empty()) {
+        return;
+    }
+    tasks.Wait();
+    pending_ranges.clear();
+}
 
-SwBlitter::~SwBlitter() = default;
+void SwBlitter::WaitForRegion(PAddr addr, u32 size) {
+    const PAddr end = addr + size;
+    const bool overlaps = std::any_of(
+        pending_ranges.begin(), pending_ranges.end(),
+        [&](const PendingRange& range) { return addr < range.end && range.start < end; });
+    if (overlaps) {
+        Wait();
+    }
+}
+
+void SwBlitter::AddPendingRange(PAddr start, PAddr end) {
+    pending_ranges.push_back({start, end});
+}
 
 void SwBlitter::TextureCopy(const Pica::DisplayTransferConfig& config) {
     const PAddr src_addr = config.GetPhysicalInputAddress();
@@ -117,39 +357,39 @@ void SwBlitter::TextureCopy(const Pica::DisplayTransferConfig& config) {
     }
 }
 
-void SwBlitter::DisplayTransfer(const Pica::DisplayTransferConfig& config) {
+u32 SwBlitter::DisplayTransfer(const Pica::DisplayTransferConfig& config) {
     const PAddr src_addr = config.GetPhysicalInputAddress();
     PAddr dst_addr = config.GetPhysicalOutputAddress();
 
     // TODO: do hwtest with these cases
     if (!memory.IsValidPhysicalAddress(src_addr)) {
         LOG_CRITICAL(HW_GPU, "invalid input address {:#010X}", src_addr);
-        return;
+        return 0;
     }
 
     if (!memory.IsValidPhysicalAddress(dst_addr)) {
         LOG_CRITICAL(HW_GPU, "invalid output address {:#010X}", dst_addr);
-        return;
+        return 0;
     }
 
     if (config.input_width == 0) {
         LOG_CRITICAL(HW_GPU, "zero input width");
-        return;
+        return 0;
     }
 
     if (config.input_height == 0) {
         LOG_CRITICAL(HW_GPU, "zero input height");
-        return;
+        return 0;
     }
 
     if (config.output_width == 0) {
         LOG_CRITICAL(HW_GPU, "zero output width");
-        return;
+        return 0;
     }
 
     if (config.output_height == 0) {
         LOG_CRITICAL(HW_GPU, "zero output height");
-        return;
+        return 0;
     }
 
     // Using flip_vertically alongside crop_input_lines produces skewed output on hardware.
@@ -166,13 +406,19 @@ void SwBlitter::DisplayTransfer(const Pica::DisplayTransferConfig& config) {
         LOG_CRITICAL(HW_GPU, "Unimplemented display transfer scaling mode {}",
                      config.scaling.Value());
         UNIMPLEMENTED();
-        return;
+        return 0;
     }
 
     if (config.input_linear && config.scaling != config.NoScale) {
         LOG_CRITICAL(HW_GPU, "Scaling is only implemented on tiled input");
         UNIMPLEMENTED();
-        return;
+        return 0;
+    }
+
+    const TransferRowsFunc transfer_rows =
+        GetTransferRowsFunc(config.input_format, config.output_format, config.scaling);
+    if (!transfer_rows) {
+        return 0;
     }
 
     const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
@@ -188,159 +434,106 @@ void SwBlitter::DisplayTransfer(const Pica::DisplayTransferConfig& config) {
     rasterizer->FlushRegion(config.GetPhysicalInputAddress(), input_size);
     rasterizer->InvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-    for (u32 y = 0; y < output_height; ++y) {
-        for (u32 x = 0; x < output_width; ++x) {
-            Common::Vec4<u8> src_color;
-
-            // Calculate the [x,y] position of the input image
-            // based on the current output position and the scale
-            const u32 input_x = x << horizontal_scale;
-            const u32 input_y = y << vertical_scale;
-
-            u32 output_y;
-            if (config.flip_vertically) {
-                // Flip the y value of the output data,
-                // we do this after calculating the [x,y] position of the input image
-                // to account for the scaling options.
-                output_y = output_height - y - 1;
-            } else {
-                output_y = y;
-            }
-
-            const u32 dst_bytes_per_pixel = BytesPerPixel(config.output_format);
-            const u32 src_bytes_per_pixel = BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
-
-            if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
-            } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    const u32 coarse_y = input_y & ~7;
-                    const u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    const u32 out_coarse_y = output_y & ~7;
-                    const u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    const u32 in_coarse_y = input_y & ~7;
-                    const u32 in_stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
-            }
-
-            const u8* src_pixel = src_pointer + src_offset;
-            src_color = DecodePixel(config.input_format, src_pixel);
-            if (config.scaling == config.ScaleX) {
-                const auto pixel =
-                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
-                src_color = ((src_color + pixel) / 2).Cast<u8>();
-            } else if (config.scaling == config.ScaleXY) {
-                const auto pixel1 =
-                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
-                const auto pixel2 =
-                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
-                const auto pixel3 =
-                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
-                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
-            }
+    const TransferParams params = {
+        .src = src_pointer,
+        .dst = dst_pointer,
+        .input_width = config.input_width,
+        .output_width = output_width,
+        .output_height = output_height,
+        .flip_vertically = config.flip_vertically != 0,
+        .input_linear = config.input_linear != 0,
+        .dont_swizzle = config.dont_swizzle != 0,
+    };
+
+    if (output_width * output_height < MIN_PARALLEL_TRANSFER_PIXELS) {
+        transfer_rows(params, 0, output_height);
+        return output_size;
+    }
 
-            u8* dst_pixel = dst_pointer + dst_offset;
-            switch (config.output_format) {
-            case Pica::PixelFormat::RGBA8:
-                Common::Color::EncodeRGBA8(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGB8:
-                Common::Color::EncodeRGB8(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGB565:
-                Common::Color::EncodeRGB565(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGB5A1:
-                Common::Color::EncodeRGB5A1(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGBA4:
-                Common::Color::EncodeRGBA4(src_color, dst_pixel);
-                break;
-            default:
-                LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
-                          static_cast<u32>(config.output_format.Value()));
-                break;
-            }
-        }
+    // Split the output in bands of whole tile rows.
+    const u32 num_tasks = NumTasks(thread_pool);
+    const u32 rows_per_task = Common::AlignUp((output_height + num_tasks - 1) / num_tasks, 8);
+    for (u32 y = 0; y < output_height; y += rows_per_task) {
+        const u32 y_end = std::min(y + rows_per_task, output_height);
+        thread_pool.Submit([transfer_rows, params, y, y_end] { transfer_rows(params, y, y_end); },
+                           tasks);
     }
+    AddPendingRange(src_addr, src_addr + input_size);
+    AddPendingRange(std::min(dst_addr, config.GetPhysicalOutputAddress()),
+                    std::max(dst_addr, config.GetPhysicalOutputAddress()) + output_size);
+
+    return output_size;
 }
 
-void SwBlitter::MemoryFill(const Pica::MemoryFillConfig& config) {
+u32 SwBlitter::MemoryFill(const Pica::MemoryFillConfig& config) {
     const PAddr start_addr = config.GetStartAddress();
     const PAddr end_addr = config.GetEndAddress();
 
     // TODO: do hwtest with these cases
     if (!memory.IsValidPhysicalAddress(start_addr)) {
         LOG_CRITICAL(HW_GPU, "invalid start address {:#010X}", start_addr);
-        return;
+        return 0;
     }
 
     if (!memory.IsValidPhysicalAddress(end_addr)) {
         LOG_CRITICAL(HW_GPU, "invalid end address {:#010X}", end_addr);
-        return;
+        return 0;
     }
 
     if (end_addr <= start_addr) {
         LOG_CRITICAL(HW_GPU, "invalid memory range from {:#010X} to {:#010X}", start_addr,
                      end_addr);
-        return;
+        return 0;
     }
 
     u8* start = memory.GetPhysicalPointer(start_addr);
-    u8* end = memory.GetPhysicalPointer(end_addr);
+    const u32 range_size = end_addr - start_addr;
 
-    rasterizer->InvalidateRegion(start_addr, end_addr - start_addr);
+    rasterizer->InvalidateRegion(start_addr, range_size);
 
+    // Expand the fill value to a pattern of whole values. 24-bit and 16-bit fills write the last
+    // value completely even if it straddles the end address, 32-bit fills stop before it.
+    std::array<u8, FILL_PATTERN_SIZE> pattern;
+    u32 fill_size;
     if (config.fill_24bit) {
-        // Fill with 24-bit values
-        for (u8* ptr = start; ptr < end; ptr += 3) {
-            ptr[0] = config.value_24bit_r;
-            ptr[1] = config.value_24bit_g;
-            ptr[2] = config.value_24bit_b;
+        const std::array<u8, 3> value = {static_cast<u8>(config.value_24bit_r),
+                                         static_cast<u8>(config.value_24bit_g),
+                                         static_cast<u8>(config.value_24bit_b)};
+        for (std::size_t i = 0; i < pattern.size(); i += value.size()) {
+            std::memcpy(&pattern[i], value.data(), value.size());
         }
+        fill_size = Common::AlignUp(range_size, 3);
     } else if (config.fill_32bit) {
-        // Fill with 32-bit values
-        if (end > start) {
-            const u32 value = config.value_32bit;
-            const std::size_t len = (end - start) / sizeof(u32);
-            for (std::size_t i = 0; i < len; ++i) {
-                std::memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
-            }
+        const u32 value = config.value_32bit;
+        for (std::size_t i = 0; i < pattern.size(); i += sizeof(u32)) {
+            std::memcpy(&pattern[i], &value, sizeof(u32));
         }
+        fill_size = Common::AlignDown(range_size, sizeof(u32));
     } else {
-        // Fill with 16-bit values
         const u16 value_16bit = config.value_16bit.Value();
-        for (u8* ptr = start; ptr < end; ptr += sizeof(u16)) {
-            std::memcpy(ptr, &value_16bit, sizeof(u16));
+        for (std::size_t i = 0; i < pattern.size(); i += sizeof(u16)) {
+            std::memcpy(&pattern[i], &value_16bit, sizeof(u16));
         }
+        fill_size = Common::AlignUp(range_size, sizeof(u16));
+    }
+
+    if (fill_size < MIN_PARALLEL_FILL_SIZE) {
+        FillPattern(start, fill_size, pattern);
+        return fill_size;
     }
+
+    // Split the range in chunks that start on a pattern boundary.
+    const u32 num_tasks = NumTasks(thread_pool);
+    const u32 chunk_size =
+        Common::AlignUp((fill_size + num_tasks - 1) / num_tasks, FILL_PATTERN_SIZE);
+    for (u32 offset = 0; offset < fill_size; offset += chunk_size) {
+        const u32 size = std::min(chunk_size, fill_size - offset);
+        thread_pool.Submit(
+            [dst = start + offset, size, pattern] { FillPattern(dst, size, pattern); }, tasks);
+    }
+    AddPendingRange(start_addr, start_addr + fill_size);
+
+    return fill_size;
 }
 
 } // namespace SwRenderer
@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <vector>
+#include "common/common_types.h"
+#include "common/thread_pool.h"
+
 namespace Pica {
 struct DisplayTransferConfig;
 struct MemoryFillConfig;
@@ -19,20 +23,51 @@ class RasterizerInterface;
 
 namespace SwRenderer {
 
+/**
+ * CPU fallback for the PICA transfer engine (PPF) and memory fill units (PSC).
+ * Display transfers and memory fills are split by rows and processed by a pool of
+ * worker threads, so the caller may continue emulation until the result is needed.
+ */
 class SwBlitter {
 public:
     explicit SwBlitter(Memory::MemorySystem& memory, VideoCore::RasterizerInterface* rasterizer);
     ~SwBlitter();
 
+    /// Performs the texture copy on the calling thread.
     void TextureCopy(const Pica::DisplayTransferConfig& config);
 
-    void DisplayTransfer(const Pica::DisplayTransferConfig& config);
+    /**
+     * Queues the display transfer on the blitter workers.
+     * @returns The number of bytes that will be written, zero if the transfer was rejected.
+     */
+    u32 DisplayTransfer(const Pica::DisplayTransferConfig& config);
+
+    /**
+     * Queues the memory fill on the blitter workers.
+     * @returns The number of bytes that will be written, zero if the fill was rejected.
+     */
+    u32 MemoryFill(const Pica::MemoryFillConfig& config);
+
+    /// Blocks until all queued transfers and fills have been written to memory.
+    void Wait();
 
-    void MemoryFill(const Pica::MemoryFillConfig& config);
+    /// Blocks until memory in [addr, addr + size) is no longer read or written by queued work.
+    void WaitForRegion(PAddr addr, u32 size);
 
 private:
+    struct PendingRange {
+        PAddr start;
+        PAddr end;
+    };
+
+    /// Records a range of memory accessed by the work being queued.
+    void AddPendingRange(PAddr start, PAddr end);
+
     Memory::MemorySystem& memory;
     VideoCore::RasterizerInterface* rasterizer;
+    Common::ThreadPool& thread_pool;
+    Common::TaskGroup tasks;
+    std::vector<PendingRange> pending_ranges;
 };
 
 } // namespace SwRenderer
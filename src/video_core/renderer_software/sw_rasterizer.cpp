@@ -102,8 +102,7 @@ private:
 
 RasterizerSoftware::RasterizerSoftware(Memory::MemorySystem& memory_, Pica::PicaCore& pica_)
     : memory{memory_}, pica{pica_}, regs{pica.regs.internal},
-      num_sw_threads{std::max(std::thread::hardware_concurrency(), 2U)},
-      sw_workers{num_sw_threads, "SwRenderer workers"}, fb{memory, regs.framebuffer} {}
+      thread_pool{Common::ThreadPool::Shared()}, fb{memory, regs.framebuffer} {}
 
 void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                                      const Pica::OutputVertex& v2) {
@@ -466,9 +465,12 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                 }
             }
         };
-        sw_workers.QueueWork(std::move(process_scanline));
+        // Keep each row on the same worker across triangles, where its framebuffer lines are
+        // already cached.
+        thread_pool.Submit(std::move(process_scanline), draw_tasks, Common::TaskPriority::Critical,
+                           y >> 4);
     }
-    sw_workers.WaitForRequests();
+    draw_tasks.Wait();
 }
 
 std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
@@ -5,7 +5,7 @@
 #pragma once
 
 #include <span>
-#include "common/thread_worker.h"
+#include "common/thread_pool.h"
 #include "video_core/pica/regs_texturing.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_software/sw_clipper.h"
@@ -70,8 +70,8 @@ private:
     Memory::MemorySystem& memory;
     Pica::PicaCore& pica;
     Pica::RegsInternal& regs;
-    std::size_t num_sw_threads;
-    Common::ThreadWorker sw_workers;
+    Common::ThreadPool& thread_pool;
+    Common::TaskGroup draw_tasks;
     Framebuffer fb;
 };
 
@@ -67,8 +67,8 @@ Shader::~Shader() {
 GraphicsPipeline::GraphicsPipeline(const Instance& instance_, RenderpassCache& renderpass_cache_,
                                    const PipelineInfo& info_, vk::PipelineCache pipeline_cache_,
                                    vk::PipelineLayout layout_, std::array<Shader*, 3> stages_,
-                                   Common::ThreadWorker* worker_)
-    : instance{instance_}, renderpass_cache{renderpass_cache_}, worker{worker_},
+                                   Common::TaskGroup* tasks_)
+    : instance{instance_}, renderpass_cache{renderpass_cache_}, tasks{tasks_},
       pipeline_layout{layout_}, pipeline_cache{pipeline_cache_}, info{info_}, stages{stages_} {}
 
 GraphicsPipeline::~GraphicsPipeline() = default;
@@ -93,11 +93,23 @@ bool GraphicsPipeline::TryBuild(bool wait_built) {
     }
 
     // Fallback to (a)synchronous compilation
-    worker->QueueWork([this] { Build(); });
     is_pending = true;
+    BuildWhenShadersDone();
     return wait_built;
 }
 
+void GraphicsPipeline::BuildWhenShadersDone() {
+    // Build runs on the thread pool, where it must not block on the shader tasks queued behind
+    // it, so it is only submitted once the last pending shader finishes.
+    const auto pending = std::find_if(stages.begin(), stages.end(),
+                                      [](Shader* shader) { return shader && !shader->IsDone(); });
+    if (pending != stages.end()) {
+        (*pending)->OnDone([this] { BuildWhenShadersDone(); });
+        return;
+    }
+    Common::ThreadPool::Shared().Submit([this] { Build(); }, *tasks);
+}
+
 bool GraphicsPipeline::Build(bool fail_on_compile_required) {
     MICROPROFILE_SCOPE(Vulkan_Pipeline);
     const vk::Device device = instance.GetDevice();
@@ -2,7 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include "common/thread_worker.h"
+#include "common/thread_pool.h"
 #include "video_core/pica/regs_pipeline.h"
 #include "video_core/pica/regs_rasterizer.h"
 #include "video_core/rasterizer_cache/pixel_format.h"
@@ -23,16 +23,38 @@ public:
         condvar.wait(lock, [this] { return is_done.load(std::memory_order::relaxed); });
     }
 
+    /// Calls func once the handle is marked done, right away if it already is.
+    void OnDone(UniqueFunction<void>&& func) {
+        {
+            std::scoped_lock lock{mutex};
+            if (!is_done.load(std::memory_order::relaxed)) {
+                continuations.push_back(std::move(func));
+                return;
+            }
+        }
+        func();
+    }
+
     void MarkDone(bool done = true) noexcept {
-        std::scoped_lock lock{mutex};
-        is_done = done;
-        condvar.notify_all();
+        std::vector<UniqueFunction<void>> ready;
+        {
+            std::scoped_lock lock{mutex};
+            is_done = done;
+            if (done) {
+                ready.swap(continuations);
+            }
+            condvar.notify_all();
+        }
+        for (auto& func : ready) {
+            func();
+        }
     }
 
 private:
     std::condition_variable condvar;
     std::mutex mutex;
     std::atomic_bool is_done{false};
+    std::vector<UniqueFunction<void>> continuations;
 };
 
 } // namespace Common
@@ -168,7 +190,7 @@ public:
     explicit GraphicsPipeline(const Instance& instance, RenderpassCache& renderpass_cache,
                               const PipelineInfo& info, vk::PipelineCache pipeline_cache,
                               vk::PipelineLayout layout, std::array<Shader*, 3> stages,
-                              Common::ThreadWorker* worker);
+                              Common::TaskGroup* tasks);
     ~GraphicsPipeline();
 
     bool TryBuild(bool wait_built);
@@ -179,10 +201,14 @@ public:
         return *pipeline;
     }
 
+private:
+    /// Queues Build on the thread pool once every shader stage has been compiled.
+    void BuildWhenShadersDone();
+
 private:
     const Instance& instance;
     RenderpassCache& renderpass_cache;
-    Common::ThreadWorker* worker;
+    Common::TaskGroup* tasks;
 
     vk::UniquePipeline pipeline;
     vk::PipelineLayout pipeline_layout;
@@ -82,8 +82,6 @@ constexpr std::array<vk::DescriptorSetLayoutBinding, 7> SHADOW_BINDINGS = {{
 PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
                              RenderpassCache& renderpass_cache_, DescriptorPool& pool_)
     : instance{instance_}, scheduler{scheduler_}, renderpass_cache{renderpass_cache_}, pool{pool_},
-      num_worker_threads{std::max(std::thread::hardware_concurrency(), 2U)},
-      workers{num_worker_threads, "Pipeline workers"},
       descriptor_set_providers{DescriptorSetProvider{instance, pool, BUFFER_BINDINGS},
                                DescriptorSetProvider{instance, pool, TEXTURE_BINDINGS},
                                DescriptorSetProvider{instance, pool, SHADOW_BINDINGS}},
@@ -121,6 +119,8 @@ void PipelineCache::BuildLayout() {
 }
 
 PipelineCache::~PipelineCache() {
+    // Pipelines still compiling write to the pipeline cache.
+    tasks.Wait();
     SaveDiskCache();
 }
 
@@ -206,7 +206,7 @@ bool PipelineCache::BindPipeline(const PipelineInfo& info, bool wait_built) {
     if (new_pipeline) {
         it.value() =
             std::make_unique<GraphicsPipeline>(instance, renderpass_cache, info, *pipeline_cache,
-                                               *pipeline_layout, current_shaders, &workers);
+                                               *pipeline_layout, current_shaders, &tasks);
     }
 
     GraphicsPipeline* const pipeline{it->second.get()};
@@ -417,10 +417,13 @@ bool PipelineCache::UseProgrammableVertexShader(const Pica::RegsInternal& regs,
         if (new_program) {
             shader.program = std::move(program);
             const vk::Device device = instance.GetDevice();
-            workers.QueueWork([device, &shader] {
-                shader.module = Compile(shader.program, vk::ShaderStageFlagBits::eVertex, device);
-                shader.MarkDone();
-            });
+            Common::ThreadPool::Shared().Submit(
+                [device, &shader] {
+                    shader.module =
+                        Compile(shader.program, vk::ShaderStageFlagBits::eVertex, device);
+                    shader.MarkDone();
+                },
+                tasks);
         }
 
         it->second = &shader;
@@ -454,11 +457,13 @@ bool PipelineCache::UseFixedGeometryShader(const Pica::RegsInternal& regs) {
     auto& shader = it->second;
 
     if (new_shader) {
-        workers.QueueWork([gs_config, device = instance.GetDevice(), &shader]() {
-            const auto code = GLSL::GenerateFixedGeometryShader(gs_config, true);
-            shader.module = Compile(code, vk::ShaderStageFlagBits::eGeometry, device);
-            shader.MarkDone();
-        });
+        Common::ThreadPool::Shared().Submit(
+            [gs_config, device = instance.GetDevice(), &shader]() {
+                const auto code = GLSL::GenerateFixedGeometryShader(gs_config, true);
+                shader.module = Compile(code, vk::ShaderStageFlagBits::eGeometry, device);
+                shader.MarkDone();
+            },
+            tasks);
     }
 
     current_shaders[ProgramType::GS] = &shader;
@@ -479,18 +484,20 @@ void PipelineCache::UseFragmentShader(const Pica::RegsInternal& regs,
     auto& shader = it->second;
 
     if (new_shader) {
-        workers.QueueWork([fs_config, this, &shader]() {
-            const bool use_spirv = Settings::values.spirv_shader_gen.GetValue();
-            if (use_spirv && !fs_config.UsesShadowPipeline()) {
-                const std::vector code = SPIRV::GenerateFragmentShader(fs_config, profile);
-                shader.module = CompileSPV(code, instance.GetDevice());
-            } else {
-                const std::string code = GLSL::GenerateFragmentShader(fs_config, profile);
-                shader.module =
-                    Compile(code, vk::ShaderStageFlagBits::eFragment, instance.GetDevice());
-            }
-            shader.MarkDone();
-        });
+        Common::ThreadPool::Shared().Submit(
+            [fs_config, this, &shader]() {
+                const bool use_spirv = Settings::values.spirv_shader_gen.GetValue();
+                if (use_spirv && !fs_config.UsesShadowPipeline()) {
+                    const std::vector code = SPIRV::GenerateFragmentShader(fs_config, profile);
+                    shader.module = CompileSPV(code, instance.GetDevice());
+                } else {
+                    const std::string code = GLSL::GenerateFragmentShader(fs_config, profile);
+                    shader.module =
+                        Compile(code, vk::ShaderStageFlagBits::eFragment, instance.GetDevice());
+                }
+                shader.MarkDone();
+            },
+            tasks);
     }
 
     current_shaders[ProgramType::FS] = &shader;
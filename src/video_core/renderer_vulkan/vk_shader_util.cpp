@@ -8,6 +8,7 @@
 #include "common/assert.h"
 #include "common/literals.h"
 #include "common/logging/log.h"
+#include "common/perf_counters.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
 
 namespace Vulkan {
@@ -159,6 +160,7 @@ bool InitializeCompiler() {
 } // Anonymous namespace
 
 vk::ShaderModule Compile(std::string_view code, vk::ShaderStageFlagBits stage, vk::Device device) {
+    PERF_TRACE_SCOPE("Compile shader");
     if (!InitializeCompiler()) {
         return {};
     }
@@ -216,6 +218,9 @@ vk::ShaderModule Compile(std::string_view code, vk::ShaderStageFlagBits stage, v
 }
 
 vk::ShaderModule CompileSPV(std::span<const u32> code, vk::Device device) {
+    static const Common::Perf::Counter shader_compiles{"Shader compiles"};
+    shader_compiles.Add();
+
     const vk::ShaderModuleCreateInfo shader_info = {
         .codeSize = code.size() * sizeof(u32),
         .pCode = code.data(),
@@ -2,8 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <exception>
 #include <map>
+#include <optional>
 #include <set>
 #include <string>
 #include <tuple>
@@ -268,10 +271,10 @@ public:
     GLSLGenerator(const std::set<Subroutine>& subroutines, const ProgramCode& program_code,
                   const SwizzleData& swizzle_data, u32 main_offset,
                   const RegGetter& inputreg_getter, const RegGetter& outputreg_getter,
-                  bool sanitize_mul)
+                  bool sanitize_mul, bool is_gs)
         : subroutines(subroutines), program_code(program_code), swizzle_data(swizzle_data),
           main_offset(main_offset), inputreg_getter(inputreg_getter),
-          outputreg_getter(outputreg_getter), sanitize_mul(sanitize_mul) {
+          outputreg_getter(outputreg_getter), sanitize_mul(sanitize_mul), is_gs(is_gs) {
 
         Generate();
     }
@@ -360,6 +363,10 @@ private:
 
     /// Generates code representing a bool uniform
     std::string GetUniformBool(u32 index) const {
+        if (is_gs && index == 15) {
+            // The uniform b15 is set to true after every geometry shader invocation.
+            return "(uniforms.b[15] || gl_PrimitiveIDIn != 0)";
+        }
         return fmt::format("uniforms.b[{}]", index);
     }
 
@@ -792,8 +799,24 @@ private:
             }
 
             case OpCode::Id::EMIT:
+                if (is_gs) {
+                    shader.AddLine("emit();");
+                } else {
+                    LOG_ERROR(HW_GPU, "Geometry shader operation detected in vertex shader");
+                }
+                break;
+
             case OpCode::Id::SETEMIT:
-                LOG_ERROR(HW_GPU, "Geometry shader operation detected in vertex shader");
+                if (is_gs) {
+                    if (instr.setemit.vertex_id >= 3) {
+                        throw DecompileFail("Invalid SETEMIT vertex id");
+                    }
+                    shader.AddLine("setemit({}u, {}, {});", instr.setemit.vertex_id.Value(),
+                                   instr.setemit.prim_emit.Value() != 0,
+                                   instr.setemit.winding.Value() != 0);
+                } else {
+                    LOG_ERROR(HW_GPU, "Geometry shader operation detected in vertex shader");
+                }
                 break;
 
             default: {
@@ -934,18 +957,344 @@ private:
     const RegGetter& inputreg_getter;
     const RegGetter& outputreg_getter;
     const bool sanitize_mul;
+    const bool is_gs;
 
     ShaderWriter shader;
 };
 
+/**
+ * Checks that every invocation of a geometry shader only depends on its own inputs. The host runs
+ * the invocations in parallel from the registers the unit has before the draw, so a program that
+ * reads a register, the emitter state or a buffered vertex left by a previous invocation does not
+ * produce the same result there.
+ */
+class GeometryShaderAnalyzer {
+public:
+    GeometryShaderAnalyzer(const ProgramCode& program_code, const SwizzleData& swizzle_data,
+                           u32 output_mask, u32 max_vertices)
+        : program_code(program_code), swizzle_data(swizzle_data), output_mask(output_mask),
+          max_vertices(max_vertices) {}
+
+    void Analyze(u32 main_offset) {
+        Scan(main_offset, PROGRAM_END, State{}, 0);
+    }
+
+private:
+    /// Registers written by every code path so far, as masks of components.
+    struct State {
+        std::array<u8, 16> temporary{};
+        std::array<u8, 16> output{};
+        u8 address_registers = 0;
+        u8 conditional_code = 0;
+        bool emitter_set = false;
+        u32 vertex_id = 0;
+        bool prim_emit = false;
+        u8 prim_buffer = 0;
+        /// Maximum number of EMIT instructions executed by any code path.
+        u32 num_emits = 0;
+        /// Maximum number of primitives emitted by any code path.
+        u32 num_primitives = 0;
+    };
+
+    /// Merges the states of two code paths. std::nullopt stands for a path that has ended.
+    static std::optional<State> Merge(const std::optional<State>& a,
+                                      const std::optional<State>& b) {
+        if (!a || !b) {
+            return a ? a : b;
+        }
+        State result;
+        for (std::size_t i = 0; i < 16; ++i) {
+            result.temporary[i] = a->temporary[i] & b->temporary[i];
+            result.output[i] = a->output[i] & b->output[i];
+        }
+        result.address_registers = a->address_registers & b->address_registers;
+        result.conditional_code = a->conditional_code & b->conditional_code;
+        result.emitter_set = a->emitter_set && b->emitter_set && a->vertex_id == b->vertex_id &&
+                             a->prim_emit == b->prim_emit;
+        result.vertex_id = a->vertex_id;
+        result.prim_emit = a->prim_emit;
+        result.prim_buffer = a->prim_buffer & b->prim_buffer;
+        result.num_emits = std::max(a->num_emits, b->num_emits);
+        result.num_primitives = std::max(a->num_primitives, b->num_primitives);
+        return result;
+    }
+
+    template <SwizzlePattern::Selector (SwizzlePattern::*getter)(int) const>
+    static u8 GetReadMask(const SwizzlePattern& swizzle, u8 components) {
+        u8 mask = 0;
+        for (int i = 0; i < 4; ++i) {
+            if (components & (1 << i)) {
+                mask |= 1 << static_cast<int>((swizzle.*getter)(i));
+            }
+        }
+        return mask;
+    }
+
+    static u8 GetDestMask(const SwizzlePattern& swizzle) {
+        u8 mask = 0;
+        for (int i = 0; i < 4; ++i) {
+            if (swizzle.DestComponentEnabled(i)) {
+                mask |= 1 << i;
+            }
+        }
+        return mask;
+    }
+
+    static void CheckSource(const State& state, const SourceRegister& source, u8 read_mask,
+                            u32 address_register_index) {
+        switch (source.GetRegisterType()) {
+        case RegisterType::Temporary:
+            if ((state.temporary[source.GetIndex()] & read_mask) != read_mask) {
+                throw DecompileFail("Temporary register read before it is written");
+            }
+            break;
+        case RegisterType::FloatUniform:
+            if (address_register_index != 0 &&
+                !(state.address_registers & (1 << (address_register_index - 1)))) {
+                throw DecompileFail("Address register read before it is written");
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    static void WriteDest(State& state, const DestRegister& dest, u8 mask) {
+        const auto index = static_cast<std::size_t>(dest.GetIndex());
+        if (dest.GetRegisterType() == RegisterType::Output) {
+            state.output[index] |= mask;
+        } else {
+            state.temporary[index] |= mask;
+        }
+    }
+
+    static void CheckCondition(const State& state, Instruction::FlowControlType flow_control) {
+        using Op = Instruction::FlowControlType::Op;
+        const u8 mask = flow_control.op == Op::JustX ? 1 : flow_control.op == Op::JustY ? 2 : 3;
+        if ((state.conditional_code & mask) != mask) {
+            throw DecompileFail("Conditional code read before it is written");
+        }
+    }
+
+    void AnalyzeArithmetic(State& state, const Instruction& instr) const {
+        const SwizzlePattern swizzle = {swizzle_data[instr.common.operand_desc_id]};
+        const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+        const bool is_inverted =
+            (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+        const u8 dest_mask = GetDestMask(swizzle);
+
+        u8 src1_components = dest_mask;
+        u8 src2_components = dest_mask;
+        switch (opcode) {
+        case OpCode::Id::DP3:
+            src1_components = src2_components = 0x7;
+            break;
+        case OpCode::Id::DP4:
+            src1_components = src2_components = 0xF;
+            break;
+        case OpCode::Id::DPH:
+        case OpCode::Id::DPHI:
+            src1_components = 0x7;
+            src2_components = 0xF;
+            break;
+        case OpCode::Id::CMP:
+            src1_components = src2_components = 0x3;
+            break;
+        case OpCode::Id::RCP:
+        case OpCode::Id::RSQ:
+        case OpCode::Id::EX2:
+        case OpCode::Id::LG2:
+            src1_components = 0x1;
+            src2_components = 0;
+            break;
+        case OpCode::Id::MOV:
+        case OpCode::Id::FLR:
+            src2_components = 0;
+            break;
+        case OpCode::Id::MOVA:
+            src1_components = dest_mask & 0x3;
+            src2_components = 0;
+            break;
+        default:
+            break;
+        }
+
+        CheckSource(state, instr.common.GetSrc1(is_inverted),
+                    GetReadMask<&SwizzlePattern::GetSelectorSrc1>(swizzle, src1_components),
+                    !is_inverted * instr.common.address_register_index);
+        if (src2_components != 0) {
+            CheckSource(state, instr.common.GetSrc2(is_inverted),
+                        GetReadMask<&SwizzlePattern::GetSelectorSrc2>(swizzle, src2_components),
+                        is_inverted * instr.common.address_register_index);
+        }
+
+        switch (opcode) {
+        case OpCode::Id::CMP:
+            state.conditional_code = 0x3;
+            break;
+        case OpCode::Id::MOVA:
+            state.address_registers |= dest_mask & 0x3;
+            break;
+        default:
+            WriteDest(state, instr.common.dest.Value(), dest_mask);
+            break;
+        }
+    }
+
+    void AnalyzeMultiplyAdd(State& state, const Instruction& instr) const {
+        const SwizzlePattern swizzle = {swizzle_data[instr.mad.operand_desc_id]};
+        const bool is_inverted = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI;
+        const u8 dest_mask = GetDestMask(swizzle);
+
+        CheckSource(state, instr.mad.GetSrc1(is_inverted),
+                    GetReadMask<&SwizzlePattern::GetSelectorSrc1>(swizzle, dest_mask), 0);
+        CheckSource(state, instr.mad.GetSrc2(is_inverted),
+                    GetReadMask<&SwizzlePattern::GetSelectorSrc2>(swizzle, dest_mask),
+                    !is_inverted * instr.mad.address_register_index);
+        CheckSource(state, instr.mad.GetSrc3(is_inverted),
+                    GetReadMask<&SwizzlePattern::GetSelectorSrc3>(swizzle, dest_mask),
+                    is_inverted * instr.mad.address_register_index);
+        WriteDest(state, instr.mad.dest.Value(), dest_mask);
+    }
+
+    void Emit(State& state) const {
+        if (!state.emitter_set) {
+            throw DecompileFail("EMIT depends on the emitter state of a previous invocation");
+        }
+        for (u32 reg = 0; reg < 16; ++reg) {
+            if ((output_mask & (1 << reg)) && state.output[reg] != 0xF) {
+                throw DecompileFail("Output register emitted before it is written");
+            }
+        }
+        state.prim_buffer |= 1 << state.vertex_id;
+        ++state.num_emits;
+        if (state.prim_emit) {
+            if (state.prim_buffer != 0x7) {
+                throw DecompileFail("Primitive uses a vertex of a previous invocation");
+            }
+            if (++state.num_primitives * 3 > max_vertices) {
+                throw DecompileFail("Too many vertices emitted");
+            }
+        }
+    }
+
+    /**
+     * Follows every code path in a range of code.
+     * @return the state at the return point, or std::nullopt if all code paths reach an END.
+     */
+    std::optional<State> Scan(u32 begin, u32 end, State state, u32 depth) const {
+        if (depth > MAX_CALL_DEPTH) {
+            throw DecompileFail("Call stack too deep");
+        }
+
+        for (u32 offset = begin; offset != end && offset < PROGRAM_END; ++offset) {
+            const Instruction instr = {program_code[offset]};
+            switch (instr.opcode.Value().GetInfo().type) {
+            case OpCode::Type::Arithmetic:
+                AnalyzeArithmetic(state, instr);
+                continue;
+            case OpCode::Type::MultiplyAdd:
+                AnalyzeMultiplyAdd(state, instr);
+                continue;
+            default:
+                break;
+            }
+
+            switch (instr.opcode.Value()) {
+            case OpCode::Id::NOP:
+                break;
+            case OpCode::Id::END:
+                return std::nullopt;
+            case OpCode::Id::CALL:
+            case OpCode::Id::CALLC:
+            case OpCode::Id::CALLU: {
+                if (instr.opcode.Value() == OpCode::Id::CALLC) {
+                    CheckCondition(state, instr.flow_control);
+                }
+                const auto called = Scan(instr.flow_control.dest_offset,
+                                         instr.flow_control.dest_offset +
+                                             instr.flow_control.num_instructions,
+                                         state, depth + 1);
+                if (instr.opcode.Value() == OpCode::Id::CALL) {
+                    if (!called) {
+                        return std::nullopt;
+                    }
+                    state = *called;
+                } else {
+                    state = *Merge(state, called);
+                }
+                break;
+            }
+            case OpCode::Id::IFC:
+            case OpCode::Id::IFU: {
+                if (instr.opcode.Value() == OpCode::Id::IFC) {
+                    CheckCondition(state, instr.flow_control);
+                }
+                const u32 else_offset = instr.flow_control.dest_offset;
+                const u32 endif_offset = else_offset + instr.flow_control.num_instructions;
+                const auto if_state = Scan(offset + 1, else_offset, state, depth + 1);
+                const auto else_state = instr.flow_control.num_instructions != 0
+                                            ? Scan(else_offset, endif_offset, state, depth + 1)
+                                            : std::optional<State>{state};
+                const auto merged = Merge(if_state, else_state);
+                if (!merged) {
+                    return std::nullopt;
+                }
+                state = *merged;
+                offset = endif_offset - 1;
+                break;
+            }
+            case OpCode::Id::LOOP: {
+                // The body runs at least once, and every iteration starts with at least the
+                // registers the first one has, so scanning it once is enough. The number of
+                // iterations comes from a uniform, so it may not emit.
+                state.address_registers |= 0x4;
+                const auto loop_state =
+                    Scan(offset + 1, instr.flow_control.dest_offset + 1, state, depth + 1);
+                if (!loop_state) {
+                    return std::nullopt;
+                }
+                if (loop_state->num_emits != state.num_emits) {
+                    throw DecompileFail("EMIT inside a loop");
+                }
+                state = *loop_state;
+                offset = instr.flow_control.dest_offset;
+                break;
+            }
+            case OpCode::Id::SETEMIT:
+                state.emitter_set = true;
+                state.vertex_id = instr.setemit.vertex_id;
+                state.prim_emit = instr.setemit.prim_emit != 0;
+                if (state.vertex_id >= 3) {
+                    throw DecompileFail("Invalid SETEMIT vertex id");
+                }
+                break;
+            case OpCode::Id::EMIT:
+                Emit(state);
+                break;
+            default:
+                throw DecompileFail("Unsupported instruction in geometry shader");
+            }
+        }
+        return state;
+    }
+
+    static constexpr u32 MAX_CALL_DEPTH = 16;
+
+    const ProgramCode& program_code;
+    const SwizzleData& swizzle_data;
+    const u32 output_mask;
+    const u32 max_vertices;
+};
+
 std::string DecompileProgram(const ProgramCode& program_code, const SwizzleData& swizzle_data,
                              u32 main_offset, const RegGetter& inputreg_getter,
-                             const RegGetter& outputreg_getter, bool sanitize_mul) {
+                             const RegGetter& outputreg_getter, bool sanitize_mul, bool is_gs) {
 
     try {
         auto subroutines = ControlFlowAnalyzer(program_code, main_offset).MoveSubroutines();
         GLSLGenerator generator(subroutines, program_code, swizzle_data, main_offset,
-                                inputreg_getter, outputreg_getter, sanitize_mul);
+                                inputreg_getter, outputreg_getter, sanitize_mul, is_gs);
         return generator.MoveShaderCode();
     } catch (const DecompileFail& exception) {
         LOG_INFO(HW_GPU, "Shader decompilation failed: {}", exception.what());
@@ -953,4 +1302,16 @@ std::string DecompileProgram(const ProgramCode& program_code, const SwizzleData&
     }
 }
 
+bool IsStatelessGeometryShader(const ProgramCode& program_code, const SwizzleData& swizzle_data,
+                               u32 main_offset, u32 output_mask, u32 max_vertices) {
+    try {
+        GeometryShaderAnalyzer(program_code, swizzle_data, output_mask, max_vertices)
+            .Analyze(main_offset);
+        return true;
+    } catch (const DecompileFail& exception) {
+        LOG_INFO(HW_GPU, "Geometry shader needs the software path: {}", exception.what());
+        return false;
+    }
+}
+
 } // namespace Pica::Shader::Generator::GLSL
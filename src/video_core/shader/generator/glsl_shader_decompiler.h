@@ -15,6 +15,16 @@ using RegGetter = std::function<std::string(u32)>;
 std::string DecompileProgram(const Pica::ProgramCode& program_code,
                              const Pica::SwizzleData& swizzle_data, u32 main_offset,
                              const RegGetter& inputreg_getter, const RegGetter& outputreg_getter,
-                             bool sanitize_mul);
+                             bool sanitize_mul, bool is_gs = false);
+
+/**
+ * Checks whether a geometry shader program can run as a host geometry shader. Every invocation
+ * must write the registers, emitter state and buffered vertices it uses, and emit at most
+ * max_vertices vertices.
+ * @param output_mask the output registers that are emitted as vertex attributes.
+ */
+bool IsStatelessGeometryShader(const Pica::ProgramCode& program_code,
+                               const Pica::SwizzleData& swizzle_data, u32 main_offset,
+                               u32 output_mask, u32 max_vertices);
 
 } // namespace Pica::Shader::Generator::GLSL
@@ -5,6 +5,7 @@
 #include <string_view>
 #include <fmt/format.h>
 
+#include "common/logging/log.h"
 #include "video_core/pica/regs_rasterizer.h"
 #include "video_core/shader/generator/glsl_shader_decompiler.h"
 #include "video_core/shader/generator/glsl_shader_gen.h"
@@ -15,13 +16,15 @@ using VSOutputAttributes = Pica::RasterizerRegs::VSOutputAttributes;
 
 namespace Pica::Shader::Generator::GLSL {
 
-constexpr std::string_view VSPicaUniformBlockDef = R"(
+constexpr std::string_view PicaUniformsDef = R"(
 struct pica_uniforms {
     bool b[16];
     uvec4 i[4];
     vec4 f[96];
 };
+)";
 
+constexpr std::string_view VSPicaUniformBlockDef = R"(
 #ifdef VULKAN
 layout (set = 0, binding = 0, std140) uniform vs_pica_data {
 #else
@@ -31,6 +34,12 @@ layout (binding = 0, std140) uniform vs_pica_data {
 };
 )";
 
+constexpr std::string_view GSPicaUniformBlockDef = R"(
+layout (binding = 3, std140) uniform gs_pica_data {
+    pica_uniforms uniforms;
+};
+)";
+
 constexpr std::string_view VSUniformBlockDef = R"(
 #ifdef VULKAN
 layout (set = 0, binding = 1, std140) uniform vs_data {
@@ -168,6 +177,7 @@ std::string GenerateVertexShader(const ShaderSetup& setup, const PicaVSConfig& c
         out += "#extension GL_ARB_separate_shader_objects : enable\n";
     }
 
+    out += PicaUniformsDef;
     out += VSPicaUniformBlockDef;
     out += VSUniformBlockDef;
 
@@ -429,4 +439,120 @@ void main() {
 
     return out;
 }
+
+std::string GenerateGeometryShader(const ShaderSetup& setup, const PicaGSConfig& config,
+                                   bool separable_shader) {
+    const auto& state = config.state;
+    if (state.num_inputs % state.attributes_per_vertex != 0 || state.num_outputs == 0) {
+        return "";
+    }
+
+    u32 output_mask = 0;
+    for (u32 reg = 0; reg < 16; ++reg) {
+        if (state.output_map[reg] < state.num_outputs) {
+            output_mask |= 1 << reg;
+        }
+    }
+    if (!IsStatelessGeometryShader(setup.program_code, setup.swizzle_data, state.main_offset,
+                                   output_mask, MAX_GEOMETRY_SHADER_VERTICES)) {
+        return "";
+    }
+
+    std::string out;
+    if (separable_shader) {
+        out += "#extension GL_ARB_separate_shader_objects : enable\n";
+    }
+
+    switch (state.num_inputs / state.attributes_per_vertex) {
+    case 1:
+        out += "layout(points) in;\n";
+        break;
+    case 2:
+        out += "layout(lines) in;\n";
+        break;
+    case 3:
+        out += "layout(triangles) in;\n";
+        break;
+    case 4:
+        out += "layout(lines_adjacency) in;\n";
+        break;
+    case 6:
+        out += "layout(triangles_adjacency) in;\n";
+        break;
+    default:
+        LOG_ERROR(Render, "Unsupported geometry shader vertex count {}",
+                  state.num_inputs / state.attributes_per_vertex);
+        return "";
+    }
+    out += fmt::format("layout(triangle_strip, max_vertices = {}) out;\n\n",
+                       MAX_GEOMETRY_SHADER_VERTICES);
+
+    out += PicaUniformsDef;
+    out += GSPicaUniformBlockDef;
+    out += GetGSCommonSource(state.gs_state, separable_shader);
+
+    const auto get_input_reg = [&state](u32 reg) -> std::string {
+        ASSERT(reg < 16);
+        const u32 attr = state.input_map[reg];
+        if (attr < state.num_inputs) {
+            return fmt::format("vs_out_attr{}[{}]", attr % state.attributes_per_vertex,
+                               attr / state.attributes_per_vertex);
+        }
+        return "vec4(0.0, 0.0, 0.0, 1.0)";
+    };
+
+    const auto get_output_reg = [&state](u32 reg) -> std::string {
+        ASSERT(reg < 16);
+        const u32 attr = state.output_map[reg];
+        if (attr < state.num_outputs) {
+            return fmt::format("output_buffer.attributes[{}]", attr);
+        }
+        return "";
+    };
+
+    const auto program_source =
+        DecompileProgram(setup.program_code, setup.swizzle_data, state.main_offset, get_input_reg,
+                         get_output_reg, state.sanitize_mul, true);
+    if (program_source.empty()) {
+        return "";
+    }
+
+    out += R"(
+Vertex output_buffer;
+Vertex prim_buffer[3];
+uint vertex_id;
+bool prim_emit;
+bool winding;
+
+bool exec_shader();
+
+void setemit(uint vertex_id_, bool prim_emit_, bool winding_) {
+    vertex_id = vertex_id_;
+    prim_emit = prim_emit_;
+    winding = winding_;
+}
+
+void emit() {
+    prim_buffer[vertex_id] = output_buffer;
+    if (prim_emit) {
+        if (winding) {
+            EmitPrim(prim_buffer[1], prim_buffer[0], prim_buffer[2]);
+        } else {
+            EmitPrim(prim_buffer[0], prim_buffer[1], prim_buffer[2]);
+        }
+    }
+}
+
+void main() {
+)";
+    for (u32 i = 0; i < state.num_outputs; ++i) {
+        out += fmt::format("    output_buffer.attributes[{}] = vec4(0.0, 0.0, 0.0, 1.0);\n", i);
+    }
+    out += "\n    exec_shader();\n}\n\n";
+
+    out += program_source;
+
+    return out;
+}
+
 } // namespace Pica::Shader::Generator::GLSL
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <string>
+#include "common/common_types.h"
+
 // High precision may or may not be supported in GLES3. If it isn't, use medium precision instead.
 static constexpr char fragment_shader_precision_OES[] = R"(
 #if GL_ES
@@ -27,11 +30,15 @@ struct ShaderSetup;
 
 namespace Pica::Shader::Generator {
 struct PicaVSConfig;
+struct PicaGSConfig;
 struct PicaFixedGSConfig;
 } // namespace Pica::Shader::Generator
 
 namespace Pica::Shader::Generator::GLSL {
 
+/// Maximum number of vertices emitted by a single invocation of a translated geometry shader.
+constexpr u32 MAX_GEOMETRY_SHADER_VERTICES = 30;
+
 /**
  * Generates the GLSL vertex shader program source code that accepts vertices from software shader
  * and directly passes them to the fragment shader.
@@ -46,6 +53,13 @@ std::string GenerateTrivialVertexShader(bool use_clip_planes, bool separable_sha
 std::string GenerateVertexShader(const Pica::ShaderSetup& setup, const PicaVSConfig& config,
                                  bool separable_shader);
 
+/**
+ * Generates the GLSL geometry shader program source code for the given GS program
+ * @returns String of the shader source code; empty on failure
+ */
+std::string GenerateGeometryShader(const Pica::ShaderSetup& setup, const PicaGSConfig& config,
+                                   bool separable_shader);
+
 /**
  * Generates the GLSL fixed geometry shader program source code for non-GS PICA pipeline
  * @returns String of the shader source code
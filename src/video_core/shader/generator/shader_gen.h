@@ -86,6 +86,30 @@ struct PicaVSConfigState {
     PicaGSConfigState gs_state;
 };
 
+/**
+ * This struct contains information to identify a GLSL geometry shader translated from a PICA
+ * geometry shader running in Point mode.
+ */
+struct PicaProgrammableGSConfigState {
+    void Init(const Pica::RegsInternal& regs, Pica::ShaderSetup& setup, bool use_clip_planes_);
+
+    u64 program_hash;
+    u64 swizzle_hash;
+    u32 main_offset;
+    bool sanitize_mul;
+
+    u32 num_inputs;
+    u32 attributes_per_vertex;
+    // input_map[input register index] -> input attribute index
+    std::array<u32, 16> input_map;
+
+    u32 num_outputs;
+    // output_map[output register index] -> output attribute index
+    std::array<u32, 16> output_map;
+
+    PicaGSConfigState gs_state;
+};
+
 /**
  * This struct contains information to identify a GL vertex shader generated from PICA vertex
  * shader.
@@ -103,6 +127,21 @@ struct PicaFixedGSConfig : Common::HashableStruct<PicaGSConfigState> {
     explicit PicaFixedGSConfig(const Pica::RegsInternal& regs, bool use_clip_planes_);
 };
 
+/**
+ * This struct contains information to identify a GL geometry shader generated from PICA geometry
+ * shader.
+ */
+struct PicaGSConfig : Common::HashableStruct<PicaProgrammableGSConfigState> {
+    explicit PicaGSConfig(const Pica::RegsInternal& regs, Pica::ShaderSetup& setup,
+                          bool use_clip_planes_);
+};
+
+/**
+ * Returns the number of vertices read by every invocation of a geometry shader in Point mode, or 0
+ * if its inputs do not split into whole vertices.
+ */
+u32 GetGSVerticesPerInvocation(const Pica::RegsInternal& regs);
+
 } // namespace Pica::Shader::Generator
 
 namespace std {
@@ -113,6 +152,13 @@ struct hash<Pica::Shader::Generator::PicaVSConfig> {
     }
 };
 
+template <>
+struct hash<Pica::Shader::Generator::PicaGSConfig> {
+    std::size_t operator()(const Pica::Shader::Generator::PicaGSConfig& k) const noexcept {
+        return k.Hash();
+    }
+};
+
 template <>
 struct hash<Pica::Shader::Generator::PicaFixedGSConfig> {
     std::size_t operator()(const Pica::Shader::Generator::PicaFixedGSConfig& k) const noexcept {
@@ -105,4 +105,12 @@ static_assert(sizeof(VSPicaUniformData) == 1856,
 static_assert(sizeof(VSPicaUniformData) < 16384,
               "VSPicaUniformData structure must be less than 16kb as per the OpenGL spec");
 
+struct GSPicaUniformData {
+    alignas(16) PicaUniformsData uniforms;
+};
+static_assert(sizeof(GSPicaUniformData) == 1856,
+              "The size of the GSPicaUniformData does not match the structure in the shader");
+static_assert(sizeof(GSPicaUniformData) < 16384,
+              "GSPicaUniformData structure must be less than 16kb as per the OpenGL spec");
+
 } // namespace Pica::Shader::Generator
@@ -29,6 +29,9 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, ShaderUnit& state) const = 0;
+
+    /// Sets the title id of the running application, used to key per-title data.
+    virtual void SetTitleId([[maybe_unused]] u64 title_id) {}
 };
 
 std::unique_ptr<ShaderEngine> CreateEngine(bool use_jit);
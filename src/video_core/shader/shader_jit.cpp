@@ -5,9 +5,21 @@
 #include "common/arch.h"
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include <fmt/format.h>
 #include "common/assert.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
 #include "common/hash.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/perf_counters.h"
+#include "common/settings.h"
+#include "common/zstd_compression.h"
+#include "video_core/pica/shader_setup.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit.h"
 #if CITRA_ARCH(arm64)
@@ -19,32 +31,154 @@
 
 namespace Pica::Shader {
 
-JitEngine::JitEngine() = default;
-JitEngine::~JitEngine() = default;
+namespace {
+
+/// Maximum number of compiled programs kept in memory
+constexpr std::size_t MAX_CACHED_PROGRAMS = 512;
+
+constexpr u32 PERSISTENT_CACHE_MAGIC = 0x54494A50; // "PJIT"
+constexpr u32 PERSISTENT_CACHE_VERSION = 2;
+
+struct PersistentCacheHeader {
+    u32 magic;
+    u32 version;
+};
+
+/// Precedes the zstd compressed ProgramSource of every program in the persistent cache.
+struct PersistentEntryHeader {
+    u64 key;
+    u32 compressed_size;
+    u32 reserved;
+};
+
+/// The inputs of a compilation, copied so the guest may overwrite them while it is in progress.
+struct ProgramSource {
+    ProgramCode program_code;
+    SwizzleData swizzle_data;
+};
+
+u64 GetProgramKey(u64 code_hash, u64 swizzle_hash) {
+    return Common::HashCombine(code_hash, swizzle_hash);
+}
+
+u64 GetProgramKey(const ProgramSource& source) {
+    return GetProgramKey(IncrementalHash<MAX_PROGRAM_CODE_LENGTH>::Compute(source.program_code),
+                         IncrementalHash<MAX_SWIZZLE_DATA_LENGTH>::Compute(source.swizzle_data));
+}
+
+std::span<const u8> AsBytes(const ProgramSource& source) {
+    return {reinterpret_cast<const u8*>(&source), sizeof(source)};
+}
+
+/// A program read from the persistent cache.
+struct PersistedProgram {
+    u64 key;
+    std::span<const u8> compressed_source;
+};
+
+/// Writes a persistent cache with the given programs and moves it over the one at path.
+bool WritePersistentCache(const std::string& path, std::span<const PersistedProgram> programs) {
+    const std::string temp_path = path + ".tmp";
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        const PersistentCacheHeader header{PERSISTENT_CACHE_MAGIC, PERSISTENT_CACHE_VERSION};
+        bool good = file.IsOpen() && file.WriteObject(header) == 1;
+        for (const auto& [key, compressed_source] : programs) {
+            const PersistentEntryHeader entry{key, static_cast<u32>(compressed_source.size()), 0};
+            good = good && file.WriteObject(entry) == 1 &&
+                   file.WriteBytes(compressed_source.data(), compressed_source.size()) ==
+                       compressed_source.size();
+        }
+        if (!good) {
+            file.Close();
+            FileUtil::Delete(temp_path);
+            return false;
+        }
+    }
+    return FileUtil::Replace(temp_path, path);
+}
+
+} // Anonymous namespace
+
+struct JitEngine::Program {
+    std::unique_ptr<JitShader> shader;
+    /// Set by the compiler thread once shader can be used.
+    std::atomic<bool> ready{};
+    /// Set by the compiler thread if the persisted source of the program was corrupted.
+    std::atomic<bool> invalid{};
+
+    void Compile(const ProgramSource& source) {
+        static const Common::Perf::Counter jit_compiles{"Shader JIT compiles"};
+        jit_compiles.Add();
+        PERF_TRACE_SCOPE("Compile shader JIT");
+        auto jit_shader = std::make_unique<JitShader>();
+        jit_shader->Compile(&source.program_code, &source.swizzle_data);
+        shader = std::move(jit_shader);
+        ready.store(true, std::memory_order_release);
+    }
+};
+
+JitEngine::JitEngine() : compiler{std::make_unique<Common::ThreadWorker>(1, "ShaderJit")} {}
+
+JitEngine::~JitEngine() {
+    // Stop the compiler thread first, its tasks use the cache and the persistent cache file.
+    compiler.reset();
+}
 
 void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.entry_point = entry_point;
 
-    const u64 code_hash = setup.GetProgramCodeHash();
-    const u64 swizzle_hash = setup.GetSwizzleDataHash();
+    if (!persistent_cache_loaded) {
+        LoadPersistentCache();
+    }
 
-    const u64 cache_key = Common::HashCombine(code_hash, swizzle_hash);
-    auto iter = cache.find(cache_key);
+    const u64 key = GetProgramKey(setup.GetProgramCodeHash(), setup.GetSwizzleDataHash());
+    auto iter = cache.find(key);
+    if (iter != cache.end() && iter->second.program->invalid.load(std::memory_order_acquire)) {
+        // Compile it again from the guest program, persisting a good copy.
+        lru.erase(iter->second.lru_position);
+        cache.erase(iter);
+        persisted_keys.erase(key);
+        iter = cache.end();
+    }
     if (iter != cache.end()) {
-        setup.cached_shader = iter->second.get();
-    } else {
-        auto shader = std::make_unique<JitShader>();
-        shader->Compile(&setup.program_code, &setup.swizzle_data);
-        setup.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
+        lru.splice(lru.begin(), lru, iter->second.lru_position);
+        const Program& program = *iter->second.program;
+        setup.cached_shader =
+            program.ready.load(std::memory_order_acquire) ? program.shader.get() : nullptr;
+        return;
     }
+
+    // Interpret the program until the compiler thread is done with it.
+    static const Common::Perf::Counter cache_misses{"Shader JIT cache misses"};
+    cache_misses.Add();
+    setup.cached_shader = nullptr;
+
+    auto source = std::make_unique<ProgramSource>();
+    source->program_code = setup.program_code;
+    source->swizzle_data = setup.swizzle_data;
+    const bool persist = !persistent_cache_path.empty() && persisted_keys.insert(key).second;
+    compiler->QueueWork([this, key, persist, program = InsertProgram(key),
+                        source = std::move(source)] {
+        program->Compile(*source);
+        if (persist) {
+            PersistProgram(key, Common::Compression::CompressDataZSTDDefault(AsBytes(*source)));
+        }
+    });
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
 
+void JitEngine::SetTitleId(u64 title_id_) {
+    title_id = title_id_;
+}
+
 void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
-    ASSERT(setup.cached_shader != nullptr);
+    if (setup.cached_shader == nullptr) {
+        interpreter.Run(setup, state);
+        return;
+    }
 
     MICROPROFILE_SCOPE(GPU_Shader);
 
@@ -52,6 +186,127 @@ void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     shader->Run(setup, state, setup.entry_point);
 }
 
+std::shared_ptr<JitEngine::Program> JitEngine::InsertProgram(u64 key) {
+    // The shaders used by the current draw were just moved to the front, so they are never
+    // evicted. A program that is still compiling is kept alive by its compilation task.
+    if (cache.size() >= MAX_CACHED_PROGRAMS) {
+        cache.erase(lru.back());
+        lru.pop_back();
+    }
+    lru.push_front(key);
+    auto program = std::make_shared<Program>();
+    cache.emplace(key, CacheEntry{program, lru.begin()});
+    return program;
+}
+
+void JitEngine::LoadPersistentCache() {
+    persistent_cache_loaded = true;
+
+    if (!Settings::values.use_disk_shader_cache.GetValue() || title_id == 0) {
+        return;
+    }
+    persistent_cache_path =
+        fmt::format("{}pica_jit" DIR_SEP "{:016X}.bin",
+                    FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir), title_id);
+
+    std::string data;
+    FileUtil::ReadFileToString(false, persistent_cache_path, data);
+    PersistentCacheHeader header{};
+    if (data.size() >= sizeof(header)) {
+        std::memcpy(&header, data.data(), sizeof(header));
+    }
+    if (header.magic != PERSISTENT_CACHE_MAGIC || header.version != PERSISTENT_CACHE_VERSION) {
+        // Missing or outdated, start a new one.
+        CreatePersistentCache();
+        return;
+    }
+
+    std::vector<PersistedProgram> appended;
+    bool truncated = false;
+    std::size_t offset = sizeof(header);
+    while (offset + sizeof(PersistentEntryHeader) <= data.size()) {
+        PersistentEntryHeader entry;
+        std::memcpy(&entry, data.data() + offset, sizeof(entry));
+        offset += sizeof(entry);
+        if (offset + entry.compressed_size > data.size()) {
+            LOG_WARNING(HW_GPU, "Ignoring the truncated end of {}", persistent_cache_path);
+            truncated = true;
+            break;
+        }
+        appended.push_back({entry.key, {reinterpret_cast<const u8*>(data.data()) + offset,
+                                        entry.compressed_size}});
+        offset += entry.compressed_size;
+    }
+
+    // Programs are appended as they are found, a later copy replaces an earlier one. Only the
+    // most recently persisted programs are kept, the others would be evicted from the cache right
+    // after being compiled.
+    std::vector<PersistedProgram> programs;
+    for (auto it = appended.rbegin(); it != appended.rend(); ++it) {
+        if (programs.size() == MAX_CACHED_PROGRAMS) {
+            break;
+        }
+        if (persisted_keys.insert(it->key).second) {
+            programs.push_back(*it);
+        }
+    }
+    std::reverse(programs.begin(), programs.end());
+
+    if (truncated || programs.size() != appended.size()) {
+        // Compact the file so that it does not grow with every boot.
+        if (!WritePersistentCache(persistent_cache_path, programs)) {
+            LOG_ERROR(HW_GPU, "Failed to compact the shader JIT cache {}", persistent_cache_path);
+        }
+    }
+
+    // The most recently persisted programs are inserted last, so they are the last evicted.
+    for (const auto& [key, compressed_source] : programs) {
+        compiler->QueueWork(
+            [key, program = InsertProgram(key),
+             compressed = std::vector<u8>(compressed_source.begin(), compressed_source.end())] {
+                const std::vector<u8> decompressed =
+                    Common::Compression::DecompressDataZSTD(compressed);
+                auto source = std::make_unique<ProgramSource>();
+                if (decompressed.size() == sizeof(ProgramSource)) {
+                    std::memcpy(source.get(), decompressed.data(), sizeof(ProgramSource));
+                }
+                if (decompressed.size() != sizeof(ProgramSource) ||
+                    GetProgramKey(*source) != key) {
+                    LOG_WARNING(HW_GPU, "Ignoring corrupted shader JIT cache entry {:016X}", key);
+                    program->invalid.store(true, std::memory_order_release);
+                    return;
+                }
+                program->Compile(*source);
+            });
+    }
+    LOG_INFO(HW_GPU, "Compiling {} shader programs from {}", programs.size(),
+             persistent_cache_path);
+}
+
+void JitEngine::CreatePersistentCache() {
+    if (!FileUtil::CreateFullPath(persistent_cache_path)) {
+        LOG_ERROR(HW_GPU, "Failed to create the directory of {}", persistent_cache_path);
+        persistent_cache_path.clear();
+        return;
+    }
+    const PersistentCacheHeader header{PERSISTENT_CACHE_MAGIC, PERSISTENT_CACHE_VERSION};
+    FileUtil::IOFile file(persistent_cache_path, "wb");
+    if (!file.IsOpen() || file.WriteObject(header) != 1) {
+        LOG_ERROR(HW_GPU, "Failed to create the shader JIT cache {}", persistent_cache_path);
+        persistent_cache_path.clear();
+    }
+}
+
+void JitEngine::PersistProgram(u64 key, std::span<const u8> compressed_source) {
+    FileUtil::IOFile file(persistent_cache_path, "ab");
+    const PersistentEntryHeader entry{key, static_cast<u32>(compressed_source.size()), 0};
+    if (!file.IsOpen() || file.WriteObject(entry) != 1 ||
+        file.WriteBytes(compressed_source.data(), compressed_source.size()) !=
+            compressed_source.size()) {
+        LOG_ERROR(HW_GPU, "Failed to write to the shader JIT cache {}", persistent_cache_path);
+    }
+}
+
 } // namespace Pica::Shader
 
 #endif // CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
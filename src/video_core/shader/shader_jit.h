@@ -7,15 +7,27 @@
 #include "common/arch.h"
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
 
+#include <list>
 #include <memory>
+#include <span>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "video_core/shader/shader.h"
+#include "video_core/shader/shader_interpreter.h"
 
 namespace Pica::Shader {
 
 class JitShader;
 
+/**
+ * Shader engine that runs programs with the JIT. New programs are compiled on a background thread
+ * and run in the interpreter until they are ready, so streaming shaders does not stall emulation.
+ * The compiled programs are kept in a LRU cache and their sources are persisted per title, so they
+ * can be compiled ahead of time on the next boot.
+ */
 class JitEngine final : public ShaderEngine {
 public:
     JitEngine();
@@ -23,9 +35,40 @@ public:
 
     void SetupBatch(ShaderSetup& setup, u32 entry_point) override;
     void Run(const ShaderSetup& setup, ShaderUnit& state) const override;
+    void SetTitleId(u64 title_id) override;
 
 private:
-    std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    struct Program;
+    struct CacheEntry {
+        std::shared_ptr<Program> program;
+        std::list<u64>::iterator lru_position;
+    };
+
+    /// Adds a program that is not compiled yet to the cache, evicting the least recently used one.
+    std::shared_ptr<Program> InsertProgram(u64 key);
+
+    /// Reads the programs persisted by previous boots, compacts the file and queues the most
+    /// recent ones for compilation.
+    void LoadPersistentCache();
+
+    /// Starts an empty persistent cache at persistent_cache_path, clearing the path on failure.
+    void CreatePersistentCache();
+
+    /// Appends a program source to the persistent cache, called on the compiler thread.
+    void PersistProgram(u64 key, std::span<const u8> compressed_source);
+
+    InterpreterEngine interpreter;
+
+    std::unordered_map<u64, CacheEntry> cache;
+    /// Keys of the cached programs, the most recently used first.
+    std::list<u64> lru;
+
+    u64 title_id{};
+    bool persistent_cache_loaded{};
+    std::string persistent_cache_path;
+    std::unordered_set<u64> persisted_keys;
+
+    std::unique_ptr<Common::ThreadWorker> compiler;
 };
 
 } // namespace Pica::Shader